@@ -14,4 +14,9 @@ public class GLFrameDemoView extends SkityDemoView {
     protected com.skity.graphic.Renderer generateRender() {
         return new GLFrameRender();
     }
+
+    @Override
+    protected int msaaSamples() {
+        return 4;
+    }
 }
@@ -3,6 +3,7 @@ package com.skity.android;
 import android.content.Context;
 import android.opengl.GLES30;
 import android.opengl.GLSurfaceView;
+import android.view.MotionEvent;
 
 import com.skity.graphic.Renderer;
 
@@ -21,7 +22,7 @@ public class SkityDemoView extends GLSurfaceView implements GLSurfaceView.EGLCon
         setEGLConfigChooser(this);
         setEGLContextClientVersion(3);
 
-        mRenderer = new MRenderer(this, generateRender());
+        mRenderer = new MRenderer(this, generateRender(), msaaSamples());
 
         setRenderer(mRenderer);
     }
@@ -30,12 +31,43 @@ public class SkityDemoView extends GLSurfaceView implements GLSurfaceView.EGLCon
         mRenderer.onDestroy();
     }
 
+    @Override
+    public boolean onTouchEvent(MotionEvent event) {
+        int action = event.getActionMasked();
+        boolean down = action != MotionEvent.ACTION_UP && action != MotionEvent.ACTION_CANCEL;
+        // written straight into the native input channel, the next frame picks it up
+        mRenderer.mRender.setInput(event.getX(), event.getY(), down,
+                event.getEventTime() * 1000000L);
+        return true;
+    }
+
     protected com.skity.graphic.Renderer generateRender() {
         return new com.skity.graphic.Renderer();
     }
 
+    /**
+     * Sample count asked from the EGL config and handed to Renderer.setMSAASamples(). 0 keeps the
+     * default 4x window surface.
+     */
+    protected int msaaSamples() {
+        return 0;
+    }
+
     @Override
     public EGLConfig chooseConfig(EGL10 egl10, EGLDisplay eglDisplay) {
+        int samples = msaaSamples() > 0 ? msaaSamples() : 4;
+
+        EGLConfig config = chooseConfig(egl10, eglDisplay, samples);
+        if (config == null) {
+            // a single sampled window, Renderer multisamples into an offscreen target if it can
+            config = chooseConfig(egl10, eglDisplay, 0);
+        }
+
+        return config;
+    }
+
+    private static EGLConfig chooseConfig(EGL10 egl10, EGLDisplay eglDisplay, int samples) {
+        // the stencil is kept in every config, path fills need it whichever target is drawn to
         int[] attrs = {
                 EGL10.EGL_RED_SIZE, 8,
                 EGL10.EGL_GREEN_SIZE, 8,
@@ -43,8 +75,8 @@ public class SkityDemoView extends GLSurfaceView implements GLSurfaceView.EGLCon
                 EGL10.EGL_ALPHA_SIZE, 8,
                 EGL10.EGL_DEPTH_SIZE, 0,
                 EGL10.EGL_STENCIL_SIZE, 8,
-                EGL10.EGL_SAMPLE_BUFFERS, 1,
-                EGL10.EGL_SAMPLES, 4,
+                EGL10.EGL_SAMPLE_BUFFERS, samples > 0 ? 1 : 0,
+                EGL10.EGL_SAMPLES, samples,
                 EGL10.EGL_NONE,
         };
 
@@ -63,10 +95,12 @@ public class SkityDemoView extends GLSurfaceView implements GLSurfaceView.EGLCon
     private static class MRenderer implements GLSurfaceView.Renderer {
         private final GLSurfaceView mView;
         private final com.skity.graphic.Renderer mRender;
+        private final int mSamples;
 
-        private MRenderer(GLSurfaceView view, com.skity.graphic.Renderer nativeRender) {
+        private MRenderer(GLSurfaceView view, com.skity.graphic.Renderer nativeRender, int samples) {
             this.mView = view;
             mRender = nativeRender;
+            mSamples = samples;
         }
 
 
@@ -76,6 +110,7 @@ public class SkityDemoView extends GLSurfaceView implements GLSurfaceView.EGLCon
                     , mView.getHeight()
                     , (int) mView.getContext().getResources().getDisplayMetrics().density
                     , mView.getContext());
+            mRender.setMSAASamples(mSamples);
         }
 
         @Override
@@ -3,6 +3,7 @@ package com.skity.android;
 import android.content.Context;
 import android.graphics.Rect;
 import android.util.Log;
+import android.view.MotionEvent;
 import android.view.Surface;
 import android.view.SurfaceHolder;
 import android.view.SurfaceView;
@@ -26,12 +27,24 @@ public abstract class SkityVkDemoView extends SurfaceView implements SurfaceHold
         mRenderer.draw();
     }
 
+    @Override
+    public boolean onTouchEvent(MotionEvent event) {
+        int action = event.getActionMasked();
+        boolean down = action != MotionEvent.ACTION_UP && action != MotionEvent.ACTION_CANCEL;
+        // written straight into the native input channel, the next frame picks it up
+        mRenderer.setInput(event.getX(), event.getY(), down, event.getEventTime() * 1000000L);
+        return true;
+    }
+
     @Override
     public void surfaceCreated(@NonNull SurfaceHolder holder) {
         Surface surface = holder.getSurface();
         Rect rect = holder.getSurfaceFrame();
         mRenderer.destroy();
         mRenderer.init(rect.width(), rect.height(), (int) getContext().getResources().getDisplayMetrics().density, getContext(), surface);
+        if (useNativeFrameLoop()) {
+            mRenderer.startFrameLoop();
+        }
     }
 
     @Override
@@ -45,4 +58,12 @@ public abstract class SkityVkDemoView extends SurfaceView implements SurfaceHold
     }
 
     protected abstract VkRenderer generateRender();
+
+    /**
+     * Let the renderer schedule its own frames on vsync while the surface exists, instead of the
+     * activity calling {@link #draw()}.
+     */
+    protected boolean useNativeFrameLoop() {
+        return false;
+    }
 }
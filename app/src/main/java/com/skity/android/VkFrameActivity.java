@@ -4,9 +4,8 @@ import androidx.appcompat.app.AppCompatActivity;
 
 import android.content.pm.ActivityInfo;
 import android.os.Bundle;
-import android.view.Choreographer;
 
-public class VkFrameActivity extends AppCompatActivity implements Choreographer.FrameCallback {
+public class VkFrameActivity extends AppCompatActivity {
 
     VkFrameDemoView mView;
 
@@ -14,26 +13,8 @@ public class VkFrameActivity extends AppCompatActivity implements Choreographer.
     protected void onCreate(Bundle savedInstanceState) {
         super.onCreate(savedInstanceState);
         setRequestedOrientation(ActivityInfo.SCREEN_ORIENTATION_LANDSCAPE);
+        // renders itself on vsync while its surface exists
         mView = new VkFrameDemoView(this);
         setContentView(mView);
     }
-
-    @Override
-    protected void onResume() {
-        super.onResume();
-        Choreographer.getInstance().postFrameCallback(this);
-    }
-
-    @Override
-    protected void onPause() {
-        super.onPause();
-        Choreographer.getInstance().removeFrameCallback(this);
-    }
-
-    @Override
-    public void doFrame(long frameTimeNanos) {
-        mView.draw();
-
-        Choreographer.getInstance().postFrameCallback(this);
-    }
-}
\ No newline at end of file
+}
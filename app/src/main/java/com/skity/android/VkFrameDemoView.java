@@ -15,4 +15,9 @@ public class VkFrameDemoView extends SkityVkDemoView{
     protected VkRenderer generateRender() {
         return new VkFrameRender();
     }
+
+    @Override
+    protected boolean useNativeFrameLoop() {
+        return true;
+    }
 }
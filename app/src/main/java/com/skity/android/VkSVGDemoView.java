@@ -1,17 +1,80 @@
 package com.skity.android;
 
 import android.content.Context;
+import android.view.GestureDetector;
+import android.view.MotionEvent;
+import android.view.ScaleGestureDetector;
+import android.view.SurfaceHolder;
+
+import androidx.annotation.NonNull;
 
 import com.skity.graphic.VkRenderer;
 import com.skity.graphic.VkSVGRenderer;
 
 public class VkSVGDemoView extends SkityVkDemoView {
+    private VkSVGRenderer mSVGRenderer;
+    private final ScaleGestureDetector mScaleDetector;
+    private final GestureDetector mPanDetector;
+
+    // the document is scaled by mZoom, then moved by (mX, mY)
+    private float mZoom = 1.f;
+    private float mX = 50.f;
+    private float mY = 50.f;
+
     public VkSVGDemoView(Context context) {
         super(context);
+
+        mScaleDetector = new ScaleGestureDetector(context,
+                new ScaleGestureDetector.SimpleOnScaleGestureListener() {
+                    @Override
+                    public boolean onScale(ScaleGestureDetector detector) {
+                        float zoom = Math.max(1.f / 256.f,
+                                Math.min(mZoom * detector.getScaleFactor(), 256.f));
+                        float factor = zoom / mZoom;
+                        // keep the document point under the focus in place
+                        mX = detector.getFocusX() - (detector.getFocusX() - mX) * factor;
+                        mY = detector.getFocusY() - (detector.getFocusY() - mY) * factor;
+                        mZoom = zoom;
+                        updateView();
+                        return true;
+                    }
+                });
+        mPanDetector = new GestureDetector(context, new GestureDetector.SimpleOnGestureListener() {
+            @Override
+            public boolean onScroll(MotionEvent e1, MotionEvent e2, float distanceX,
+                                    float distanceY) {
+                mX -= distanceX;
+                mY -= distanceY;
+                updateView();
+                return true;
+            }
+        });
     }
 
     @Override
     protected VkRenderer generateRender() {
-        return new VkSVGRenderer();
+        mSVGRenderer = new VkSVGRenderer();
+        return mSVGRenderer;
+    }
+
+    @Override
+    public void surfaceCreated(@NonNull SurfaceHolder holder) {
+        super.surfaceCreated(holder);
+
+        // a new native renderer, it starts from the default view
+        updateView();
+    }
+
+    @Override
+    public boolean onTouchEvent(MotionEvent event) {
+        mScaleDetector.onTouchEvent(event);
+        if (!mScaleDetector.isInProgress()) {
+            mPanDetector.onTouchEvent(event);
+        }
+        return super.onTouchEvent(event);
+    }
+
+    private void updateView() {
+        mSVGRenderer.setView(mZoom, mX, mY);
     }
 }
@@ -0,0 +1,4 @@
+# Natives are registered by name in JNI_OnLoad
+-keepclasseswithmembernames,includedescriptorclasses class com.skity.graphic.** {
+    native <methods>;
+}
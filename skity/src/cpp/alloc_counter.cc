@@ -0,0 +1,241 @@
+
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "platform_log.hpp"
+
+static const char *kTAG = "SkityAlloc";
+#define LOGI(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_INFO, kTAG, __VA_ARGS__))
+
+constexpr size_t AllocCounter::kMaxThreads;
+constexpr uint32_t AllocFrameMeter::kReportFrames;
+
+namespace {
+
+struct ThreadSlot {
+    std::atomic<int32_t> tid = {0};
+    std::atomic<uint64_t> allocations = {0};
+    std::atomic<uint64_t> frees = {0};
+    std::atomic<uint64_t> bytes = {0};
+};
+
+// plain arrays and pthread keys, nothing here may allocate
+ThreadSlot g_slots[AllocCounter::kMaxThreads];
+std::atomic<size_t> g_slot_count = {0};
+pthread_key_t g_slot_key;
+pthread_once_t g_slot_once = PTHREAD_ONCE_INIT;
+
+void create_slot_key() {
+    pthread_key_create(&g_slot_key, nullptr);
+}
+
+ThreadSlot *current_slot() {
+    pthread_once(&g_slot_once, create_slot_key);
+
+    auto slot = static_cast<ThreadSlot *>(pthread_getspecific(g_slot_key));
+    if (slot) {
+        return slot;
+    }
+
+    size_t index = g_slot_count.fetch_add(1);
+    if (index >= AllocCounter::kMaxThreads) {
+        index = AllocCounter::kMaxThreads - 1;
+        g_slot_count = AllocCounter::kMaxThreads;
+    }
+
+    slot = &g_slots[index];
+    slot->tid = static_cast<int32_t>(syscall(SYS_gettid));
+    pthread_setspecific(g_slot_key, slot);
+
+    return slot;
+}
+
+AllocCounts read_slot(ThreadSlot const &slot) {
+    AllocCounts counts;
+    counts.allocations = slot.allocations.load(std::memory_order_relaxed);
+    counts.frees = slot.frees.load(std::memory_order_relaxed);
+    counts.bytes = slot.bytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+AllocCounts operator-(AllocCounts const &a, AllocCounts const &b) {
+    return AllocCounts{a.allocations - b.allocations, a.frees - b.frees, a.bytes - b.bytes};
+}
+
+}  // namespace
+
+#ifdef SKITY_ALLOC_COUNTER
+
+static void count_allocation(size_t size) {
+    auto slot = current_slot();
+    slot->allocations.fetch_add(1, std::memory_order_relaxed);
+    slot->bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+static void count_free(void *ptr) {
+    if (ptr) {
+        current_slot()->frees.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// resolved by -Wl,--wrap, see SKITY_ALLOC_COUNTER in CMakeLists.txt
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    count_allocation(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    count_allocation(count * size);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    count_free(ptr);
+    count_allocation(size);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    count_free(ptr);
+    __real_free(ptr);
+}
+}
+
+static void *counted_new(size_t size) {
+    count_allocation(size);
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    while (true) {
+        void *ptr = __real_malloc(size);
+        if (ptr) {
+            return ptr;
+        }
+
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void counted_delete(void *ptr) {
+    count_free(ptr);
+    __real_free(ptr);
+}
+
+void *operator new(size_t size) {
+    return counted_new(size);
+}
+
+void *operator new[](size_t size) {
+    return counted_new(size);
+}
+
+void *operator new(size_t size, std::nothrow_t const &) noexcept {
+    count_allocation(size);
+    return __real_malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, std::nothrow_t const &) noexcept {
+    count_allocation(size);
+    return __real_malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept {
+    counted_delete(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    counted_delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    counted_delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    counted_delete(ptr);
+}
+
+void operator delete(void *ptr, std::nothrow_t const &) noexcept {
+    counted_delete(ptr);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const &) noexcept {
+    counted_delete(ptr);
+}
+
+#endif  // SKITY_ALLOC_COUNTER
+
+AllocCounts AllocCounter::CurrentThread() {
+    if (!Enabled()) {
+        return {};
+    }
+
+    return read_slot(*current_slot());
+}
+
+size_t AllocCounter::Snapshot(std::array<ThreadAllocCounts, kMaxThreads> *out) {
+    size_t count = std::min<size_t>(g_slot_count, kMaxThreads);
+
+    for (size_t i = 0; i < count; i++) {
+        (*out)[i].tid = g_slots[i].tid;
+        (*out)[i].counts = read_slot(g_slots[i]);
+    }
+
+    return count;
+}
+
+AllocCounts AllocFrameMeter::tick() {
+    AllocCounts now = AllocCounter::CurrentThread();
+    AllocCounts frame = now - last_;
+    last_ = now;
+
+    frames_++;
+
+    return frame;
+}
+
+void AllocFrameMeter::report(const char *name) {
+    if (!AllocCounter::Enabled() || frames_ < kReportFrames) {
+        return;
+    }
+
+    size_t count = AllocCounter::Snapshot(&current_);
+
+    for (size_t i = 0; i < count; i++) {
+        AllocCounts base = i < report_count_ ? report_base_[i].counts : AllocCounts{};
+        AllocCounts delta = current_[i].counts - base;
+        if (delta.allocations == 0) {
+            continue;
+        }
+
+        LOGI("%s tid %d: %.1f allocs / %.1f frees / %.1f KB per frame", name, current_[i].tid,
+             static_cast<double>(delta.allocations) / frames_,
+             static_cast<double>(delta.frees) / frames_,
+             static_cast<double>(delta.bytes) / frames_ / 1024.0);
+    }
+
+    report_base_ = current_;
+    report_count_ = count;
+    frames_ = 0;
+}
@@ -0,0 +1,84 @@
+
+#ifndef SKITY_ANDROID_ALLOC_COUNTER_HPP
+#define SKITY_ANDROID_ALLOC_COUNTER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct AllocCounts {
+    uint64_t allocations = {};
+    uint64_t frees = {};
+    uint64_t bytes = {};
+};
+
+struct ThreadAllocCounts {
+    int32_t tid = {};
+    AllocCounts counts = {};
+};
+
+/**
+ * Heap allocation counts per thread.
+ *
+ * Only counts when built with -DSKITY_ALLOC_COUNTER=ON, which replaces
+ * operator new/delete and wraps malloc, calloc, realloc and free of the
+ * wrapper and the statically linked Skity (-Wl,--wrap). Otherwise every
+ * count stays 0.
+ */
+class AllocCounter {
+public:
+    // threads past this share the last slot
+    static constexpr size_t kMaxThreads = 64;
+
+    static constexpr bool Enabled() {
+#ifdef SKITY_ALLOC_COUNTER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static AllocCounts CurrentThread();
+
+    /**
+     * Copy the totals of every thread that allocated so far into out without
+     * allocating.
+     *
+     * @return number of entries written
+     */
+    static size_t Snapshot(std::array<ThreadAllocCounts, kMaxThreads> *out);
+};
+
+/**
+ * Turns the running AllocCounter totals into per frame numbers, ticked once
+ * per frame on the render thread.
+ */
+class AllocFrameMeter {
+public:
+    // frames between two report() logs
+    static constexpr uint32_t kReportFrames = 300;
+
+    AllocFrameMeter() = default;
+
+    ~AllocFrameMeter() = default;
+
+    /**
+     * @return what the calling thread allocated since the last tick
+     */
+    AllocCounts tick();
+
+    /**
+     * Log the average allocations per frame of every thread since the last
+     * report, once every kReportFrames ticks.
+     */
+    void report(const char *name);
+
+private:
+    AllocCounts last_ = {};
+    uint32_t frames_ = {};
+    size_t report_count_ = {};
+    std::array<ThreadAllocCounts, AllocCounter::kMaxThreads> report_base_ = {};
+    std::array<ThreadAllocCounts, AllocCounter::kMaxThreads> current_ = {};
+};
+
+#endif //SKITY_ANDROID_ALLOC_COUNTER_HPP
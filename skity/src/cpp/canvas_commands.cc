@@ -0,0 +1,346 @@
+
+#include "canvas_commands.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstring>
+
+class CanvasCommandPlayer::Reader {
+public:
+    Reader(uint8_t const *data, size_t size) : data_(data), size_(size) {}
+
+    template<class T>
+    bool read(T *value) {
+        if (size_ - offset_ < sizeof(T)) {
+            return false;
+        }
+
+        // the stream is not aligned
+        std::memcpy(value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool read_floats(float *values, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (!read(values + i)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool read_bytes(size_t count, uint8_t const **bytes) {
+        if (size_ - offset_ < count) {
+            return false;
+        }
+
+        *bytes = data_ + offset_;
+        offset_ += count;
+        return true;
+    }
+
+    size_t Offset() const { return offset_; }
+
+    bool AtEnd() const { return offset_ >= size_; }
+
+private:
+    uint8_t const *data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+CanvasCommandPlayer::CanvasCommandPlayer() {
+    reset_paint();
+}
+
+void CanvasCommandPlayer::reset_paint() {
+    paint_ = skity::Paint{};
+    paint_.setStyle(skity::Paint::kFill_Style);
+    paint_.setAntiAlias(true);
+    paint_.setColor(skity::ColorSetARGB(255, 0, 0, 0));
+}
+
+void CanvasCommandPlayer::set_images(std::vector<std::shared_ptr<skity::Pixmap>> images) {
+    images_ = std::move(images);
+
+    atlas_ = ImageAtlas{};
+    atlas_ids_.clear();
+    for (auto const &image : images_) {
+        atlas_ids_.emplace_back(image ? atlas_.add(image) : ImageAtlas::kInvalidImage);
+    }
+}
+
+bool CanvasCommandPlayer::play(skity::Canvas *canvas, uint8_t const *data, size_t size) {
+    stats_ = {};
+    stats_.bytes = static_cast<uint32_t>(size);
+    open_saves_ = 0;
+    bound_texture_ = INT64_MIN;
+    // paint set by the last stream or by per call natives does not leak in
+    reset_paint();
+    atlas_.begin_frame();
+
+    Reader reader{data, size};
+    while (!reader.AtEnd()) {
+        size_t offset = reader.Offset();
+
+        uint8_t op = 0;
+        reader.read(&op);
+
+        if (!execute(canvas, static_cast<CanvasOp>(op), &reader)) {
+            stats_.malformed = true;
+            stats_.error_offset = static_cast<uint32_t>(offset);
+            break;
+        }
+
+        stats_.commands++;
+    }
+
+    // a stream never leaks its matrix or clip into the next one
+    for (; open_saves_ > 0; open_saves_--) {
+        canvas->restore();
+    }
+    path_.reset();
+
+    return !stats_.malformed;
+}
+
+bool CanvasCommandPlayer::execute(skity::Canvas *canvas, CanvasOp op, Reader *reader) {
+    float args[6];
+
+    switch (op) {
+        case CanvasOp::kSave:
+            canvas->save();
+            open_saves_++;
+            return true;
+        case CanvasOp::kRestore:
+            // unbalanced restores would pop the renderer's own state
+            if (open_saves_ > 0) {
+                canvas->restore();
+                open_saves_--;
+            }
+            return true;
+        case CanvasOp::kTranslate:
+            if (!reader->read_floats(args, 2)) {
+                return false;
+            }
+            canvas->translate(args[0], args[1]);
+            return true;
+        case CanvasOp::kScale:
+            if (!reader->read_floats(args, 2)) {
+                return false;
+            }
+            canvas->scale(args[0], args[1]);
+            return true;
+        case CanvasOp::kRotate:
+            if (!reader->read_floats(args, 1)) {
+                return false;
+            }
+            canvas->rotate(args[0]);
+            return true;
+        case CanvasOp::kConcat: {
+            if (!reader->read_floats(args, 6)) {
+                return false;
+            }
+            skity::Matrix matrix(1.f);
+            matrix[0][0] = args[0];
+            matrix[1][0] = args[1];
+            matrix[3][0] = args[2];
+            matrix[0][1] = args[3];
+            matrix[1][1] = args[4];
+            matrix[3][1] = args[5];
+            canvas->concat(matrix);
+            return true;
+        }
+        case CanvasOp::kClipRect:
+            if (!reader->read_floats(args, 4)) {
+                return false;
+            }
+            canvas->clipRect(skity::Rect::MakeLTRB(args[0], args[1], args[2], args[3]));
+            return true;
+        case CanvasOp::kSetColor: {
+            uint32_t color = 0;
+            if (!reader->read(&color)) {
+                return false;
+            }
+            paint_.setColor(color);
+            return true;
+        }
+        case CanvasOp::kSetStyle: {
+            uint8_t style = 0;
+            if (!reader->read(&style) || style > 2) {
+                return false;
+            }
+            paint_.setStyle(style == 0 ? skity::Paint::kFill_Style
+                                       : style == 1 ? skity::Paint::kStroke_Style
+                                                    : skity::Paint::kStrokeAndFill_Style);
+            return true;
+        }
+        case CanvasOp::kSetStrokeWidth:
+            if (!reader->read_floats(args, 1)) {
+                return false;
+            }
+            paint_.setStrokeWidth(args[0]);
+            return true;
+        case CanvasOp::kSetTextSize:
+            if (!reader->read_floats(args, 1)) {
+                return false;
+            }
+            paint_.setTextSize(args[0]);
+            return true;
+        case CanvasOp::kSetAntiAlias: {
+            uint8_t enabled = 0;
+            if (!reader->read(&enabled)) {
+                return false;
+            }
+            paint_.setAntiAlias(enabled != 0);
+            return true;
+        }
+        case CanvasOp::kMoveTo:
+            if (!reader->read_floats(args, 2)) {
+                return false;
+            }
+            move_to(args[0], args[1]);
+            return true;
+        case CanvasOp::kLineTo:
+            if (!reader->read_floats(args, 2)) {
+                return false;
+            }
+            line_to(args[0], args[1]);
+            return true;
+        case CanvasOp::kQuadTo:
+            if (!reader->read_floats(args, 4)) {
+                return false;
+            }
+            quad_to(args[0], args[1], args[2], args[3]);
+            return true;
+        case CanvasOp::kCubicTo:
+            if (!reader->read_floats(args, 6)) {
+                return false;
+            }
+            cubic_to(args[0], args[1], args[2], args[3], args[4], args[5]);
+            return true;
+        case CanvasOp::kClose:
+            close();
+            return true;
+        case CanvasOp::kDrawPath:
+            draw_path(canvas);
+            stats_.draws++;
+            return true;
+        case CanvasOp::kDrawRect:
+            if (!reader->read_floats(args, 4)) {
+                return false;
+            }
+            canvas->drawRect(skity::Rect::MakeLTRB(args[0], args[1], args[2], args[3]), paint_);
+            stats_.draws++;
+            return true;
+        case CanvasOp::kDrawRoundRect:
+            if (!reader->read_floats(args, 6)) {
+                return false;
+            }
+            canvas->drawRoundRect(skity::Rect::MakeLTRB(args[0], args[1], args[2], args[3]),
+                                  args[4], args[5], paint_);
+            stats_.draws++;
+            return true;
+        case CanvasOp::kDrawCircle:
+            if (!reader->read_floats(args, 3)) {
+                return false;
+            }
+            canvas->drawCircle(args[0], args[1], args[2], paint_);
+            stats_.draws++;
+            return true;
+        case CanvasOp::kDrawText: {
+            uint16_t length = 0;
+            uint8_t const *bytes = nullptr;
+            if (!reader->read_floats(args, 2) || !reader->read(&length) ||
+                !reader->read_bytes(length, &bytes)) {
+                return false;
+            }
+            draw_text(canvas, reinterpret_cast<const char *>(bytes), length, args[0], args[1]);
+            stats_.draws++;
+            return true;
+        }
+        case CanvasOp::kDrawImage: {
+            uint32_t index = 0;
+            if (!reader->read(&index) || !reader->read_floats(args, 4)) {
+                return false;
+            }
+            draw_image(canvas, index, skity::Rect::MakeLTRB(args[0], args[1], args[2], args[3]));
+            stats_.draws++;
+            return true;
+        }
+    }
+
+    // unknown opcode, the argument size is unknown as well
+    return false;
+}
+
+void CanvasCommandPlayer::move_to(float x, float y) {
+    path_.moveTo(x, y);
+}
+
+void CanvasCommandPlayer::line_to(float x, float y) {
+    path_.lineTo(x, y);
+}
+
+void CanvasCommandPlayer::quad_to(float x1, float y1, float x2, float y2) {
+    path_.quadTo(x1, y1, x2, y2);
+}
+
+void CanvasCommandPlayer::cubic_to(float x1, float y1, float x2, float y2, float x3, float y3) {
+    path_.cubicTo(x1, y1, x2, y2, x3, y3);
+}
+
+void CanvasCommandPlayer::close() {
+    path_.close();
+}
+
+void CanvasCommandPlayer::draw_path(skity::Canvas *canvas) {
+    canvas->drawPath(path_, paint_);
+    path_.reset();
+}
+
+void CanvasCommandPlayer::draw_text(skity::Canvas *canvas, const char *text, size_t length,
+                                    float x, float y) {
+    // the canvas wants a terminated string
+    text_.assign(text, length);
+    canvas->drawSimpleText2(text_.c_str(), x, y, paint_);
+}
+
+void CanvasCommandPlayer::draw_image(skity::Canvas *canvas, uint32_t index,
+                                     skity::Rect const &dst) {
+    if (index >= images_.size() || !images_[index]) {
+        return;
+    }
+
+    stats_.image_draws++;
+
+    uint32_t id = atlas_ids_[index];
+    int64_t texture = id != ImageAtlas::kInvalidImage ? atlas_.PageOf(id) : -1 - int64_t{index};
+    if (texture != bound_texture_) {
+        bound_texture_ = texture;
+        stats_.texture_binds++;
+    }
+
+    if (id != ImageAtlas::kInvalidImage) {
+        atlas_.draw(canvas, id, dst, &paint_);
+        return;
+    }
+
+    auto const &pixmap = images_[index];
+
+    skity::Matrix local_matrix = glm::translate(glm::mat4(1.f),
+                                                glm::vec3(dst.left(), dst.top(), 0.f));
+    local_matrix = glm::scale(local_matrix, glm::vec3(dst.width() / pixmap->Width(),
+                                                      dst.height() / pixmap->Height(), 1.f));
+
+    auto shader = skity::Shader::MakeShader(pixmap);
+    shader->SetLocalMatrix(local_matrix);
+
+    skity::Paint image_paint = paint_;
+    image_paint.setStyle(skity::Paint::kFill_Style);
+    image_paint.setShader(shader);
+
+    canvas->drawRect(dst, image_paint);
+}
@@ -0,0 +1,146 @@
+
+#ifndef SKITY_ANDROID_CANVAS_COMMANDS_HPP
+#define SKITY_ANDROID_CANVAS_COMMANDS_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image_atlas.hpp"
+
+/**
+ * Opcodes of a canvas command stream, written by CanvasCommands.java. Every
+ * command is one opcode byte followed by its arguments in native byte order
+ * without padding. Keep the values in sync with the Java side.
+ *
+ * Paint and path are state of the player: kSet* change the paint used by all
+ * following draws, path verbs build the path that kDrawPath draws and clears.
+ * Both start from their defaults in every stream.
+ */
+enum class CanvasOp : uint8_t {
+    kSave = 1,
+    kRestore = 2,
+    // dx, dy
+    kTranslate = 3,
+    // sx, sy
+    kScale = 4,
+    // degrees
+    kRotate = 5,
+    // scale_x, skew_x, trans_x, skew_y, scale_y, trans_y
+    kConcat = 6,
+    // left, top, right, bottom
+    kClipRect = 7,
+    // u32 ARGB
+    kSetColor = 8,
+    // u8, 0 fill, 1 stroke, 2 stroke and fill
+    kSetStyle = 9,
+    kSetStrokeWidth = 10,
+    kSetTextSize = 11,
+    // u8
+    kSetAntiAlias = 12,
+    // x, y
+    kMoveTo = 13,
+    kLineTo = 14,
+    // x1, y1, x2, y2
+    kQuadTo = 15,
+    // x1, y1, x2, y2, x3, y3
+    kCubicTo = 16,
+    kClose = 17,
+    kDrawPath = 18,
+    // left, top, right, bottom
+    kDrawRect = 19,
+    // left, top, right, bottom, rx, ry
+    kDrawRoundRect = 20,
+    // cx, cy, radius
+    kDrawCircle = 21,
+    // x, y, u16 byte count, UTF-8 bytes
+    kDrawText = 22,
+    // u32 image index, left, top, right, bottom
+    kDrawImage = 23,
+};
+
+struct CanvasCommandStats {
+    uint32_t commands = {};
+    uint32_t draws = {};
+    uint32_t bytes = {};
+    uint32_t image_draws = {};
+    // image draws sampling another texture than the draw before
+    uint32_t texture_binds = {};
+    // offset of the first malformed command, the rest of the stream was dropped
+    bool malformed = {};
+    uint32_t error_offset = {};
+};
+
+/**
+ * Executes canvas command streams, so a frame of app driven drawing costs a
+ * single JNI call. The per command methods are public for callers that
+ * issue them one by one.
+ *
+ * Saves left open by a stream are restored at its end.
+ */
+class CanvasCommandPlayer {
+public:
+    CanvasCommandPlayer();
+
+    ~CanvasCommandPlayer() = default;
+
+    /**
+     * Images kDrawImage refers to by index. The ones small enough are packed
+     * into an ImageAtlas, so draws switching between them keep one texture.
+     */
+    void set_images(std::vector<std::shared_ptr<skity::Pixmap>> images);
+
+    /**
+     * Every stream starts from the default paint: black, fill, anti aliased.
+     *
+     * @return false if the stream was malformed, everything before the bad
+     *         command was executed
+     */
+    bool play(skity::Canvas *canvas, uint8_t const *data, size_t size);
+
+    CanvasCommandStats const &LastStats() const { return stats_; }
+
+    skity::Paint &GetPaint() { return paint_; }
+
+    void move_to(float x, float y);
+
+    void line_to(float x, float y);
+
+    void quad_to(float x1, float y1, float x2, float y2);
+
+    void cubic_to(float x1, float y1, float x2, float y2, float x3, float y3);
+
+    void close();
+
+    void draw_path(skity::Canvas *canvas);
+
+    void draw_text(skity::Canvas *canvas, const char *text, size_t length, float x, float y);
+
+    void draw_image(skity::Canvas *canvas, uint32_t index, skity::Rect const &dst);
+
+private:
+    class Reader;
+
+    void reset_paint();
+
+    bool execute(skity::Canvas *canvas, CanvasOp op, Reader *reader);
+
+private:
+    skity::Paint paint_ = {};
+    skity::Path path_ = {};
+    std::string text_ = {};
+    std::vector<std::shared_ptr<skity::Pixmap>> images_ = {};
+    ImageAtlas atlas_{};
+    // atlas id of every image, ImageAtlas::kInvalidImage if it is drawn alone
+    std::vector<uint32_t> atlas_ids_ = {};
+    // atlas page or -1 - image index of the last image draw
+    int64_t bound_texture_ = {};
+    // saves of the running stream that were not restored yet
+    int32_t open_saves_ = {};
+    CanvasCommandStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_CANVAS_COMMANDS_HPP
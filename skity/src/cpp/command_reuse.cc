@@ -0,0 +1,35 @@
+#include "command_reuse.hpp"
+
+void CommandReuseTracker::reset(size_t image_count) {
+    recordings_.assign(image_count, Recording{});
+    run_key_ = 0;
+    // recordings made before the reset never match the run
+    run_start_ = ++flushes_;
+}
+
+bool CommandReuseTracker::CanReuse(uint32_t slot, uint32_t image, uint64_t key) const {
+    if (key == 0 || image >= recordings_.size()) {
+        return false;
+    }
+
+    Recording const &recording = recordings_[image];
+    return recording.key == key && recording.slot == slot && recording.flush >= run_start_;
+}
+
+void CommandReuseTracker::recorded(uint32_t slot, uint32_t image, uint64_t key) {
+    flushes_++;
+    if (key == 0 || key != run_key_) {
+        run_key_ = key;
+        run_start_ = flushes_;
+    }
+
+    if (image < recordings_.size()) {
+        recordings_[image] = Recording{key, slot, flushes_};
+    }
+}
+
+void CommandReuseTracker::dropped(uint32_t image) {
+    if (image < recordings_.size()) {
+        recordings_[image] = Recording{};
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef SKITY_ANDROID_COMMAND_REUSE_HPP
+#define SKITY_ANDROID_COMMAND_REUSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Decides when VkRenderer may submit the command buffer recorded for a
+ * swapchain image again instead of recording the canvas.
+ *
+ * A recording only holds references: Skity's Vulkan canvas writes vertices,
+ * uniforms and descriptor sets into buffers of the image it flushes for, see
+ * GPUVkContext::GetCurrentBufferIndex(), and into resources shared by all
+ * images such as the glyph atlas. Replaying is safe as long as none of them
+ * was rewritten with other content since the recording:
+ *
+ * - the buffers of an image are only written by a flush for that image,
+ *   which records its command buffer again and replaces the entry
+ * - shared resources are written by every flush, so a flush of any other
+ *   content key ends the reuse of all recordings made before it
+ *
+ * A recording is also tied to the frame slot that made it: before a frame
+ * submits again it only waits for the last submission of its own slot.
+ *
+ * Not thread safe, belongs to the render thread.
+ */
+class CommandReuseTracker {
+public:
+    CommandReuseTracker() = default;
+
+    ~CommandReuseTracker() = default;
+
+    /**
+     * Forget every recording, for image_count swapchain images.
+     */
+    void reset(size_t image_count);
+
+    /**
+     * @return true if the recording of image can be submitted again by slot
+     *         for content key, never for key 0
+     */
+    bool CanReuse(uint32_t slot, uint32_t image, uint64_t key) const;
+
+    /**
+     * The canvas was flushed into the buffers of image while slot recorded
+     * its command buffer, key 0 if the recording must not be reused.
+     */
+    void recorded(uint32_t slot, uint32_t image, uint64_t key);
+
+    /**
+     * Recording into image failed before the canvas was flushed.
+     */
+    void dropped(uint32_t image);
+
+private:
+    struct Recording {
+        uint64_t key = {};
+        uint32_t slot = {};
+        // value of flushes_ right after the flush of this recording
+        uint64_t flush = {};
+    };
+
+    std::vector<Recording> recordings_ = {};
+    uint64_t flushes_ = {};
+    // content key of the last flush, and the first flush since which every
+    // flush had that key
+    uint64_t run_key_ = {};
+    uint64_t run_start_ = {};
+};
+
+#endif //SKITY_ANDROID_COMMAND_REUSE_HPP
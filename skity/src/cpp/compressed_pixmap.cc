@@ -0,0 +1,244 @@
+
+#include "compressed_pixmap.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "etc2_codec.hpp"
+
+static constexpr uint32_t kGL_ETC1_RGB8_OES = 0x8D64;
+static constexpr uint32_t kGL_COMPRESSED_RGB8_ETC2 = 0x9274;
+static constexpr uint32_t kGL_COMPRESSED_RGBA8_ETC2_EAC = 0x9278;
+static constexpr uint32_t kGL_COMPRESSED_RGBA_ASTC_4x4_KHR = 0x93B0;
+
+// 2D ASTC footprints, in the order of their GL (and Vulkan) format enums
+static const uint32_t kASTCFootprints[][2] = {
+        {4,  4},
+        {5,  4},
+        {5,  5},
+        {6,  5},
+        {6,  6},
+        {8,  5},
+        {8,  6},
+        {8,  8},
+        {10, 5},
+        {10, 6},
+        {10, 8},
+        {10, 10},
+        {12, 10},
+        {12, 12},
+};
+
+static const uint8_t kKTXIdentifier[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n',
+};
+
+static constexpr uint32_t kASTCMagic = 0x5CA1AB13;
+
+static uint32_t read_u32(const uint8_t *p, bool swap) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if (swap) {
+        v = ((v & 0xFF) << 24) | ((v & 0xFF00) << 8) | ((v >> 8) & 0xFF00) | (v >> 24);
+    }
+    return v;
+}
+
+// bytes of the blocks covering width x height, 0 if that does not fit size_t
+static size_t blocks_size(uint32_t width, uint32_t height, uint32_t block_width,
+                          uint32_t block_height, uint32_t block_bytes) {
+    uint64_t blocks = ((uint64_t{width} + block_width - 1) / block_width) *
+                      ((uint64_t{height} + block_height - 1) / block_height);
+    if (blocks > SIZE_MAX / block_bytes) {
+        return 0;
+    }
+    return static_cast<size_t>(blocks * block_bytes);
+}
+
+static int32_t astc_footprint_index(uint32_t block_width, uint32_t block_height) {
+    for (size_t i = 0; i < sizeof(kASTCFootprints) / sizeof(kASTCFootprints[0]); i++) {
+        if (kASTCFootprints[i][0] == block_width && kASTCFootprints[i][1] == block_height) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
+std::shared_ptr<CompressedPixmap> CompressedPixmap::MakeFromData(const void *data, size_t size) {
+    auto bytes = reinterpret_cast<const uint8_t *>(data);
+
+    if (size >= sizeof(kKTXIdentifier) &&
+        std::memcmp(bytes, kKTXIdentifier, sizeof(kKTXIdentifier)) == 0) {
+        return MakeFromKTX(bytes, size);
+    }
+
+    if (size >= 4 && read_u32(bytes, false) == kASTCMagic) {
+        return MakeFromASTC(bytes, size);
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<CompressedPixmap> CompressedPixmap::MakeFromKTX(const uint8_t *data,
+                                                                size_t size) {
+    constexpr size_t kHeaderSize = 64;
+    if (size < kHeaderSize + 4) {
+        return nullptr;
+    }
+
+    bool swap = read_u32(data + 12, false) != 0x04030201;
+
+    uint32_t internal_format = read_u32(data + 28, swap);
+    uint32_t width = read_u32(data + 36, swap);
+    uint32_t height = read_u32(data + 40, swap);
+    uint32_t depth = read_u32(data + 44, swap);
+    uint32_t faces = read_u32(data + 52, swap);
+    uint32_t key_value_bytes = read_u32(data + 60, swap);
+
+    if (width == 0 || height == 0 || depth > 1 || faces != 1) {
+        return nullptr;
+    }
+
+    std::shared_ptr<CompressedPixmap> pixmap{new CompressedPixmap};
+    pixmap->width_ = width;
+    pixmap->height_ = height;
+
+    if (internal_format == kGL_ETC1_RGB8_OES || internal_format == kGL_COMPRESSED_RGB8_ETC2) {
+        // ETC1 is a subset of ETC2 RGB8
+        pixmap->format_ = CompressedFormat::kETC2_RGB8;
+    } else if (internal_format == kGL_COMPRESSED_RGBA8_ETC2_EAC) {
+        pixmap->format_ = CompressedFormat::kETC2_RGBA8;
+    } else {
+        int32_t index = static_cast<int32_t>(internal_format - kGL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+        if (internal_format < kGL_COMPRESSED_RGBA_ASTC_4x4_KHR ||
+            index >= static_cast<int32_t>(sizeof(kASTCFootprints) / sizeof(kASTCFootprints[0]))) {
+            return nullptr;
+        }
+        pixmap->format_ = CompressedFormat::kASTC;
+        pixmap->block_width_ = kASTCFootprints[index][0];
+        pixmap->block_height_ = kASTCFootprints[index][1];
+    }
+
+    // size is at least kHeaderSize + 4, none of these can wrap
+    if (key_value_bytes > size - kHeaderSize - 4) {
+        return nullptr;
+    }
+    size_t offset = kHeaderSize + key_value_bytes;
+
+    size_t image_size = read_u32(data + offset, swap);
+    offset += 4;
+
+    size_t expected = blocks_size(width, height, pixmap->block_width_, pixmap->block_height_,
+                                  pixmap->BlockBytes());
+
+    if (expected == 0 || image_size < expected || expected > size - offset) {
+        return nullptr;
+    }
+
+    pixmap->blocks_.assign(data + offset, data + offset + expected);
+
+    return pixmap;
+}
+
+std::shared_ptr<CompressedPixmap> CompressedPixmap::MakeFromASTC(const uint8_t *data,
+                                                                 size_t size) {
+    constexpr size_t kHeaderSize = 16;
+    if (size < kHeaderSize) {
+        return nullptr;
+    }
+
+    uint32_t block_width = data[4];
+    uint32_t block_height = data[5];
+    uint32_t block_depth = data[6];
+    uint32_t width = data[7] | (data[8] << 8) | (data[9] << 16);
+    uint32_t height = data[10] | (data[11] << 8) | (data[12] << 16);
+    uint32_t depth = data[13] | (data[14] << 8) | (data[15] << 16);
+
+    if (block_depth != 1 || depth != 1 || width == 0 || height == 0 ||
+        astc_footprint_index(block_width, block_height) < 0) {
+        return nullptr;
+    }
+
+    std::shared_ptr<CompressedPixmap> pixmap{new CompressedPixmap};
+    pixmap->format_ = CompressedFormat::kASTC;
+    pixmap->width_ = width;
+    pixmap->height_ = height;
+    pixmap->block_width_ = block_width;
+    pixmap->block_height_ = block_height;
+
+    size_t expected = blocks_size(width, height, block_width, block_height, 16);
+
+    if (expected == 0 || expected > size - kHeaderSize) {
+        return nullptr;
+    }
+
+    pixmap->blocks_.assign(data + kHeaderSize, data + kHeaderSize + expected);
+
+    return pixmap;
+}
+
+uint32_t CompressedPixmap::GLInternalFormat() const {
+    switch (format_) {
+        case CompressedFormat::kETC2_RGB8:
+            return kGL_COMPRESSED_RGB8_ETC2;
+        case CompressedFormat::kETC2_RGBA8:
+            return kGL_COMPRESSED_RGBA8_ETC2_EAC;
+        case CompressedFormat::kASTC:
+            return kGL_COMPRESSED_RGBA_ASTC_4x4_KHR +
+                   astc_footprint_index(block_width_, block_height_);
+    }
+    return 0;
+}
+
+std::shared_ptr<skity::Pixmap> CompressedPixmap::Decode() const {
+    if (format_ == CompressedFormat::kASTC) {
+        return nullptr;
+    }
+
+    // the blocks fit in memory, the RGBA expansion of them may not
+    if (uint64_t{width_} * height_ > SIZE_MAX / 4) {
+        return nullptr;
+    }
+
+    size_t row_bytes = static_cast<size_t>(width_) * 4;
+    std::vector<uint8_t> pixels(row_bytes * height_);
+
+    uint32_t blocks_x = (width_ + 3) / 4;
+    uint32_t blocks_y = (height_ + 3) / 4;
+    const uint8_t *block = blocks_.data();
+
+    uint8_t decoded[16 * 4];
+    for (uint32_t by = 0; by < blocks_y; by++) {
+        for (uint32_t bx = 0; bx < blocks_x; bx++) {
+            if (format_ == CompressedFormat::kETC2_RGBA8) {
+                etc2::decode_rgb_block(block + 8, decoded);
+                etc2::decode_alpha_block(block, decoded);
+            } else {
+                etc2::decode_rgb_block(block, decoded);
+            }
+            block += BlockBytes();
+
+            // edge blocks hang over the image, copy only what is inside
+            uint32_t copy_width = std::min(4u, width_ - bx * 4);
+            uint32_t copy_height = std::min(4u, height_ - by * 4);
+            for (uint32_t y = 0; y < copy_height; y++) {
+                std::memcpy(pixels.data() + (by * 4 + y) * row_bytes + bx * 16,
+                            decoded + y * 16, copy_width * 4);
+            }
+        }
+    }
+
+    if (format_ == CompressedFormat::kETC2_RGBA8) {
+        // canvas images are premultiplied, same as Android bitmaps
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            uint32_t a = pixels[i + 3];
+            for (size_t c = 0; c < 3; c++) {
+                pixels[i + c] = static_cast<uint8_t>((pixels[i + c] * a + 127) / 255);
+            }
+        }
+    }
+
+    auto data = skity::Data::MakeWithCopy(pixels.data(), pixels.size());
+    return std::make_shared<skity::Pixmap>(data, row_bytes, width_, height_);
+}
@@ -0,0 +1,92 @@
+
+#ifndef SKITY_ANDROID_COMPRESSED_PIXMAP_HPP
+#define SKITY_ANDROID_COMPRESSED_PIXMAP_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class CompressedFormat {
+    kETC2_RGB8,
+    kETC2_RGBA8,
+    kASTC,
+};
+
+/**
+ * Block compressed formats the GPU can sample directly. Only textures created
+ * outside of Skity's canvas can use this, the canvas samples RGBA pixmaps.
+ */
+struct TextureCompressionCaps {
+    bool etc2 = {};
+    bool astc_ldr = {};
+
+    bool Supports(CompressedFormat format) const {
+        return format == CompressedFormat::kASTC ? astc_ldr : etc2;
+    }
+};
+
+/**
+ * Pixmap counterpart that keeps ETC2 or ASTC blocks as they come out of the
+ * asset, so they can be uploaded without expanding to RGBA.
+ *
+ * Only the base level is kept. Dimensions whose block or pixel sizes do not
+ * fit size_t are rejected, which matters on 32-bit ABIs.
+ */
+class CompressedPixmap {
+public:
+    /**
+     * Parse a KTX 1.1 container (ETC1, ETC2 RGB8, ETC2 RGBA8 EAC or ASTC) or
+     * a raw .astc file.
+     *
+     * @return nullptr if the data is not one of the above
+     */
+    static std::shared_ptr<CompressedPixmap> MakeFromData(const void *data, size_t size);
+
+    CompressedFormat Format() const { return format_; }
+
+    uint32_t Width() const { return width_; }
+
+    uint32_t Height() const { return height_; }
+
+    uint32_t BlockWidth() const { return block_width_; }
+
+    uint32_t BlockHeight() const { return block_height_; }
+
+    uint32_t BlockBytes() const { return format_ == CompressedFormat::kETC2_RGB8 ? 8 : 16; }
+
+    const uint8_t *Blocks() const { return blocks_.data(); }
+
+    size_t BlocksSize() const { return blocks_.size(); }
+
+    /**
+     * Matching GL_COMPRESSED_* internal format.
+     */
+    uint32_t GLInternalFormat() const;
+
+    /**
+     * Expand to a premultiplied RGBA Pixmap on the CPU.
+     *
+     * @return nullptr for ASTC, which has no CPU decoder here, or if the
+     *         pixels would not fit in memory
+     */
+    std::shared_ptr<skity::Pixmap> Decode() const;
+
+private:
+    CompressedPixmap() = default;
+
+    static std::shared_ptr<CompressedPixmap> MakeFromKTX(const uint8_t *data, size_t size);
+
+    static std::shared_ptr<CompressedPixmap> MakeFromASTC(const uint8_t *data, size_t size);
+
+private:
+    CompressedFormat format_ = {};
+    uint32_t width_ = {};
+    uint32_t height_ = {};
+    uint32_t block_width_ = 4;
+    uint32_t block_height_ = 4;
+    std::vector<uint8_t> blocks_ = {};
+};
+
+#endif //SKITY_ANDROID_COMPRESSED_PIXMAP_HPP
@@ -0,0 +1,478 @@
+
+#include "etc2_codec.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace etc2 {
+
+static const int32_t kModifierTable[8][2] = {
+        {2,  8},
+        {5,  17},
+        {9,  29},
+        {13, 42},
+        {18, 60},
+        {24, 80},
+        {33, 106},
+        {47, 183},
+};
+
+static const int32_t kDistanceTable[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+static const int32_t kAlphaModifierTable[16][8] = {
+        {-3, -6, -9,  -15, 2, 5, 8, 14},
+        {-3, -7, -10, -13, 2, 6, 9, 12},
+        {-2, -5, -8,  -13, 1, 4, 7, 12},
+        {-2, -4, -6,  -13, 1, 3, 5, 12},
+        {-3, -6, -8,  -12, 2, 5, 7, 11},
+        {-3, -7, -9,  -11, 2, 6, 8, 10},
+        {-4, -7, -8,  -11, 3, 6, 7, 10},
+        {-3, -5, -8,  -11, 2, 4, 7, 10},
+        {-2, -6, -8,  -10, 1, 5, 7, 9},
+        {-2, -5, -8,  -10, 1, 4, 7, 9},
+        {-2, -4, -8,  -10, 1, 3, 7, 9},
+        {-2, -5, -7,  -10, 1, 4, 6, 9},
+        {-3, -4, -7,  -10, 2, 3, 6, 9},
+        {-1, -2, -3,  -10, 0, 1, 2, 9},
+        {-4, -6, -8,  -9,  3, 5, 7, 8},
+        {-3, -5, -7,  -9,  2, 4, 6, 8},
+};
+
+static inline int32_t clamp255(int32_t v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline int32_t extend4(uint32_t v) {
+    return static_cast<int32_t>((v << 4) | v);
+}
+
+static inline int32_t extend5(uint32_t v) {
+    return static_cast<int32_t>((v << 3) | (v >> 2));
+}
+
+static inline int32_t extend6(uint32_t v) {
+    return static_cast<int32_t>((v << 2) | (v >> 4));
+}
+
+static inline int32_t extend7(uint32_t v) {
+    return static_cast<int32_t>((v << 1) | (v >> 6));
+}
+
+static inline uint64_t read_be64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void write_be64(uint64_t v, uint8_t *p) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = static_cast<uint8_t>(v & 0xFF);
+        v >>= 8;
+    }
+}
+
+// ETC stores pixel indices column major, pixels are row major
+static inline uint32_t pixel_index(uint32_t etc_index) {
+    uint32_t x = etc_index / 4;
+    uint32_t y = etc_index % 4;
+    return (y * 4 + x) * 4;
+}
+
+static inline uint32_t selector(uint64_t bits, uint32_t etc_index) {
+    uint32_t msb = (bits >> (16 + etc_index)) & 1;
+    uint32_t lsb = (bits >> etc_index) & 1;
+    return (msb << 1) | lsb;
+}
+
+static void write_pixel(uint8_t *pixels, uint32_t etc_index, int32_t r, int32_t g, int32_t b) {
+    uint8_t *p = pixels + pixel_index(etc_index);
+    p[0] = static_cast<uint8_t>(clamp255(r));
+    p[1] = static_cast<uint8_t>(clamp255(g));
+    p[2] = static_cast<uint8_t>(clamp255(b));
+    p[3] = 255;
+}
+
+static void decode_sub_blocks(uint64_t bits, const int32_t base[2][3], uint8_t *pixels) {
+    uint32_t table[2] = {
+            static_cast<uint32_t>((bits >> 37) & 7),
+            static_cast<uint32_t>((bits >> 34) & 7),
+    };
+    bool flip = (bits >> 32) & 1;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t x = i / 4;
+        uint32_t y = i % 4;
+        uint32_t sub = flip ? (y >= 2) : (x >= 2);
+
+        int32_t modifier;
+        switch (selector(bits, i)) {
+            case 0:
+                modifier = kModifierTable[table[sub]][0];
+                break;
+            case 1:
+                modifier = kModifierTable[table[sub]][1];
+                break;
+            case 2:
+                modifier = -kModifierTable[table[sub]][0];
+                break;
+            default:
+                modifier = -kModifierTable[table[sub]][1];
+                break;
+        }
+
+        write_pixel(pixels, i, base[sub][0] + modifier, base[sub][1] + modifier,
+                    base[sub][2] + modifier);
+    }
+}
+
+static void decode_paint_colors(uint64_t bits, const int32_t paint[4][3], uint8_t *pixels) {
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t s = selector(bits, i);
+        write_pixel(pixels, i, paint[s][0], paint[s][1], paint[s][2]);
+    }
+}
+
+static void decode_t_mode(uint64_t bits, uint8_t *pixels) {
+    uint32_t r1 = (((bits >> 58) & 3) << 2) | ((bits >> 56) & 3);
+    int32_t c1[3] = {extend4(r1), extend4((bits >> 52) & 0xF), extend4((bits >> 48) & 0xF)};
+    int32_t c2[3] = {extend4((bits >> 44) & 0xF), extend4((bits >> 40) & 0xF),
+                     extend4((bits >> 36) & 0xF)};
+    int32_t d = kDistanceTable[(((bits >> 34) & 3) << 1) | ((bits >> 32) & 1)];
+
+    int32_t paint[4][3] = {
+            {c1[0],     c1[1],     c1[2]},
+            {c2[0] + d, c2[1] + d, c2[2] + d},
+            {c2[0],     c2[1],     c2[2]},
+            {c2[0] - d, c2[1] - d, c2[2] - d},
+    };
+
+    decode_paint_colors(bits, paint, pixels);
+}
+
+static void decode_h_mode(uint64_t bits, uint8_t *pixels) {
+    uint32_t r1 = (bits >> 59) & 0xF;
+    uint32_t g1 = (((bits >> 56) & 7) << 1) | ((bits >> 52) & 1);
+    uint32_t b1 = (((bits >> 51) & 1) << 3) | ((bits >> 47) & 7);
+    uint32_t r2 = (bits >> 43) & 0xF;
+    uint32_t g2 = (bits >> 39) & 0xF;
+    uint32_t b2 = (bits >> 35) & 0xF;
+
+    uint32_t packed1 = (r1 << 8) | (g1 << 4) | b1;
+    uint32_t packed2 = (r2 << 8) | (g2 << 4) | b2;
+    uint32_t index = (((bits >> 34) & 1) << 2) | (((bits >> 32) & 1) << 1) |
+                     (packed1 >= packed2 ? 1 : 0);
+    int32_t d = kDistanceTable[index];
+
+    int32_t c1[3] = {extend4(r1), extend4(g1), extend4(b1)};
+    int32_t c2[3] = {extend4(r2), extend4(g2), extend4(b2)};
+
+    int32_t paint[4][3] = {
+            {c1[0] + d, c1[1] + d, c1[2] + d},
+            {c1[0] - d, c1[1] - d, c1[2] - d},
+            {c2[0] + d, c2[1] + d, c2[2] + d},
+            {c2[0] - d, c2[1] - d, c2[2] - d},
+    };
+
+    decode_paint_colors(bits, paint, pixels);
+}
+
+static void decode_planar_mode(uint64_t bits, uint8_t *pixels) {
+    int32_t o[3] = {
+            extend6((bits >> 57) & 0x3F),
+            extend7((((bits >> 56) & 1) << 6) | ((bits >> 49) & 0x3F)),
+            extend6((((bits >> 48) & 1) << 5) | (((bits >> 43) & 3) << 3) | ((bits >> 39) & 7)),
+    };
+    int32_t h[3] = {
+            extend6((((bits >> 34) & 0x1F) << 1) | ((bits >> 32) & 1)),
+            extend7((bits >> 25) & 0x7F),
+            extend6((bits >> 19) & 0x3F),
+    };
+    int32_t v[3] = {
+            extend6((bits >> 13) & 0x3F),
+            extend7((bits >> 6) & 0x7F),
+            extend6(bits & 0x3F),
+    };
+
+    for (int32_t y = 0; y < 4; y++) {
+        for (int32_t x = 0; x < 4; x++) {
+            uint8_t *p = pixels + (y * 4 + x) * 4;
+            for (int c = 0; c < 3; c++) {
+                int32_t value = (x * (h[c] - o[c]) + y * (v[c] - o[c]) + 4 * o[c] + 2) >> 2;
+                p[c] = static_cast<uint8_t>(clamp255(value));
+            }
+            p[3] = 255;
+        }
+    }
+}
+
+void decode_rgb_block(const uint8_t *block, uint8_t *pixels) {
+    uint64_t bits = read_be64(block);
+
+    int32_t base[2][3];
+
+    if (((bits >> 33) & 1) == 0) {
+        // individual mode
+        for (int c = 0; c < 3; c++) {
+            base[0][c] = extend4((bits >> (60 - c * 8)) & 0xF);
+            base[1][c] = extend4((bits >> (56 - c * 8)) & 0xF);
+        }
+        decode_sub_blocks(bits, base, pixels);
+        return;
+    }
+
+    int32_t base5[3];
+    int32_t sum5[3];
+    for (int c = 0; c < 3; c++) {
+        base5[c] = static_cast<int32_t>((bits >> (59 - c * 8)) & 0x1F);
+        int32_t delta = static_cast<int32_t>((bits >> (56 - c * 8)) & 7);
+        if (delta >= 4) {
+            delta -= 8;
+        }
+        sum5[c] = base5[c] + delta;
+    }
+
+    // an out of range second color selects one of the ETC2 modes
+    if (sum5[0] < 0 || sum5[0] > 31) {
+        decode_t_mode(bits, pixels);
+        return;
+    }
+    if (sum5[1] < 0 || sum5[1] > 31) {
+        decode_h_mode(bits, pixels);
+        return;
+    }
+    if (sum5[2] < 0 || sum5[2] > 31) {
+        decode_planar_mode(bits, pixels);
+        return;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        base[0][c] = extend5(base5[c]);
+        base[1][c] = extend5(sum5[c]);
+    }
+    decode_sub_blocks(bits, base, pixels);
+}
+
+void decode_alpha_block(const uint8_t *block, uint8_t *pixels) {
+    uint64_t bits = read_be64(block);
+
+    int32_t base = static_cast<int32_t>(bits >> 56);
+    int32_t multiplier = static_cast<int32_t>((bits >> 52) & 0xF);
+    const int32_t *table = kAlphaModifierTable[(bits >> 48) & 0xF];
+
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t index = (bits >> (45 - i * 3)) & 7;
+        pixels[pixel_index(i) + 3] = static_cast<uint8_t>(
+                clamp255(base + table[index] * multiplier));
+    }
+}
+
+/**
+ * Best table and selectors for one half of a block around a fixed base color.
+ */
+struct SubBlockFit {
+    uint32_t table = {};
+    uint32_t selectors[8] = {};
+    int64_t error = INT64_MAX;
+};
+
+static SubBlockFit fit_sub_block(const uint8_t *pixels, const uint32_t *indices,
+                                 const int32_t base[3]) {
+    SubBlockFit best;
+
+    for (uint32_t t = 0; t < 8; t++) {
+        SubBlockFit fit;
+        fit.table = t;
+        fit.error = 0;
+
+        int32_t modifiers[4] = {
+                kModifierTable[t][0],
+                kModifierTable[t][1],
+                -kModifierTable[t][0],
+                -kModifierTable[t][1],
+        };
+
+        for (uint32_t k = 0; k < 8; k++) {
+            const uint8_t *p = pixels + pixel_index(indices[k]);
+
+            int64_t best_error = INT64_MAX;
+            for (uint32_t s = 0; s < 4; s++) {
+                int64_t error = 0;
+                for (int c = 0; c < 3; c++) {
+                    int64_t diff = clamp255(base[c] + modifiers[s]) - p[c];
+                    error += diff * diff;
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    fit.selectors[k] = s;
+                }
+            }
+            fit.error += best_error;
+        }
+
+        if (fit.error < best.error) {
+            best = fit;
+        }
+    }
+
+    return best;
+}
+
+void encode_rgb_block(const uint8_t *pixels, uint8_t *block) {
+    uint64_t best_bits = 0;
+    int64_t best_error = INT64_MAX;
+
+    for (uint32_t flip = 0; flip < 2; flip++) {
+        uint32_t indices[2][8];
+        uint32_t count[2] = {};
+        int32_t average[2][3] = {};
+
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t x = i / 4;
+            uint32_t y = i % 4;
+            uint32_t sub = flip ? (y >= 2) : (x >= 2);
+            indices[sub][count[sub]++] = i;
+
+            const uint8_t *p = pixels + pixel_index(i);
+            for (int c = 0; c < 3; c++) {
+                average[sub][c] += p[c];
+            }
+        }
+
+        for (auto &a : average) {
+            for (int c = 0; c < 3; c++) {
+                a[c] = (a[c] + 4) / 8;
+            }
+        }
+
+        for (uint32_t diff = 0; diff < 2; diff++) {
+            uint32_t quantized[2][3];
+            int32_t base[2][3];
+            bool valid = true;
+
+            for (uint32_t sub = 0; sub < 2; sub++) {
+                for (int c = 0; c < 3; c++) {
+                    if (diff) {
+                        quantized[sub][c] = (average[sub][c] * 31 + 127) / 255;
+                        base[sub][c] = extend5(quantized[sub][c]);
+                    } else {
+                        quantized[sub][c] = (average[sub][c] * 15 + 127) / 255;
+                        base[sub][c] = extend4(quantized[sub][c]);
+                    }
+                }
+            }
+
+            int32_t delta[3] = {};
+            if (diff) {
+                for (int c = 0; c < 3; c++) {
+                    delta[c] = static_cast<int32_t>(quantized[1][c]) -
+                               static_cast<int32_t>(quantized[0][c]);
+                    if (delta[c] < -4 || delta[c] > 3) {
+                        valid = false;
+                    }
+                }
+            }
+
+            if (!valid) {
+                continue;
+            }
+
+            SubBlockFit fits[2] = {
+                    fit_sub_block(pixels, indices[0], base[0]),
+                    fit_sub_block(pixels, indices[1], base[1]),
+            };
+
+            int64_t error = fits[0].error + fits[1].error;
+            if (error >= best_error) {
+                continue;
+            }
+
+            uint64_t bits = 0;
+            for (int c = 0; c < 3; c++) {
+                if (diff) {
+                    bits |= static_cast<uint64_t>(quantized[0][c]) << (59 - c * 8);
+                    bits |= static_cast<uint64_t>(delta[c] & 7) << (56 - c * 8);
+                } else {
+                    bits |= static_cast<uint64_t>(quantized[0][c]) << (60 - c * 8);
+                    bits |= static_cast<uint64_t>(quantized[1][c]) << (56 - c * 8);
+                }
+            }
+            bits |= static_cast<uint64_t>(fits[0].table) << 37;
+            bits |= static_cast<uint64_t>(fits[1].table) << 34;
+            bits |= static_cast<uint64_t>(diff) << 33;
+            bits |= static_cast<uint64_t>(flip) << 32;
+
+            for (uint32_t sub = 0; sub < 2; sub++) {
+                for (uint32_t k = 0; k < 8; k++) {
+                    uint32_t i = indices[sub][k];
+                    uint32_t s = fits[sub].selectors[k];
+                    bits |= static_cast<uint64_t>(s >> 1) << (16 + i);
+                    bits |= static_cast<uint64_t>(s & 1) << i;
+                }
+            }
+
+            best_error = error;
+            best_bits = bits;
+        }
+    }
+
+    write_be64(best_bits, block);
+}
+
+void encode_alpha_block(const uint8_t *pixels, uint8_t *block) {
+    int32_t min_alpha = 255;
+    int32_t max_alpha = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        int32_t a = pixels[i * 4 + 3];
+        min_alpha = std::min(min_alpha, a);
+        max_alpha = std::max(max_alpha, a);
+    }
+
+    uint64_t best_bits = 0;
+    int64_t best_error = INT64_MAX;
+
+    for (uint32_t t = 0; t < 16 && best_error > 0; t++) {
+        const int32_t *table = kAlphaModifierTable[t];
+        int32_t table_min = table[3];
+        int32_t table_max = table[7];
+
+        for (int32_t multiplier = 1; multiplier < 16 && best_error > 0; multiplier++) {
+            // center the table span on the alpha range of the block
+            int32_t base = clamp255(
+                    (min_alpha + max_alpha - (table_min + table_max) * multiplier + 1) / 2);
+
+            uint64_t bits = (static_cast<uint64_t>(base) << 56) |
+                            (static_cast<uint64_t>(multiplier) << 52) |
+                            (static_cast<uint64_t>(t) << 48);
+            int64_t error = 0;
+
+            for (uint32_t i = 0; i < 16; i++) {
+                int32_t a = pixels[pixel_index(i) + 3];
+
+                int64_t best_diff = INT64_MAX;
+                uint32_t best_index = 0;
+                for (uint32_t k = 0; k < 8; k++) {
+                    int64_t diff = clamp255(base + table[k] * multiplier) - a;
+                    diff *= diff;
+                    if (diff < best_diff) {
+                        best_diff = diff;
+                        best_index = k;
+                    }
+                }
+
+                error += best_diff;
+                bits |= static_cast<uint64_t>(best_index) << (45 - i * 3);
+            }
+
+            if (error < best_error) {
+                best_error = error;
+                best_bits = bits;
+            }
+        }
+    }
+
+    write_be64(best_bits, block);
+}
+
+}  // namespace etc2
@@ -0,0 +1,42 @@
+
+#ifndef SKITY_ANDROID_ETC2_CODEC_HPP
+#define SKITY_ANDROID_ETC2_CODEC_HPP
+
+#include <cstdint>
+
+/**
+ * Block level ETC2 / EAC codec.
+ *
+ * Decoding covers every ETC2 RGB mode (individual, differential, T, H and
+ * planar) plus the EAC alpha block of RGBA8_ETC2_EAC. Encoding only emits
+ * individual and differential blocks, which keeps it simple and produces
+ * streams that are valid ETC1 as well as ETC2.
+ *
+ * Pixels are 4x4 RGBA, row major, 16 * 4 bytes.
+ */
+namespace etc2 {
+
+constexpr uint32_t kBlockSize = 4;
+
+constexpr uint32_t kRGBBlockBytes = 8;
+
+constexpr uint32_t kRGBABlockBytes = 16;
+
+/**
+ * Decode 8 bytes of ETC2 RGB into the rgb channels of pixels, alpha is set to
+ * 255.
+ */
+void decode_rgb_block(const uint8_t *block, uint8_t *pixels);
+
+/**
+ * Decode 8 bytes of EAC alpha into the alpha channel of pixels.
+ */
+void decode_alpha_block(const uint8_t *block, uint8_t *pixels);
+
+void encode_rgb_block(const uint8_t *pixels, uint8_t *block);
+
+void encode_alpha_block(const uint8_t *pixels, uint8_t *block);
+
+}  // namespace etc2
+
+#endif //SKITY_ANDROID_ETC2_CODEC_HPP
@@ -0,0 +1,82 @@
+#include "frame_arena.hpp"
+
+constexpr size_t FrameArena::kBlockSize;
+
+static uint8_t *align_up(uint8_t *ptr, size_t alignment) {
+    auto value = reinterpret_cast<uintptr_t>(ptr);
+    return reinterpret_cast<uint8_t *>((value + alignment - 1) & ~(uintptr_t) (alignment - 1));
+}
+
+FrameArena::FrameArena(size_t block_size) : block_size_(block_size > 0 ? block_size : kBlockSize) {}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+    stats_.allocations++;
+    stats_.bytes += size;
+
+    uint8_t *ptr = cursor_ ? align_up(cursor_, alignment) : nullptr;
+    if (ptr && size <= static_cast<size_t>(end_ - ptr)) {
+        cursor_ = ptr + size;
+        return ptr;
+    }
+
+    return allocate_slow(size, alignment);
+}
+
+void *FrameArena::allocate_slow(size_t size, size_t alignment) {
+    if (size + alignment > block_size_) {
+        Block block;
+        block.size = size + alignment;
+        block.data.reset(new uint8_t[block.size]);
+        stats_.blocks++;
+
+        uint8_t *ptr = align_up(block.data.get(), alignment);
+        large_blocks_.emplace_back(std::move(block));
+        return ptr;
+    }
+
+    // the rest of the current block is dropped until the next reset
+    if (cursor_) {
+        block_index_++;
+    }
+
+    if (block_index_ >= blocks_.size()) {
+        Block block;
+        block.size = block_size_;
+        block.data.reset(new uint8_t[block.size]);
+        blocks_.emplace_back(std::move(block));
+        block_index_ = blocks_.size() - 1;
+        stats_.blocks++;
+    }
+
+    Block &block = blocks_[block_index_];
+    uint8_t *ptr = align_up(block.data.get(), alignment);
+    cursor_ = ptr + size;
+    end_ = block.data.get() + block.size;
+
+    return ptr;
+}
+
+void FrameArena::reset() {
+    large_blocks_.clear();
+
+    block_index_ = 0;
+    if (blocks_.empty()) {
+        cursor_ = nullptr;
+        end_ = nullptr;
+    } else {
+        cursor_ = blocks_[0].data.get();
+        end_ = cursor_ + blocks_[0].size;
+    }
+
+    last_frame_ = stats_;
+    stats_ = {};
+}
+
+size_t FrameArena::Capacity() const {
+    size_t capacity = 0;
+    for (auto const &block : blocks_) {
+        capacity += block.size;
+    }
+
+    return capacity;
+}
@@ -0,0 +1,115 @@
+#ifndef SKITY_ANDROID_FRAME_ARENA_HPP
+#define SKITY_ANDROID_FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct FrameArenaStats {
+    uint64_t allocations = {};
+    uint64_t bytes = {};
+    // heap blocks the arena had to add, 0 once it has grown to the frame size
+    uint64_t blocks = {};
+};
+
+/**
+ * Bump pointer arena for wrapper data that lives one frame.
+ *
+ * Allocations are never freed on their own, reset() rewinds the whole arena
+ * once nothing allocated from it is used anymore. Blocks are kept across
+ * resets, so after the first frames an arena stops touching the heap.
+ * Nothing is destructed on reset, containers on top of it have to be
+ * destroyed before.
+ *
+ * Skity's canvas takes no allocator, the paths and vertex data it builds
+ * stay on the heap.
+ *
+ * Not thread safe.
+ */
+class FrameArena {
+public:
+    static constexpr size_t kBlockSize = 16 * 1024;
+
+    FrameArena() : FrameArena(kBlockSize) {}
+
+    explicit FrameArena(size_t block_size);
+
+    ~FrameArena() = default;
+
+    FrameArena(FrameArena const &) = delete;
+
+    FrameArena &operator=(FrameArena const &) = delete;
+
+    void *allocate(size_t size, size_t alignment);
+
+    /**
+     * Rewind to the first block. Blocks of requests larger than the block
+     * size are released.
+     */
+    void reset();
+
+    /**
+     * What was allocated since the last reset().
+     */
+    FrameArenaStats const &Stats() const { return stats_; }
+
+    /**
+     * Stats() right before the last reset().
+     */
+    FrameArenaStats const &LastFrame() const { return last_frame_; }
+
+    size_t Capacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data = {};
+        size_t size = {};
+    };
+
+    void *allocate_slow(size_t size, size_t alignment);
+
+private:
+    size_t block_size_;
+    std::vector<Block> blocks_ = {};
+    size_t block_index_ = {};
+    // requests larger than a block, released on reset()
+    std::vector<Block> large_blocks_ = {};
+    uint8_t *cursor_ = {};
+    uint8_t *end_ = {};
+    FrameArenaStats stats_ = {};
+    FrameArenaStats last_frame_ = {};
+};
+
+/**
+ * Standard allocator on top of a FrameArena, deallocate is a no-op.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena *arena) : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const &other) : arena_(other.Arena()) {}
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(arena_->allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {}
+
+    FrameArena *Arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(ArenaAllocator<U> const &other) const { return arena_ == other.Arena(); }
+
+    template <typename U>
+    bool operator!=(ArenaAllocator<U> const &other) const { return arena_ != other.Arena(); }
+
+private:
+    FrameArena *arena_;
+};
+
+#endif //SKITY_ANDROID_FRAME_ARENA_HPP
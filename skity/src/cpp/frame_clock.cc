@@ -0,0 +1,31 @@
+
+#include "frame_clock.hpp"
+
+#include <time.h>
+
+int64_t monotonic_nanos() {
+    struct timespec res = {};
+    clock_gettime(CLOCK_MONOTONIC, &res);
+
+    return static_cast<int64_t>(res.tv_sec) * 1000000000 + res.tv_nsec;
+}
+
+double monotonic_seconds() {
+    return monotonic_nanos() / 1e9;
+}
+
+void FrameClock::begin_frame() {
+    double now = vsync_time_ >= 0.0 ? vsync_time_ : monotonic_seconds();
+    vsync_driven_ = vsync_time_ >= 0.0;
+    vsync_time_ = -1.0;
+
+    if (!started_) {
+        start_time_ = time_ = now;
+        started_ = true;
+    }
+
+    // a vsync stamp lies in the past, switching from free running frames to
+    // driven ones must not run the animation backwards
+    delta_ = now > time_ ? now - time_ : 0.0;
+    time_ += delta_;
+}
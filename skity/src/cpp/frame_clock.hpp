@@ -0,0 +1,72 @@
+
+#ifndef SKITY_ANDROID_FRAME_CLOCK_HPP
+#define SKITY_ANDROID_FRAME_CLOCK_HPP
+
+#include <cstdint>
+
+/**
+ * CLOCK_MONOTONIC, the clock Choreographer frame times are taken on.
+ */
+int64_t monotonic_nanos();
+
+double monotonic_seconds();
+
+/**
+ * Animation time of the frames a renderer draws.
+ *
+ * When a vsync loop drives the renderer every frame is stamped with the
+ * timestamp of its vsync, so animations advance in whole refresh periods no
+ * matter how late in the period the frame started. Frames drawn without one
+ * fall back to the monotonic clock at the start of draw().
+ *
+ * Not thread safe, belongs to the render thread.
+ */
+class FrameClock {
+public:
+    FrameClock() = default;
+
+    ~FrameClock() = default;
+
+    /**
+     * Time of the vsync the next frame is drawn for, in seconds on
+     * CLOCK_MONOTONIC. Consumed by the next begin_frame().
+     */
+    void set_vsync_time(double seconds) { vsync_time_ = seconds; }
+
+    /**
+     * Latch the time of the frame about to be drawn. The first frame starts
+     * the animation at 0.
+     */
+    void begin_frame();
+
+    /**
+     * Absolute time of the current frame.
+     */
+    double FrameTime() const { return time_; }
+
+    /**
+     * Seconds since the first frame.
+     */
+    double AnimationTime() const { return time_ - start_time_; }
+
+    /**
+     * Seconds since the previous frame, 0 on the first one.
+     */
+    double Delta() const { return delta_; }
+
+    /**
+     * Whether the current frame was stamped by a vsync loop.
+     */
+    bool IsVsyncDriven() const { return vsync_driven_; }
+
+private:
+    double time_ = {};
+    double start_time_ = {};
+    double delta_ = {};
+    // pending stamp from set_vsync_time, negative when there is none
+    double vsync_time_ = -1.0;
+    bool vsync_driven_ = {};
+    bool started_ = {};
+};
+
+#endif //SKITY_ANDROID_FRAME_CLOCK_HPP
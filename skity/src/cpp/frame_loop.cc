@@ -0,0 +1,210 @@
+
+#include "frame_loop.hpp"
+
+#include "frame_clock.hpp"
+
+#include <cerrno>
+#include <time.h>
+
+#ifdef __ANDROID__
+#include <dlfcn.h>
+#endif
+
+#include <utility>
+
+constexpr int64_t FrameLoop::kDefaultPeriodNanos;
+constexpr uint32_t FrameLoop::kPeriodWindow;
+
+TimerVsyncSource::TimerVsyncSource(double hz)
+        : period_(static_cast<int64_t>(1e9 / (hz > 1.0 ? hz : 1.0))) {}
+
+bool TimerVsyncSource::start(Callback callback) {
+    running_ = true;
+
+    int64_t next = monotonic_nanos() + period_;
+    while (running_) {
+        struct timespec deadline = {};
+        deadline.tv_sec = static_cast<time_t>(next / 1000000000);
+        deadline.tv_nsec = static_cast<long>(next % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+        }
+
+        if (!running_) {
+            break;
+        }
+
+        callback(next);
+
+        next += period_;
+        int64_t now = monotonic_nanos();
+        if (next <= now) {
+            next += ((now - next) / period_ + 1) * period_;
+        }
+    }
+
+    return true;
+}
+
+#ifdef __ANDROID__
+
+namespace {
+
+using PostFrameCallback64 = void (*)(AChoreographer *, void (*)(int64_t, void *), void *);
+
+// API 29, looked up at runtime so the library still loads on API 28
+PostFrameCallback64 post_frame_callback64() {
+    static auto fn = reinterpret_cast<PostFrameCallback64>(
+            dlsym(RTLD_DEFAULT, "AChoreographer_postFrameCallback64"));
+    return fn;
+}
+
+}  // namespace
+
+struct ChoreographerVsyncSource::State {
+    AChoreographer *choreographer = {};
+    Callback callback = {};
+    bool running = {};
+};
+
+ChoreographerVsyncSource::~ChoreographerVsyncSource() {
+    stop();
+}
+
+bool ChoreographerVsyncSource::start(Callback callback) {
+    stop();
+
+    // only threads with a looper have a choreographer
+    auto choreographer = AChoreographer_getInstance();
+    if (choreographer == nullptr) {
+        return false;
+    }
+
+    state_ = std::make_shared<State>();
+    state_->choreographer = choreographer;
+    state_->callback = std::move(callback);
+    state_->running = true;
+
+    post(state_);
+
+    return true;
+}
+
+void ChoreographerVsyncSource::stop() {
+    if (state_) {
+        state_->running = false;
+        state_.reset();
+    }
+}
+
+void ChoreographerVsyncSource::post(std::shared_ptr<State> const &state) {
+    auto pending = new std::shared_ptr<State>(state);
+
+    if (auto post64 = post_frame_callback64()) {
+        post64(state->choreographer, [](int64_t time, void *data) {
+            dispatch(time, data);
+        }, pending);
+        return;
+    }
+
+    // the frame time of this one is a long, which wraps every 2 seconds on 32
+    // bit ABIs. The callback runs right after the vsync, the clock is close.
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    AChoreographer_postFrameCallback(state->choreographer, [](long, void *data) {
+        dispatch(monotonic_nanos(), data);
+    }, pending);
+#pragma clang diagnostic pop
+}
+
+void ChoreographerVsyncSource::dispatch(int64_t frame_time_nanos, void *data) {
+    std::unique_ptr<std::shared_ptr<State>> pending{static_cast<std::shared_ptr<State> *>(data)};
+    auto state = *pending;
+
+    if (!state->running) {
+        return;
+    }
+
+    // posted first, a callback that stops the source cancels it
+    post(state);
+    state->callback(frame_time_nanos);
+}
+
+#endif
+
+FrameLoop::FrameLoop(std::unique_ptr<VsyncSource> source, DrawCallback draw)
+        : source_(std::move(source)), draw_(std::move(draw)) {}
+
+FrameLoop::~FrameLoop() {
+    stop();
+}
+
+bool FrameLoop::start() {
+    if (running_) {
+        return true;
+    }
+
+    running_ = true;
+    skipped_last_ = false;
+    last_vsync_ = 0;
+
+    // a blocking source only returns once stopped
+    if (!source_->start([this](int64_t vsync_nanos) { on_vsync(vsync_nanos); })) {
+        running_ = false;
+        return false;
+    }
+
+    return true;
+}
+
+void FrameLoop::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    source_->stop();
+}
+
+void FrameLoop::on_vsync(int64_t vsync_nanos) {
+    stats_.vsyncs++;
+    update_period(vsync_nanos);
+
+    int64_t lateness = monotonic_nanos() - vsync_nanos;
+    if (lateness > period_ && !skipped_last_) {
+        stats_.late_skips++;
+        skipped_last_ = true;
+        return;
+    }
+
+    skipped_last_ = false;
+    stats_.frames++;
+
+    draw_(vsync_nanos / 1e9);
+}
+
+void FrameLoop::update_period(int64_t vsync_nanos) {
+    int64_t delta = last_vsync_ > 0 ? vsync_nanos - last_vsync_ : 0;
+    last_vsync_ = vsync_nanos;
+
+    // deltas spanning missed vsyncs are multiples of the period, the smallest
+    // one of a window is the period itself. Below 2 ms is a duplicate.
+    if (delta > 2000000 && (window_min_ == 0 || delta < window_min_)) {
+        window_min_ = delta;
+
+        // follow the first window right away, later ones only once complete
+        if (!period_measured_) {
+            period_ = window_min_;
+        }
+    }
+
+    if (++window_count_ >= kPeriodWindow) {
+        if (window_min_ > 0) {
+            period_ = window_min_;
+            period_measured_ = true;
+        }
+        window_min_ = 0;
+        window_count_ = 0;
+    }
+
+    stats_.period_ms = static_cast<float>(period_ / 1e6);
+}
@@ -0,0 +1,154 @@
+
+#ifndef SKITY_ANDROID_FRAME_LOOP_HPP
+#define SKITY_ANDROID_FRAME_LOOP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#ifdef __ANDROID__
+#include <android/choreographer.h>
+#endif
+
+/**
+ * Delivers vsync timestamps, in nanoseconds on CLOCK_MONOTONIC, to a callback
+ * on the thread that called start() until stop().
+ */
+class VsyncSource {
+public:
+    using Callback = std::function<void(int64_t vsync_nanos)>;
+
+    virtual ~VsyncSource() = default;
+
+    /**
+     * @return false if the source can not run on this thread
+     */
+    virtual bool start(Callback callback) = 0;
+
+    virtual void stop() = 0;
+};
+
+/**
+ * Fixed rate ticks for hosts without a display. start() runs the loop on the
+ * calling thread and returns after stop(), which can be called from the
+ * callback or any other thread. Ticks that pass while the callback runs are
+ * dropped, like vsyncs of a real display.
+ */
+class TimerVsyncSource : public VsyncSource {
+public:
+    explicit TimerVsyncSource(double hz = 60.0);
+
+    ~TimerVsyncSource() override = default;
+
+    bool start(Callback callback) override;
+
+    void stop() override { running_ = false; }
+
+private:
+    int64_t period_ = {};
+    std::atomic<bool> running_ = {false};
+};
+
+#ifdef __ANDROID__
+
+/**
+ * AChoreographer frame callbacks, delivered through the looper of the thread
+ * that called start(), which returns right away. start() and stop() have to
+ * be called on that thread.
+ *
+ * Uses AChoreographer_postFrameCallback64 where the device has it (API 29).
+ * Older devices get the callback with a 32 bit frame time on 32 bit ABIs, so
+ * frames are stamped with CLOCK_MONOTONIC when it runs instead, which hides
+ * how late it was.
+ */
+class ChoreographerVsyncSource : public VsyncSource {
+public:
+    ChoreographerVsyncSource() = default;
+
+    ~ChoreographerVsyncSource() override;
+
+    bool start(Callback callback) override;
+
+    void stop() override;
+
+private:
+    struct State;
+
+    static void post(std::shared_ptr<State> const &state);
+
+    static void dispatch(int64_t frame_time_nanos, void *data);
+
+private:
+    // posted callbacks can not be removed, each one holds the state it was
+    // posted for and drops out once that is stopped
+    std::shared_ptr<State> state_ = {};
+};
+
+#endif
+
+struct FrameLoopStats {
+    uint64_t vsyncs = {};
+    uint64_t frames = {};
+    // vsyncs skipped because they were delivered after the next one was due
+    uint64_t late_skips = {};
+    // refresh period measured from the vsync timestamps
+    float period_ms = {};
+};
+
+/**
+ * Renders once per vsync of a VsyncSource.
+ *
+ * The draw callback gets the vsync time in seconds, meant for
+ * FrameClock::set_vsync_time. A vsync delivered more than a refresh period
+ * late is skipped, its frame could not be presented before the next vsync
+ * which is due right away. Never more than one in a row, so a thread that is
+ * always behind still renders on every other vsync.
+ *
+ * start(), stop() and Stats() are called on the thread the source delivers
+ * on.
+ */
+class FrameLoop {
+public:
+    using DrawCallback = std::function<void(double vsync_seconds)>;
+
+    // 60 Hz until the first vsyncs are measured
+    static constexpr int64_t kDefaultPeriodNanos = 16666667;
+    // vsyncs the period is measured over
+    static constexpr uint32_t kPeriodWindow = 60;
+
+    FrameLoop(std::unique_ptr<VsyncSource> source, DrawCallback draw);
+
+    ~FrameLoop();
+
+    /**
+     * Blocks until stop() for sources that run their own loop, see
+     * TimerVsyncSource.
+     */
+    bool start();
+
+    void stop();
+
+    bool IsRunning() const { return running_; }
+
+    FrameLoopStats const &Stats() const { return stats_; }
+
+private:
+    void on_vsync(int64_t vsync_nanos);
+
+    void update_period(int64_t vsync_nanos);
+
+private:
+    std::unique_ptr<VsyncSource> source_ = {};
+    DrawCallback draw_ = {};
+    bool running_ = {};
+    bool skipped_last_ = {};
+    int64_t period_ = kDefaultPeriodNanos;
+    int64_t last_vsync_ = {};
+    int64_t window_min_ = {};
+    uint32_t window_count_ = {};
+    bool period_measured_ = {};
+    FrameLoopStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_FRAME_LOOP_HPP
@@ -2,17 +2,9 @@
 #include "frame_renderer.hpp"
 
 #include <GLES3/gl3.h>
-#include <time.h>
 
 #include <utility>
 
-static double skity_get_time() {
-    struct timespec res = {};
-    clock_gettime(CLOCK_REALTIME, &res);
-
-    return res.tv_sec + (double) res.tv_nsec / (double) 1e9;
-}
-
 void render_frame_demo(
         skity::Canvas *canvas,
         std::vector<std::shared_ptr<skity::Pixmap>> const &images,
@@ -21,41 +13,111 @@ void render_frame_demo(
         float width, float height, float t);
 
 FrameRender::FrameRender() : Renderer(),
-                             fpsGraph(Perf::GRAPH_RENDER_FPS, "Frame Time"),
-                             cpuGraph(Perf::GRAPH_RENDER_MS, "CPU Time") {}
+                             fpsGraph(PerfGraph::kFPS, "Frame Time"),
+                             cpuGraph(PerfGraph::kMS, "CPU Time"),
+                             allocGraph(PerfGraph::kCount, "Allocs / Frame"),
+                             pathCacheGraph(PerfGraph::kPercent, "Path Cache Hits") {}
 
 void FrameRender::init_render_typeface(std::shared_ptr<skity::Typeface> typeface,
                                        std::shared_ptr<skity::Typeface> emoji) {
     render_typeface_ = std::move(typeface);
     emoji_typeface_ = std::move(emoji);
 
-    start_time_ = time_ = prev_time_ = skity_get_time();
+    fpsGraph.set_typeface(render_typeface_);
+    cpuGraph.set_typeface(render_typeface_);
+    allocGraph.set_typeface(render_typeface_);
+    pathCacheGraph.set_typeface(render_typeface_);
+
+    // rasterize the demo and perf graph text while images are still loading
+    glyph_prewarmer_.start({
+            GlyphWarmRequest{render_typeface_, {12.f, 13.f, 14.f, 15.f, 16.f, 18.f, 20.f, 28.f},
+                             GlyphPrewarmer::AsciiCharset()},
+    });
 }
 
 void FrameRender::init_images(std::vector<std::shared_ptr<skity::Pixmap>> images) {
     render_images_ = std::move(images);
+    // app command streams can draw the demo images by index
+    GetCommandPlayer()->set_images(render_images_);
 
     glClearColor(0.3f, 0.3f, 0.32f, 1.f);
 }
 
-void FrameRender::draw() {
-    Renderer::draw();
-
-    time_ = skity_get_time();
-
-    double dt = time_ - prev_time_;
-    prev_time_ = time_;
-
-    render_frame_demo(GetCanvas(), render_images_, render_typeface_, emoji_typeface_, 0.f, 0.f,
-                      Width(), Height(),
-                      static_cast<float>(time_ - start_time_));
-
-    cpu_time_ = skity_get_time() - time_;
+void FrameRender::onDraw(skity::Canvas *canvas) {
+    // everything since the last onDraw, including the flush and submit of that frame
+    AllocCounts allocs = alloc_meter_.tick();
+    alloc_meter_.report("frame");
+
+    if (glyph_prewarmer_.IsPending()) {
+        // one time upload, kept out of the CPU graph
+        glyph_prewarmer_.upload(canvas);
+    }
+
+    // vsync time when a frame loop drives the renderer, see FrameClock
+    double dt = GetFrameClock().Delta();
+    float t = static_cast<float>(GetFrameClock().AnimationTime());
+    double cpu_start = monotonic_seconds();
+
+    // sample count can only be changed on the offscreen target, a multisampled
+    // window keeps the count of its EGL config, see Renderer::set_msaa_samples
+    if (UsesMSAATarget()) {
+        if (governor_.LevelCount() == 0) {
+            governor_.set_levels(QualityGovernor::DefaultLevels(msaa_samples(), false));
+        }
+
+        if (governor_.update(dt)) {
+            set_msaa_samples(governor_.Current().samples);
+        }
+    }
+
+    // everything the pointer affects is recorded from here on
+    InputSample input = latch_input();
+
+    // off, the demo draws straight into the canvas and the cache drops its paths
+    bool path_cache = path_cache_enabled_;
+    path_cache_.set_enabled(path_cache);
+    skity::Canvas *demo_canvas = GetCanvas();
+    if (path_cache) {
+        path_cache_.begin_frame();
+        path_canvas_.set_target(GetCanvas(), Width(), Height());
+        demo_canvas = &path_canvas_;
+    }
+
+    render_frame_demo(demo_canvas, render_images_, render_typeface_, emoji_typeface_,
+                      input.x, input.y, Width(), Height(), t);
+
+    cpu_time_ = monotonic_seconds() - cpu_start;
     fpsGraph.RenderGraph(GetCanvas(), 5, 5);
     cpuGraph.RenderGraph(GetCanvas(), 5 + 200 + 5, 5);
 
-    GetCanvas()->flush();
-
     fpsGraph.UpdateGraph(dt);
     cpuGraph.UpdateGraph(cpu_time_);
-}
\ No newline at end of file
+
+    if (path_cache) {
+        // second row, lookups of the previous frame
+        pathCacheGraph.RenderGraph(GetCanvas(), 5, 5 + PerfGraph::kHeight + 5);
+        pathCacheGraph.UpdateGraph(path_cache_.LastFrameStats().HitRate());
+    }
+
+    if (AllocCounter::Enabled()) {
+        allocGraph.RenderGraph(GetCanvas(), 5 + 2 * (200 + 5), 5);
+        allocGraph.UpdateGraph(allocs.allocations);
+    }
+}
+
+bool FrameRender::init_compressed_images(
+        std::vector<std::shared_ptr<CompressedPixmap>> const &images) {
+    // the canvas only samples textures it uploads itself, so the demo images
+    // are expanded here. Loading them still skips the JPEG decode.
+    std::vector<std::shared_ptr<skity::Pixmap>> pixmaps;
+    for (auto const &image : images) {
+        auto pixmap = image ? image->Decode() : nullptr;
+        if (!pixmap) {
+            return false;
+        }
+        pixmaps.emplace_back(std::move(pixmap));
+    }
+
+    init_images(std::move(pixmaps));
+    return true;
+}
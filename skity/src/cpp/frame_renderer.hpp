@@ -3,8 +3,14 @@
 #define SKITY_ANDROID_FRAME_RENDERER_HPP
 
 #include "renderer.hpp"
-#include "perf.hpp"
+#include "perf_graph.hpp"
+#include "alloc_counter.hpp"
+#include "compressed_pixmap.hpp"
+#include "glyph_prewarm.hpp"
+#include "quality_governor.hpp"
+#include "path_geometry_cache.hpp"
 
+#include <atomic>
 #include <vector>
 #include <memory>
 
@@ -20,19 +26,42 @@ public:
 
     void init_images(std::vector<std::shared_ptr<skity::Pixmap>> images);
 
+    /**
+     * Decode ETC2 images for the canvas.
+     *
+     * @return false, with no image set, if one of them can not be decoded
+     */
+    bool init_compressed_images(std::vector<std::shared_ptr<CompressedPixmap>> const &images);
+
+    GlyphWarmStats const &GlyphWarmupStats() const { return glyph_prewarmer_.Stats(); }
+
+    QualityGovernor const &Governor() const { return governor_; }
+
+    /**
+     * Draw the demo through the path cache, off by default. Safe from any
+     * thread, the next frame picks it up; compare the CPU Time graph.
+     */
+    void set_path_cache(bool enabled) { path_cache_enabled_ = enabled; }
+
 protected:
-    void draw() override;
+    void onDraw(skity::Canvas *canvas) override;
 
 private:
     std::shared_ptr<skity::Typeface> render_typeface_ = {};
     std::shared_ptr<skity::Typeface> emoji_typeface_ = {};
     std::vector<std::shared_ptr<skity::Pixmap>> render_images_ = {};
-    double time_ = {};
-    double start_time_ = {};
-    double prev_time_ = {};
     double cpu_time_ = {};
-    Perf fpsGraph;
-    Perf cpuGraph;
+    PerfGraph fpsGraph;
+    PerfGraph cpuGraph;
+    PerfGraph allocGraph;
+    PerfGraph pathCacheGraph;
+    AllocFrameMeter alloc_meter_ = {};
+    GlyphPrewarmer glyph_prewarmer_ = {};
+    QualityGovernor governor_{};
+    // flattened demo paths, the canvas forwards to GetCanvas()
+    PathGeometryCache path_cache_ = {};
+    PathCacheCanvas path_canvas_{&path_cache_};
+    std::atomic<bool> path_cache_enabled_ = {false};
 };
 
 
@@ -0,0 +1,142 @@
+
+#include "glyph_prewarm.hpp"
+
+#include <chrono>
+
+#include "platform_log.hpp"
+
+static const char *kTAG = "SkityGlyph";
+#define LOGI(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_INFO, kTAG, __VA_ARGS__))
+
+static std::vector<skity::Unichar> decode_utf8(std::string const &text) {
+    std::vector<skity::Unichar> code_points;
+
+    size_t i = 0;
+    while (i < text.size()) {
+        auto c = static_cast<uint8_t>(text[i]);
+        skity::Unichar code_point = 0;
+        size_t length = 1;
+
+        if (c < 0x80) {
+            code_point = c;
+        } else if ((c >> 5) == 0x6) {
+            code_point = c & 0x1F;
+            length = 2;
+        } else if ((c >> 4) == 0xE) {
+            code_point = c & 0x0F;
+            length = 3;
+        } else if ((c >> 3) == 0x1E) {
+            code_point = c & 0x07;
+            length = 4;
+        } else {
+            // stray continuation byte
+            i++;
+            continue;
+        }
+
+        if (i + length > text.size()) {
+            break;
+        }
+
+        for (size_t k = 1; k < length; k++) {
+            code_point = (code_point << 6) | (static_cast<uint8_t>(text[i + k]) & 0x3F);
+        }
+
+        code_points.emplace_back(code_point);
+        i += length;
+    }
+
+    return code_points;
+}
+
+GlyphPrewarmer::~GlyphPrewarmer() {
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void GlyphPrewarmer::start(std::vector<GlyphWarmRequest> requests) {
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    requests_ = std::move(requests);
+    stats_ = {};
+    pending_ = true;
+
+    worker_ = std::thread([this]() { rasterize(); });
+}
+
+void GlyphPrewarmer::upload(skity::Canvas *canvas) {
+    if (!pending_) {
+        return;
+    }
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    skity::Paint paint;
+    paint.setStyle(skity::Paint::kFill_Style);
+    // fully transparent: the glyphs land in the atlas but nothing shows up
+    paint.setColor(skity::ColorSetARGB(0, 0, 0, 0));
+
+    for (auto const &request : requests_) {
+        paint.setTypeface(request.typeface);
+        for (float size : request.sizes) {
+            paint.setTextSize(size);
+            canvas->drawSimpleText2(request.charset.c_str(), 0.f, size, paint);
+        }
+    }
+
+    stats_.upload_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+    LOGI("warmed %u glyphs, rasterize %.2f ms on worker, upload %.2f ms", stats_.glyphs,
+         stats_.rasterize_ms, stats_.upload_ms);
+
+    requests_.clear();
+    pending_ = false;
+}
+
+std::string GlyphPrewarmer::AsciiCharset() {
+    std::string charset;
+    for (char c = 0x20; c < 0x7F; c++) {
+        charset.push_back(c);
+    }
+    return charset;
+}
+
+void GlyphPrewarmer::rasterize() {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t glyphs = 0;
+
+    for (auto const &request : requests_) {
+        if (!request.typeface) {
+            continue;
+        }
+
+        std::vector<skity::GlyphID> glyph_ids;
+        for (skity::Unichar code_point : decode_utf8(request.charset)) {
+            if (!request.typeface->containGlyph(code_point)) {
+                continue;
+            }
+            glyph_ids.emplace_back(request.typeface->unicharToGlyph(code_point));
+        }
+
+        for (float size : request.sizes) {
+            for (skity::GlyphID glyph_id : glyph_ids) {
+                // FreeType work happens here, the typeface keeps the bitmap
+                request.typeface->getGlyphBitmapInfo(glyph_id, size);
+                glyphs++;
+            }
+        }
+    }
+
+    stats_.glyphs = glyphs;
+    stats_.rasterize_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,70 @@
+
+#ifndef SKITY_ANDROID_GLYPH_PREWARM_HPP
+#define SKITY_ANDROID_GLYPH_PREWARM_HPP
+
+#include <skity/skity.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GlyphWarmRequest {
+    std::shared_ptr<skity::Typeface> typeface = {};
+    std::vector<float> sizes = {};
+    // UTF-8 encoded set of characters to warm
+    std::string charset = {};
+};
+
+struct GlyphWarmStats {
+    uint32_t glyphs = {};
+    double rasterize_ms = {};
+    double upload_ms = {};
+};
+
+/**
+ * Rasterizes a configured set of glyphs on a worker thread while the app is
+ * still loading, then pushes them through the canvas once on the render
+ * thread so they sit in the glyph atlas before the first frame is presented.
+ *
+ * The typefaces must not be used by anyone else until upload() returned.
+ */
+class GlyphPrewarmer {
+public:
+    GlyphPrewarmer() = default;
+
+    ~GlyphPrewarmer();
+
+    GlyphPrewarmer(GlyphPrewarmer const &) = delete;
+
+    GlyphPrewarmer &operator=(GlyphPrewarmer const &) = delete;
+
+    void start(std::vector<GlyphWarmRequest> requests);
+
+    /**
+     * Wait for the worker and draw every warmed glyph invisibly so the canvas
+     * uploads them with the next flush. Does nothing after the first call.
+     */
+    void upload(skity::Canvas *canvas);
+
+    bool IsPending() const { return pending_; }
+
+    GlyphWarmStats const &Stats() const { return stats_; }
+
+    /**
+     * Printable ASCII, the default character set.
+     */
+    static std::string AsciiCharset();
+
+private:
+    void rasterize();
+
+private:
+    std::vector<GlyphWarmRequest> requests_ = {};
+    std::thread worker_ = {};
+    std::atomic<bool> pending_ = {false};
+    GlyphWarmStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_GLYPH_PREWARM_HPP
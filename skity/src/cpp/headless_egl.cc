@@ -0,0 +1,264 @@
+
+#include "headless_egl.hpp"
+
+#include <EGL/eglext.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "platform_log.hpp"
+
+static const char *kTAG = "SkityEGL";
+#define LOGI(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_INFO, kTAG, __VA_ARGS__))
+#define LOGE(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_ERROR, kTAG, __VA_ARGS__))
+
+static bool has_extension(const char *extensions, const char *name) {
+    if (extensions == nullptr) {
+        return false;
+    }
+
+    size_t length = std::strlen(name);
+    const char *p = extensions;
+    while ((p = std::strstr(p, name)) != nullptr) {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) {
+            return true;
+        }
+        p += length;
+    }
+
+    return false;
+}
+
+HeadlessEGL::~HeadlessEGL() {
+    destroy();
+}
+
+bool HeadlessEGL::init(int32_t width, int32_t height) {
+    width_ = width;
+    height_ = height;
+
+    if (!init_display()) {
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+        LOGE("eglBindAPI failed : 0x%x", eglGetError());
+        return false;
+    }
+
+    bool use_pbuffer = choose_config(true);
+    if (!use_pbuffer) {
+        const char *extensions = eglQueryString(display_, EGL_EXTENSIONS);
+        if (!has_extension(extensions, "EGL_KHR_surfaceless_context") || !choose_config(false)) {
+            LOGE("no usable EGL config for headless rendering");
+            return false;
+        }
+    }
+
+    EGLint context_attribs[] = {
+            EGL_CONTEXT_CLIENT_VERSION, 3,
+            EGL_NONE,
+    };
+
+    context_ = eglCreateContext(display_, config_, EGL_NO_CONTEXT, context_attribs);
+    if (context_ == EGL_NO_CONTEXT) {
+        LOGE("eglCreateContext failed : 0x%x", eglGetError());
+        return false;
+    }
+
+    if (use_pbuffer) {
+        EGLint surface_attribs[] = {
+                EGL_WIDTH, width_,
+                EGL_HEIGHT, height_,
+                EGL_NONE,
+        };
+
+        surface_ = eglCreatePbufferSurface(display_, config_, surface_attribs);
+        if (surface_ == EGL_NO_SURFACE) {
+            LOGE("eglCreatePbufferSurface failed : 0x%x", eglGetError());
+            return false;
+        }
+    }
+
+    if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+        LOGE("eglMakeCurrent failed : 0x%x", eglGetError());
+        return false;
+    }
+
+    if (IsSurfaceless() && !init_fbo()) {
+        return false;
+    }
+
+    glViewport(0, 0, width_, height_);
+
+    LOGI("headless context ready %dx%d, renderer = %s, surfaceless = %d", width_, height_,
+         (const char *) glGetString(GL_RENDERER), IsSurfaceless());
+
+    return true;
+}
+
+void HeadlessEGL::destroy() {
+    if (display_ == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    if (context_ != EGL_NO_CONTEXT && eglGetCurrentContext() == context_) {
+        if (fbo_) {
+            glDeleteFramebuffers(1, &fbo_);
+            fbo_ = 0;
+        }
+        if (color_rb_) {
+            glDeleteRenderbuffers(1, &color_rb_);
+            color_rb_ = 0;
+        }
+        if (stencil_rb_) {
+            glDeleteRenderbuffers(1, &stencil_rb_);
+            stencil_rb_ = 0;
+        }
+    }
+
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (surface_ != EGL_NO_SURFACE) {
+        eglDestroySurface(display_, surface_);
+        surface_ = EGL_NO_SURFACE;
+    }
+
+    if (context_ != EGL_NO_CONTEXT) {
+        eglDestroyContext(display_, context_);
+        context_ = EGL_NO_CONTEXT;
+    }
+
+    eglTerminate(display_);
+    display_ = EGL_NO_DISPLAY;
+}
+
+bool HeadlessEGL::read_pixels(std::vector<uint8_t> &pixels) {
+    if (context_ == EGL_NO_CONTEXT) {
+        return false;
+    }
+
+    size_t row_bytes = static_cast<size_t>(width_) * 4;
+    pixels.resize(row_bytes * height_);
+
+    glFinish();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    if (glGetError() != GL_NO_ERROR) {
+        return false;
+    }
+
+    // GL origin is bottom-left, flip so row 0 is the top of the image
+    std::vector<uint8_t> row(row_bytes);
+    for (int32_t y = 0; y < height_ / 2; y++) {
+        uint8_t *top = pixels.data() + y * row_bytes;
+        uint8_t *bottom = pixels.data() + (height_ - 1 - y) * row_bytes;
+        std::memcpy(row.data(), top, row_bytes);
+        std::memcpy(top, bottom, row_bytes);
+        std::memcpy(bottom, row.data(), row_bytes);
+    }
+
+    return true;
+}
+
+bool HeadlessEGL::write_ppm(const char *path) {
+    std::vector<uint8_t> pixels;
+    if (!read_pixels(pixels)) {
+        return false;
+    }
+
+    FILE *file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        LOGE("can not open %s for write", path);
+        return false;
+    }
+
+    std::fprintf(file, "P6\n%d %d\n255\n", width_, height_);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        std::fwrite(pixels.data() + i, 1, 3, file);
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+bool HeadlessEGL::init_display() {
+    const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+        auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress(
+                "eglGetPlatformDisplayEXT");
+        if (get_platform_display) {
+            display_ = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                            nullptr);
+        }
+    }
+
+    if (display_ == EGL_NO_DISPLAY) {
+        display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (display_ == EGL_NO_DISPLAY) {
+        LOGE("no EGL display available");
+        return false;
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (!eglInitialize(display_, &major, &minor)) {
+        LOGE("eglInitialize failed : 0x%x", eglGetError());
+        display_ = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    LOGI("EGL version %d.%d vendor = %s", major, minor, eglQueryString(display_, EGL_VENDOR));
+
+    return true;
+}
+
+bool HeadlessEGL::choose_config(bool need_pbuffer) {
+    EGLint attribs[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+            EGL_SURFACE_TYPE, need_pbuffer ? EGL_PBUFFER_BIT : 0,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_STENCIL_SIZE, need_pbuffer ? 8 : 0,
+            EGL_NONE,
+    };
+
+    EGLint num_configs = 0;
+    if (!eglChooseConfig(display_, attribs, &config_, 1, &num_configs)) {
+        return false;
+    }
+
+    return num_configs > 0;
+}
+
+bool HeadlessEGL::init_fbo() {
+    glGenRenderbuffers(1, &color_rb_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_rb_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+
+    glGenRenderbuffers(1, &stencil_rb_);
+    glBindRenderbuffer(GL_RENDERBUFFER, stencil_rb_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_, height_);
+
+    glGenFramebuffers(1, &fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_rb_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              stencil_rb_);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOGE("headless framebuffer incomplete : 0x%x", status);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+
+#ifndef SKITY_ANDROID_HEADLESS_EGL_HPP
+#define SKITY_ANDROID_HEADLESS_EGL_HPP
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Native EGL bootstrap for running the GL renderers without a GLSurfaceView.
+ *
+ * Prefers the Mesa surfaceless platform (llvmpipe on a Linux host), falls back
+ * to the default display with a pbuffer surface. When no pbuffer config is
+ * available the context is made current without a surface and rendering goes
+ * into an internal framebuffer object instead.
+ */
+class HeadlessEGL {
+public:
+    HeadlessEGL() = default;
+
+    ~HeadlessEGL();
+
+    HeadlessEGL(HeadlessEGL const &) = delete;
+
+    HeadlessEGL &operator=(HeadlessEGL const &) = delete;
+
+    bool init(int32_t width, int32_t height);
+
+    void destroy();
+
+    /**
+     * Read back the current framebuffer as tightly packed RGBA8888, top row
+     * first.
+     */
+    bool read_pixels(std::vector<uint8_t> &pixels);
+
+    /**
+     * Write the current framebuffer to a binary PPM file.
+     */
+    bool write_ppm(const char *path);
+
+    int32_t Width() const { return width_; }
+
+    int32_t Height() const { return height_; }
+
+    bool IsSurfaceless() const { return surface_ == EGL_NO_SURFACE; }
+
+private:
+    bool init_display();
+
+    bool choose_config(bool need_pbuffer);
+
+    bool init_fbo();
+
+private:
+    int32_t width_ = {};
+    int32_t height_ = {};
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLConfig config_ = {};
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLSurface surface_ = EGL_NO_SURFACE;
+    GLuint fbo_ = {};
+    GLuint color_rb_ = {};
+    GLuint stencil_rb_ = {};
+};
+
+#endif //SKITY_ANDROID_HEADLESS_EGL_HPP
@@ -0,0 +1,328 @@
+
+#include "image_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+ImageAtlas::ImageAtlas(uint32_t page_size, uint32_t max_image_size, uint32_t max_pages)
+        : page_size_(page_size), max_image_size_(max_image_size), max_pages_(max_pages) {}
+
+uint32_t ImageAtlas::add(std::shared_ptr<skity::Pixmap> const &pixmap) {
+    if (!pixmap || pixmap->Width() == 0 || pixmap->Height() == 0 ||
+        pixmap->Width() > max_image_size_ || pixmap->Height() > max_image_size_) {
+        return kInvalidImage;
+    }
+
+    Entry entry{};
+    entry.width = pixmap->Width();
+    entry.height = pixmap->Height();
+    entry.last_used = frame_;
+    entry.source = pixmap;
+
+    uint32_t id = next_id_++;
+
+    if (!place(entry)) {
+        return kInvalidImage;
+    }
+
+    entries_[id] = std::move(entry);
+    return id;
+}
+
+void ImageAtlas::remove(uint32_t id) {
+    // the space is given back the next time the page is repacked
+    entries_.erase(id);
+}
+
+bool ImageAtlas::draw(skity::Canvas *canvas, uint32_t id, skity::Rect const &dst,
+                      skity::Paint const *paint) {
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+        return false;
+    }
+
+    Entry &entry = it->second;
+    entry.last_used = frame_;
+
+    skity::Paint image_paint = paint ? *paint : skity::Paint{};
+    image_paint.setStyle(skity::Paint::kFill_Style);
+    image_paint.setShader(page_shader(entry.page));
+
+    // the sub-rect in page pixels, moved and scaled onto dst
+    canvas->save();
+    canvas->translate(dst.left(), dst.top());
+    canvas->scale(dst.width() / entry.width, dst.height() / entry.height);
+    canvas->translate(-static_cast<float>(entry.x), -static_cast<float>(entry.y));
+    canvas->drawRect(skity::Rect::MakeXYWH(entry.x, entry.y, entry.width, entry.height),
+                     image_paint);
+    canvas->restore();
+
+    stats_.draws++;
+    if (bound_page_ != static_cast<int32_t>(entry.page)) {
+        stats_.texture_binds++;
+        bound_page_ = entry.page;
+    }
+
+    return true;
+}
+
+int32_t ImageAtlas::PageOf(uint32_t id) const {
+    auto it = entries_.find(id);
+    return it != entries_.end() ? static_cast<int32_t>(it->second.page) : -1;
+}
+
+uint32_t ImageAtlas::evict_idle(uint32_t max_idle_frames) {
+    uint32_t count = 0;
+
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (frame_ - it->second.last_used > max_idle_frames) {
+            it = entries_.erase(it);
+            count++;
+        } else {
+            ++it;
+        }
+    }
+
+    return count;
+}
+
+void ImageAtlas::begin_frame() {
+    stats_.pages = pages_.size();
+    last_stats_ = stats_;
+    stats_ = {};
+
+    frame_++;
+    bound_page_ = -1;
+}
+
+bool ImageAtlas::place(Entry &entry) {
+    uint32_t cell_width = entry.width + padding_ * 2;
+    uint32_t cell_height = entry.height + padding_ * 2;
+
+    auto try_pages = [&]() {
+        for (uint32_t i = 0; i < pages_.size(); i++) {
+            uint32_t x = 0;
+            uint32_t y = 0;
+            if (pack(pages_[i], cell_width, cell_height, &x, &y)) {
+                entry.page = i;
+                entry.x = x + padding_;
+                entry.y = y + padding_;
+                blit(pages_[i], entry);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (try_pages()) {
+        return true;
+    }
+
+    // reclaim space left by removed or evicted entries
+    for (uint32_t i = 0; i < pages_.size(); i++) {
+        repack(i);
+    }
+
+    if (try_pages()) {
+        return true;
+    }
+
+    if (pages_.size() < max_pages_) {
+        pages_.emplace_back();
+        reset_page(pages_.back());
+        return try_pages();
+    }
+
+    // atlas is full, evict least recently used entries that are not part of
+    // the current frame until the new one fits
+    while (true) {
+        auto lru = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->second.last_used < frame_ &&
+                (lru == entries_.end() || it->second.last_used < lru->second.last_used)) {
+                lru = it;
+            }
+        }
+
+        if (lru == entries_.end()) {
+            return false;
+        }
+
+        uint32_t page = lru->second.page;
+        entries_.erase(lru);
+        repack(page);
+
+        if (try_pages()) {
+            return true;
+        }
+    }
+}
+
+bool ImageAtlas::pack(Page &page, uint32_t width, uint32_t height, uint32_t *x, uint32_t *y) {
+    int32_t best_index = -1;
+    uint32_t best_bottom = UINT32_MAX;
+    uint32_t best_width = UINT32_MAX;
+    uint32_t best_y = 0;
+
+    for (size_t i = 0; i < page.skyline.size(); i++) {
+        int32_t fit_y = fit(page, i, width, height);
+        if (fit_y < 0) {
+            continue;
+        }
+
+        uint32_t bottom = fit_y + height;
+        if (bottom < best_bottom ||
+            (bottom == best_bottom && page.skyline[i].width < best_width)) {
+            best_index = i;
+            best_bottom = bottom;
+            best_width = page.skyline[i].width;
+            best_y = fit_y;
+        }
+    }
+
+    if (best_index < 0) {
+        return false;
+    }
+
+    *x = page.skyline[best_index].x;
+    *y = best_y;
+
+    Segment node{*x, best_y + height, width};
+    page.skyline.insert(page.skyline.begin() + best_index, node);
+
+    // shrink or drop the segments now covered by the new node
+    for (size_t i = best_index + 1; i < page.skyline.size(); i++) {
+        Segment &prev = page.skyline[i - 1];
+        Segment &curr = page.skyline[i];
+
+        if (curr.x >= prev.x + prev.width) {
+            break;
+        }
+
+        uint32_t shrink = prev.x + prev.width - curr.x;
+        if (curr.width <= shrink) {
+            page.skyline.erase(page.skyline.begin() + i);
+            i--;
+        } else {
+            curr.x += shrink;
+            curr.width -= shrink;
+            break;
+        }
+    }
+
+    // merge neighbours at the same height
+    for (size_t i = 0; i + 1 < page.skyline.size();) {
+        if (page.skyline[i].y == page.skyline[i + 1].y) {
+            page.skyline[i].width += page.skyline[i + 1].width;
+            page.skyline.erase(page.skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+
+    return true;
+}
+
+int32_t ImageAtlas::fit(Page const &page, size_t index, uint32_t width, uint32_t height) const {
+    uint32_t x = page.skyline[index].x;
+    if (x + width > page_size_) {
+        return -1;
+    }
+
+    uint32_t y = page.skyline[index].y;
+    int64_t width_left = width;
+
+    while (width_left > 0) {
+        if (index >= page.skyline.size()) {
+            return -1;
+        }
+
+        y = std::max(y, page.skyline[index].y);
+        if (y + height > page_size_) {
+            return -1;
+        }
+
+        width_left -= page.skyline[index].width;
+        index++;
+    }
+
+    return y;
+}
+
+void ImageAtlas::repack(uint32_t page_index) {
+    Page &page = pages_[page_index];
+
+    std::vector<Entry *> live;
+    for (auto &it : entries_) {
+        if (it.second.page == page_index) {
+            live.emplace_back(&it.second);
+        }
+    }
+
+    std::sort(live.begin(), live.end(), [](Entry const *a, Entry const *b) {
+        return a->height > b->height;
+    });
+
+    reset_page(page);
+
+    for (Entry *entry : live) {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        // everything fitted before, sorted by height it still fits
+        pack(page, entry->width + padding_ * 2, entry->height + padding_ * 2, &x, &y);
+        entry->x = x + padding_;
+        entry->y = y + padding_;
+        blit(page, *entry);
+    }
+}
+
+void ImageAtlas::reset_page(Page &page) {
+    page.pixels.assign(static_cast<size_t>(page_size_) * page_size_ * 4, 0);
+    page.skyline.clear();
+    page.skyline.emplace_back(Segment{0, 0, page_size_});
+    page.dirty = true;
+}
+
+void ImageAtlas::blit(Page &page, Entry const &entry) {
+    auto src = reinterpret_cast<const uint8_t *>(entry.source->Addr());
+    size_t src_row_bytes = entry.source->RowBytes();
+    size_t dst_row_bytes = static_cast<size_t>(page_size_) * 4;
+    size_t row_bytes = static_cast<size_t>(entry.width) * 4;
+
+    for (uint32_t row = 0; row < entry.height; row++) {
+        uint8_t *dst = page.pixels.data() + (entry.y + row) * dst_row_bytes + entry.x * 4;
+        std::memcpy(dst, src + row * src_row_bytes, row_bytes);
+
+        // extrude the edge pixels into the gutter
+        for (uint32_t p = 1; p <= padding_; p++) {
+            std::memcpy(dst - p * 4, dst, 4);
+            std::memcpy(dst + row_bytes + (p - 1) * 4, dst + row_bytes - 4, 4);
+        }
+    }
+
+    uint8_t *first = page.pixels.data() + entry.y * dst_row_bytes + (entry.x - padding_) * 4;
+    uint8_t *last = first + (entry.height - 1) * dst_row_bytes;
+    size_t padded_row_bytes = row_bytes + padding_ * 2 * 4;
+    for (uint32_t p = 1; p <= padding_; p++) {
+        std::memcpy(first - p * dst_row_bytes, first, padded_row_bytes);
+        std::memcpy(last + p * dst_row_bytes, last, padded_row_bytes);
+    }
+
+    page.dirty = true;
+}
+
+std::shared_ptr<skity::Shader> const &ImageAtlas::page_shader(uint32_t page_index) {
+    Page &page = pages_[page_index];
+
+    if (page.dirty || !page.shader) {
+        // a new Pixmap makes Skity upload a fresh texture for the page
+        auto data = skity::Data::MakeWithCopy(page.pixels.data(), page.pixels.size());
+        page.pixmap = std::make_shared<skity::Pixmap>(data, page_size_ * 4, page_size_,
+                                                      page_size_);
+        page.shader = skity::Shader::MakeShader(page.pixmap);
+        page.dirty = false;
+        stats_.page_uploads++;
+    }
+
+    return page.shader;
+}
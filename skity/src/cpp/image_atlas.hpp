@@ -0,0 +1,131 @@
+
+#ifndef SKITY_ANDROID_IMAGE_ATLAS_HPP
+#define SKITY_ANDROID_IMAGE_ATLAS_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Packs many small Pixmaps into a few shared atlas pages.
+ *
+ * Each page is one Pixmap (so one GPU texture inside Skity) with one pixmap
+ * shader, made again only when the page pixels change. Images are placed with
+ * a skyline bottom-left packer and drawn as their sub-rect of the page under a
+ * transform mapping it onto the destination, so consecutive draws from the
+ * same page keep the same texture bound.
+ *
+ * Entries not drawn for a while can be evicted. A page that runs out of space
+ * is repacked with its live entries before a new page is opened.
+ */
+class ImageAtlas {
+public:
+    static constexpr uint32_t kInvalidImage = 0;
+
+    struct FrameStats {
+        uint32_t draws = {};
+        uint32_t texture_binds = {};
+        uint32_t pages = {};
+        // pages whose pixels changed and need a new upload this frame
+        uint32_t page_uploads = {};
+    };
+
+    explicit ImageAtlas(uint32_t page_size = 1024, uint32_t max_image_size = 256,
+                        uint32_t max_pages = 4);
+
+    ~ImageAtlas() = default;
+
+    /**
+     * Copy pixmap into the atlas.
+     *
+     * @return  id to draw the image with, or kInvalidImage if the image is too
+     *          large for the atlas or there is no room left even after eviction
+     */
+    uint32_t add(std::shared_ptr<skity::Pixmap> const &pixmap);
+
+    void remove(uint32_t id);
+
+    bool contains(uint32_t id) const { return entries_.count(id) != 0; }
+
+    /**
+     * @return page the image is on, -1 if the id is unknown
+     */
+    int32_t PageOf(uint32_t id) const;
+
+    /**
+     * Draw the image into dst.
+     */
+    bool draw(skity::Canvas *canvas, uint32_t id, skity::Rect const &dst,
+              skity::Paint const *paint = nullptr);
+
+    /**
+     * Evict every entry that was not drawn in the last max_idle_frames frames.
+     */
+    uint32_t evict_idle(uint32_t max_idle_frames);
+
+    void begin_frame();
+
+    FrameStats const &LastFrameStats() const { return last_stats_; }
+
+    uint32_t PageCount() const { return pages_.size(); }
+
+private:
+    struct Segment {
+        uint32_t x = {};
+        uint32_t y = {};
+        uint32_t width = {};
+    };
+
+    struct Entry {
+        uint32_t page = {};
+        uint32_t x = {};
+        uint32_t y = {};
+        uint32_t width = {};
+        uint32_t height = {};
+        uint64_t last_used = {};
+        std::shared_ptr<skity::Pixmap> source = {};
+    };
+
+    struct Page {
+        std::vector<uint8_t> pixels = {};
+        std::vector<Segment> skyline = {};
+        std::shared_ptr<skity::Pixmap> pixmap = {};
+        // samples pixmap in page pixels
+        std::shared_ptr<skity::Shader> shader = {};
+        bool dirty = {};
+    };
+
+    bool pack(Page &page, uint32_t width, uint32_t height, uint32_t *x, uint32_t *y);
+
+    int32_t fit(Page const &page, size_t index, uint32_t width, uint32_t height) const;
+
+    void repack(uint32_t page_index);
+
+    void reset_page(Page &page);
+
+    void blit(Page &page, Entry const &entry);
+
+    bool place(Entry &entry);
+
+    std::shared_ptr<skity::Shader> const &page_shader(uint32_t page_index);
+
+private:
+    uint32_t page_size_;
+    uint32_t max_image_size_;
+    uint32_t max_pages_;
+    // gutter around each image, filled with its extruded edge so bilinear
+    // sampling never picks up a neighbour
+    uint32_t padding_ = 1;
+    std::vector<Page> pages_ = {};
+    std::unordered_map<uint32_t, Entry> entries_ = {};
+    uint32_t next_id_ = 1;
+    uint64_t frame_ = {};
+    int32_t bound_page_ = -1;
+    FrameStats stats_ = {};
+    FrameStats last_stats_ = {};
+};
+
+#endif //SKITY_ANDROID_IMAGE_ATLAS_HPP
@@ -0,0 +1,99 @@
+
+#include "input_channel.hpp"
+
+#include "frame_clock.hpp"
+
+#include <algorithm>
+
+constexpr size_t InputLatencyMeter::kWindow;
+
+void InputChannel::write(float x, float y, bool down, int64_t event_nanos) {
+    if (event_nanos <= 0) {
+        event_nanos = monotonic_nanos();
+    }
+
+    // odd while the fields are being replaced
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    x_.store(x, std::memory_order_relaxed);
+    y_.store(y, std::memory_order_relaxed);
+    down_.store(down, std::memory_order_relaxed);
+    event_nanos_.store(event_nanos, std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+bool InputChannel::read(InputSample *sample) const {
+    for (;;) {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1) {
+            continue;
+        }
+
+        sample->x = x_.load(std::memory_order_relaxed);
+        sample->y = y_.load(std::memory_order_relaxed);
+        sample->down = down_.load(std::memory_order_relaxed);
+        sample->event_nanos = event_nanos_.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+            sample->sequence = before / 2;
+            return true;
+        }
+    }
+}
+
+void InputLatencyMeter::latched(InputSample const &sample, int64_t now_nanos) {
+    if (sample.sequence == 0 || sample.sequence == last_sequence_) {
+        pending_event_ = 0;
+        return;
+    }
+
+    last_sequence_ = sample.sequence;
+    pending_event_ = sample.event_nanos;
+    pending_latch_ = now_nanos;
+}
+
+void InputLatencyMeter::submitted(int64_t now_nanos) {
+    if (pending_event_ == 0) {
+        return;
+    }
+
+    Entry entry{static_cast<float>((now_nanos - pending_event_) / 1e6),
+                static_cast<float>((pending_latch_ - pending_event_) / 1e6)};
+    pending_event_ = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    window_.emplace_back(entry);
+    if (window_.size() > kWindow) {
+        window_.pop_front();
+    }
+    frames_++;
+}
+
+InputLatencyStats InputLatencyMeter::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    InputLatencyStats stats;
+    stats.frames = frames_;
+    if (window_.empty()) {
+        return stats;
+    }
+
+    for (auto const &entry : window_) {
+        stats.average_ms += entry.submit_ms;
+        stats.average_latch_ms += entry.latch_ms;
+        stats.max_ms = std::max(stats.max_ms, entry.submit_ms);
+    }
+    stats.average_ms /= window_.size();
+    stats.average_latch_ms /= window_.size();
+    stats.last_ms = window_.back().submit_ms;
+
+    return stats;
+}
@@ -0,0 +1,107 @@
+
+#ifndef SKITY_ANDROID_INPUT_CHANNEL_HPP
+#define SKITY_ANDROID_INPUT_CHANNEL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+struct InputSample {
+    float x = {};
+    float y = {};
+    bool down = {};
+    // when the event happened, CLOCK_MONOTONIC nanoseconds
+    int64_t event_nanos = {};
+    // increments with every write, 0 before the first one
+    uint64_t sequence = {};
+};
+
+/**
+ * Latest pointer position, written by the UI thread and read by the render
+ * thread without locks.
+ *
+ * Only the newest value matters, so a write simply replaces the previous one
+ * and the reader never waits for the writer. The fields are guarded by a
+ * sequence counter: a read that overlapped a write sees an odd or changed
+ * counter and retries. One writer at a time.
+ */
+class InputChannel {
+public:
+    InputChannel() = default;
+
+    ~InputChannel() = default;
+
+    /**
+     * @param event_nanos  time of the input event, 0 to use the current time
+     */
+    void write(float x, float y, bool down, int64_t event_nanos);
+
+    /**
+     * @return false before the first write
+     */
+    bool read(InputSample *sample) const;
+
+private:
+    std::atomic<uint64_t> sequence_ = {0};
+    std::atomic<float> x_ = {0.f};
+    std::atomic<float> y_ = {0.f};
+    std::atomic<bool> down_ = {false};
+    std::atomic<int64_t> event_nanos_ = {0};
+};
+
+struct InputLatencyStats {
+    // frames that latched a new input sample
+    uint64_t frames = {};
+    // input event to the frame's queue submission, over the last kWindow frames
+    float last_ms = {};
+    float average_ms = {};
+    float max_ms = {};
+    // part of it spent before the frame latched the sample
+    float average_latch_ms = {};
+};
+
+/**
+ * Input to submit latency of the frames that used a new input sample.
+ *
+ * latched() and submitted() are called on the render thread, Stats() from
+ * any thread.
+ */
+class InputLatencyMeter {
+public:
+    static constexpr size_t kWindow = 120;
+
+    InputLatencyMeter() = default;
+
+    ~InputLatencyMeter() = default;
+
+    /**
+     * The frame being recorded uses sample. Samples that were already
+     * latched by an earlier frame are not counted again.
+     */
+    void latched(InputSample const &sample, int64_t now_nanos);
+
+    /**
+     * The frame that latched last was handed to the GPU queue.
+     */
+    void submitted(int64_t now_nanos);
+
+    InputLatencyStats Stats() const;
+
+private:
+    struct Entry {
+        float submit_ms;
+        float latch_ms;
+    };
+
+    uint64_t last_sequence_ = {};
+    // event and latch time of the frame in flight, 0 when it latched nothing new
+    int64_t pending_event_ = {};
+    int64_t pending_latch_ = {};
+
+    mutable std::mutex mutex_ = {};
+    std::deque<Entry> window_ = {};
+    uint64_t frames_ = {};
+};
+
+#endif //SKITY_ANDROID_INPUT_CHANNEL_HPP
@@ -0,0 +1,127 @@
+
+#include "mip_image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+std::shared_ptr<MipImage> MipImage::Make(std::shared_ptr<skity::Pixmap> base, bool mipmaps) {
+    if (!base || base->Width() == 0 || base->Height() == 0) {
+        return nullptr;
+    }
+
+    std::shared_ptr<MipImage> image{new MipImage};
+    image->levels_.emplace_back(std::move(base));
+
+    if (mipmaps) {
+        image->build_chain();
+    }
+
+    return image;
+}
+
+void MipImage::build_chain() {
+    while (true) {
+        auto const &src = levels_.back();
+        uint32_t src_width = src->Width();
+        uint32_t src_height = src->Height();
+
+        if (src_width == 1 && src_height == 1) {
+            break;
+        }
+
+        uint32_t width = std::max(src_width / 2, 1u);
+        uint32_t height = std::max(src_height / 2, 1u);
+
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+        auto src_pixels = reinterpret_cast<const uint8_t *>(src->Addr());
+        size_t src_row_bytes = src->RowBytes();
+
+        // pixels are premultiplied, so a plain average is correct
+        for (uint32_t y = 0; y < height; y++) {
+            uint32_t y0 = std::min(y * 2, src_height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, src_height - 1);
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t x0 = std::min(x * 2, src_width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, src_width - 1);
+
+                const uint8_t *p00 = src_pixels + y0 * src_row_bytes + x0 * 4;
+                const uint8_t *p01 = src_pixels + y0 * src_row_bytes + x1 * 4;
+                const uint8_t *p10 = src_pixels + y1 * src_row_bytes + x0 * 4;
+                const uint8_t *p11 = src_pixels + y1 * src_row_bytes + x1 * 4;
+
+                uint8_t *dst = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+                for (int c = 0; c < 4; c++) {
+                    dst[c] = static_cast<uint8_t>((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+                }
+            }
+        }
+
+        auto data = skity::Data::MakeWithCopy(pixels.data(), pixels.size());
+        levels_.emplace_back(std::make_shared<skity::Pixmap>(data, width * 4, width, height));
+    }
+}
+
+float MipImage::compute_lod(skity::Matrix const &matrix, skity::Rect const &dst) const {
+    // device space length of the unit x and y axes
+    float scale_x = std::sqrt(matrix[0][0] * matrix[0][0] + matrix[0][1] * matrix[0][1]);
+    float scale_y = std::sqrt(matrix[1][0] * matrix[1][0] + matrix[1][1] * matrix[1][1]);
+
+    float device_width = dst.width() * scale_x;
+    float device_height = dst.height() * scale_y;
+
+    if (device_width <= 0.f || device_height <= 0.f) {
+        return 0.f;
+    }
+
+    auto const &base = levels_.front();
+    float ratio = std::max(base->Width() / device_width, base->Height() / device_height);
+
+    return ratio > 1.f ? std::log2(ratio) : 0.f;
+}
+
+void MipImage::draw(skity::Canvas *canvas, skity::Rect const &dst, skity::Paint const *paint,
+                    Sampling sampling) {
+    skity::Paint image_paint = paint ? *paint : skity::Paint{};
+    image_paint.setStyle(skity::Paint::kFill_Style);
+
+    float lod = 0.f;
+    if (sampling == Sampling::kAuto && levels_.size() > 1) {
+        lod = compute_lod(canvas->getTotalMatrix(), dst);
+    }
+
+    uint32_t max_level = levels_.size() - 1;
+    auto level = std::min(static_cast<uint32_t>(lod), max_level);
+    float fraction = level < max_level ? lod - level : 0.f;
+
+    draw_level(canvas, level, dst, image_paint);
+
+    if (fraction > 1.f / 32.f) {
+        // blend in the next level, fine for opaque images which the demo
+        // ones are
+        image_paint.setAlphaF(image_paint.getAlphaF() * fraction);
+        draw_level(canvas, level + 1, dst, image_paint);
+    }
+}
+
+void MipImage::draw_level(skity::Canvas *canvas, uint32_t level, skity::Rect const &dst,
+                          skity::Paint const &paint) {
+    auto const &pixmap = levels_[level];
+
+    skity::Matrix local_matrix = glm::translate(glm::mat4(1.f),
+                                                glm::vec3(dst.left(), dst.top(), 0.f));
+    local_matrix = glm::scale(local_matrix, glm::vec3(dst.width() / pixmap->Width(),
+                                                      dst.height() / pixmap->Height(), 1.f));
+
+    auto shader = skity::Shader::MakeShader(pixmap);
+    shader->SetLocalMatrix(local_matrix);
+
+    skity::Paint level_paint = paint;
+    level_paint.setShader(shader);
+
+    canvas->drawRect(dst, level_paint);
+
+    stats_.draws++;
+    stats_.sampled_bytes += static_cast<uint64_t>(pixmap->Width()) * pixmap->Height() * 4;
+}
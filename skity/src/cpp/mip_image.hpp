@@ -0,0 +1,70 @@
+
+#ifndef SKITY_ANDROID_MIP_IMAGE_HPP
+#define SKITY_ANDROID_MIP_IMAGE_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Pixmap with an opt-in mip chain for images drawn through the canvas.
+ *
+ * Skity samples canvas images bilinear from a single level, so the chain is
+ * built on the CPU (2x2 box filter) and draw() picks the levels from the
+ * current canvas transform: plain bilinear when magnified, and when minified
+ * the two nearest levels blended by the fractional lod, which is trilinear
+ * filtering done with two draws.
+ */
+class MipImage {
+public:
+    enum class Sampling {
+        // always sample the base level
+        kLinear,
+        // trilinear between mip levels whenever the draw minifies
+        kAuto,
+    };
+
+    struct DrawStats {
+        uint32_t draws = {};
+        // bytes of every level sampled, an upper bound of texture traffic
+        uint64_t sampled_bytes = {};
+    };
+
+    /**
+     * @param mipmaps   build the chain; without it the image always samples
+     *                  the base level
+     */
+    static std::shared_ptr<MipImage> Make(std::shared_ptr<skity::Pixmap> base, bool mipmaps);
+
+    void draw(skity::Canvas *canvas, skity::Rect const &dst, skity::Paint const *paint = nullptr,
+              Sampling sampling = Sampling::kAuto);
+
+    uint32_t LevelCount() const { return levels_.size(); }
+
+    std::shared_ptr<skity::Pixmap> const &Level(uint32_t level) const { return levels_[level]; }
+
+    DrawStats const &Stats() const { return stats_; }
+
+    void reset_stats() { stats_ = {}; }
+
+    /**
+     * Level of detail for drawing into dst under matrix, 0 when not minified.
+     */
+    float compute_lod(skity::Matrix const &matrix, skity::Rect const &dst) const;
+
+private:
+    MipImage() = default;
+
+    void build_chain();
+
+    void draw_level(skity::Canvas *canvas, uint32_t level, skity::Rect const &dst,
+                    skity::Paint const &paint);
+
+private:
+    std::vector<std::shared_ptr<skity::Pixmap>> levels_ = {};
+    DrawStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_MIP_IMAGE_HPP
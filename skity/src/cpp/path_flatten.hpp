@@ -0,0 +1,91 @@
+
+#ifndef SKITY_ANDROID_PATH_FLATTEN_HPP
+#define SKITY_ANDROID_PATH_FLATTEN_HPP
+
+#include <skity/skity.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Segments a curve whose control polygon deviates by deviation from a line
+ * needs to stay within tolerance of it.
+ */
+inline uint32_t curve_segments(float deviation, float tolerance) {
+    float n = std::ceil(std::sqrt(deviation / tolerance));
+    return static_cast<uint32_t>(std::min(std::max(n, 1.f), 100.f));
+}
+
+/**
+ * Walk path as polylines, curves split into lines that stay within tolerance
+ * of the curve. Calls sink->move_to(x, y), sink->line_to(x, y) and
+ * sink->close().
+ */
+template <typename Sink>
+void flatten_path(skity::Path const &path, float tolerance, Sink *sink) {
+    skity::Path::Iter iter{path, false};
+    skity::Point pts[4];
+
+    for (;;) {
+        auto verb = iter.next(pts);
+        if (verb == skity::Path::Verb::kDone) {
+            break;
+        }
+
+        switch (verb) {
+            case skity::Path::Verb::kMove:
+                sink->move_to(pts[0].x, pts[0].y);
+                break;
+            case skity::Path::Verb::kLine:
+                sink->line_to(pts[1].x, pts[1].y);
+                break;
+            case skity::Path::Verb::kQuad:
+            case skity::Path::Verb::kConic: {
+                float w = verb == skity::Path::Verb::kConic ? iter.conicWeight() : 1.f;
+                float ddx = pts[0].x - 2.f * pts[1].x + pts[2].x;
+                float ddy = pts[0].y - 2.f * pts[1].y + pts[2].y;
+                // conics bend harder than their control polygon when w > 1
+                uint32_t n = curve_segments(0.25f * std::sqrt(ddx * ddx + ddy * ddy) *
+                                            std::max(w, 1.f), tolerance);
+                for (uint32_t i = 1; i <= n; i++) {
+                    float t = static_cast<float>(i) / n;
+                    float a = (1.f - t) * (1.f - t);
+                    float b = 2.f * t * (1.f - t) * w;
+                    float c = t * t;
+                    float d = a + b + c;
+                    sink->line_to((a * pts[0].x + b * pts[1].x + c * pts[2].x) / d,
+                                  (a * pts[0].y + b * pts[1].y + c * pts[2].y) / d);
+                }
+                break;
+            }
+            case skity::Path::Verb::kCubic: {
+                float d0x = pts[0].x - 2.f * pts[1].x + pts[2].x;
+                float d0y = pts[0].y - 2.f * pts[1].y + pts[2].y;
+                float d1x = pts[1].x - 2.f * pts[2].x + pts[3].x;
+                float d1y = pts[1].y - 2.f * pts[2].y + pts[3].y;
+                float deviation = std::sqrt(std::max(d0x * d0x + d0y * d0y,
+                                                     d1x * d1x + d1y * d1y));
+                uint32_t n = curve_segments(0.75f * deviation, tolerance);
+                for (uint32_t i = 1; i <= n; i++) {
+                    float t = static_cast<float>(i) / n;
+                    float s = 1.f - t;
+                    float a = s * s * s;
+                    float b = 3.f * s * s * t;
+                    float c = 3.f * s * t * t;
+                    float d = t * t * t;
+                    sink->line_to(a * pts[0].x + b * pts[1].x + c * pts[2].x + d * pts[3].x,
+                                  a * pts[0].y + b * pts[1].y + c * pts[2].y + d * pts[3].y);
+                }
+                break;
+            }
+            case skity::Path::Verb::kClose:
+                sink->close();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+#endif //SKITY_ANDROID_PATH_FLATTEN_HPP
@@ -0,0 +1,306 @@
+
+#include "path_geometry_cache.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#include "path_flatten.hpp"
+
+constexpr float PathGeometryCache::kTolerance;
+constexpr float PathGeometryCache::kBucketsPerOctave;
+constexpr size_t PathGeometryCache::kDefaultPointBudget;
+
+namespace {
+
+// FNV-1a over the bytes of each value
+struct PathHasher {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    void add(uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    }
+};
+
+uint32_t float_bits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// builds the flattened copy
+struct PathSink {
+    skity::Path *path;
+    size_t points;
+
+    void move_to(float x, float y) {
+        path->moveTo(x, y);
+        points++;
+    }
+
+    void line_to(float x, float y) {
+        path->lineTo(x, y);
+        points++;
+    }
+
+    void close() { path->close(); }
+};
+
+}  // namespace
+
+size_t PathGeometryCache::KeyHash::operator()(Key const &key) const {
+    uint64_t bucket = static_cast<uint32_t>(key.bucket);
+    return static_cast<size_t>(key.hash ^ (bucket * 0x9e3779b97f4a7c15ull));
+}
+
+PathGeometryCache::PathGeometryCache(size_t point_budget)
+        : point_budget_(point_budget > 0 ? point_budget : 1),
+          seen_{{KeySet(0, KeyHash{}, std::equal_to<Key>{}, ArenaAllocator<Key>(&seen_arenas_[0])),
+                 KeySet(0, KeyHash{}, std::equal_to<Key>{},
+                        ArenaAllocator<Key>(&seen_arenas_[1]))}} {}
+
+skity::Path const &PathGeometryCache::get(skity::Path const &path, float scale) {
+    if (!enabled_) {
+        return path;
+    }
+
+    uint64_t hash = hash_path(path);
+    if (hash == 0 || !(scale > 0.f)) {
+        return path;
+    }
+
+    stats_.lookups++;
+
+    Key key{hash, static_cast<int32_t>(std::floor(std::log2(scale) * kBucketsPerOctave))};
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        if (it->second->source != path_data_) {
+            // another path with the same hash, the entry stays for its owner
+            stats_.collisions++;
+            return path;
+        }
+
+        entries_.splice(entries_.begin(), entries_, it->second);
+        stats_.hits++;
+        return it->second->path;
+    }
+
+    // first sighting, flatten only if it shows up again next frame
+    seen_[seen_index_].insert(key);
+    if (seen_[seen_index_ ^ 1].count(key) == 0) {
+        return path;
+    }
+
+    // flattened for the largest scale of the bucket
+    float bucket_scale = std::exp2((key.bucket + 1) / kBucketsPerOctave);
+
+    Entry entry;
+    entry.key = key;
+    entry.path.setFillType(path.getFillType());
+
+    PathSink sink{&entry.path, 0};
+    flatten_path(path, kTolerance / bucket_scale, &sink);
+    entry.points = sink.points;
+    entry.source = path_data_;
+
+    points_ += entry.points;
+    entries_.emplace_front(std::move(entry));
+    index_[key] = entries_.begin();
+
+    evict();
+
+    return entries_.front().path;
+}
+
+void PathGeometryCache::begin_frame() {
+    stats_.entries = static_cast<uint32_t>(entries_.size());
+    stats_.points = points_;
+    stats_.arena_allocations = seen_arenas_[seen_index_].Stats().allocations;
+    last_stats_ = stats_;
+    stats_ = {};
+
+    // the keys of two frames ago make room for this frame's
+    seen_index_ ^= 1;
+    reset_seen(seen_index_);
+}
+
+void PathGeometryCache::set_enabled(bool enabled) {
+    if (enabled == enabled_) {
+        return;
+    }
+
+    enabled_ = enabled;
+    clear();
+}
+
+void PathGeometryCache::clear() {
+    index_.clear();
+    entries_.clear();
+    reset_seen(0);
+    reset_seen(1);
+    points_ = 0;
+}
+
+void PathGeometryCache::reset_seen(uint32_t index) {
+    // the set is gone before the memory it lived in is handed out again
+    seen_[index].~KeySet();
+    seen_arenas_[index].reset();
+    new (&seen_[index]) KeySet(0, KeyHash{}, std::equal_to<Key>{},
+                               ArenaAllocator<Key>(&seen_arenas_[index]));
+}
+
+uint64_t PathGeometryCache::hash_path(skity::Path const &path) {
+    path_data_.clear();
+    path_data_.emplace_back(static_cast<uint32_t>(path.getFillType()));
+
+    bool curves = false;
+
+    skity::Path::Iter iter{path, false};
+    skity::Point pts[4];
+
+    for (;;) {
+        auto verb = iter.next(pts);
+        if (verb == skity::Path::Verb::kDone) {
+            break;
+        }
+
+        path_data_.emplace_back(static_cast<uint32_t>(verb));
+
+        // pts[0] of anything but a move repeats the last point
+        uint32_t first = verb == skity::Path::Verb::kMove ? 0 : 1;
+        uint32_t count = 0;
+        switch (verb) {
+            case skity::Path::Verb::kMove:
+            case skity::Path::Verb::kLine:
+                count = 1;
+                break;
+            case skity::Path::Verb::kQuad:
+                count = 2;
+                curves = true;
+                break;
+            case skity::Path::Verb::kConic:
+                count = 2;
+                curves = true;
+                path_data_.emplace_back(float_bits(iter.conicWeight()));
+                break;
+            case skity::Path::Verb::kCubic:
+                count = 3;
+                curves = true;
+                break;
+            default:
+                break;
+        }
+
+        for (uint32_t i = first; i < first + count; i++) {
+            path_data_.emplace_back(float_bits(pts[i].x));
+            path_data_.emplace_back(float_bits(pts[i].y));
+        }
+    }
+
+    if (!curves) {
+        return 0;
+    }
+
+    PathHasher hasher;
+    for (uint32_t value : path_data_) {
+        hasher.add(value);
+    }
+
+    return hasher.hash != 0 ? hasher.hash : 1;
+}
+
+void PathGeometryCache::evict() {
+    // never the entry just added, get() hands it out
+    while (points_ > point_budget_ && entries_.size() > 1) {
+        points_ -= entries_.back().points;
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
+
+PathCacheCanvas::PathCacheCanvas(PathGeometryCache *cache) : cache_(cache) {
+    matrices_.emplace_back(1.f);
+}
+
+void PathCacheCanvas::set_target(skity::Canvas *target, uint32_t width, uint32_t height) {
+    target_ = target;
+    width_ = width;
+    height_ = height;
+
+    matrices_.clear();
+    matrices_.emplace_back(1.f);
+}
+
+void PathCacheCanvas::onClipPath(skity::Path const &path, ClipOp op) {
+    target_->clipPath(cache_->get(path, CurrentScale()), op);
+}
+
+void PathCacheCanvas::onDrawPath(skity::Path const &path, skity::Paint const &paint) {
+    target_->drawPath(cache_->get(path, CurrentScale()), paint);
+}
+
+void PathCacheCanvas::onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                                 skity::Paint const &paint) {
+    target_->drawTextBlob(blob, x, y, paint);
+}
+
+void PathCacheCanvas::onSave() {
+    matrices_.emplace_back(matrices_.back());
+    target_->save();
+}
+
+void PathCacheCanvas::onRestore() {
+    if (matrices_.size() > 1) {
+        matrices_.pop_back();
+    }
+    target_->restore();
+}
+
+void PathCacheCanvas::onTranslate(float dx, float dy) {
+    matrices_.back() = glm::translate(matrices_.back(), glm::vec3(dx, dy, 0.f));
+    target_->translate(dx, dy);
+}
+
+void PathCacheCanvas::onScale(float sx, float sy) {
+    matrices_.back() = glm::scale(matrices_.back(), glm::vec3(sx, sy, 1.f));
+    target_->scale(sx, sy);
+}
+
+void PathCacheCanvas::onRotate(float degree) {
+    matrices_.back() = glm::rotate(matrices_.back(), glm::radians(degree),
+                                   glm::vec3(0.f, 0.f, 1.f));
+    target_->rotate(degree);
+}
+
+void PathCacheCanvas::onRotate(float degree, float px, float py) {
+    auto &matrix = matrices_.back();
+    matrix = glm::translate(matrix, glm::vec3(px, py, 0.f));
+    matrix = glm::rotate(matrix, glm::radians(degree), glm::vec3(0.f, 0.f, 1.f));
+    matrix = glm::translate(matrix, glm::vec3(-px, -py, 0.f));
+    target_->rotate(degree, px, py);
+}
+
+void PathCacheCanvas::onConcat(skity::Matrix const &matrix) {
+    matrices_.back() = matrices_.back() * matrix;
+    target_->concat(matrix);
+}
+
+void PathCacheCanvas::onFlush() {
+    target_->flush();
+}
+
+void PathCacheCanvas::onUpdateViewport(uint32_t width, uint32_t height) {
+    width_ = width;
+    height_ = height;
+}
+
+float PathCacheCanvas::CurrentScale() const {
+    auto const &matrix = matrices_.back();
+    return std::sqrt(std::abs(matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0]));
+}
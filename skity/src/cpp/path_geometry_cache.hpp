@@ -0,0 +1,202 @@
+
+#ifndef SKITY_ANDROID_PATH_GEOMETRY_CACHE_HPP
+#define SKITY_ANDROID_PATH_GEOMETRY_CACHE_HPP
+
+#include <skity/skity.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "frame_arena.hpp"
+
+struct PathCacheFrameStats {
+    // paths with curves looked up, line only paths are drawn as they are
+    uint32_t lookups = {};
+    uint32_t hits = {};
+    // hash matched an entry of another path, drawn uncached
+    uint32_t collisions = {};
+    uint32_t entries = {};
+    size_t points = {};
+    // allocations of the frame's first sightings, served by an arena
+    uint64_t arena_allocations = {};
+
+    float HitRate() const { return lookups > 0 ? static_cast<float>(hits) / lookups : 0.f; }
+};
+
+/**
+ * Flattened paths kept across frames.
+ *
+ * Skity subdivides every curve of a path again each time it is drawn. get()
+ * returns a copy made of lines only, flattened for the scale bucket of the
+ * transform, so Skity gets polygons it can fill right away. Entries are keyed
+ * by a hash of the path content and the bucket: a path that is only
+ * translated, or scaled within its bucket, hits. A hit is checked against the
+ * verbs and points the entry was flattened from, so a hash collision costs a
+ * miss instead of drawing another path's geometry.
+ *
+ * Lookups walk the whole path every frame and Skity still tessellates the
+ * flattened copy, so the saving depends on the content. set_enabled(false)
+ * turns the cache into a pass through to compare frame times.
+ *
+ * A path is flattened on its second frame in a row, animated paths that
+ * never come back are not worth a copy. Their keys are the per frame
+ * allocations of the cache, they go to one FrameArena per frame instead of
+ * the heap. The cache holds at most point_budget points, least recently used
+ * entries are dropped first.
+ */
+class PathGeometryCache {
+public:
+    // max distance of flattened curves from the curve, in device pixels
+    static constexpr float kTolerance = 0.25f;
+    // scale buckets per doubling of the transform scale
+    static constexpr float kBucketsPerOctave = 4.f;
+    static constexpr size_t kDefaultPointBudget = 128 * 1024;
+
+    PathGeometryCache() : PathGeometryCache(kDefaultPointBudget) {}
+
+    explicit PathGeometryCache(size_t point_budget);
+
+    ~PathGeometryCache() = default;
+
+    /**
+     * @param scale length scale of the transform path is drawn with
+     * @return the flattened copy, or path itself
+     */
+    skity::Path const &get(skity::Path const &path, float scale);
+
+    /**
+     * Close the stats of the last frame.
+     */
+    void begin_frame();
+
+    PathCacheFrameStats const &LastFrameStats() const { return last_stats_; }
+
+    void clear();
+
+    /**
+     * Disabled, get() returns every path as it is and the cache is emptied.
+     */
+    void set_enabled(bool enabled);
+
+    bool IsEnabled() const { return enabled_; }
+
+private:
+    struct Key {
+        uint64_t hash = {};
+        int32_t bucket = {};
+
+        bool operator==(Key const &other) const {
+            return hash == other.hash && bucket == other.bucket;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(Key const &key) const;
+    };
+
+    using KeySet = std::unordered_set<Key, KeyHash, std::equal_to<Key>, ArenaAllocator<Key>>;
+
+    struct Entry {
+        Key key = {};
+        skity::Path path = {};
+        size_t points = {};
+        // fill type, verbs and point bits of the source path
+        std::vector<uint32_t> source = {};
+    };
+
+    /**
+     * Encode path into path_data_ and hash that.
+     *
+     * @return 0 for paths without curves
+     */
+    uint64_t hash_path(skity::Path const &path);
+
+    void evict();
+
+    /**
+     * Replace seen_[index] by an empty set and rewind its arena.
+     */
+    void reset_seen(uint32_t index);
+
+private:
+    size_t point_budget_;
+    bool enabled_ = true;
+    size_t points_ = {};
+    // encoding of the path looked up last, reused across lookups
+    std::vector<uint32_t> path_data_ = {};
+    // most recently used at the front
+    std::list<Entry> entries_ = {};
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_ = {};
+    // looked up without an entry, in this frame at seen_index_ and in the
+    // last one, each set on its own arena
+    std::array<FrameArena, 2> seen_arenas_ = {};
+    std::array<KeySet, 2> seen_;
+    uint32_t seen_index_ = {};
+    PathCacheFrameStats stats_ = {};
+    PathCacheFrameStats last_stats_ = {};
+};
+
+/**
+ * Canvas forwarding everything to another canvas, with paths and clip paths
+ * replaced by their PathGeometryCache copies. Keeps its own transform stack
+ * for the scale.
+ */
+class PathCacheCanvas : public skity::Canvas {
+public:
+    explicit PathCacheCanvas(PathGeometryCache *cache);
+
+    ~PathCacheCanvas() override = default;
+
+    /**
+     * Forward to target from its current state on, call at the start of every
+     * frame since renderers can recreate their canvas.
+     */
+    void set_target(skity::Canvas *target, uint32_t width, uint32_t height);
+
+protected:
+    void onClipPath(skity::Path const &path, ClipOp op) override;
+
+    void onDrawPath(skity::Path const &path, skity::Paint const &paint) override;
+
+    void onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                    skity::Paint const &paint) override;
+
+    void onSave() override;
+
+    void onRestore() override;
+
+    void onTranslate(float dx, float dy) override;
+
+    void onScale(float sx, float sy) override;
+
+    void onRotate(float degree) override;
+
+    void onRotate(float degree, float px, float py) override;
+
+    void onConcat(skity::Matrix const &matrix) override;
+
+    void onFlush() override;
+
+    uint32_t onGetWidth() const override { return width_; }
+
+    uint32_t onGetHeight() const override { return height_; }
+
+    void onUpdateViewport(uint32_t width, uint32_t height) override;
+
+private:
+    float CurrentScale() const;
+
+private:
+    PathGeometryCache *cache_;
+    skity::Canvas *target_ = {};
+    uint32_t width_ = {};
+    uint32_t height_ = {};
+    std::vector<skity::Matrix> matrices_ = {};
+};
+
+#endif //SKITY_ANDROID_PATH_GEOMETRY_CACHE_HPP
@@ -0,0 +1,143 @@
+
+#include "perf_graph.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+constexpr float PerfGraph::kWidth;
+constexpr float PerfGraph::kHeight;
+constexpr size_t PerfGraph::kHistoryCount;
+
+PerfGraph::PerfGraph(Style style, std::string name) : style_(style), name_(std::move(name)) {}
+
+void PerfGraph::set_typeface(std::shared_ptr<skity::Typeface> typeface) {
+    typeface_ = std::move(typeface);
+    text_cache_.clear();
+}
+
+void PerfGraph::UpdateGraph(float frame_time) {
+    head_ = (head_ + 1) % kHistoryCount;
+    values_[head_] = frame_time;
+}
+
+float PerfGraph::GetAverage() const {
+    float sum = 0.f;
+    for (float v : values_) {
+        sum += v;
+    }
+    return sum / kHistoryCount;
+}
+
+void PerfGraph::RenderGraph(skity::Canvas *canvas, float x, float y) {
+    float avg = GetAverage();
+
+    skity::Paint paint;
+    paint.setStyle(skity::Paint::kFill_Style);
+    paint.setAntiAlias(true);
+
+    paint.setColor(skity::ColorSetARGB(128, 0, 0, 0));
+    canvas->drawRect(skity::Rect::MakeXYWH(x, y, kWidth, kHeight), paint);
+
+    skity::Path path;
+    path.moveTo(x, y + kHeight);
+    for (size_t i = 0; i < kHistoryCount; i++) {
+        float v = values_[(head_ + i) % kHistoryCount];
+        float max;
+        if (style_ == kFPS) {
+            v = 1.f / (0.00001f + v);
+            max = 80.f;
+        } else if (style_ == kCount) {
+            max = 200.f;
+        } else if (style_ == kPercent) {
+            v = v * 100.f;
+            max = 100.f;
+        } else {
+            v = v * 1000.f;
+            max = 20.f;
+        }
+        if (v > max) {
+            v = max;
+        }
+        float vx = x + (static_cast<float>(i) / (kHistoryCount - 1)) * kWidth;
+        float vy = y + kHeight - ((v / max) * kHeight);
+        path.lineTo(vx, vy);
+    }
+    path.lineTo(x + kWidth, y + kHeight);
+    path.close();
+
+    paint.setColor(skity::ColorSetARGB(128, 255, 192, 0));
+    canvas->drawPath(path, paint);
+
+    if (!typeface_) {
+        return;
+    }
+
+    paint.setTypeface(typeface_);
+
+    paint.setTextSize(12.f);
+    paint.setColor(skity::ColorSetARGB(192, 240, 240, 240));
+    text_cache_.draw(canvas, name_, x + 3.f, y + 3.f + 12.f, paint);
+
+    char readout[64];
+    if (style_ == kFPS) {
+        paint.setTextSize(15.f);
+        paint.setColor(skity::ColorSetARGB(255, 240, 240, 240));
+        std::snprintf(readout, sizeof(readout), "%.2f", 1.f / avg);
+        draw_readout(canvas, readout, "FPS", x + kWidth - 3.f, y + 3.f + 15.f, paint);
+
+        paint.setTextSize(13.f);
+        paint.setColor(skity::ColorSetARGB(160, 240, 240, 240));
+        std::snprintf(readout, sizeof(readout), "%.2f", avg * 1000.f);
+        draw_readout(canvas, readout, "ms", x + kWidth - 3.f, y + kHeight - 3.f, paint);
+    } else if (style_ == kCount) {
+        paint.setTextSize(15.f);
+        paint.setColor(skity::ColorSetARGB(255, 240, 240, 240));
+        std::snprintf(readout, sizeof(readout), "%.1f", avg);
+        draw_readout(canvas, readout, nullptr, x + kWidth - 3.f, y + 3.f + 15.f, paint);
+    } else if (style_ == kPercent) {
+        paint.setTextSize(15.f);
+        paint.setColor(skity::ColorSetARGB(255, 240, 240, 240));
+        std::snprintf(readout, sizeof(readout), "%.1f", avg * 100.f);
+        draw_readout(canvas, readout, "%", x + kWidth - 3.f, y + 3.f + 15.f, paint);
+    } else {
+        paint.setTextSize(15.f);
+        paint.setColor(skity::ColorSetARGB(255, 240, 240, 240));
+        std::snprintf(readout, sizeof(readout), "%.2f", avg * 1000.f);
+        draw_readout(canvas, readout, "ms", x + kWidth - 3.f, y + 3.f + 15.f, paint);
+    }
+}
+
+void PerfGraph::draw_readout(skity::Canvas *canvas, const char *value, const char *unit,
+                             float right, float baseline, skity::Paint const &paint) {
+    if (unit) {
+        auto blob = text_cache_.get(unit, paint);
+        if (blob) {
+            right -= blob->getBoundSize().x;
+            canvas->drawTextBlob(blob.get(), right, baseline, paint);
+        }
+        right -= paint.getTextSize() * 0.3f;
+    }
+
+    // the same cell for every digit, so the readout does not jitter
+    auto zero = text_cache_.get("0", paint);
+    float cell = zero ? zero->getBoundSize().x * 1.15f : paint.getTextSize() * 0.6f;
+
+    for (size_t i = std::strlen(value); i > 0; i--) {
+        char c = value[i - 1];
+        // one character fits the small string buffer, no allocation per glyph
+        auto blob = text_cache_.get(std::string(1, c), paint);
+        if (!blob) {
+            continue;
+        }
+
+        float width = blob->getBoundSize().x;
+        if (c >= '0' && c <= '9') {
+            right -= cell;
+            canvas->drawTextBlob(blob.get(), right + (cell - width) * 0.5f, baseline, paint);
+        } else {
+            right -= width + paint.getTextSize() * 0.1f;
+            canvas->drawTextBlob(blob.get(), right, baseline, paint);
+        }
+    }
+}
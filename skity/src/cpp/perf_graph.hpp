@@ -0,0 +1,71 @@
+
+#ifndef SKITY_ANDROID_PERF_GRAPH_HPP
+#define SKITY_ANDROID_PERF_GRAPH_HPP
+
+#include <skity/skity.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "text_blob_cache.hpp"
+
+/**
+ * Frame time graph in the style of the example Perf, drawing its label and
+ * readout through a TextBlobCache instead of re-shaping them every frame.
+ *
+ * The readout changes every frame, so it is not cached as a whole: it is laid
+ * out from one blob per character, digits in fixed width cells, and a blob for
+ * the unit.
+ */
+class PerfGraph {
+public:
+    enum Style {
+        kFPS,
+        kMS,
+        // plain per frame count, e.g. heap allocations
+        kCount,
+        // ratio in [0, 1], e.g. a cache hit rate
+        kPercent,
+    };
+
+    static constexpr float kWidth = 200.f;
+    static constexpr float kHeight = 35.f;
+
+    PerfGraph(Style style, std::string name);
+
+    ~PerfGraph() = default;
+
+    void set_typeface(std::shared_ptr<skity::Typeface> typeface);
+
+    /**
+     * @param frame_time  in seconds, the count for kCount or the ratio for
+     *                    kPercent
+     */
+    void UpdateGraph(float frame_time);
+
+    void RenderGraph(skity::Canvas *canvas, float x, float y);
+
+    float GetAverage() const;
+
+    TextBlobCache const &GetTextCache() const { return text_cache_; }
+
+private:
+    static constexpr size_t kHistoryCount = 100;
+
+    /**
+     * Draw value followed by unit, right aligned at right.
+     */
+    void draw_readout(skity::Canvas *canvas, const char *value, const char *unit, float right,
+                      float baseline, skity::Paint const &paint);
+
+    Style style_;
+    std::string name_;
+    std::shared_ptr<skity::Typeface> typeface_ = {};
+    std::array<float, kHistoryCount> values_ = {};
+    size_t head_ = {};
+    // label, unit and readout characters of every text size
+    TextBlobCache text_cache_{64};
+};
+
+#endif //SKITY_ANDROID_PERF_GRAPH_HPP
@@ -0,0 +1,32 @@
+
+#ifndef SKITY_ANDROID_PLATFORM_LOG_HPP
+#define SKITY_ANDROID_PLATFORM_LOG_HPP
+
+#ifdef __ANDROID__
+
+#include <android/log.h>
+
+#define SKITY_LOG_INFO ANDROID_LOG_INFO
+#define SKITY_LOG_WARN ANDROID_LOG_WARN
+#define SKITY_LOG_ERROR ANDROID_LOG_ERROR
+
+#define SKITY_LOG_PRINT(level, tag, ...) \
+  __android_log_print(level, tag, __VA_ARGS__)
+
+#else
+
+#include <cstdio>
+
+#define SKITY_LOG_INFO "I"
+#define SKITY_LOG_WARN "W"
+#define SKITY_LOG_ERROR "E"
+
+// host builds (headless tools) have no logcat, print to stderr instead
+#define SKITY_LOG_PRINT(level, tag, ...)       \
+  (std::fprintf(stderr, "%s/%s: ", level, tag), \
+   std::fprintf(stderr, __VA_ARGS__),           \
+   std::fputc('\n', stderr))
+
+#endif
+
+#endif //SKITY_ANDROID_PLATFORM_LOG_HPP
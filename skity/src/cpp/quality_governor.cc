@@ -0,0 +1,136 @@
+
+#include "quality_governor.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "platform_log.hpp"
+
+constexpr uint32_t QualityGovernor::kWindowFrames;
+constexpr uint32_t QualityGovernor::kUpgradeFrames;
+constexpr uint32_t QualityGovernor::kMaxUpgradeFrames;
+constexpr size_t QualityGovernor::kLogCapacity;
+constexpr float QualityGovernor::kDefaultBudgetMs;
+
+static const char *kTAG = "SkityQuality";
+#define LOGI(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_INFO, kTAG, __VA_ARGS__))
+
+// average above budget * kDowngradeRatio steps down
+static constexpr float kDowngradeRatio = 1.15f;
+// vsync jitter still counts as within budget
+static constexpr float kInBudgetRatio = 1.05f;
+// longer frames are pauses or loading stalls, not rendering cost
+static constexpr double kMaxFrameTime = 0.25;
+
+QualityGovernor::QualityGovernor(float budget_ms) : budget_ms_(budget_ms) {}
+
+void QualityGovernor::set_levels(std::vector<QualityLevel> levels) {
+    levels_ = std::move(levels);
+    level_count_ = levels_.size();
+    current_ = 0;
+
+    window_.clear();
+    window_sum_ = 0.f;
+    frames_in_budget_ = 0;
+    upgrade_frames_ = kUpgradeFrames;
+    upgraded_ = false;
+}
+
+bool QualityGovernor::update(double frame_time) {
+    if (levels_.empty() || frame_time <= 0.0 || frame_time > kMaxFrameTime) {
+        return false;
+    }
+
+    frame_++;
+
+    float ms = static_cast<float>(frame_time * 1000.0);
+    window_.push_back(ms);
+    window_sum_ += ms;
+    if (window_.size() > kWindowFrames) {
+        window_sum_ -= window_.front();
+        window_.pop_front();
+    }
+
+    if (window_.size() < kWindowFrames) {
+        return false;
+    }
+
+    float average_ms = window_sum_ / window_.size();
+    int32_t level = current_;
+
+    if (average_ms > budget_ms_ * kDowngradeRatio) {
+        frames_in_budget_ = 0;
+
+        if (level + 1 >= static_cast<int32_t>(levels_.size())) {
+            return false;
+        }
+
+        if (upgraded_ && frame_ - upgrade_frame_ < upgrade_frames_) {
+            // the last step up did not hold, wait longer before the next one
+            upgrade_frames_ = std::min(upgrade_frames_ * 2, kMaxUpgradeFrames);
+        }
+        upgraded_ = false;
+
+        change_level(level + 1, average_ms);
+        return true;
+    }
+
+    if (average_ms > budget_ms_ * kInBudgetRatio) {
+        frames_in_budget_ = 0;
+        return false;
+    }
+
+    frames_in_budget_++;
+    if (level == 0 || frames_in_budget_ < upgrade_frames_) {
+        return false;
+    }
+
+    upgraded_ = true;
+    upgrade_frame_ = frame_;
+
+    change_level(level - 1, average_ms);
+    return true;
+}
+
+std::vector<QualityTransition> QualityGovernor::Transitions() const {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+
+    return {log_.begin(), log_.end()};
+}
+
+std::vector<QualityLevel> QualityGovernor::DefaultLevels(int32_t max_samples,
+                                                          bool render_scale) {
+    std::vector<QualityLevel> levels;
+
+    for (int32_t samples = std::max(max_samples, 1); samples > 1; samples /= 2) {
+        levels.emplace_back(QualityLevel{samples, 1.f});
+    }
+    levels.emplace_back(QualityLevel{1, 1.f});
+
+    if (render_scale) {
+        levels.emplace_back(QualityLevel{1, 0.75f});
+        levels.emplace_back(QualityLevel{1, 0.5f});
+    }
+
+    return levels;
+}
+
+void QualityGovernor::change_level(int32_t level, float average_ms) {
+    int32_t from = current_;
+    current_ = level;
+
+    // frames measured at the old level say nothing about the new one
+    window_.clear();
+    window_sum_ = 0.f;
+    frames_in_budget_ = 0;
+
+    LOGI("quality level %d -> %d, average %.2f ms, budget %.2f ms", from, level, average_ms,
+         budget_ms_);
+
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    log_.emplace_back(QualityTransition{frame_, from, level, average_ms});
+    if (log_.size() > kLogCapacity) {
+        log_.pop_front();
+    }
+}
@@ -0,0 +1,108 @@
+
+#ifndef SKITY_ANDROID_QUALITY_GOVERNOR_HPP
+#define SKITY_ANDROID_QUALITY_GOVERNOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * One step of the quality ladder, level 0 is the best looking one.
+ */
+struct QualityLevel {
+    // MSAA sample count, 1 disables multisampling
+    int32_t samples = 1;
+    // fraction of the surface size the frame is rendered at
+    float render_scale = 1.f;
+};
+
+struct QualityTransition {
+    // frame the decision was made on, counted from the first update()
+    uint64_t frame = {};
+    int32_t from = {};
+    int32_t to = {};
+    // rolling average frame time that triggered it
+    float average_ms = {};
+};
+
+/**
+ * Picks a QualityLevel from measured frame times.
+ *
+ * Steps one level down as soon as the rolling average misses the budget, and
+ * one level up only after the frame time stayed within budget for a long
+ * stretch. Frames are paced by vsync, so headroom can not be seen directly;
+ * instead every upgrade that is undone quickly doubles the stretch needed for
+ * the next one, which keeps the governor from oscillating between two levels.
+ *
+ * Without levels the governor is idle. set_levels, update and Current are
+ * called on the render thread, the other getters from any thread.
+ */
+class QualityGovernor {
+public:
+    // frames in the rolling average
+    static constexpr uint32_t kWindowFrames = 30;
+    // frames within budget before the first attempt to step up
+    static constexpr uint32_t kUpgradeFrames = 180;
+    static constexpr uint32_t kMaxUpgradeFrames = 3600;
+    static constexpr size_t kLogCapacity = 32;
+    // 60 fps
+    static constexpr float kDefaultBudgetMs = 1000.f / 60.f;
+
+    explicit QualityGovernor(float budget_ms = kDefaultBudgetMs);
+
+    ~QualityGovernor() = default;
+
+    /**
+     * Replace the ladder and restart from level 0.
+     */
+    void set_levels(std::vector<QualityLevel> levels);
+
+    /**
+     * Feed the duration of the last frame.
+     *
+     * @return true when the current level changed
+     */
+    bool update(double frame_time);
+
+    int32_t CurrentLevel() const { return current_; }
+
+    QualityLevel Current() const { return levels_[current_]; }
+
+    int32_t LevelCount() const { return level_count_; }
+
+    float BudgetMs() const { return budget_ms_; }
+
+    /**
+     * Most recent transitions, oldest first.
+     */
+    std::vector<QualityTransition> Transitions() const;
+
+    /**
+     * Halve the sample count down to single sampled, starting at max_samples.
+     * With render_scale the ladder continues with lower render scales.
+     */
+    static std::vector<QualityLevel> DefaultLevels(int32_t max_samples, bool render_scale);
+
+private:
+    void change_level(int32_t level, float average_ms);
+
+private:
+    std::vector<QualityLevel> levels_ = {};
+    std::atomic<int32_t> level_count_ = {0};
+    float budget_ms_;
+    std::atomic<int32_t> current_ = {0};
+    std::deque<float> window_ = {};
+    float window_sum_ = {};
+    uint64_t frame_ = {};
+    uint32_t frames_in_budget_ = {};
+    uint32_t upgrade_frames_ = kUpgradeFrames;
+    // frame of the last step up, to detect upgrades that did not hold
+    uint64_t upgrade_frame_ = {};
+    bool upgraded_ = {};
+    mutable std::mutex log_mutex_ = {};
+    std::deque<QualityTransition> log_ = {};
+};
+
+#endif //SKITY_ANDROID_QUALITY_GOVERNOR_HPP
@@ -0,0 +1,346 @@
+
+#include "renderer.hpp"
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "platform_log.hpp"
+
+static const char *kTAG = "SkityGL";
+#define LOGI(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_INFO, kTAG, __VA_ARGS__))
+#define LOGW(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_WARN, kTAG, __VA_ARGS__))
+#define LOGE(...) \
+  ((void)SKITY_LOG_PRINT(SKITY_LOG_ERROR, kTAG, __VA_ARGS__))
+
+static PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleEXT_ = nullptr;
+static PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC glRenderbufferStorageMultisampleEXT_ = nullptr;
+
+static bool has_gl_extension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i = 0; i < count; i++) {
+        auto ext = (const char *) glGetStringi(GL_EXTENSIONS, i);
+        if (ext && std::strcmp(ext, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool load_msaa_to_texture_procs() {
+    if (glFramebufferTexture2DMultisampleEXT_ && glRenderbufferStorageMultisampleEXT_) {
+        return true;
+    }
+
+    if (!has_gl_extension("GL_EXT_multisampled_render_to_texture")) {
+        return false;
+    }
+
+    glFramebufferTexture2DMultisampleEXT_ = (PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC)
+            eglGetProcAddress("glFramebufferTexture2DMultisampleEXT");
+    glRenderbufferStorageMultisampleEXT_ = (PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC)
+            eglGetProcAddress("glRenderbufferStorageMultisampleEXT");
+
+    return glFramebufferTexture2DMultisampleEXT_ && glRenderbufferStorageMultisampleEXT_;
+}
+
+Renderer::~Renderer() {
+    destroy_msaa_target();
+}
+
+void Renderer::init(int w, int h, int d) {
+    width_ = w;
+    height_ = h;
+    density_ = d;
+
+    init_gl();
+
+    skity::GPUContext ctx{skity::GPUBackendType::kOpenGL, (void *) eglGetProcAddress};
+    canvas_ = skity::Canvas::MakeHardwareAccelationCanvas(width_, height_, density_, &ctx);
+}
+
+void Renderer::init_gl() {
+    glClearColor(1.f, 1.f, 1.f, 1.f);
+    glClearStencil(0x0);
+    glStencilMask(0xFF);
+    glEnable(GL_STENCIL_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    const char* version;
+    std::vector<const char*> prefixes = {
+            "OpenGL ES-CM ",
+            "OpenGL ES-CL ",
+            "OpenGL ES ",
+    };
+
+    version = (const char*) glGetString(GL_VERSION);
+
+    LOGI("glVersion = %s", version);
+
+    for(auto pref : prefixes) {
+        size_t length = std::strlen(pref);
+        if (std::strncmp(version, pref, length) == 0) {
+            version += length;
+            break;
+        }
+    }
+
+    int major, minor;
+    std::sscanf(version, "%d.%d", &major, &minor);
+
+    LOGI("major = %d | minor = %d", major, minor);
+
+    // ETC2 is core since ES 3.0
+    compression_caps_.etc2 = major >= 3;
+    compression_caps_.astc_ldr = has_gl_extension("GL_KHR_texture_compression_astc_ldr");
+
+    LOGI("texture compression etc2 = %d | astc = %d", compression_caps_.etc2,
+         compression_caps_.astc_ldr);
+
+    // samples of the window surface picked by the EGL config
+    glGetIntegerv(GL_SAMPLES, &window_samples_);
+    msaa_samples_ = window_samples_;
+}
+
+GLuint Renderer::create_texture(CompressedPixmap const &pixmap) {
+    std::shared_ptr<skity::Pixmap> decoded;
+    if (!compression_caps_.Supports(pixmap.Format())) {
+        decoded = pixmap.Decode();
+        if (!decoded) {
+            LOGE("compressed format %d is not supported and has no CPU decoder",
+                 (int) pixmap.Format());
+            return 0;
+        }
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    if (decoded) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, decoded->Width(), decoded->Height(), 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, decoded->Addr());
+    } else {
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, pixmap.GLInternalFormat(), pixmap.Width(),
+                               pixmap.Height(), 0, pixmap.BlocksSize(), pixmap.Blocks());
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return texture;
+}
+
+GLuint Renderer::create_texture(skity::Pixmap const &pixmap, bool mipmaps) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // GL_UNPACK_ROW_LENGTH skips the row padding some pixmaps carry
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pixmap.RowBytes() / 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pixmap.Width(), pixmap.Height(), 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, pixmap.Addr());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    if (mipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return texture;
+}
+
+void Renderer::draw() {
+    frame_clock_.begin_frame();
+
+    auto canvas = begin_frame();
+
+    onDraw(canvas);
+
+    if (commands_ && !command_player_.play(canvas, commands_, command_size_)) {
+        LOGW("canvas commands malformed at byte %u",
+             command_player_.LastStats().error_offset);
+    }
+
+    end_frame();
+}
+
+void Renderer::draw_commands(uint8_t const *data, size_t size) {
+    commands_ = data;
+    command_size_ = size;
+
+    draw();
+
+    commands_ = nullptr;
+    command_size_ = 0;
+}
+
+InputSample Renderer::latch_input() {
+    InputSample sample;
+    input_channel_.read(&sample);
+    input_latency_.latched(sample, monotonic_nanos());
+
+    return sample;
+}
+
+skity::Canvas *Renderer::begin_frame() {
+    update_msaa_target();
+
+    if (msaa_fbo_) {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target_fbo_);
+        glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_);
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    return canvas_.get();
+}
+
+void Renderer::end_frame() {
+    canvas_->flush();
+    // the frame's GL commands are with the driver, the swap follows right after
+    input_latency_.submitted(monotonic_nanos());
+
+    if (!msaa_fbo_) {
+        if (msaa_samples_ > 0) {
+            // the window resolves on-tile at swap, keep the stencil from being written back
+            GLint fbo = 0;
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+            GLenum stencil_attachment = fbo ? GL_DEPTH_STENCIL_ATTACHMENT : GL_STENCIL;
+            glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &stencil_attachment);
+        }
+        return;
+    }
+
+    // stencil is only needed while drawing, drop it before the tile is written back
+    GLenum stencil_attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+    glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &stencil_attachment);
+
+    // reading the texture resolves the samples on-tile, only single-sampled
+    // color goes through memory
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, msaa_fbo_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_fbo_);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT,
+                      GL_NEAREST);
+
+    GLenum color_attachment = GL_COLOR_ATTACHMENT0;
+    glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_);
+    glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &color_attachment);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target_fbo_);
+}
+
+void Renderer::set_default_typeface(std::shared_ptr<skity::Typeface> typeface) {
+    canvas_->setDefaultTypeface(std::move(typeface));
+}
+
+void Renderer::update_msaa_target() {
+    int32_t samples = requested_samples_;
+    if (samples == applied_samples_) {
+        return;
+    }
+    applied_samples_ = samples;
+
+    destroy_msaa_target();
+
+    if (samples <= 0 || samples == window_samples_) {
+        // drawing straight into the window, it multisamples itself if the config asked for it
+        return;
+    }
+
+    if (window_samples_ > 0) {
+        // a single sampled texture can not be blitted into a multisampled window
+        LOGW("window surface has %d samples, keep drawing into it", window_samples_);
+        return;
+    }
+
+    create_msaa_target(samples);
+}
+
+void Renderer::create_msaa_target(int32_t samples) {
+    if (!load_msaa_to_texture_procs()) {
+        LOGW("GL_EXT_multisampled_render_to_texture not supported, keep default framebuffer");
+        return;
+    }
+
+    GLint max_samples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES_EXT, &max_samples);
+    if (samples > max_samples) {
+        LOGW("requested %d samples, clamp to %d", samples, max_samples);
+        samples = max_samples;
+    }
+
+    glGenTextures(1, &msaa_texture_);
+    glBindTexture(GL_TEXTURE_2D, msaa_texture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width_, height_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &msaa_stencil_);
+    glBindRenderbuffer(GL_RENDERBUFFER, msaa_stencil_);
+    glRenderbufferStorageMultisampleEXT_(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, width_,
+                                         height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint prev_fbo = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+
+    glGenFramebuffers(1, &msaa_fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_);
+    glFramebufferTexture2DMultisampleEXT_(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                          msaa_texture_, 0, samples);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              msaa_stencil_);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, prev_fbo);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOGE("msaa framebuffer incomplete : 0x%x", status);
+        destroy_msaa_target();
+        return;
+    }
+
+    msaa_samples_ = samples;
+
+    LOGI("render to multisampled texture, samples = %d", msaa_samples_);
+}
+
+void Renderer::destroy_msaa_target() {
+    if (msaa_fbo_) {
+        glDeleteFramebuffers(1, &msaa_fbo_);
+        msaa_fbo_ = 0;
+    }
+
+    if (msaa_texture_) {
+        glDeleteTextures(1, &msaa_texture_);
+        msaa_texture_ = 0;
+    }
+
+    if (msaa_stencil_) {
+        glDeleteRenderbuffers(1, &msaa_stencil_);
+        msaa_stencil_ = 0;
+    }
+
+    msaa_samples_ = window_samples_;
+}
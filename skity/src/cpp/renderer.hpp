@@ -0,0 +1,166 @@
+
+#ifndef SKITY_ANDROID_RENDERER_HPP
+#define SKITY_ANDROID_RENDERER_HPP
+
+#include "skity/skity.hpp"
+#include "skity/gpu/gpu_context.hpp"
+
+#include <GLES3/gl3.h>
+
+#include <atomic>
+
+#include "canvas_commands.hpp"
+#include "compressed_pixmap.hpp"
+#include "frame_clock.hpp"
+#include "input_channel.hpp"
+
+class Renderer {
+public:
+    Renderer() = default;
+
+    virtual ~Renderer();
+
+    void init(int w, int h, int d);
+
+    void draw();
+
+    /**
+     * Draw a frame with a canvas command stream executed on top of onDraw(),
+     * see CanvasCommandPlayer. data only has to live until this returns.
+     */
+    void draw_commands(uint8_t const *data, size_t size);
+
+    /**
+     * draw() split in two, for callers issuing canvas calls one by one. The
+     * canvas is valid until end_frame(), onDraw() is not called.
+     */
+    skity::Canvas *begin_frame();
+
+    void end_frame();
+
+    /**
+     * Canvas of the frame between begin_frame() and end_frame().
+     */
+    skity::Canvas *GetFrameCanvas() { return canvas_.get(); }
+
+    CanvasCommandPlayer *GetCommandPlayer() { return &command_player_; }
+
+    void set_default_typeface(std::shared_ptr<skity::Typeface> typeface);
+
+    /**
+     * Stamp the next draw() with the vsync it is drawn for, see FrameClock.
+     */
+    void set_vsync_time(double seconds) { frame_clock_.set_vsync_time(seconds); }
+
+    /**
+     * Latest touch position, written from the UI thread and latched by the
+     * frame right before it records the content that follows it.
+     */
+    InputChannel *GetInputChannel() { return &input_channel_; }
+
+    /**
+     * Input to submit latency of the frames that latched new input. Can be
+     * called from any thread.
+     */
+    InputLatencyStats GetInputLatency() const { return input_latency_.Stats(); }
+
+    /**
+     * Multisample frames with the given sample count, resolved on-tile with
+     * the stencil buffer never leaving tile memory.
+     *
+     * When the window surface already has that many samples frames are drawn
+     * straight into it and the stencil is invalidated after flush. Only a
+     * single sampled window gets an offscreen FBO backed by
+     * EXT_multisampled_render_to_texture, blitted into the window after flush.
+     * Without the extension, or with a window of another sample count, frames
+     * keep going to the window as it is. Pass 0 to stop using the offscreen
+     * target.
+     *
+     * Can be called from any thread, the change is applied on the next draw.
+     */
+    void set_msaa_samples(int32_t samples) { requested_samples_ = samples; }
+
+    /**
+     * Sample count frames are currently drawn with, the offscreen target's or
+     * the window surface's.
+     */
+    int32_t msaa_samples() const { return msaa_samples_; }
+
+    /**
+     * Frames go through the offscreen target, only then can the sample count
+     * change at runtime.
+     */
+    bool UsesMSAATarget() const { return msaa_fbo_ != 0; }
+
+    /**
+     * Compressed formats the GL context can sample, valid after init().
+     */
+    TextureCompressionCaps GetCompressionCaps() const { return compression_caps_; }
+
+    /**
+     * Create a texture from compressed blocks on the current context, decoding
+     * them on the CPU when the format is not supported.
+     *
+     * @return texture name, 0 on failure
+     */
+    GLuint create_texture(CompressedPixmap const &pixmap);
+
+    /**
+     * Create an RGBA texture on the current context. With mipmaps the chain is
+     * filled by glGenerateMipmap and sampled trilinear.
+     */
+    GLuint create_texture(skity::Pixmap const &pixmap, bool mipmaps);
+
+protected:
+    virtual void onDraw(skity::Canvas *canvas) {}
+
+    skity::Canvas *GetCanvas() { return canvas_.get(); }
+
+    FrameClock const &GetFrameClock() const { return frame_clock_; }
+
+    /**
+     * Read the newest input sample for the frame being recorded, call it as
+     * late as possible. Zero before the first input.
+     */
+    InputSample latch_input();
+
+    int32_t Width() const { return width_; }
+
+    int32_t Height() const { return height_; }
+
+    int32_t Density() const { return density_; }
+
+private:
+    void init_gl();
+
+    void update_msaa_target();
+
+    void create_msaa_target(int32_t samples);
+
+    void destroy_msaa_target();
+
+private:
+    int32_t width_ = {};
+    int32_t height_ = {};
+    int32_t density_ = {};
+    std::unique_ptr<skity::Canvas> canvas_ = {};
+    std::atomic<int32_t> requested_samples_ = {0};
+    // requested_samples_ the target was last set up for
+    int32_t applied_samples_ = {};
+    GLint window_samples_ = {};
+    int32_t msaa_samples_ = {};
+    GLuint msaa_fbo_ = {};
+    GLuint msaa_texture_ = {};
+    GLuint msaa_stencil_ = {};
+    GLint target_fbo_ = {};
+    TextureCompressionCaps compression_caps_ = {};
+    FrameClock frame_clock_ = {};
+    InputChannel input_channel_ = {};
+    InputLatencyMeter input_latency_ = {};
+    CanvasCommandPlayer command_player_{};
+    // stream of the running draw_commands() call
+    uint8_t const *commands_ = {};
+    size_t command_size_ = {};
+};
+
+#endif //SKITY_ANDROID_RENDERER_HPP
@@ -16,15 +16,144 @@
 #include <android/asset_manager_jni.h>
 #include <android/native_window_jni.h>
 #include <android/bitmap.h>
+#include <android/log.h>
 
+#include <cstring>
 #include <utility>
 
 #define SKITY_DEFAULT_FONT "Roboto Mono Nerd Font Complete.ttf"
 
-extern "C"
-JNIEXPORT jlong JNICALL
-Java_com_skity_graphic_Renderer_nativeInit(JNIEnv *env, jobject thiz, jint width, jint height,
-                                           jint density) {
+static std::vector<std::shared_ptr<CompressedPixmap>> load_compressed_images(
+        JNIEnv *env, jobject asset_manager, jobjectArray paths) {
+    auto am = AAssetManager_fromJava(env, asset_manager);
+
+    std::vector<std::shared_ptr<CompressedPixmap>> images = {};
+
+    int size = env->GetArrayLength(paths);
+    for (int i = 0; i < size; i++) {
+        auto path = (jstring) env->GetObjectArrayElement(paths, i);
+        auto path_str = env->GetStringUTFChars(path, nullptr);
+
+        // an image that fails to load stays a null entry, the renderer then
+        // falls back to the jpg files
+        std::shared_ptr<CompressedPixmap> image = {};
+        auto asset = AAssetManager_open(am, path_str, AASSET_MODE_BUFFER);
+        if (asset) {
+            image = CompressedPixmap::MakeFromData(AAsset_getBuffer(asset),
+                                                   AAsset_getLength(asset));
+            AAsset_close(asset);
+        }
+        images.emplace_back(std::move(image));
+
+        env->ReleaseStringUTFChars(path, path_str);
+        env->DeleteLocalRef(path);
+    }
+
+    return images;
+}
+
+static uint8_t const *get_command_data(JNIEnv *env, jobject buffer, jint size) {
+    auto data = (uint8_t const *) env->GetDirectBufferAddress(buffer);
+    if (data == nullptr || size < 0 || size > env->GetDirectBufferCapacity(buffer)) {
+        return nullptr;
+    }
+
+    return data;
+}
+
+static jlongArray make_transition_array(JNIEnv *env, QualityGovernor const &governor) {
+    auto transitions = governor.Transitions();
+
+    // frame, from, to, average frame time in microseconds
+    std::vector<jlong> values;
+    values.reserve(transitions.size() * 4);
+    for (auto const &t : transitions) {
+        values.emplace_back(t.frame);
+        values.emplace_back(t.from);
+        values.emplace_back(t.to);
+        values.emplace_back(static_cast<jlong>(t.average_ms * 1000.f));
+    }
+
+    auto array = env->NewLongArray(values.size());
+    env->SetLongArrayRegion(array, 0, values.size(), values.data());
+
+    return array;
+}
+
+/**
+ * Class and method IDs looked up once in JNI_OnLoad. The IDs stay valid as
+ * long as the class is loaded, which the global reference guarantees.
+ */
+struct JavaIds {
+    jclass list_class = {};
+    jmethodID list_size = {};
+    jmethodID list_get = {};
+};
+
+static JavaIds g_java_ids = {};
+
+static bool init_java_ids(JNIEnv *env) {
+    auto list_class = env->FindClass("java/util/List");
+    if (list_class == nullptr) {
+        return false;
+    }
+
+    g_java_ids.list_class = (jclass) env->NewGlobalRef(list_class);
+    g_java_ids.list_size = env->GetMethodID(list_class, "size", "()I");
+    g_java_ids.list_get = env->GetMethodID(list_class, "get", "(I)Ljava/lang/Object;");
+    env->DeleteLocalRef(list_class);
+
+    return g_java_ids.list_size != nullptr && g_java_ids.list_get != nullptr;
+}
+
+/**
+ * Copy the pixels of a List<Bitmap> into pixmaps.
+ */
+static std::vector<std::shared_ptr<skity::Pixmap>> load_bitmaps(JNIEnv *env, jobject images) {
+    std::vector<std::shared_ptr<skity::Pixmap>> skity_images = {};
+
+    int size = env->CallIntMethod(images, g_java_ids.list_size);
+    skity_images.reserve(size);
+    for (int i = 0; i < size; i++) {
+        auto bitmap = env->CallObjectMethod(images, g_java_ids.list_get, i);
+
+        AndroidBitmapInfo info;
+        void *addr = nullptr;
+        if (AndroidBitmap_getInfo(env, bitmap, &info) == ANDROID_BITMAP_RESULT_SUCCESS &&
+            AndroidBitmap_lockPixels(env, bitmap, &addr) == ANDROID_BITMAP_RESULT_SUCCESS) {
+            auto data = skity::Data::MakeWithCopy(addr, info.height * info.stride);
+
+            skity_images.emplace_back(std::make_shared<skity::Pixmap>(
+                    data, info.stride, info.width, info.height
+            ));
+
+            AndroidBitmap_unlockPixels(env, bitmap);
+        }
+
+        // the list can be longer than the local reference table
+        env->DeleteLocalRef(bitmap);
+    }
+
+    return skity_images;
+}
+
+static jfloatArray make_input_latency_array(JNIEnv *env, InputLatencyStats const &stats) {
+    // frames, last, average, max and average latch time in milliseconds
+    jfloat values[] = {
+            static_cast<jfloat>(stats.frames),
+            stats.last_ms,
+            stats.average_ms,
+            stats.max_ms,
+            stats.average_latch_ms,
+    };
+
+    auto array = env->NewFloatArray(5);
+    env->SetFloatArrayRegion(array, 0, 5, values);
+
+    return array;
+}
+
+static jlong renderer_init(JNIEnv *env, jobject thiz, jint width, jint height, jint density) {
     auto render = new StaticRenderer;
 
     render->init(width, height, density);
@@ -33,27 +162,56 @@ Java_com_skity_graphic_Renderer_nativeInit(JNIEnv *env, jobject thiz, jint width
 }
 
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_Renderer_nativeDraw(JNIEnv *env, jobject thiz, jlong handler) {
+static void renderer_draw(JNIEnv *env, jobject thiz, jlong handler) {
     auto render = (Renderer *) handler;
 
     render->draw();
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_Renderer_nativeDestroy(JNIEnv *env, jobject thiz, jlong handler) {
-    // TODO: implement nativeDestroy()
+static void renderer_draw_commands(JNIEnv *env, jobject thiz, jlong handler, jobject buffer,
+                                   jint size) {
+    auto render = (Renderer *) handler;
+    auto data = get_command_data(env, buffer, size);
+    if (render == nullptr || data == nullptr) {
+        return;
+    }
+
+    render->draw_commands(data, size);
+}
+
+static void renderer_destroy(JNIEnv *env, jobject thiz, jlong handler) {
     auto render = (Renderer *) handler;
 
     delete render;
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_Renderer_nativeLoadDefaultAssets(JNIEnv *env, jobject thiz, jlong handler,
-                                                        jobject asset_manager) {
+static void renderer_set_msaa_samples(JNIEnv *env, jobject thiz, jlong handler, jint samples) {
+    auto render = (Renderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->set_msaa_samples(samples);
+}
+
+static void renderer_write_input(jlong handler, jfloat x, jfloat y, jboolean down,
+                                 jlong event_nanos) {
+    auto render = (Renderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->GetInputChannel()->write(x, y, down, event_nanos);
+}
+
+static jfloatArray renderer_get_input_latency(JNIEnv *env, jobject thiz, jlong handler) {
+    auto render = (Renderer *) handler;
+
+    return make_input_latency_array(env, render ? render->GetInputLatency() : InputLatencyStats{});
+}
+
+static void renderer_load_default_assets(JNIEnv *env, jobject thiz, jlong handler,
+                                         jobject asset_manager) {
     auto render = (Renderer *) handler;
     auto am = AAssetManager_fromJava(env, asset_manager);
 
@@ -73,10 +231,8 @@ Java_com_skity_graphic_Renderer_nativeLoadDefaultAssets(JNIEnv *env, jobject thi
     AAsset_close(font_asset);
 }
 
-extern "C"
-JNIEXPORT jlong JNICALL
-Java_com_skity_graphic_GLSVGRender_nativeInitSVG(JNIEnv *env, jobject thiz, jint width, jint height,
-                                                 jint density, jobject context) {
+static jlong gl_svg_init(JNIEnv *env, jobject thiz, jint width, jint height, jint density,
+                         jobject context) {
     auto render = new SVGRenderer;
 
     render->init(width, height, density);
@@ -84,10 +240,7 @@ Java_com_skity_graphic_GLSVGRender_nativeInitSVG(JNIEnv *env, jobject thiz, jint
     return (jlong) render;
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_GLSVGRender_nativeLoadSVG(JNIEnv *env, jobject thiz, jlong handler,
-                                                 jobject asset_manager) {
+static void gl_svg_load_svg(JNIEnv *env, jobject thiz, jlong handler, jobject asset_manager) {
     auto svg_render = (SVGRenderer *) handler;
 
     auto am = AAssetManager_fromJava(env, asset_manager);
@@ -107,21 +260,61 @@ Java_com_skity_graphic_GLSVGRender_nativeLoadSVG(JNIEnv *env, jobject thiz, jlon
 
     AAsset_close(svg_asset);
 }
-extern "C"
-JNIEXPORT jlong JNICALL
-Java_com_skity_graphic_GLFrameRender_nativeInitFrame(JNIEnv *env, jobject thiz, jint width,
-                                                     jint height, jint density, jobject context) {
+
+static void gl_svg_set_view(jlong handler, jfloat zoom, jfloat x, jfloat y) {
+    auto svg_render = (SVGRenderer *) handler;
+    if (svg_render == nullptr) {
+        return;
+    }
+
+    svg_render->set_view(zoom, x, y);
+}
+
+static void gl_svg_set_culling(jlong handler, jboolean culling) {
+    auto svg_render = (SVGRenderer *) handler;
+    if (svg_render == nullptr) {
+        return;
+    }
+
+    svg_render->set_culling(culling);
+}
+
+static jlongArray cull_stats_array(JNIEnv *env, SVGCullStats const &stats) {
+    jlong values[] = {
+            stats.groups,
+            stats.draws,
+            stats.visited_groups,
+            stats.culled_groups,
+            stats.issued_draws,
+            stats.culled_draws,
+    };
+
+    auto array = env->NewLongArray(6);
+    env->SetLongArrayRegion(array, 0, 6, values);
+
+    return array;
+}
+
+static jlongArray gl_svg_get_cull_stats(JNIEnv *env, jobject thiz, jlong handler) {
+    auto svg_render = (SVGRenderer *) handler;
+    if (svg_render == nullptr) {
+        return nullptr;
+    }
+
+    return cull_stats_array(env, svg_render->CullStats());
+}
+
+static jlong gl_frame_init(JNIEnv *env, jobject thiz, jint width, jint height, jint density,
+                           jobject context) {
     auto render = new FrameRender;
 
     render->init(width, height, density);
 
     return (jlong) render;
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_GLFrameRender_nativeInitTypefaces(JNIEnv *env, jobject thiz,
-                                                         jlong native_handle,
-                                                         jobject asset_manager) {
+
+static void gl_frame_init_typefaces(JNIEnv *env, jobject thiz, jlong native_handle,
+                                    jobject asset_manager) {
     auto render = (FrameRender *) native_handle;
     auto am = AAssetManager_fromJava(env, asset_manager);
 
@@ -165,43 +358,43 @@ Java_com_skity_graphic_GLFrameRender_nativeInitTypefaces(JNIEnv *env, jobject th
     AAsset_close(font_asset);
     AAsset_close(emoji_asset);
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_GLFrameRender_nativeInitImages(JNIEnv *env, jobject thiz,
-                                                      jlong native_handle, jobject images) {
-    auto list_class = env->GetObjectClass(images);
-    auto size_method = env->GetMethodID(list_class, "size", "()I");
-    auto get_method = env->GetMethodID(list_class, "get", "(I)Ljava/lang/Object;");
 
-    std::vector<std::shared_ptr<skity::Pixmap>> skity_images = {};
+static void gl_frame_init_images(JNIEnv *env, jobject thiz, jlong native_handle, jobject images) {
+    auto render = (FrameRender *) native_handle;
 
-    int size = env->CallIntMethod(images, size_method);
-    for (int i = 0; i < size; i++) {
-        auto bitmap = env->CallObjectMethod(images, get_method, i);
+    render->init_images(load_bitmaps(env, images));
+}
 
-        AndroidBitmapInfo info;
-        AndroidBitmap_getInfo(env, bitmap, &info);
+static jboolean gl_frame_init_compressed_images(JNIEnv *env, jobject thiz, jlong native_handle,
+                                                jobject asset_manager, jobjectArray paths) {
+    auto render = (FrameRender *) native_handle;
 
-        void *addr = nullptr;
-        AndroidBitmap_lockPixels(env, bitmap, &addr);
+    return render->init_compressed_images(load_compressed_images(env, asset_manager, paths));
+}
 
-        auto data = skity::Data::MakeWithCopy(addr, info.height * info.stride);
+static jint gl_frame_get_quality_level(jlong native_handle) {
+    auto render = (FrameRender *) native_handle;
 
-        skity_images.emplace_back(std::make_shared<skity::Pixmap>(
-                data, info.stride, info.width, info.height
-        ));
+    return render->Governor().CurrentLevel();
+}
 
-        AndroidBitmap_unlockPixels(env, bitmap);
-    }
+static jlongArray gl_frame_get_quality_transitions(JNIEnv *env, jobject thiz, jlong native_handle) {
+    auto render = (FrameRender *) native_handle;
 
+    return make_transition_array(env, render->Governor());
+}
+
+static void gl_frame_set_path_cache(jlong native_handle, jboolean enabled) {
     auto render = (FrameRender *) native_handle;
+    if (render == nullptr) {
+        return;
+    }
 
-    render->init_images(skity_images);
+    render->set_path_cache(enabled);
 }
-extern "C"
-JNIEXPORT jlong JNICALL
-Java_com_skity_graphic_VkFrameRender_nativeInit(JNIEnv *env, jobject thiz, jint width, jint height,
-                                                jint density, jobject surface) {
+
+static jlong vk_frame_init(JNIEnv *env, jobject thiz, jint width, jint height, jint density,
+                           jobject surface) {
     auto render = new VkFrameRenderer();
 
     ANativeWindow *window = ANativeWindow_fromSurface(env, surface);
@@ -212,35 +405,161 @@ Java_com_skity_graphic_VkFrameRender_nativeInit(JNIEnv *env, jobject thiz, jint
 
     return (jlong) render;
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_VkRenderer_nativeLoadDefaultAssets(JNIEnv *env, jobject thiz, jlong handler,
-                                                          jobject asset_manager) {
-    // TODO: implement nativeLoadDefaultAssets()
+
+static void vk_renderer_load_default_assets(JNIEnv *env, jobject thiz, jlong handler,
+                                            jobject asset_manager) {
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_VkRenderer_nativeDraw(JNIEnv *env, jobject thiz, jlong handler) {
+
+static void vk_renderer_draw(JNIEnv *env, jobject thiz, jlong handler) {
     auto render = (VkRenderer *) handler;
     if (render == nullptr) {
         return;
     }
     render->draw();
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_VkRenderer_nativeDestroy(JNIEnv *env, jobject thiz, jlong handler) {
+
+static void vk_renderer_draw_commands(JNIEnv *env, jobject thiz, jlong handler, jobject buffer,
+                                      jint size) {
+    auto render = (VkRenderer *) handler;
+    auto data = get_command_data(env, buffer, size);
+    if (render == nullptr || data == nullptr) {
+        return;
+    }
+
+    render->draw_commands(data, size);
+}
+
+static void vk_renderer_destroy(JNIEnv *env, jobject thiz, jlong handler) {
     auto render = (VkRenderer *) handler;
 
     render->destroy();
 
     delete render;
 }
-extern "C"
-JNIEXPORT jlong JNICALL
-Java_com_skity_graphic_VkSVGRenderer_nativeCreateSVGRender(JNIEnv *env, jobject thiz, jint width,
-                                                           jint height, jint density,
-                                                           jobject surface) {
+
+static void vk_renderer_set_render_scale(jlong handler, jfloat scale) {
+    auto render = (VkRenderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->set_render_scale(scale);
+}
+
+static jlongArray vk_renderer_get_memory_stats(JNIEnv *env, jobject thiz, jlong handler) {
+    auto &tracker = VkMemoryTracker::Instance();
+
+    // bytes, allocations per category then size, budget, usage, flags per heap
+    std::vector<jlong> values;
+    for (auto const &usage : tracker.Usage()) {
+        values.emplace_back(usage.bytes);
+        values.emplace_back(usage.allocations);
+    }
+    for (auto const &heap : tracker.QueryHeapBudgets()) {
+        values.emplace_back(heap.size);
+        values.emplace_back(heap.budget);
+        values.emplace_back(heap.usage);
+        values.emplace_back(heap.flags);
+    }
+
+    auto array = env->NewLongArray(values.size());
+    env->SetLongArrayRegion(array, 0, values.size(), values.data());
+
+    return array;
+}
+
+static jfloat vk_renderer_get_memory_pressure(jlong handler) {
+    return VkMemoryTracker::Instance().QueryPressure();
+}
+
+static void vk_renderer_write_input(jlong handler, jfloat x, jfloat y, jboolean down,
+                                   jlong event_nanos) {
+    auto render = (VkRenderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->GetInputChannel()->write(x, y, down, event_nanos);
+}
+
+static jfloatArray vk_renderer_get_input_latency(JNIEnv *env, jobject thiz, jlong handler) {
+    auto render = (VkRenderer *) handler;
+
+    return make_input_latency_array(env, render ? render->GetInputLatency() : InputLatencyStats{});
+}
+
+static jboolean vk_renderer_start_frame_loop(JNIEnv *env, jobject thiz, jlong handler) {
+    auto render = (VkRenderer *) handler;
+    if (render == nullptr) {
+        return JNI_FALSE;
+    }
+
+    return render->start_frame_loop() ? JNI_TRUE : JNI_FALSE;
+}
+
+static void vk_renderer_stop_frame_loop(JNIEnv *env, jobject thiz, jlong handler) {
+    auto render = (VkRenderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->stop_frame_loop();
+}
+
+static jlongArray vk_renderer_get_frame_loop_stats(JNIEnv *env, jobject thiz, jlong handler) {
+    auto render = (VkRenderer *) handler;
+    auto stats = render ? render->GetFrameLoopStats() : FrameLoopStats{};
+
+    // vsyncs, frames, late skips, refresh period in microseconds
+    jlong values[] = {
+            static_cast<jlong>(stats.vsyncs),
+            static_cast<jlong>(stats.frames),
+            static_cast<jlong>(stats.late_skips),
+            static_cast<jlong>(stats.period_ms * 1000.f),
+    };
+
+    auto array = env->NewLongArray(4);
+    env->SetLongArrayRegion(array, 0, 4, values);
+
+    return array;
+}
+
+static void vk_renderer_set_static_content(jlong handler, jboolean is_static) {
+    auto render = (VkRenderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->set_static_content(is_static);
+}
+
+static void vk_renderer_invalidate_content(jlong handler) {
+    auto render = (VkRenderer *) handler;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->invalidate_content();
+}
+
+static jlongArray vk_renderer_get_command_reuse(JNIEnv *env, jobject thiz, jlong handler) {
+    auto render = (VkRenderer *) handler;
+    auto stats = render ? render->GetCommandReuseStats() : CommandReuseStats{};
+
+    // frames, frames that resubmitted an earlier recording
+    jlong values[] = {
+            static_cast<jlong>(stats.frames),
+            static_cast<jlong>(stats.reused),
+    };
+
+    auto array = env->NewLongArray(2);
+    env->SetLongArrayRegion(array, 0, 2, values);
+
+    return array;
+}
+
+static jlong vk_svg_init(JNIEnv *env, jobject thiz, jint width, jint height, jint density,
+                         jobject surface) {
     auto render = new VkSVGRender;
     ANativeWindow *window = ANativeWindow_fromSurface(env, surface);
     render->init(width, height, density, window);
@@ -248,10 +567,8 @@ Java_com_skity_graphic_VkSVGRenderer_nativeCreateSVGRender(JNIEnv *env, jobject
 
     return (jlong) render;
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_VkSVGRenderer_nativeInitSVGDom(JNIEnv *env, jobject thiz, jlong handler,
-                                                      jobject asset_manager) {
+
+static void vk_svg_init_svg_dom(JNIEnv *env, jobject thiz, jlong handler, jobject asset_manager) {
     auto svg_render = (VkSVGRender *) handler;
 
     auto am = AAssetManager_fromJava(env, asset_manager);
@@ -271,10 +588,69 @@ Java_com_skity_graphic_VkSVGRenderer_nativeInitSVGDom(JNIEnv *env, jobject thiz,
 
     AAsset_close(svg_asset);
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_VkFrameRender_nativeInitTypeface(JNIEnv *env, jobject thiz, jlong handler,
-                                                        jobject asset_manager) {
+
+static void vk_svg_set_view(jlong handler, jfloat zoom, jfloat x, jfloat y) {
+    auto svg_render = (VkSVGRender *) handler;
+    if (svg_render == nullptr) {
+        return;
+    }
+
+    svg_render->set_view(zoom, x, y);
+}
+
+static void vk_svg_set_culling(jlong handler, jboolean culling) {
+    auto svg_render = (VkSVGRender *) handler;
+    if (svg_render == nullptr) {
+        return;
+    }
+
+    svg_render->set_culling(culling);
+}
+
+static jlongArray vk_svg_get_cull_stats(JNIEnv *env, jobject thiz, jlong handler) {
+    auto svg_render = (VkSVGRender *) handler;
+    if (svg_render == nullptr) {
+        return nullptr;
+    }
+
+    return cull_stats_array(env, svg_render->CullStats());
+}
+
+static void vk_svg_set_tiled(jlong handler, jboolean tiled) {
+    auto svg_render = (VkSVGRender *) handler;
+    if (svg_render == nullptr) {
+        return;
+    }
+
+    svg_render->set_tiled(tiled);
+}
+
+static jlongArray vk_svg_get_tile_stats(JNIEnv *env, jobject thiz, jlong handler) {
+    auto svg_render = (VkSVGRender *) handler;
+    if (svg_render == nullptr) {
+        return nullptr;
+    }
+
+    SVGTileStats stats = svg_render->TileStats();
+    jlong values[] = {
+            stats.level,
+            stats.visible,
+            stats.current,
+            stats.placeholders,
+            stats.missing,
+            stats.rendered,
+            stats.cached,
+            static_cast<jlong>(stats.render_ms * 1000.f),
+    };
+
+    auto array = env->NewLongArray(8);
+    env->SetLongArrayRegion(array, 0, 8, values);
+
+    return array;
+}
+
+static void vk_frame_init_typeface(JNIEnv *env, jobject thiz, jlong handler,
+                                   jobject asset_manager) {
     auto render = (VkFrameRenderer *) handler;
 
     auto am = AAssetManager_fromJava(env, asset_manager);
@@ -319,36 +695,289 @@ Java_com_skity_graphic_VkFrameRender_nativeInitTypeface(JNIEnv *env, jobject thi
     AAsset_close(font_asset);
     AAsset_close(emoji_asset);
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_skity_graphic_VkFrameRender_nativeInitImages(JNIEnv *env, jobject thiz,
-                                                      jlong native_handle, jobject images) {
-    auto list_class = env->GetObjectClass(images);
-    auto size_method = env->GetMethodID(list_class, "size", "()I");
-    auto get_method = env->GetMethodID(list_class, "get", "(I)Ljava/lang/Object;");
 
-    std::vector<std::shared_ptr<skity::Pixmap>> skity_images = {};
+static void vk_frame_init_images(JNIEnv *env, jobject thiz, jlong native_handle, jobject images) {
+    auto render = (VkFrameRenderer *) native_handle;
 
-    int size = env->CallIntMethod(images, size_method);
-    for (int i = 0; i < size; i++) {
-        auto bitmap = env->CallObjectMethod(images, get_method, i);
+    render->init_images(load_bitmaps(env, images));
+}
 
-        AndroidBitmapInfo info;
-        AndroidBitmap_getInfo(env, bitmap, &info);
+static jboolean vk_frame_init_compressed_images(JNIEnv *env, jobject thiz, jlong native_handle,
+                                                jobject asset_manager, jobjectArray paths) {
+    auto render = (VkFrameRenderer *) native_handle;
 
-        void *addr = nullptr;
-        AndroidBitmap_lockPixels(env, bitmap, &addr);
+    return render->init_compressed_images(load_compressed_images(env, asset_manager, paths));
+}
 
-        auto data = skity::Data::MakeWithCopy(addr, info.height * info.stride);
+static jint vk_frame_get_quality_level(jlong native_handle) {
+    auto render = (VkFrameRenderer *) native_handle;
 
-        skity_images.emplace_back(std::make_shared<skity::Pixmap>(
-                data, info.stride, info.width, info.height
-        ));
+    return render->Governor().CurrentLevel();
+}
 
-        AndroidBitmap_unlockPixels(env, bitmap);
-    }
+static jlongArray vk_frame_get_quality_transitions(JNIEnv *env, jobject thiz, jlong native_handle) {
+    auto render = (VkFrameRenderer *) native_handle;
+
+    return make_transition_array(env, render->Governor());
+}
 
+static void vk_frame_set_path_cache(jlong native_handle, jboolean enabled) {
     auto render = (VkFrameRenderer *) native_handle;
+    if (render == nullptr) {
+        return;
+    }
+
+    render->set_path_cache(enabled);
+}
+
+static void bench_play_commands(JNIEnv *env, jclass clazz, jlong handler, jobject buffer,
+                                jint size) {
+    auto render = (Renderer *) handler;
+    auto data = get_command_data(env, buffer, size);
+    if (data == nullptr) {
+        return;
+    }
+
+    // like draw_commands() without the renderer's own content
+    auto canvas = render->begin_frame();
+    render->GetCommandPlayer()->play(canvas, data, size);
+    render->end_frame();
+}
+
+static void bench_begin_frame(JNIEnv *env, jclass clazz, jlong handler) {
+    ((Renderer *) handler)->begin_frame();
+}
+
+static void bench_end_frame(JNIEnv *env, jclass clazz, jlong handler) {
+    ((Renderer *) handler)->end_frame();
+}
+
+static void bench_save(jlong handler) {
+    ((Renderer *) handler)->GetFrameCanvas()->save();
+}
+
+static void bench_restore(jlong handler) {
+    ((Renderer *) handler)->GetFrameCanvas()->restore();
+}
+
+static void bench_translate(jlong handler, jfloat dx, jfloat dy) {
+    ((Renderer *) handler)->GetFrameCanvas()->translate(dx, dy);
+}
+
+static void bench_rotate(jlong handler, jfloat degrees) {
+    ((Renderer *) handler)->GetFrameCanvas()->rotate(degrees);
+}
+
+static void bench_set_color(jlong handler, jint argb) {
+    ((Renderer *) handler)->GetCommandPlayer()->GetPaint().setColor(static_cast<uint32_t>(argb));
+}
 
-    render->init_images(skity_images);
-}
\ No newline at end of file
+static void bench_set_style(jlong handler, jint style) {
+    auto &paint = ((Renderer *) handler)->GetCommandPlayer()->GetPaint();
+    paint.setStyle(style == 0 ? skity::Paint::kFill_Style
+                              : style == 1 ? skity::Paint::kStroke_Style
+                                           : skity::Paint::kStrokeAndFill_Style);
+}
+
+static void bench_set_text_size(jlong handler, jfloat size) {
+    ((Renderer *) handler)->GetCommandPlayer()->GetPaint().setTextSize(size);
+}
+
+static void bench_draw_rect(jlong handler, jfloat left, jfloat top, jfloat right, jfloat bottom) {
+    auto render = (Renderer *) handler;
+    render->GetFrameCanvas()->drawRect(skity::Rect::MakeLTRB(left, top, right, bottom),
+                                       render->GetCommandPlayer()->GetPaint());
+}
+
+static void bench_move_to(jlong handler, jfloat x, jfloat y) {
+    ((Renderer *) handler)->GetCommandPlayer()->move_to(x, y);
+}
+
+static void bench_line_to(jlong handler, jfloat x, jfloat y) {
+    ((Renderer *) handler)->GetCommandPlayer()->line_to(x, y);
+}
+
+static void bench_cubic_to(jlong handler, jfloat x1, jfloat y1, jfloat x2, jfloat y2, jfloat x3,
+                           jfloat y3) {
+    ((Renderer *) handler)->GetCommandPlayer()->cubic_to(x1, y1, x2, y2, x3, y3);
+}
+
+static void bench_close(jlong handler) {
+    ((Renderer *) handler)->GetCommandPlayer()->close();
+}
+
+static void bench_draw_path(jlong handler) {
+    auto render = (Renderer *) handler;
+    render->GetCommandPlayer()->draw_path(render->GetFrameCanvas());
+}
+
+static void bench_draw_image(jlong handler, jint index, jfloat left, jfloat top, jfloat right,
+                             jfloat bottom) {
+    auto render = (Renderer *) handler;
+    render->GetCommandPlayer()->draw_image(render->GetFrameCanvas(), static_cast<uint32_t>(index),
+                                           skity::Rect::MakeLTRB(left, top, right, bottom));
+}
+
+static jint bench_get_texture_binds(jlong handler) {
+    return static_cast<jint>(((Renderer *) handler)->GetCommandPlayer()->LastStats().texture_binds);
+}
+
+static void bench_draw_text(JNIEnv *env, jclass clazz, jlong handler, jstring text, jfloat x,
+                            jfloat y) {
+    auto render = (Renderer *) handler;
+
+    auto chars = env->GetStringUTFChars(text, nullptr);
+    render->GetCommandPlayer()->draw_text(render->GetFrameCanvas(), chars, std::strlen(chars), x,
+                                          y);
+    env->ReleaseStringUTFChars(text, chars);
+}
+
+#define SKITY_NATIVE(name, signature, fn) {name, signature, reinterpret_cast<void *>(fn)}
+
+// @CriticalNative entries take neither JNIEnv nor the class, see the Java side
+// for which ones are annotated.
+
+static const JNINativeMethod kRendererMethods[] = {
+        SKITY_NATIVE("nativeInit", "(III)J", renderer_init),
+        SKITY_NATIVE("nativeLoadDefaultAssets", "(JLandroid/content/res/AssetManager;)V",
+                     renderer_load_default_assets),
+        SKITY_NATIVE("nativeDraw", "(J)V", renderer_draw),
+        SKITY_NATIVE("nativeDrawCommands", "(JLjava/nio/ByteBuffer;I)V", renderer_draw_commands),
+        SKITY_NATIVE("nativeDestroy", "(J)V", renderer_destroy),
+        SKITY_NATIVE("nativeSetMSAASamples", "(JI)V", renderer_set_msaa_samples),
+        SKITY_NATIVE("nativeWriteInput", "(JFFZJ)V", renderer_write_input),
+        SKITY_NATIVE("nativeGetInputLatency", "(J)[F", renderer_get_input_latency),
+};
+
+static const JNINativeMethod kGLSVGRenderMethods[] = {
+        SKITY_NATIVE("nativeInitSVG", "(IIILandroid/content/Context;)J", gl_svg_init),
+        SKITY_NATIVE("nativeLoadSVG", "(JLandroid/content/res/AssetManager;)V", gl_svg_load_svg),
+        SKITY_NATIVE("nativeSetView", "(JFFF)V", gl_svg_set_view),
+        SKITY_NATIVE("nativeSetCulling", "(JZ)V", gl_svg_set_culling),
+        SKITY_NATIVE("nativeGetCullStats", "(J)[J", gl_svg_get_cull_stats),
+};
+
+static const JNINativeMethod kGLFrameRenderMethods[] = {
+        SKITY_NATIVE("nativeInitFrame", "(IIILandroid/content/Context;)J", gl_frame_init),
+        SKITY_NATIVE("nativeInitTypefaces", "(JLandroid/content/res/AssetManager;)V",
+                     gl_frame_init_typefaces),
+        SKITY_NATIVE("nativeInitImages", "(JLjava/util/List;)V", gl_frame_init_images),
+        SKITY_NATIVE("nativeInitCompressedImages",
+                     "(JLandroid/content/res/AssetManager;[Ljava/lang/String;)Z",
+                     gl_frame_init_compressed_images),
+        SKITY_NATIVE("nativeGetQualityLevel", "(J)I", gl_frame_get_quality_level),
+        SKITY_NATIVE("nativeGetQualityTransitions", "(J)[J", gl_frame_get_quality_transitions),
+        SKITY_NATIVE("nativeSetPathCache", "(JZ)V", gl_frame_set_path_cache),
+};
+
+static const JNINativeMethod kVkRendererMethods[] = {
+        SKITY_NATIVE("nativeLoadDefaultAssets", "(JLandroid/content/res/AssetManager;)V",
+                     vk_renderer_load_default_assets),
+        SKITY_NATIVE("nativeDraw", "(J)V", vk_renderer_draw),
+        SKITY_NATIVE("nativeDestroy", "(J)V", vk_renderer_destroy),
+        SKITY_NATIVE("nativeSetRenderScale", "(JF)V", vk_renderer_set_render_scale),
+        SKITY_NATIVE("nativeDrawCommands", "(JLjava/nio/ByteBuffer;I)V",
+                     vk_renderer_draw_commands),
+        SKITY_NATIVE("nativeGetMemoryStats", "(J)[J", vk_renderer_get_memory_stats),
+        SKITY_NATIVE("nativeGetMemoryPressure", "(J)F", vk_renderer_get_memory_pressure),
+        SKITY_NATIVE("nativeStartFrameLoop", "(J)Z", vk_renderer_start_frame_loop),
+        SKITY_NATIVE("nativeStopFrameLoop", "(J)V", vk_renderer_stop_frame_loop),
+        SKITY_NATIVE("nativeGetFrameLoopStats", "(J)[J", vk_renderer_get_frame_loop_stats),
+        SKITY_NATIVE("nativeWriteInput", "(JFFZJ)V", vk_renderer_write_input),
+        SKITY_NATIVE("nativeGetInputLatency", "(J)[F", vk_renderer_get_input_latency),
+        SKITY_NATIVE("nativeSetStaticContent", "(JZ)V", vk_renderer_set_static_content),
+        SKITY_NATIVE("nativeInvalidateContent", "(J)V", vk_renderer_invalidate_content),
+        SKITY_NATIVE("nativeGetCommandReuse", "(J)[J", vk_renderer_get_command_reuse),
+};
+
+static const JNINativeMethod kVkFrameRenderMethods[] = {
+        SKITY_NATIVE("nativeInit", "(IIILandroid/view/Surface;)J", vk_frame_init),
+        SKITY_NATIVE("nativeInitTypeface", "(JLandroid/content/res/AssetManager;)V",
+                     vk_frame_init_typeface),
+        SKITY_NATIVE("nativeInitImages", "(JLjava/util/List;)V", vk_frame_init_images),
+        SKITY_NATIVE("nativeInitCompressedImages",
+                     "(JLandroid/content/res/AssetManager;[Ljava/lang/String;)Z",
+                     vk_frame_init_compressed_images),
+        SKITY_NATIVE("nativeGetQualityLevel", "(J)I", vk_frame_get_quality_level),
+        SKITY_NATIVE("nativeGetQualityTransitions", "(J)[J", vk_frame_get_quality_transitions),
+        SKITY_NATIVE("nativeSetPathCache", "(JZ)V", vk_frame_set_path_cache),
+};
+
+static const JNINativeMethod kVkSVGRendererMethods[] = {
+        SKITY_NATIVE("nativeCreateSVGRender", "(IIILandroid/view/Surface;)J", vk_svg_init),
+        SKITY_NATIVE("nativeInitSVGDom", "(JLandroid/content/res/AssetManager;)V",
+                     vk_svg_init_svg_dom),
+        SKITY_NATIVE("nativeSetView", "(JFFF)V", vk_svg_set_view),
+        SKITY_NATIVE("nativeSetCulling", "(JZ)V", vk_svg_set_culling),
+        SKITY_NATIVE("nativeGetCullStats", "(J)[J", vk_svg_get_cull_stats),
+        SKITY_NATIVE("nativeSetTiled", "(JZ)V", vk_svg_set_tiled),
+        SKITY_NATIVE("nativeGetTileStats", "(J)[J", vk_svg_get_tile_stats),
+};
+
+static const JNINativeMethod kCanvasCommandsBenchmarkMethods[] = {
+        SKITY_NATIVE("nativePlayCommands", "(JLjava/nio/ByteBuffer;I)V", bench_play_commands),
+        SKITY_NATIVE("nativeBeginFrame", "(J)V", bench_begin_frame),
+        SKITY_NATIVE("nativeEndFrame", "(J)V", bench_end_frame),
+        SKITY_NATIVE("nativeSave", "(J)V", bench_save),
+        SKITY_NATIVE("nativeRestore", "(J)V", bench_restore),
+        SKITY_NATIVE("nativeTranslate", "(JFF)V", bench_translate),
+        SKITY_NATIVE("nativeRotate", "(JF)V", bench_rotate),
+        SKITY_NATIVE("nativeSetColor", "(JI)V", bench_set_color),
+        SKITY_NATIVE("nativeSetStyle", "(JI)V", bench_set_style),
+        SKITY_NATIVE("nativeSetTextSize", "(JF)V", bench_set_text_size),
+        SKITY_NATIVE("nativeDrawRect", "(JFFFF)V", bench_draw_rect),
+        SKITY_NATIVE("nativeMoveTo", "(JFF)V", bench_move_to),
+        SKITY_NATIVE("nativeLineTo", "(JFF)V", bench_line_to),
+        SKITY_NATIVE("nativeCubicTo", "(JFFFFFF)V", bench_cubic_to),
+        SKITY_NATIVE("nativeClose", "(J)V", bench_close),
+        SKITY_NATIVE("nativeDrawPath", "(J)V", bench_draw_path),
+        SKITY_NATIVE("nativeDrawText", "(JLjava/lang/String;FF)V", bench_draw_text),
+        SKITY_NATIVE("nativeDrawImage", "(JIFFFF)V", bench_draw_image),
+        SKITY_NATIVE("nativeGetTextureBinds", "(J)I", bench_get_texture_binds),
+};
+
+#undef SKITY_NATIVE
+
+template<size_t N>
+static bool register_natives(JNIEnv *env, const char *class_name,
+                             const JNINativeMethod (&methods)[N]) {
+    auto clazz = env->FindClass(class_name);
+    if (clazz == nullptr) {
+        // stripped from the app, nothing can call its natives
+        env->ExceptionClear();
+        return true;
+    }
+
+    bool registered = env->RegisterNatives(clazz, methods, N) == JNI_OK;
+    env->DeleteLocalRef(clazz);
+
+    if (!registered) {
+        __android_log_print(ANDROID_LOG_ERROR, "Skity", "Failed to register natives of %s",
+                            class_name);
+    }
+
+    return registered;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM *vm, void *reserved) {
+    JNIEnv *env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+
+    // explicit registration replaces the symbol lookup of every native on its
+    // first call, and is required for @CriticalNative before Android 12
+    bool ok = init_java_ids(env) &&
+              register_natives(env, "com/skity/graphic/Renderer", kRendererMethods) &&
+              register_natives(env, "com/skity/graphic/GLSVGRender", kGLSVGRenderMethods) &&
+              register_natives(env, "com/skity/graphic/GLFrameRender", kGLFrameRenderMethods) &&
+              register_natives(env, "com/skity/graphic/VkRenderer", kVkRendererMethods) &&
+              register_natives(env, "com/skity/graphic/VkFrameRender", kVkFrameRenderMethods) &&
+              register_natives(env, "com/skity/graphic/VkSVGRenderer", kVkSVGRendererMethods) &&
+              register_natives(env, "com/skity/graphic/CanvasCommandsBenchmark",
+                               kCanvasCommandsBenchmarkMethods);
+
+    return ok ? JNI_VERSION_1_6 : JNI_ERR;
+}
@@ -0,0 +1,172 @@
+
+#include "span_blend.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// x / 255 rounded, exact for x in [0, 255 * 255]
+static inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t blend_pixel(uint32_t dst, uint32_t color, uint32_t coverage) {
+    uint32_t src[4];
+    for (uint32_t c = 0; c < 4; c++) {
+        src[c] = div255(((color >> (c * 8)) & 0xFF) * coverage);
+    }
+
+    uint32_t inv_alpha = 255 - src[3];
+
+    uint32_t result = 0;
+    for (uint32_t c = 0; c < 4; c++) {
+        uint32_t value = src[c] + div255(((dst >> (c * 8)) & 0xFF) * inv_alpha);
+        result |= std::min(value, 255u) << (c * 8);
+    }
+
+    return result;
+}
+
+#if defined(__SSE2__)
+
+static inline __m128i div255_epu16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// two pixels in 16 bit lanes
+static inline __m128i blend_epu16(__m128i dst, __m128i color, __m128i coverage) {
+    __m128i src = div255_epu16(_mm_mullo_epi16(color, coverage));
+
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)),
+                                        _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i inv_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+    return _mm_add_epi16(src, div255_epu16(_mm_mullo_epi16(dst, inv_alpha)));
+}
+
+#endif
+
+void blend_span(uint32_t *dst, uint8_t const *coverage, uint32_t count, uint32_t color) {
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+
+    for (; i + 4 <= count; i += 4) {
+        uint32_t cov4 = 0;
+        for (uint32_t k = 0; k < 4; k++) {
+            cov4 |= static_cast<uint32_t>(coverage[i + k]) << (k * 8);
+        }
+        if (cov4 == 0) {
+            continue;
+        }
+
+        // c0 c0 c0 c0 c1 c1 c1 c1 ... as bytes
+        __m128i cov = _mm_cvtsi32_si128(static_cast<int>(cov4));
+        cov = _mm_unpacklo_epi8(cov, cov);
+        cov = _mm_unpacklo_epi16(cov, cov);
+
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dst + i));
+
+        __m128i lo = blend_epu16(_mm_unpacklo_epi8(pixels, zero), color16,
+                                 _mm_unpacklo_epi8(cov, zero));
+        __m128i hi = blend_epu16(_mm_unpackhi_epi8(pixels, zero), color16,
+                                 _mm_unpackhi_epi8(cov, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    uint8x8_t color_r = vdup_n_u8(color & 0xFF);
+    uint8x8_t color_g = vdup_n_u8((color >> 8) & 0xFF);
+    uint8x8_t color_b = vdup_n_u8((color >> 16) & 0xFF);
+    uint8x8_t color_a = vdup_n_u8((color >> 24) & 0xFF);
+
+    // rounded x / 255 narrowed to 8 bit
+    auto div255_u8 = [](uint16x8_t x) { return vraddhn_u16(x, vrshrq_n_u16(x, 8)); };
+
+    for (; i + 8 <= count; i += 8) {
+        uint8x8_t cov = vld1_u8(coverage + i);
+        uint8x8x4_t pixels = vld4_u8(reinterpret_cast<uint8_t const *>(dst + i));
+
+        uint8x8_t src_r = div255_u8(vmull_u8(color_r, cov));
+        uint8x8_t src_g = div255_u8(vmull_u8(color_g, cov));
+        uint8x8_t src_b = div255_u8(vmull_u8(color_b, cov));
+        uint8x8_t src_a = div255_u8(vmull_u8(color_a, cov));
+        uint8x8_t inv_alpha = vmvn_u8(src_a);
+
+        pixels.val[0] = vqadd_u8(src_r, div255_u8(vmull_u8(pixels.val[0], inv_alpha)));
+        pixels.val[1] = vqadd_u8(src_g, div255_u8(vmull_u8(pixels.val[1], inv_alpha)));
+        pixels.val[2] = vqadd_u8(src_b, div255_u8(vmull_u8(pixels.val[2], inv_alpha)));
+        pixels.val[3] = vqadd_u8(src_a, div255_u8(vmull_u8(pixels.val[3], inv_alpha)));
+
+        vst4_u8(reinterpret_cast<uint8_t *>(dst + i), pixels);
+    }
+#endif
+
+    for (; i < count; i++) {
+        if (coverage[i]) {
+            dst[i] = blend_pixel(dst[i], color, coverage[i]);
+        }
+    }
+}
+
+void blend_span_opaque(uint32_t *dst, uint32_t count, uint32_t color) {
+    if ((color >> 24) == 0xFF) {
+        std::fill(dst, dst + count, color);
+        return;
+    }
+
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+    __m128i full = _mm_set1_epi16(255);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dst + i));
+
+        __m128i lo = blend_epu16(_mm_unpacklo_epi8(pixels, zero), color16, full);
+        __m128i hi = blend_epu16(_mm_unpackhi_epi8(pixels, zero), color16, full);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    uint8x16_t src = vreinterpretq_u8_u32(vdupq_n_u32(color));
+    uint8x8_t inv_alpha = vdup_n_u8(255 - (color >> 24));
+
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t pixels = vld1q_u8(reinterpret_cast<uint8_t const *>(dst + i));
+
+        uint16x8_t lo = vmull_u8(vget_low_u8(pixels), inv_alpha);
+        uint16x8_t hi = vmull_u8(vget_high_u8(pixels), inv_alpha);
+        uint8x16_t scaled = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)),
+                                        vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i), vqaddq_u8(src, scaled));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = blend_pixel(dst[i], color, 255);
+    }
+}
+
+uint32_t premultiply_color(float r, float g, float b, float a) {
+    a = std::min(std::max(a, 0.f), 1.f);
+
+    auto channel = [a](float value) {
+        value = std::min(std::max(value, 0.f), 1.f) * a;
+        return static_cast<uint32_t>(value * 255.f + 0.5f);
+    };
+
+    return channel(r) | channel(g) << 8 | channel(b) << 16 |
+           static_cast<uint32_t>(a * 255.f + 0.5f) << 24;
+}
@@ -0,0 +1,22 @@
+
+#ifndef SKITY_ANDROID_SPAN_BLEND_HPP
+#define SKITY_ANDROID_SPAN_BLEND_HPP
+
+#include <cstdint>
+
+/**
+ * Source over blending of a solid color into a row of premultiplied RGBA8
+ * pixels, R in the lowest byte. color is premultiplied in the same layout.
+ *
+ * Uses SSE2 or NEON when the target has it, 4 or 8 pixels per step.
+ */
+void blend_span(uint32_t *dst, uint8_t const *coverage, uint32_t count, uint32_t color);
+
+/**
+ * blend_span() with full coverage. Opaque colors are stored directly.
+ */
+void blend_span_opaque(uint32_t *dst, uint32_t count, uint32_t color);
+
+uint32_t premultiply_color(float r, float g, float b, float a);
+
+#endif //SKITY_ANDROID_SPAN_BLEND_HPP
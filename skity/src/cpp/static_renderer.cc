@@ -5,12 +5,6 @@
 void draw_canvas(skity::Canvas *canvas);
 
 
-void StaticRenderer::draw() {
-    Renderer::draw();
-
-    auto canvas = GetCanvas();
-
+void StaticRenderer::onDraw(skity::Canvas *canvas) {
     draw_canvas(canvas);
-
-    canvas->flush();
 }
\ No newline at end of file
@@ -12,7 +12,7 @@ public:
 
 
 protected:
-    void draw() override;
+    void onDraw(skity::Canvas *canvas) override;
 
 };
 
@@ -0,0 +1,544 @@
+
+#include "svg_cull_tree.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+
+constexpr uint32_t SVGCullTree::kLeafSize;
+constexpr float SVGCullTree::kCullPadding;
+
+// clip of the document before it clips anything itself
+static constexpr float kUnclipped = 1e9f;
+// deepest BVH walk, the median split keeps them around log2(items / kLeafSize)
+static constexpr uint32_t kMaxBvhDepth = 64;
+
+class SVGCullTree::Recorder : public skity::Canvas {
+public:
+    Recorder(SVGCullTree *tree, uint32_t width, uint32_t height);
+
+    ~Recorder() override = default;
+
+    /**
+     * Close the groups the document left open and build the BVHs.
+     */
+    void finish();
+
+protected:
+    void onClipPath(skity::Path const &path, ClipOp op) override;
+
+    void onDrawPath(skity::Path const &path, skity::Paint const &paint) override;
+
+    void onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                    skity::Paint const &paint) override;
+
+    void onSave() override;
+
+    void onRestore() override;
+
+    void onTranslate(float dx, float dy) override;
+
+    void onScale(float sx, float sy) override;
+
+    void onRotate(float degree) override;
+
+    void onRotate(float degree, float px, float py) override;
+
+    void onConcat(skity::Matrix const &matrix) override;
+
+    void onFlush() override {}
+
+    uint32_t onGetWidth() const override { return width_; }
+
+    uint32_t onGetHeight() const override { return height_; }
+
+    void onUpdateViewport(uint32_t width, uint32_t height) override;
+
+private:
+    struct State {
+        skity::Matrix matrix = skity::Matrix(1.f);
+        // document space
+        Bounds clip = {};
+        uint32_t group = {};
+    };
+
+    void add_transform(skity::Matrix const &matrix);
+
+    void add_item(ItemType type, uint32_t index, Bounds const &bounds);
+
+    /**
+     * @param bounds  local space
+     * @return false if the draw is clipped away and should not be recorded
+     */
+    bool draw_bounds(Bounds const &bounds, skity::Paint const &paint, Bounds *out) const;
+
+private:
+    SVGCullTree *tree_;
+    uint32_t width_ = {};
+    uint32_t height_ = {};
+    std::vector<State> states_ = {};
+};
+
+namespace {
+
+using Bounds = SVGCullTree::Bounds;
+
+Bounds empty_bounds() {
+    return Bounds{FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+}
+
+// zero area is not empty, hairlines and straight lines have none
+bool is_empty(Bounds const &b) {
+    return b.left > b.right || b.top > b.bottom;
+}
+
+bool intersects(Bounds const &a, Bounds const &b) {
+    return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+}
+
+Bounds intersect(Bounds const &a, Bounds const &b) {
+    return Bounds{std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right),
+                  std::min(a.bottom, b.bottom)};
+}
+
+void join(Bounds *dst, Bounds const &src) {
+    dst->left = std::min(dst->left, src.left);
+    dst->top = std::min(dst->top, src.top);
+    dst->right = std::max(dst->right, src.right);
+    dst->bottom = std::max(dst->bottom, src.bottom);
+}
+
+Bounds outset(Bounds const &b, float d) {
+    return Bounds{b.left - d, b.top - d, b.right + d, b.bottom + d};
+}
+
+Bounds from_rect(skity::Rect const &rect) {
+    return Bounds{rect.left(), rect.top(), rect.right(), rect.bottom()};
+}
+
+// axis aligned bounds of the transformed corners
+Bounds map_bounds(skity::Matrix const &matrix, Bounds const &b) {
+    Bounds result = empty_bounds();
+
+    const float xs[] = {b.left, b.right};
+    const float ys[] = {b.top, b.bottom};
+    for (float x : xs) {
+        for (float y : ys) {
+            glm::vec4 p = matrix * glm::vec4(x, y, 0.f, 1.f);
+            join(&result, Bounds{p.x, p.y, p.x, p.y});
+        }
+    }
+
+    return result;
+}
+
+// how far a stroke can reach past the path bounds, in local space
+float stroke_outset(skity::Paint const &paint) {
+    if (paint.getStyle() == skity::Paint::kFill_Style) {
+        return 0.f;
+    }
+
+    float factor = 1.f;
+    if (paint.getStrokeJoin() == skity::Paint::kMiter_Join) {
+        factor = std::max(factor, paint.getStrokeMiter());
+    }
+    if (paint.getStrokeCap() == skity::Paint::kSquare_Cap) {
+        factor = std::max(factor, 1.415f);
+    }
+
+    return paint.getStrokeWidth() * 0.5f * factor;
+}
+
+}  // namespace
+
+skity::Matrix SVGView::Matrix() const {
+    skity::Matrix matrix = glm::translate(skity::Matrix(1.f), glm::vec3(x, y, 0.f));
+    return glm::scale(matrix, glm::vec3(zoom, zoom, 1.f));
+}
+
+SVGCullTree::Recorder::Recorder(SVGCullTree *tree, uint32_t width, uint32_t height)
+        : tree_(tree) {
+    onUpdateViewport(width, height);
+
+    tree_->groups_.emplace_back();
+    tree_->groups_.back().bounds = empty_bounds();
+
+    states_.emplace_back();
+    states_.back().clip = Bounds{-kUnclipped, -kUnclipped, kUnclipped, kUnclipped};
+}
+
+void SVGCullTree::Recorder::finish() {
+    while (states_.size() > 1) {
+        onRestore();
+    }
+
+    for (auto &group : tree_->groups_) {
+        tree_->build_bvh(&group);
+
+        tree_->stats_.draws += group.draw_count;
+    }
+    tree_->stats_.groups = static_cast<uint32_t>(tree_->groups_.size());
+}
+
+void SVGCullTree::Recorder::onClipPath(skity::Path const &path, ClipOp op) {
+    auto &state = states_.back();
+    if (op == ClipOp::kIntersect) {
+        state.clip = intersect(state.clip, map_bounds(state.matrix, from_rect(path.getBounds())));
+    }
+
+    Op clip;
+    clip.type = OpType::kClipPath;
+    clip.clip_op = op;
+    clip.index = static_cast<uint32_t>(tree_->paths_.size());
+    tree_->paths_.emplace_back(path);
+
+    tree_->ops_.emplace_back(clip);
+    add_item(ItemType::kState, static_cast<uint32_t>(tree_->ops_.size() - 1), {});
+}
+
+void SVGCullTree::Recorder::onDrawPath(skity::Path const &path, skity::Paint const &paint) {
+    Bounds bounds;
+    if (!draw_bounds(from_rect(path.getBounds()), paint, &bounds)) {
+        return;
+    }
+
+    Op draw;
+    draw.type = OpType::kDrawPath;
+    draw.index = static_cast<uint32_t>(tree_->paths_.size());
+    draw.paint = static_cast<uint32_t>(tree_->paints_.size());
+    tree_->paths_.emplace_back(path);
+    tree_->paints_.emplace_back(paint);
+
+    tree_->ops_.emplace_back(draw);
+    add_item(ItemType::kDraw, static_cast<uint32_t>(tree_->ops_.size() - 1), bounds);
+}
+
+void SVGCullTree::Recorder::onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                                       skity::Paint const &paint) {
+    if (blob == nullptr) {
+        return;
+    }
+
+    // the baseline is at y, ascent and descent both fit in the blob height
+    skity::Vec2 size = blob->getBoundSize();
+    Bounds bounds;
+    if (!draw_bounds(Bounds{x, y - size.y, x + size.x, y + size.y}, paint, &bounds)) {
+        return;
+    }
+
+    Op draw;
+    draw.type = OpType::kDrawBlob;
+    draw.index = static_cast<uint32_t>(tree_->blobs_.size());
+    draw.paint = static_cast<uint32_t>(tree_->paints_.size());
+    draw.x = x;
+    draw.y = y;
+    tree_->blobs_.emplace_back(std::make_shared<skity::TextBlob>(*blob));
+    tree_->paints_.emplace_back(paint);
+
+    tree_->ops_.emplace_back(draw);
+    add_item(ItemType::kDraw, static_cast<uint32_t>(tree_->ops_.size() - 1), bounds);
+}
+
+void SVGCullTree::Recorder::onSave() {
+    State state = states_.back();
+    state.group = static_cast<uint32_t>(tree_->groups_.size());
+    states_.emplace_back(state);
+
+    tree_->groups_.emplace_back();
+    tree_->groups_.back().bounds = empty_bounds();
+}
+
+void SVGCullTree::Recorder::onRestore() {
+    if (states_.size() <= 1) {
+        return;
+    }
+
+    uint32_t index = states_.back().group;
+    states_.pop_back();
+
+    auto const &group = tree_->groups_[index];
+    if (group.draw_count + group.group_count > 0) {
+        add_item(ItemType::kGroup, index, group.bounds);
+    } else if (index + 1 == tree_->groups_.size()) {
+        // nothing visible, its empty children were dropped before it
+        tree_->groups_.pop_back();
+    }
+}
+
+void SVGCullTree::Recorder::onTranslate(float dx, float dy) {
+    add_transform(glm::translate(skity::Matrix(1.f), glm::vec3(dx, dy, 0.f)));
+}
+
+void SVGCullTree::Recorder::onScale(float sx, float sy) {
+    add_transform(glm::scale(skity::Matrix(1.f), glm::vec3(sx, sy, 1.f)));
+}
+
+void SVGCullTree::Recorder::onRotate(float degree) {
+    add_transform(glm::rotate(skity::Matrix(1.f), glm::radians(degree),
+                              glm::vec3(0.f, 0.f, 1.f)));
+}
+
+void SVGCullTree::Recorder::onRotate(float degree, float px, float py) {
+    skity::Matrix matrix = glm::translate(skity::Matrix(1.f), glm::vec3(px, py, 0.f));
+    matrix = glm::rotate(matrix, glm::radians(degree), glm::vec3(0.f, 0.f, 1.f));
+    matrix = glm::translate(matrix, glm::vec3(-px, -py, 0.f));
+    add_transform(matrix);
+}
+
+void SVGCullTree::Recorder::onConcat(skity::Matrix const &matrix) {
+    add_transform(matrix);
+}
+
+void SVGCullTree::Recorder::onUpdateViewport(uint32_t width, uint32_t height) {
+    width_ = width;
+    height_ = height;
+}
+
+void SVGCullTree::Recorder::add_transform(skity::Matrix const &matrix) {
+    states_.back().matrix = states_.back().matrix * matrix;
+
+    Op concat;
+    concat.type = OpType::kConcat;
+    concat.index = static_cast<uint32_t>(tree_->matrices_.size());
+    tree_->matrices_.emplace_back(matrix);
+
+    tree_->ops_.emplace_back(concat);
+    add_item(ItemType::kState, static_cast<uint32_t>(tree_->ops_.size() - 1), {});
+}
+
+void SVGCullTree::Recorder::add_item(ItemType type, uint32_t index, Bounds const &bounds) {
+    auto &group = tree_->groups_[states_.back().group];
+
+    group.items.emplace_back(Item{type, index, bounds});
+
+    switch (type) {
+        case ItemType::kState:
+            group.states.emplace_back(static_cast<uint32_t>(group.items.size() - 1));
+            return;
+        case ItemType::kDraw:
+            group.draw_count++;
+            break;
+        case ItemType::kGroup:
+            group.group_count++;
+            break;
+    }
+
+    join(&group.bounds, bounds);
+}
+
+bool SVGCullTree::Recorder::draw_bounds(Bounds const &bounds, skity::Paint const &paint,
+                                        Bounds *out) const {
+    auto const &state = states_.back();
+
+    *out = intersect(state.clip, map_bounds(state.matrix, outset(bounds, stroke_outset(paint))));
+
+    return !is_empty(*out);
+}
+
+std::unique_ptr<SVGCullTree> SVGCullTree::Record(skity::SVGDom *dom, uint32_t width,
+                                                 uint32_t height) {
+    if (dom == nullptr) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SVGCullTree> tree{new SVGCullTree};
+
+    Recorder recorder{tree.get(), width, height};
+    dom->Render(&recorder);
+    recorder.finish();
+
+    return tree;
+}
+
+SVGCullTree::~SVGCullTree() = default;
+
+void SVGCullTree::draw(skity::Canvas *canvas, skity::Matrix const &view,
+                       skity::Rect const &clip) {
+    stats_.visited_groups = 0;
+    stats_.culled_groups = 0;
+    stats_.issued_draws = 0;
+    stats_.culled_draws = 0;
+
+    if (groups_.empty() || std::abs(glm::determinant(view)) < FLT_MIN) {
+        return;
+    }
+
+    Bounds cull = map_bounds(glm::inverse(view), outset(from_rect(clip), kCullPadding));
+
+    canvas->save();
+    canvas->concat(view);
+
+    draw_group(canvas, 0, cull);
+
+    canvas->restore();
+}
+
+skity::Rect SVGCullTree::ContentBounds() const {
+    if (groups_.empty() || is_empty(groups_[0].bounds)) {
+        return skity::Rect::MakeLTRB(0.f, 0.f, 0.f, 0.f);
+    }
+
+    auto const &b = groups_[0].bounds;
+    return skity::Rect::MakeLTRB(b.left, b.top, b.right, b.bottom);
+}
+
+void SVGCullTree::build_bvh(Group *group) {
+    group->bvh.clear();
+    group->bvh_items.clear();
+
+    if (group->draw_count + group->group_count <= kLeafSize) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < group->items.size(); i++) {
+        if (group->items[i].type != ItemType::kState) {
+            group->bvh_items.emplace_back(i);
+        }
+    }
+
+    group->bvh.reserve(2 * group->bvh_items.size() / kLeafSize + 1);
+    build_node(group, 0, static_cast<uint32_t>(group->bvh_items.size()));
+}
+
+uint32_t SVGCullTree::build_node(Group *group, uint32_t first, uint32_t last) {
+    auto index = static_cast<uint32_t>(group->bvh.size());
+    group->bvh.emplace_back();
+
+    Bounds bounds = empty_bounds();
+    Bounds centers = empty_bounds();
+    for (uint32_t i = first; i < last; i++) {
+        auto const &b = group->items[group->bvh_items[i]].bounds;
+        join(&bounds, b);
+
+        float cx = (b.left + b.right) * 0.5f;
+        float cy = (b.top + b.bottom) * 0.5f;
+        join(&centers, Bounds{cx, cy, cx, cy});
+    }
+    group->bvh[index].bounds = bounds;
+
+    if (last - first <= kLeafSize) {
+        group->bvh[index].first = first;
+        group->bvh[index].count = last - first;
+        return index;
+    }
+
+    // median along the longer axis of the item centers
+    bool split_x = centers.right - centers.left >= centers.bottom - centers.top;
+    auto const &items = group->items;
+    auto center = [&items, split_x](uint32_t item) {
+        auto const &b = items[item].bounds;
+        return split_x ? b.left + b.right : b.top + b.bottom;
+    };
+
+    uint32_t mid = first + (last - first) / 2;
+    auto begin = group->bvh_items.begin();
+    std::nth_element(begin + first, begin + mid, begin + last,
+                     [&center](uint32_t a, uint32_t b) { return center(a) < center(b); });
+
+    // the left child is index + 1
+    build_node(group, first, mid);
+    uint32_t right = build_node(group, mid, last);
+    group->bvh[index].right = right;
+
+    return index;
+}
+
+void SVGCullTree::draw_group(skity::Canvas *canvas, uint32_t index, Bounds const &cull) {
+    stats_.visited_groups++;
+
+    auto const &group = groups_[index];
+    size_t base = visible_.size();
+    size_t first = base;
+
+    if (group.bvh.empty()) {
+        for (uint32_t i = 0; i < group.items.size(); i++) {
+            auto const &item = group.items[i];
+            if (item.type == ItemType::kState || intersects(item.bounds, cull)) {
+                visible_.emplace_back(i);
+            }
+        }
+    } else {
+        uint32_t stack[kMaxBvhDepth];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            uint32_t node_index = stack[--top];
+            auto const &node = group.bvh[node_index];
+            if (!intersects(node.bounds, cull)) {
+                continue;
+            }
+
+            if (node.count > 0) {
+                for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                    uint32_t item = group.bvh_items[i];
+                    if (intersects(group.items[item].bounds, cull)) {
+                        visible_.emplace_back(item);
+                    }
+                }
+            } else if (top + 2 <= kMaxBvhDepth) {
+                stack[top++] = node.right;
+                stack[top++] = node_index + 1;
+            }
+        }
+
+        // back into document order, with the transforms and clips in between
+        size_t mid = visible_.size();
+        std::sort(visible_.begin() + base, visible_.end());
+
+        visible_.reserve(mid + (mid - base) + group.states.size());
+        std::merge(visible_.begin() + base, visible_.begin() + mid, group.states.begin(),
+                   group.states.end(), std::back_inserter(visible_));
+        first = mid;
+    }
+
+    size_t end = visible_.size();
+    uint32_t draws = 0;
+    uint32_t groups = 0;
+
+    // child groups append behind end, read by index
+    for (size_t i = first; i < end; i++) {
+        auto const &item = group.items[visible_[i]];
+        switch (item.type) {
+            case ItemType::kState:
+                run_op(canvas, ops_[item.index]);
+                break;
+            case ItemType::kDraw:
+                run_op(canvas, ops_[item.index]);
+                draws++;
+                break;
+            case ItemType::kGroup:
+                canvas->save();
+                draw_group(canvas, item.index, cull);
+                canvas->restore();
+                groups++;
+                break;
+        }
+    }
+
+    stats_.issued_draws += draws;
+    stats_.culled_draws += group.draw_count - draws;
+    stats_.culled_groups += group.group_count - groups;
+
+    visible_.resize(base);
+}
+
+void SVGCullTree::run_op(skity::Canvas *canvas, Op const &op) {
+    switch (op.type) {
+        case OpType::kConcat:
+            canvas->concat(matrices_[op.index]);
+            break;
+        case OpType::kClipPath:
+            canvas->clipPath(paths_[op.index], op.clip_op);
+            break;
+        case OpType::kDrawPath:
+            canvas->drawPath(paths_[op.index], paints_[op.paint]);
+            break;
+        case OpType::kDrawBlob:
+            canvas->drawTextBlob(blobs_[op.index].get(), op.x, op.y, paints_[op.paint]);
+            break;
+    }
+}
@@ -0,0 +1,164 @@
+
+#ifndef SKITY_ANDROID_SVG_CULL_TREE_HPP
+#define SKITY_ANDROID_SVG_CULL_TREE_HPP
+
+#include <skity/skity.hpp>
+#include <skity/svg/svg_dom.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Zoom and pan of a document: canvas = translate(x, y) * scale(zoom) * document.
+ */
+struct SVGView {
+    float zoom = 1.f;
+    float x = 50.f;
+    float y = 50.f;
+
+    skity::Matrix Matrix() const;
+};
+
+struct SVGCullStats {
+    // size of the tree
+    uint32_t groups = {};
+    uint32_t draws = {};
+    // last draw(), a culled group is counted once, not with its subtree
+    uint32_t visited_groups = {};
+    uint32_t culled_groups = {};
+    uint32_t issued_draws = {};
+    uint32_t culled_draws = {};
+};
+
+/**
+ * SVGDom recorded once into a bounding box hierarchy, drawn with everything
+ * outside the visible rect skipped.
+ *
+ * Record() renders the document into a recording canvas. Every save / restore
+ * pair the DOM issues becomes a group holding the transforms, clips, draws and
+ * child groups issued inside it, in order. Bounds are in document space and
+ * already cut by the clips around them, so content clipped away is dropped
+ * while recording. Groups with more than kLeafSize children keep a BVH over
+ * them.
+ *
+ * draw() maps the visible rect back into document space and only walks the
+ * groups and draws touching it. Transforms and clips are always replayed, the
+ * items after them depend on them.
+ *
+ * Paths, paints and text blobs are copied, the DOM is not needed afterwards.
+ */
+class SVGCullTree {
+public:
+    // children of a group before it gets a BVH, and per BVH leaf
+    static constexpr uint32_t kLeafSize = 8;
+    // device pixels the visible rect is grown by, for anti aliasing and hairlines
+    static constexpr float kCullPadding = 1.f;
+
+    // document space, left > right or top > bottom is empty
+    struct Bounds {
+        float left = {};
+        float top = {};
+        float right = {};
+        float bottom = {};
+    };
+
+    /**
+     * @param width, height  canvas size the document sees while recording
+     */
+    static std::unique_ptr<SVGCullTree> Record(skity::SVGDom *dom, uint32_t width,
+                                               uint32_t height);
+
+    ~SVGCullTree();
+
+    /**
+     * @param view  document space to the current canvas space, concatenated
+     *              onto the canvas transform
+     * @param clip  visible rect in the current canvas space
+     */
+    void draw(skity::Canvas *canvas, skity::Matrix const &view, skity::Rect const &clip);
+
+    /**
+     * Document space bounds of everything drawn.
+     */
+    skity::Rect ContentBounds() const;
+
+    SVGCullStats const &Stats() const { return stats_; }
+
+private:
+    class Recorder;
+
+    enum class OpType : uint8_t {
+        kConcat,
+        kClipPath,
+        kDrawPath,
+        kDrawBlob,
+    };
+
+    struct Op {
+        OpType type = {};
+        skity::Canvas::ClipOp clip_op = {};
+        // into matrices_, paths_ or blobs_
+        uint32_t index = {};
+        uint32_t paint = {};
+        float x = {};
+        float y = {};
+    };
+
+    enum class ItemType : uint8_t {
+        // transforms and clips, never culled
+        kState,
+        kDraw,
+        kGroup,
+    };
+
+    struct Item {
+        ItemType type = {};
+        // into ops_ or groups_
+        uint32_t index = {};
+        Bounds bounds = {};
+    };
+
+    // leaf if count > 0, else the left child follows and right is its sibling
+    struct BvhNode {
+        Bounds bounds = {};
+        uint32_t first = {};
+        uint32_t count = {};
+        uint32_t right = {};
+    };
+
+    struct Group {
+        Bounds bounds = {};
+        std::vector<Item> items = {};
+        // items of kState
+        std::vector<uint32_t> states = {};
+        uint32_t draw_count = {};
+        uint32_t group_count = {};
+        // over the other items, empty for small groups
+        std::vector<BvhNode> bvh = {};
+        std::vector<uint32_t> bvh_items = {};
+    };
+
+    SVGCullTree() = default;
+
+    void build_bvh(Group *group);
+
+    uint32_t build_node(Group *group, uint32_t first, uint32_t last);
+
+    void draw_group(skity::Canvas *canvas, uint32_t index, Bounds const &cull);
+
+    void run_op(skity::Canvas *canvas, Op const &op);
+
+private:
+    std::vector<Group> groups_ = {};
+    std::vector<Op> ops_ = {};
+    std::vector<skity::Matrix> matrices_ = {};
+    std::vector<skity::Path> paths_ = {};
+    std::vector<skity::Paint> paints_ = {};
+    std::vector<std::shared_ptr<skity::TextBlob>> blobs_ = {};
+    // visible items of the groups being drawn, each group appends its own range
+    std::vector<uint32_t> visible_ = {};
+    SVGCullStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_SVG_CULL_TREE_HPP
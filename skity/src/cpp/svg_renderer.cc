@@ -1,15 +1,49 @@
 
 #include "svg_renderer.hpp"
 
-void SVGRenderer::draw() {
-    Renderer::draw();
+void SVGRenderer::init_svg(skity::Data *data) {
+    svg_dom_ = skity::SVGDom::MakeFromData(data);
+    cull_tree_ = SVGCullTree::Record(svg_dom_.get(), Width(), Height());
+}
 
-    GetCanvas()->save();
-    GetCanvas()->translate(50, 50);
+void SVGRenderer::set_view(float zoom, float x, float y) {
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    view_.zoom = zoom;
+    view_.x = x;
+    view_.y = y;
+}
 
-    svg_dom_->Render(GetCanvas());
+SVGCullStats SVGRenderer::CullStats() const {
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    return cull_stats_;
+}
 
-    GetCanvas()->restore();
+void SVGRenderer::onDraw(skity::Canvas *canvas) {
+    alloc_meter_.tick();
+    alloc_meter_.report("svg");
 
-    GetCanvas()->flush();
-}
\ No newline at end of file
+    SVGView view;
+    {
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        view = view_;
+    }
+
+    path_cache_.begin_frame();
+    path_canvas_.set_target(GetCanvas(), Width(), Height());
+
+    if (culling_ && cull_tree_) {
+        cull_tree_->draw(&path_canvas_, view.Matrix(),
+                         skity::Rect::MakeXYWH(0.f, 0.f, Width(), Height()));
+
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        cull_stats_ = cull_tree_->Stats();
+        return;
+    }
+
+    path_canvas_.save();
+    path_canvas_.concat(view.Matrix());
+
+    svg_dom_->Render(&path_canvas_);
+
+    path_canvas_.restore();
+}
@@ -4,6 +4,12 @@
 
 #include "renderer.hpp"
 #include "skity/svg/svg_dom.hpp"
+#include "alloc_counter.hpp"
+#include "path_geometry_cache.hpp"
+#include "svg_cull_tree.hpp"
+
+#include <atomic>
+#include <mutex>
 
 class SVGRenderer : public Renderer {
 public:
@@ -11,14 +17,38 @@ public:
 
     ~SVGRenderer() override = default;
 
-    void draw() override;
+    void init_svg(skity::Data *data);
+
+    /**
+     * Zoom and pan the document, can be called from any thread.
+     */
+    void set_view(float zoom, float x, float y);
+
+    /**
+     * Draw only what the SVGCullTree finds in the viewport, on by default.
+     * Off renders the whole DOM every frame.
+     */
+    void set_culling(bool culling) { culling_ = culling; }
+
+    /**
+     * Of the last frame, can be called from any thread.
+     */
+    SVGCullStats CullStats() const;
 
-    void init_svg(skity::Data *data) {
-        svg_dom_ = skity::SVGDom::MakeFromData(data);
-    }
+protected:
+    void onDraw(skity::Canvas *canvas) override;
 
 private:
     std::unique_ptr<skity::SVGDom> svg_dom_ = {};
+    std::unique_ptr<SVGCullTree> cull_tree_ = {};
+    std::atomic<bool> culling_ = {true};
+    mutable std::mutex view_mutex_ = {};
+    SVGView view_ = {};
+    SVGCullStats cull_stats_ = {};
+    AllocFrameMeter alloc_meter_ = {};
+    // the svg paths only move with the canvas, they hit from the third frame on
+    PathGeometryCache path_cache_ = {};
+    PathCacheCanvas path_canvas_{&path_cache_};
 };
 
 
@@ -0,0 +1,249 @@
+
+#include "svg_tile_cache.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "frame_clock.hpp"
+
+constexpr uint32_t SVGTileCache::kTileSize;
+constexpr int32_t SVGTileCache::kMinLevel;
+constexpr int32_t SVGTileCache::kMaxLevel;
+constexpr int32_t SVGTileCache::kPlaceholderLevels;
+constexpr int32_t SVGTileCache::kPlaceholderDrop;
+
+namespace {
+
+// floor(value / 2^shift), also for negative tile coordinates
+int32_t floor_shift(int32_t value, int32_t shift) {
+    return value >= 0 ? value >> shift : -((-value - 1) >> shift) - 1;
+}
+
+// document units one tile of level covers
+float tile_extent(int32_t level) {
+    return SVGTileCache::kTileSize / std::exp2(static_cast<float>(level));
+}
+
+}  // namespace
+
+size_t SVGTileCache::KeyHash::operator()(Key const &key) const {
+    auto x = static_cast<uint32_t>(key.x);
+    auto y = static_cast<uint32_t>(key.y);
+    auto level = static_cast<uint32_t>(key.level);
+    return static_cast<size_t>((x * 0x9e3779b1u) ^ (y * 0x85ebca6bu) ^ (level * 0xc2b2ae35u));
+}
+
+SVGTileCache::SVGTileCache(uint32_t max_tiles) : max_tiles_(std::max(max_tiles, 1u)) {}
+
+void SVGTileCache::set_content(SVGCullTree *tree, uint32_t background) {
+    tree_ = tree;
+    background_ = background;
+
+    index_.clear();
+    tiles_.clear();
+}
+
+int32_t SVGTileCache::LevelForZoom(float zoom) {
+    // the view scales the level by 0.71 to 1.41
+    auto level = static_cast<int32_t>(std::lround(std::log2(zoom)));
+    return std::min(std::max(level, kMinLevel), kMaxLevel);
+}
+
+bool SVGTileCache::draw(skity::Canvas *canvas, WorkStealingPool *pool, SVGView const &view,
+                        uint32_t width, uint32_t height, double budget_ms) {
+    frame_++;
+    stats_ = {};
+    stats_.cached = static_cast<uint32_t>(tiles_.size());
+
+    if (tree_ == nullptr || !(view.zoom > 0.f)) {
+        return true;
+    }
+
+    int32_t level = LevelForZoom(view.zoom);
+    stats_.level = level;
+
+    // viewport in document space, limited to the content
+    skity::Rect content = tree_->ContentBounds();
+    float left = std::max(-view.x / view.zoom, content.left());
+    float top = std::max(-view.y / view.zoom, content.top());
+    float right = std::min((width - view.x) / view.zoom, content.right());
+    float bottom = std::min((height - view.y) / view.zoom, content.bottom());
+    if (left >= right || top >= bottom) {
+        return true;
+    }
+
+    float extent = tile_extent(level);
+    auto x0 = static_cast<int32_t>(std::floor(left / extent));
+    auto y0 = static_cast<int32_t>(std::floor(top / extent));
+    auto x1 = static_cast<int32_t>(std::ceil(right / extent));
+    auto y1 = static_cast<int32_t>(std::ceil(bottom / extent));
+
+    visible_.clear();
+    pending_.clear();
+
+    // coarse placeholders go first, then the tiles of level
+    size_t coarse_end = 0;
+    for (int32_t y = y0; y < y1; y++) {
+        for (int32_t x = x0; x < x1; x++) {
+            Key key{level, x, y};
+            visible_.emplace_back(key);
+
+            if (find(key)) {
+                continue;
+            }
+
+            pending_.emplace_back(key);
+
+            if (find_coarser(key) == nullptr &&
+                level - kPlaceholderDrop >= kMinLevel) {
+                Key coarse{level - kPlaceholderDrop, floor_shift(x, kPlaceholderDrop),
+                           floor_shift(y, kPlaceholderDrop)};
+                if (std::find(pending_.begin(), pending_.begin() + coarse_end, coarse) ==
+                    pending_.begin() + coarse_end) {
+                    pending_.insert(pending_.begin() + coarse_end, coarse);
+                    coarse_end++;
+                }
+            }
+        }
+    }
+    stats_.visible = static_cast<uint32_t>(visible_.size());
+
+    // nearest to the viewport center first, it is where the user looks
+    float cx = (left + right) * 0.5f;
+    float cy = (top + bottom) * 0.5f;
+    auto distance = [cx, cy](Key const &key) {
+        float e = tile_extent(key.level);
+        float dx = (key.x + 0.5f) * e - cx;
+        float dy = (key.y + 0.5f) * e - cy;
+        return dx * dx + dy * dy;
+    };
+    auto nearer = [&distance](Key const &a, Key const &b) { return distance(a) < distance(b); };
+    std::sort(pending_.begin(), pending_.begin() + coarse_end, nearer);
+    std::sort(pending_.begin() + coarse_end, pending_.end(), nearer);
+
+    double start = monotonic_seconds();
+    for (auto const &key : pending_) {
+        if (stats_.rendered > 0 && (monotonic_seconds() - start) * 1000.0 >= budget_ms) {
+            break;
+        }
+
+        if (render_tile(key, pool)) {
+            stats_.rendered++;
+        }
+    }
+    stats_.render_ms = static_cast<float>((monotonic_seconds() - start) * 1000.0);
+
+    canvas->save();
+    canvas->concat(view.Matrix());
+
+    for (auto const &key : visible_) {
+        Tile *tile = find(key);
+        if (tile) {
+            draw_tile(canvas, *tile, key);
+            stats_.current++;
+            continue;
+        }
+
+        tile = find_coarser(key);
+        if (tile) {
+            draw_tile(canvas, *tile, key);
+            stats_.placeholders++;
+        } else {
+            stats_.missing++;
+        }
+    }
+
+    canvas->restore();
+
+    evict();
+    stats_.cached = static_cast<uint32_t>(tiles_.size());
+
+    return stats_.current == stats_.visible;
+}
+
+SVGTileCache::Tile *SVGTileCache::find(Key const &key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+
+    tiles_.splice(tiles_.begin(), tiles_, it->second);
+    it->second->last_frame = frame_;
+
+    return &*it->second;
+}
+
+SVGTileCache::Tile *SVGTileCache::find_coarser(Key const &key) {
+    for (int32_t d = 1; d <= kPlaceholderLevels && key.level - d >= kMinLevel; d++) {
+        Tile *tile = find(Key{key.level - d, floor_shift(key.x, d), floor_shift(key.y, d)});
+        if (tile) {
+            return tile;
+        }
+    }
+
+    return nullptr;
+}
+
+bool SVGTileCache::render_tile(Key const &key, WorkStealingPool *pool) {
+    float scale = std::exp2(static_cast<float>(key.level));
+
+    // document space into the pixels of this tile
+    skity::Matrix view = glm::translate(skity::Matrix(1.f),
+                                        glm::vec3(-static_cast<float>(key.x) * kTileSize,
+                                                  -static_cast<float>(key.y) * kTileSize, 0.f));
+    view = glm::scale(view, glm::vec3(scale, scale, 1.f));
+
+    raster_.reset();
+    tree_->draw(&raster_, view, skity::Rect::MakeXYWH(0.f, 0.f, kTileSize, kTileSize));
+
+    pixels_.resize(kTileSize * kTileSize);
+    raster_.rasterize(pool, pixels_.data(), kTileSize * sizeof(uint32_t), background_);
+
+    auto data = skity::Data::MakeWithCopy(pixels_.data(), pixels_.size() * sizeof(uint32_t));
+    if (!data) {
+        return false;
+    }
+
+    tiles_.emplace_front();
+    Tile &tile = tiles_.front();
+    tile.key = key;
+    tile.last_frame = frame_;
+    index_[key] = tiles_.begin();
+
+    tile.pixmap = std::make_shared<skity::Pixmap>(data, kTileSize * sizeof(uint32_t), kTileSize,
+                                                  kTileSize);
+
+    // tile pixels onto the document rect of the tile
+    float extent = tile_extent(key.level);
+    skity::Matrix local_matrix = glm::translate(
+            skity::Matrix(1.f), glm::vec3(key.x * extent, key.y * extent, 0.f));
+    local_matrix = glm::scale(local_matrix, glm::vec3(extent / kTileSize, extent / kTileSize, 1.f));
+
+    tile.shader = skity::Shader::MakeShader(tile.pixmap);
+    tile.shader->SetLocalMatrix(local_matrix);
+
+    return true;
+}
+
+void SVGTileCache::draw_tile(skity::Canvas *canvas, Tile const &tile, Key const &dst) {
+    float dst_extent = tile_extent(dst.level);
+
+    skity::Paint paint;
+    paint.setStyle(skity::Paint::kFill_Style);
+    // anti aliased edges would leave seams between the tiles
+    paint.setAntiAlias(false);
+    paint.setShader(tile.shader);
+
+    canvas->drawRect(skity::Rect::MakeXYWH(dst.x * dst_extent, dst.y * dst_extent, dst_extent,
+                                           dst_extent), paint);
+}
+
+void SVGTileCache::evict() {
+    // tiles drawn this frame stay
+    while (tiles_.size() > max_tiles_ && tiles_.back().last_frame != frame_) {
+        index_.erase(tiles_.back().key);
+        tiles_.pop_back();
+    }
+}
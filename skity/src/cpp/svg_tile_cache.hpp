@@ -0,0 +1,146 @@
+
+#ifndef SKITY_ANDROID_SVG_TILE_CACHE_HPP
+#define SKITY_ANDROID_SVG_TILE_CACHE_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "svg_cull_tree.hpp"
+#include "tile_raster_canvas.hpp"
+#include "work_stealing_pool.hpp"
+
+struct SVGTileStats {
+    int32_t level = {};
+    // tiles of level covering the viewport
+    uint32_t visible = {};
+    // drawn from their own tile
+    uint32_t current = {};
+    // drawn from a coarser tile until their own tile is rendered
+    uint32_t placeholders = {};
+    // nothing to draw yet
+    uint32_t missing = {};
+    uint32_t rendered = {};
+    uint32_t cached = {};
+    float render_ms = {};
+};
+
+/**
+ * Renders an SVGCullTree into kTileSize square tiles at discrete zoom levels
+ * and composites the viewport from them.
+ *
+ * Level l holds the document at scale 2^l, a view is drawn from the level
+ * nearest its zoom and scaled by the rest. Tiles are rasterized on the CPU by
+ * a TileRasterCanvas, spread over a WorkStealingPool, and drawn through
+ * pixmap shaders. Each draw() renders missing tiles, nearest to the viewport
+ * center first, until its time budget is spent. Visible tiles not rendered
+ * yet are covered by the nearest coarser tile containing them. A visible tile
+ * without one queues the tile kPlaceholderDrop levels up first, one of those
+ * covers 16 tiles.
+ *
+ * A tile is rendered once: its Pixmap, so its texture inside Skity, and its
+ * shader live as long as the tile. Least recently drawn tiles are dropped
+ * beyond max_tiles.
+ *
+ * Tiles have the fill limits of TileRasterCanvas: solid colors only, no text,
+ * gradients or clips.
+ */
+class SVGTileCache {
+public:
+    static constexpr uint32_t kTileSize = 256;
+    static constexpr int32_t kMinLevel = -8;
+    static constexpr int32_t kMaxLevel = 8;
+    // coarser levels searched for a placeholder
+    static constexpr int32_t kPlaceholderLevels = 4;
+    static constexpr int32_t kPlaceholderDrop = 2;
+
+    SVGTileCache() : SVGTileCache(128) {}
+
+    explicit SVGTileCache(uint32_t max_tiles);
+
+    ~SVGTileCache() = default;
+
+    /**
+     * Drops every tile.
+     *
+     * @param background  premultiplied color tiles are cleared to, see
+     *                    premultiply_color(). Opaque, tiles are not blended.
+     */
+    void set_content(SVGCullTree *tree, uint32_t background);
+
+    /**
+     * @param budget_ms  time rendering tiles may take, at least one tile is
+     *                   rendered when any is needed
+     * @return           true if every visible tile was rendered, false if
+     *                   later frames still have tiles to render
+     */
+    bool draw(skity::Canvas *canvas, WorkStealingPool *pool, SVGView const &view,
+              uint32_t width, uint32_t height, double budget_ms);
+
+    SVGTileStats const &LastStats() const { return stats_; }
+
+    static int32_t LevelForZoom(float zoom);
+
+private:
+    struct Key {
+        int32_t level = {};
+        int32_t x = {};
+        int32_t y = {};
+
+        bool operator==(Key const &other) const {
+            return level == other.level && x == other.x && y == other.y;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(Key const &key) const;
+    };
+
+    struct Tile {
+        Key key = {};
+        std::shared_ptr<skity::Pixmap> pixmap = {};
+        // samples pixmap onto the document rect of key
+        std::shared_ptr<skity::Shader> shader = {};
+        uint64_t last_frame = {};
+    };
+
+    /**
+     * Moves the tile to the front of the LRU list.
+     */
+    Tile *find(Key const &key);
+
+    /**
+     * Nearest tile up to kPlaceholderLevels levels coarser containing key.
+     */
+    Tile *find_coarser(Key const &key);
+
+    bool render_tile(Key const &key, WorkStealingPool *pool);
+
+    /**
+     * Draw the part of tile covering dst, in document space.
+     */
+    void draw_tile(skity::Canvas *canvas, Tile const &tile, Key const &dst);
+
+    void evict();
+
+private:
+    SVGCullTree *tree_ = {};
+    uint32_t background_ = {};
+    uint32_t max_tiles_;
+    uint64_t frame_ = {};
+    // most recently drawn at the front
+    std::list<Tile> tiles_ = {};
+    std::unordered_map<Key, std::list<Tile>::iterator, KeyHash> index_ = {};
+    TileRasterCanvas raster_{kTileSize, kTileSize};
+    std::vector<uint32_t> pixels_ = {};
+    // per frame scratch
+    std::vector<Key> visible_ = {};
+    std::vector<Key> pending_ = {};
+    SVGTileStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_SVG_TILE_CACHE_HPP
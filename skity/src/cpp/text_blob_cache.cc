@@ -0,0 +1,62 @@
+
+#include "text_blob_cache.hpp"
+
+#include <functional>
+
+size_t TextBlobCache::KeyHash::operator()(Key const &key) const {
+    size_t hash = std::hash<std::string>()(key.text);
+    hash ^= std::hash<skity::Typeface *>()(key.typeface) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>()(key.size) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+TextBlobCache::TextBlobCache(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+std::shared_ptr<skity::TextBlob> TextBlobCache::get(std::string const &text,
+                                                    skity::Paint const &paint) {
+    auto typeface = paint.getTypeface();
+
+    Key key{text, typeface.get(), paint.getTextSize()};
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, it->second);
+        hits_++;
+        return it->second->blob;
+    }
+
+    misses_++;
+
+    skity::TextBlobBuilder builder;
+    auto blob = builder.buildTextBlob(text.c_str(), paint);
+    if (!blob) {
+        return nullptr;
+    }
+
+    entries_.emplace_front(Entry{key, typeface, blob});
+    index_[key] = entries_.begin();
+
+    if (entries_.size() > capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+
+    return blob;
+}
+
+float TextBlobCache::draw(skity::Canvas *canvas, std::string const &text, float x, float y,
+                          skity::Paint const &paint) {
+    auto blob = get(text, paint);
+    if (!blob) {
+        return 0.f;
+    }
+
+    canvas->drawTextBlob(blob.get(), x, y, paint);
+
+    return blob->getBoundSize().x;
+}
+
+void TextBlobCache::clear() {
+    index_.clear();
+    entries_.clear();
+}
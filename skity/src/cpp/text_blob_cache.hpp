@@ -0,0 +1,79 @@
+
+#ifndef SKITY_ANDROID_TEXT_BLOB_CACHE_HPP
+#define SKITY_ANDROID_TEXT_BLOB_CACHE_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * LRU cache of shaped text runs.
+ *
+ * A blob is built once per (string, typeface, size) and replayed with
+ * drawTextBlob at any translation, so text that does not change between
+ * frames skips shaping and glyph lookup entirely.
+ */
+class TextBlobCache {
+public:
+    explicit TextBlobCache(size_t capacity = 128);
+
+    ~TextBlobCache() = default;
+
+    /**
+     * Find or build the blob for text using the typeface and text size of
+     * paint.
+     */
+    std::shared_ptr<skity::TextBlob> get(std::string const &text, skity::Paint const &paint);
+
+    /**
+     * Draw text with its baseline origin at (x, y).
+     *
+     * @return the width of the drawn run
+     */
+    float draw(skity::Canvas *canvas, std::string const &text, float x, float y,
+               skity::Paint const &paint);
+
+    void clear();
+
+    size_t Size() const { return entries_.size(); }
+
+    uint64_t Hits() const { return hits_; }
+
+    uint64_t Misses() const { return misses_; }
+
+private:
+    struct Key {
+        std::string text = {};
+        skity::Typeface *typeface = {};
+        float size = {};
+
+        bool operator==(Key const &other) const {
+            return typeface == other.typeface && size == other.size && text == other.text;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(Key const &key) const;
+    };
+
+    struct Entry {
+        Key key = {};
+        // keeps the typeface alive while its address is used as key
+        std::shared_ptr<skity::Typeface> typeface = {};
+        std::shared_ptr<skity::TextBlob> blob = {};
+    };
+
+private:
+    size_t capacity_;
+    // most recently used at the front
+    std::list<Entry> entries_ = {};
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_ = {};
+    uint64_t hits_ = {};
+    uint64_t misses_ = {};
+};
+
+#endif //SKITY_ANDROID_TEXT_BLOB_CACHE_HPP
@@ -0,0 +1,679 @@
+
+#include "tile_raster_canvas.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "path_flatten.hpp"
+#include "span_blend.hpp"
+
+constexpr uint32_t TileRasterCanvas::kTileSize;
+constexpr uint32_t TileRasterCanvas::kSubScanlines;
+
+// max distance of flattened curves from the curve, in device pixels
+static constexpr float kTolerance = 0.25f;
+// clip of a fresh canvas, content outside the viewport is kept for fit_content()
+static constexpr float kUnclipped = 1e9f;
+
+namespace {
+
+struct Crossing {
+    float x = {};
+    int32_t winding = {};
+};
+
+// rasterize_draw() buffers of one thread
+struct TileScratch {
+    std::vector<uint32_t> region_edges = {};
+    std::vector<uint32_t> row_edges = {};
+    std::vector<Crossing> crossings = {};
+    // coverage runs as start / end deltas, partial pixels separately
+    std::vector<int32_t> full = {};
+    std::vector<float> partial = {};
+    std::vector<uint8_t> coverage = {};
+};
+
+thread_local TileScratch tls_scratch = {};
+
+float length(float x, float y) {
+    return std::sqrt(x * x + y * y);
+}
+
+}  // namespace
+
+TileRasterCanvas::TileRasterCanvas(uint32_t width, uint32_t height) {
+    onUpdateViewport(width, height);
+    reset();
+}
+
+void TileRasterCanvas::reset() {
+    states_.clear();
+    states_.emplace_back();
+    states_.back().clip = skity::Rect::MakeLTRB(-kUnclipped, -kUnclipped, kUnclipped, kUnclipped);
+
+    edges_.clear();
+    draws_.clear();
+    stats_ = {};
+}
+
+skity::Rect TileRasterCanvas::ContentBounds() const {
+    if (draws_.empty()) {
+        return skity::Rect::MakeLTRB(0.f, 0.f, 0.f, 0.f);
+    }
+
+    float left = draws_[0].left;
+    float top = draws_[0].top;
+    float right = draws_[0].right;
+    float bottom = draws_[0].bottom;
+    for (auto const &draw : draws_) {
+        left = std::min(left, draw.left);
+        top = std::min(top, draw.top);
+        right = std::max(right, draw.right);
+        bottom = std::max(bottom, draw.bottom);
+    }
+
+    return skity::Rect::MakeLTRB(left, top, right, bottom);
+}
+
+void TileRasterCanvas::fit_content(skity::Rect const &dst) {
+    skity::Rect bounds = ContentBounds();
+    if (bounds.width() <= 0.f || bounds.height() <= 0.f) {
+        return;
+    }
+
+    float scale = std::min(dst.width() / bounds.width(), dst.height() / bounds.height());
+    float tx = dst.left() + (dst.width() - bounds.width() * scale) * 0.5f - bounds.left() * scale;
+    float ty = dst.top() + (dst.height() - bounds.height() * scale) * 0.5f - bounds.top() * scale;
+
+    // uniform, so the slopes stay the same
+    for (auto &edge : edges_) {
+        edge.x0 = edge.x0 * scale + tx;
+        edge.y0 = edge.y0 * scale + ty;
+        edge.x1 = edge.x1 * scale + tx;
+        edge.y1 = edge.y1 * scale + ty;
+    }
+
+    for (auto &draw : draws_) {
+        draw.left = draw.left * scale + tx;
+        draw.top = draw.top * scale + ty;
+        draw.right = draw.right * scale + tx;
+        draw.bottom = draw.bottom * scale + ty;
+    }
+}
+
+void TileRasterCanvas::rasterize(WorkStealingPool *pool, uint32_t *pixels, size_t row_bytes,
+                                 uint32_t clear_color) {
+    for (auto &bin : bins_) {
+        bin.clear();
+    }
+
+    for (uint32_t i = 0; i < draws_.size(); i++) {
+        auto const &draw = draws_[i];
+
+        auto x0 = static_cast<int32_t>(std::max(std::floor(draw.left), 0.f));
+        auto y0 = static_cast<int32_t>(std::max(std::floor(draw.top), 0.f));
+        auto x1 = static_cast<int32_t>(std::min(std::ceil(draw.right), (float) width_));
+        auto y1 = static_cast<int32_t>(std::min(std::ceil(draw.bottom), (float) height_));
+        if (x1 <= x0 || y1 <= y0) {
+            continue;
+        }
+
+        for (int32_t ty = y0 / kTileSize; ty <= (y1 - 1) / (int32_t) kTileSize; ty++) {
+            for (int32_t tx = x0 / kTileSize; tx <= (x1 - 1) / (int32_t) kTileSize; tx++) {
+                bins_[ty * tiles_x_ + tx].emplace_back(i);
+            }
+        }
+    }
+
+    pool->parallel_for(tiles_x_ * tiles_y_, [this, pixels, row_bytes, clear_color](uint32_t tile) {
+        rasterize_tile(tile, pixels, row_bytes, clear_color);
+    });
+
+    stats_.tiles = tiles_x_ * tiles_y_;
+    stats_.tile_draws = 0;
+    for (auto const &bin : bins_) {
+        stats_.tile_draws += bin.size();
+    }
+}
+
+void TileRasterCanvas::onClipPath(skity::Path const &path, ClipOp op) {
+    if (op != ClipOp::kIntersect) {
+        stats_.unsupported++;
+        return;
+    }
+
+    skity::Rect bounds = path.getBounds();
+    Point corners[4] = {
+            transform({bounds.left(), bounds.top()}),
+            transform({bounds.right(), bounds.top()}),
+            transform({bounds.right(), bounds.bottom()}),
+            transform({bounds.left(), bounds.bottom()}),
+    };
+
+    float left = corners[0].x;
+    float top = corners[0].y;
+    float right = corners[0].x;
+    float bottom = corners[0].y;
+    for (auto const &corner : corners) {
+        left = std::min(left, corner.x);
+        top = std::min(top, corner.y);
+        right = std::max(right, corner.x);
+        bottom = std::max(bottom, corner.y);
+    }
+
+    // empty clips stay empty, end_draw() drops everything inside them
+    auto &clip = states_.back().clip;
+    clip = skity::Rect::MakeLTRB(std::max(clip.left(), left), std::max(clip.top(), top),
+                                 std::min(clip.right(), right), std::min(clip.bottom(), bottom));
+}
+
+void TileRasterCanvas::onDrawPath(skity::Path const &path, skity::Paint const &paint) {
+    auto const &matrix = states_.back().matrix;
+
+    // length scale of the matrix, for tolerances and hairlines
+    float scale = std::sqrt(std::abs(matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0]));
+    if (scale <= 0.f) {
+        return;
+    }
+
+    if (paint.getShader()) {
+        stats_.unsupported++;
+    }
+
+    flatten(path, kTolerance / scale);
+
+    if (paint.getStyle() != skity::Paint::kStroke_Style) {
+        begin_draw();
+        add_fill();
+
+        auto color = paint.GetFillColor();
+        end_draw(premultiply_color(color.r, color.g, color.b, color.a),
+                 path.getFillType() == skity::Path::PathFillType::kEvenOdd);
+    }
+
+    if (paint.getStyle() != skity::Paint::kFill_Style) {
+        begin_draw();
+        add_stroke(paint, scale);
+
+        // overlapping pieces of a stroke must not add up
+        auto color = paint.GetStrokeColor();
+        end_draw(premultiply_color(color.r, color.g, color.b, color.a), false);
+    }
+}
+
+void TileRasterCanvas::onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                                  skity::Paint const &paint) {
+    stats_.unsupported++;
+}
+
+void TileRasterCanvas::onSave() {
+    states_.emplace_back(states_.back());
+}
+
+void TileRasterCanvas::onRestore() {
+    if (states_.size() > 1) {
+        states_.pop_back();
+    }
+}
+
+void TileRasterCanvas::onTranslate(float dx, float dy) {
+    auto &matrix = states_.back().matrix;
+    matrix = glm::translate(matrix, glm::vec3(dx, dy, 0.f));
+}
+
+void TileRasterCanvas::onScale(float sx, float sy) {
+    auto &matrix = states_.back().matrix;
+    matrix = glm::scale(matrix, glm::vec3(sx, sy, 1.f));
+}
+
+void TileRasterCanvas::onRotate(float degree) {
+    auto &matrix = states_.back().matrix;
+    matrix = glm::rotate(matrix, glm::radians(degree), glm::vec3(0.f, 0.f, 1.f));
+}
+
+void TileRasterCanvas::onRotate(float degree, float px, float py) {
+    onTranslate(px, py);
+    onRotate(degree);
+    onTranslate(-px, -py);
+}
+
+void TileRasterCanvas::onConcat(skity::Matrix const &matrix) {
+    states_.back().matrix = states_.back().matrix * matrix;
+}
+
+void TileRasterCanvas::onUpdateViewport(uint32_t width, uint32_t height) {
+    width_ = width;
+    height_ = height;
+
+    tiles_x_ = (width_ + kTileSize - 1) / kTileSize;
+    tiles_y_ = (height_ + kTileSize - 1) / kTileSize;
+    bins_.resize(tiles_x_ * tiles_y_);
+}
+
+void TileRasterCanvas::flatten(skity::Path const &path, float tolerance) {
+    points_.clear();
+    contours_.clear();
+
+    struct Sink {
+        TileRasterCanvas *canvas;
+
+        void move_to(float x, float y) {
+            canvas->contours_.emplace_back(
+                    Contour{static_cast<uint32_t>(canvas->points_.size()), 0, false});
+            line_to(x, y);
+        }
+
+        void line_to(float x, float y) {
+            if (canvas->contours_.empty()) {
+                canvas->contours_.emplace_back(
+                        Contour{static_cast<uint32_t>(canvas->points_.size()), 0, false});
+            }
+            canvas->points_.emplace_back(Point{x, y});
+            canvas->contours_.back().count++;
+        }
+
+        void close() {
+            if (!canvas->contours_.empty()) {
+                canvas->contours_.back().closed = true;
+            }
+        }
+    };
+
+    Sink sink{this};
+    flatten_path(path, tolerance, &sink);
+}
+
+void TileRasterCanvas::begin_draw() {
+    draw_first_edge_ = static_cast<uint32_t>(edges_.size());
+    draw_left_ = draw_top_ = kUnclipped;
+    draw_right_ = draw_bottom_ = -kUnclipped;
+}
+
+void TileRasterCanvas::end_draw(uint32_t color, bool even_odd) {
+    auto const &clip = states_.back().clip;
+
+    Draw draw;
+    draw.first_edge = draw_first_edge_;
+    draw.edge_count = static_cast<uint32_t>(edges_.size()) - draw_first_edge_;
+    draw.left = std::max(draw_left_, clip.left());
+    draw.top = std::max(draw_top_, clip.top());
+    draw.right = std::min(draw_right_, clip.right());
+    draw.bottom = std::min(draw_bottom_, clip.bottom());
+    draw.color = color;
+    draw.even_odd = even_odd;
+
+    if (draw.edge_count == 0 || draw.right <= draw.left || draw.bottom <= draw.top ||
+        (color >> 24) == 0) {
+        edges_.resize(draw_first_edge_);
+        return;
+    }
+
+    draws_.emplace_back(draw);
+    stats_.draws++;
+    stats_.edges += draw.edge_count;
+}
+
+void TileRasterCanvas::add_polygon(Point const *points, uint32_t count) {
+    if (count < 2) {
+        return;
+    }
+
+    Point prev = transform(points[count - 1]);
+    for (uint32_t i = 0; i < count; i++) {
+        Point curr = transform(points[i]);
+
+        draw_left_ = std::min(draw_left_, curr.x);
+        draw_top_ = std::min(draw_top_, curr.y);
+        draw_right_ = std::max(draw_right_, curr.x);
+        draw_bottom_ = std::max(draw_bottom_, curr.y);
+
+        if (prev.y != curr.y) {
+            Edge edge;
+            if (prev.y < curr.y) {
+                edge = Edge{prev.x, prev.y, curr.x, curr.y, 0.f, 1};
+            } else {
+                edge = Edge{curr.x, curr.y, prev.x, prev.y, 0.f, -1};
+            }
+            edge.dxdy = (edge.x1 - edge.x0) / (edge.y1 - edge.y0);
+            edges_.emplace_back(edge);
+        }
+
+        prev = curr;
+    }
+}
+
+void TileRasterCanvas::add_fill() {
+    // fills close open contours implicitly
+    for (auto const &contour : contours_) {
+        add_polygon(points_.data() + contour.first, contour.count);
+    }
+}
+
+void TileRasterCanvas::add_stroke(skity::Paint const &paint, float scale) {
+    float width = paint.getStrokeWidth();
+    // hairlines stay one device pixel wide
+    float hw = width > 0.f ? width * 0.5f : 0.5f / scale;
+
+    auto cap = paint.getStrokeCap();
+    auto join = paint.getStrokeJoin();
+    float miter_limit = paint.getStrokeMiter();
+
+    // the stroke is a union of segment quads, join and cap pieces, all wound
+    // the same way so the nonzero fill covers overlaps once
+    for (auto const &contour : contours_) {
+        polyline_.clear();
+        for (uint32_t i = 0; i < contour.count; i++) {
+            Point p = points_[contour.first + i];
+            if (polyline_.empty() || p.x != polyline_.back().x || p.y != polyline_.back().y) {
+                polyline_.emplace_back(p);
+            }
+        }
+
+        bool closed = contour.closed && polyline_.size() > 2;
+        if (closed && polyline_.front().x == polyline_.back().x &&
+            polyline_.front().y == polyline_.back().y) {
+            polyline_.pop_back();
+        }
+
+        auto n = static_cast<uint32_t>(polyline_.size());
+        if (n < 2) {
+            if (n == 1 && cap == skity::Paint::kRound_Cap) {
+                add_circle(polyline_[0], hw, scale);
+            }
+            continue;
+        }
+
+        uint32_t segments = closed ? n : n - 1;
+        for (uint32_t i = 0; i < segments; i++) {
+            Point a = polyline_[i];
+            Point b = polyline_[(i + 1) % n];
+
+            float len = length(b.x - a.x, b.y - a.y);
+            float dx = (b.x - a.x) / len;
+            float dy = (b.y - a.y) / len;
+
+            if (!closed && cap == skity::Paint::kSquare_Cap) {
+                if (i == 0) {
+                    a = Point{a.x - dx * hw, a.y - dy * hw};
+                }
+                if (i == segments - 1) {
+                    b = Point{b.x + dx * hw, b.y + dy * hw};
+                }
+            }
+
+            float nx = -dy * hw;
+            float ny = dx * hw;
+
+            Point quad[4] = {
+                    {a.x + nx, a.y + ny},
+                    {b.x + nx, b.y + ny},
+                    {b.x - nx, b.y - ny},
+                    {a.x - nx, a.y - ny},
+            };
+            add_polygon(quad, 4);
+        }
+
+        uint32_t first_join = closed ? 0 : 1;
+        uint32_t last_join = closed ? n : n - 1;
+        for (uint32_t j = first_join; j < last_join; j++) {
+            Point p = polyline_[j];
+
+            if (join == skity::Paint::kRound_Join) {
+                add_circle(p, hw, scale);
+                continue;
+            }
+
+            Point prev = polyline_[(j + n - 1) % n];
+            Point next = polyline_[(j + 1) % n];
+
+            float len0 = length(p.x - prev.x, p.y - prev.y);
+            float len1 = length(next.x - p.x, next.y - p.y);
+            float d0x = (p.x - prev.x) / len0;
+            float d0y = (p.y - prev.y) / len0;
+            float d1x = (next.x - p.x) / len1;
+            float d1y = (next.y - p.y) / len1;
+
+            float cross = d0x * d1y - d0y * d1x;
+            if (std::abs(cross) < 1e-6f && d0x * d1x + d0y * d1y > 0.f) {
+                continue;
+            }
+
+            // the outer side of the turn
+            float side = cross > 0.f ? -1.f : 1.f;
+            Point n0{-d0y * hw * side, d0x * hw * side};
+            Point n1{-d1y * hw * side, d1x * hw * side};
+
+            float mx = n0.x + n1.x;
+            float my = n0.y + n1.y;
+            float mlen = length(mx, my);
+            // 1 / cos of half the turn
+            float ratio = mlen > 0.f ? 2.f * hw / mlen : 0.f;
+
+            if (join == skity::Paint::kMiter_Join && mlen > 0.f && ratio <= miter_limit) {
+                float tip = hw * ratio / mlen;
+                Point piece[4] = {
+                        p,
+                        {p.x + n0.x, p.y + n0.y},
+                        {p.x + mx * tip, p.y + my * tip},
+                        {p.x + n1.x, p.y + n1.y},
+                };
+                add_oriented(piece, 4);
+            } else {
+                Point piece[3] = {
+                        p,
+                        {p.x + n0.x, p.y + n0.y},
+                        {p.x + n1.x, p.y + n1.y},
+                };
+                add_oriented(piece, 3);
+            }
+        }
+
+        if (!closed && cap == skity::Paint::kRound_Cap) {
+            add_circle(polyline_.front(), hw, scale);
+            add_circle(polyline_.back(), hw, scale);
+        }
+    }
+}
+
+void TileRasterCanvas::add_circle(Point center, float radius, float scale) {
+    float device_radius = radius * scale;
+
+    // chord error below the tolerance
+    uint32_t n = 6;
+    if (device_radius > kTolerance) {
+        float step = std::acos(1.f - kTolerance / device_radius);
+        n = static_cast<uint32_t>(std::ceil(3.14159265f / step));
+    }
+    n = std::min(std::max(n, 6u), 128u);
+
+    Point circle[128];
+    for (uint32_t i = 0; i < n; i++) {
+        // clockwise like the segment quads
+        float angle = -6.28318531f * i / n;
+        circle[i] = Point{center.x + radius * std::cos(angle), center.y + radius * std::sin(angle)};
+    }
+
+    add_polygon(circle, n);
+}
+
+void TileRasterCanvas::add_oriented(Point const *points, uint32_t count) {
+    float area = 0.f;
+    for (uint32_t i = 0; i < count; i++) {
+        Point const &a = points[i];
+        Point const &b = points[(i + 1) % count];
+        area += a.x * b.y - b.x * a.y;
+    }
+
+    if (area <= 0.f) {
+        add_polygon(points, count);
+        return;
+    }
+
+    Point reversed[4];
+    for (uint32_t i = 0; i < count; i++) {
+        reversed[i] = points[count - 1 - i];
+    }
+    add_polygon(reversed, count);
+}
+
+TileRasterCanvas::Point TileRasterCanvas::transform(Point point) const {
+    auto const &m = states_.back().matrix;
+
+    return Point{m[0][0] * point.x + m[1][0] * point.y + m[3][0],
+                 m[0][1] * point.x + m[1][1] * point.y + m[3][1]};
+}
+
+void TileRasterCanvas::rasterize_tile(uint32_t tile, uint32_t *pixels, size_t row_bytes,
+                                      uint32_t clear_color) {
+    auto x0 = static_cast<int32_t>((tile % tiles_x_) * kTileSize);
+    auto y0 = static_cast<int32_t>((tile / tiles_x_) * kTileSize);
+    auto x1 = std::min(x0 + static_cast<int32_t>(kTileSize), static_cast<int32_t>(width_));
+    auto y1 = std::min(y0 + static_cast<int32_t>(kTileSize), static_cast<int32_t>(height_));
+
+    for (int32_t y = y0; y < y1; y++) {
+        auto row = reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(pixels) +
+                                                y * row_bytes);
+        std::fill(row + x0, row + x1, clear_color);
+    }
+
+    for (uint32_t index : bins_[tile]) {
+        auto const &draw = draws_[index];
+
+        int32_t left = std::max(x0, static_cast<int32_t>(std::floor(draw.left)));
+        int32_t top = std::max(y0, static_cast<int32_t>(std::floor(draw.top)));
+        int32_t right = std::min(x1, static_cast<int32_t>(std::ceil(draw.right)));
+        int32_t bottom = std::min(y1, static_cast<int32_t>(std::ceil(draw.bottom)));
+
+        if (right > left && bottom > top) {
+            rasterize_draw(draw, left, top, right, bottom, pixels, row_bytes);
+        }
+    }
+}
+
+void TileRasterCanvas::rasterize_draw(Draw const &draw, int32_t x0, int32_t y0, int32_t x1,
+                                      int32_t y1, uint32_t *pixels, size_t row_bytes) {
+    auto &scratch = tls_scratch;
+    int32_t width = x1 - x0;
+
+    scratch.region_edges.clear();
+    for (uint32_t i = draw.first_edge; i < draw.first_edge + draw.edge_count; i++) {
+        if (edges_[i].y1 > y0 && edges_[i].y0 < y1) {
+            scratch.region_edges.emplace_back(i);
+        }
+    }
+    std::sort(scratch.region_edges.begin(), scratch.region_edges.end(),
+              [this](uint32_t a, uint32_t b) { return edges_[a].y0 < edges_[b].y0; });
+
+    scratch.full.resize(width + 1);
+    scratch.partial.resize(width);
+    scratch.coverage.resize(width);
+    scratch.row_edges.clear();
+
+    // coverage of one sub-scanline over a whole pixel
+    constexpr float kUnit = 256.f / kSubScanlines;
+
+    auto add_span = [&scratch, x0, x1, width](float xa, float xb) {
+        float a = std::max(xa, static_cast<float>(x0)) - x0;
+        float b = std::min(xb, static_cast<float>(x1)) - x0;
+        if (b <= a) {
+            return;
+        }
+
+        auto ia = static_cast<int32_t>(a);
+        auto ib = static_cast<int32_t>(b);
+        if (ia == ib) {
+            scratch.partial[ia] += (b - a) * kUnit;
+            return;
+        }
+
+        scratch.partial[ia] += (ia + 1 - a) * kUnit;
+        scratch.full[ia + 1] += static_cast<int32_t>(kUnit);
+        scratch.full[ib] -= static_cast<int32_t>(kUnit);
+        if (ib < width) {
+            scratch.partial[ib] += (b - ib) * kUnit;
+        }
+    };
+
+    size_t next_edge = 0;
+    for (int32_t y = y0; y < y1; y++) {
+        while (next_edge < scratch.region_edges.size() &&
+               edges_[scratch.region_edges[next_edge]].y0 < y + 1) {
+            scratch.row_edges.emplace_back(scratch.region_edges[next_edge++]);
+        }
+        scratch.row_edges.erase(
+                std::remove_if(scratch.row_edges.begin(), scratch.row_edges.end(),
+                               [this, y](uint32_t e) { return edges_[e].y1 <= y; }),
+                scratch.row_edges.end());
+
+        if (scratch.row_edges.empty()) {
+            continue;
+        }
+
+        std::fill(scratch.full.begin(), scratch.full.end(), 0);
+        std::fill(scratch.partial.begin(), scratch.partial.end(), 0.f);
+
+        for (uint32_t s = 0; s < kSubScanlines; s++) {
+            float sy = y + (s + 0.5f) / kSubScanlines;
+
+            scratch.crossings.clear();
+            for (uint32_t e : scratch.row_edges) {
+                auto const &edge = edges_[e];
+                if (sy >= edge.y0 && sy < edge.y1) {
+                    scratch.crossings.emplace_back(
+                            Crossing{edge.x0 + (sy - edge.y0) * edge.dxdy, edge.winding});
+                }
+            }
+
+            if (scratch.crossings.size() < 2) {
+                continue;
+            }
+
+            std::sort(scratch.crossings.begin(), scratch.crossings.end(),
+                      [](Crossing const &a, Crossing const &b) { return a.x < b.x; });
+
+            int32_t winding = 0;
+            for (size_t k = 0; k + 1 < scratch.crossings.size(); k++) {
+                winding += scratch.crossings[k].winding;
+                bool inside = draw.even_odd ? (winding & 1) != 0 : winding != 0;
+                if (inside) {
+                    add_span(scratch.crossings[k].x, scratch.crossings[k + 1].x);
+                }
+            }
+        }
+
+        int32_t run = 0;
+        for (int32_t x = 0; x < width; x++) {
+            run += scratch.full[x];
+            auto value = run + static_cast<int32_t>(scratch.partial[x] + 0.5f);
+            scratch.coverage[x] = static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+        }
+
+        auto row = reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(pixels) +
+                                                y * row_bytes) + x0;
+        uint8_t const *coverage = scratch.coverage.data();
+
+        int32_t x = 0;
+        while (x < width) {
+            if (coverage[x] == 0) {
+                x++;
+                continue;
+            }
+
+            int32_t end = x + 1;
+            if (coverage[x] == 255) {
+                while (end < width && coverage[end] == 255) {
+                    end++;
+                }
+                blend_span_opaque(row + x, end - x, draw.color);
+            } else {
+                while (end < width && coverage[end] != 0 && coverage[end] != 255) {
+                    end++;
+                }
+                blend_span(row + x, coverage + x, end - x, draw.color);
+            }
+            x = end;
+        }
+    }
+}
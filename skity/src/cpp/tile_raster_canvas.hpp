@@ -0,0 +1,187 @@
+
+#ifndef SKITY_ANDROID_TILE_RASTER_CANVAS_HPP
+#define SKITY_ANDROID_TILE_RASTER_CANVAS_HPP
+
+#include <skity/skity.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "work_stealing_pool.hpp"
+
+struct TileRasterStats {
+    uint32_t draws = {};
+    uint32_t edges = {};
+    // draws that lost their shader or were skipped, like text
+    uint32_t unsupported = {};
+    uint32_t tiles = {};
+    // draws rasterized summed over all tiles
+    uint32_t tile_draws = {};
+};
+
+/**
+ * Canvas rasterizing on the CPU, without any GPU context.
+ *
+ * Draws are flattened to line edges in device space and recorded. rasterize()
+ * bins them into kTileSize squares and fills the tiles in parallel, each tile
+ * runs the draws touching it in order. Coverage is exact horizontally and
+ * sampled on kSubScanlines rows per pixel.
+ *
+ * Only solid colors are filled: shaders fall back to the paint color, text is
+ * skipped and path clips clip to their bounds.
+ */
+class TileRasterCanvas : public skity::Canvas {
+public:
+    static constexpr uint32_t kTileSize = 64;
+    static constexpr uint32_t kSubScanlines = 4;
+
+    TileRasterCanvas(uint32_t width, uint32_t height);
+
+    ~TileRasterCanvas() override = default;
+
+    /**
+     * Drop everything recorded, the buffers keep their capacity.
+     */
+    void reset();
+
+    /**
+     * Device space bounds of everything recorded, not limited to the canvas.
+     */
+    skity::Rect ContentBounds() const;
+
+    /**
+     * Scale and move everything recorded so ContentBounds() is centered in
+     * dst, keeping the aspect ratio. For content without a known size.
+     */
+    void fit_content(skity::Rect const &dst);
+
+    /**
+     * @param pixels        premultiplied RGBA8, Width() x Height()
+     * @param clear_color   premultiplied, see premultiply_color()
+     */
+    void rasterize(WorkStealingPool *pool, uint32_t *pixels, size_t row_bytes,
+                   uint32_t clear_color);
+
+    TileRasterStats const &Stats() const { return stats_; }
+
+protected:
+    void onClipPath(skity::Path const &path, ClipOp op) override;
+
+    void onDrawPath(skity::Path const &path, skity::Paint const &paint) override;
+
+    void onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                    skity::Paint const &paint) override;
+
+    void onSave() override;
+
+    void onRestore() override;
+
+    void onTranslate(float dx, float dy) override;
+
+    void onScale(float sx, float sy) override;
+
+    void onRotate(float degree) override;
+
+    void onRotate(float degree, float px, float py) override;
+
+    void onConcat(skity::Matrix const &matrix) override;
+
+    void onFlush() override {}
+
+    uint32_t onGetWidth() const override { return width_; }
+
+    uint32_t onGetHeight() const override { return height_; }
+
+    void onUpdateViewport(uint32_t width, uint32_t height) override;
+
+private:
+    struct Point {
+        float x = {};
+        float y = {};
+    };
+
+    // y0 < y1, winding is the direction it was drawn in
+    struct Edge {
+        float x0 = {};
+        float y0 = {};
+        float x1 = {};
+        float y1 = {};
+        float dxdy = {};
+        int32_t winding = {};
+    };
+
+    struct Draw {
+        uint32_t first_edge = {};
+        uint32_t edge_count = {};
+        // device space, already clipped
+        float left = {};
+        float top = {};
+        float right = {};
+        float bottom = {};
+        uint32_t color = {};
+        bool even_odd = {};
+    };
+
+    struct State {
+        skity::Matrix matrix = skity::Matrix(1.f);
+        // device space
+        skity::Rect clip = {};
+    };
+
+    // polyline of one contour in local space
+    struct Contour {
+        uint32_t first = {};
+        uint32_t count = {};
+        bool closed = {};
+    };
+
+    void flatten(skity::Path const &path, float tolerance);
+
+    void begin_draw();
+
+    /**
+     * Record the edges added since begin_draw() as one draw, unless it is
+     * clipped away or transparent.
+     */
+    void end_draw(uint32_t color, bool even_odd);
+
+    void add_polygon(Point const *points, uint32_t count);
+
+    void add_fill();
+
+    void add_stroke(skity::Paint const &paint, float scale);
+
+    void add_circle(Point center, float radius, float scale);
+
+    void add_oriented(Point const *points, uint32_t count);
+
+    Point transform(Point point) const;
+
+    void rasterize_tile(uint32_t tile, uint32_t *pixels, size_t row_bytes, uint32_t clear_color);
+
+    void rasterize_draw(Draw const &draw, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                        uint32_t *pixels, size_t row_bytes);
+
+private:
+    uint32_t width_ = {};
+    uint32_t height_ = {};
+    std::vector<State> states_ = {};
+    std::vector<Edge> edges_ = {};
+    std::vector<Draw> draws_ = {};
+    // recording scratch
+    std::vector<Point> points_ = {};
+    std::vector<Contour> contours_ = {};
+    std::vector<Point> polyline_ = {};
+    // the draw edges are added to
+    uint32_t draw_first_edge_ = {};
+    float draw_left_ = {};
+    float draw_top_ = {};
+    float draw_right_ = {};
+    float draw_bottom_ = {};
+    uint32_t tiles_x_ = {};
+    uint32_t tiles_y_ = {};
+    std::vector<std::vector<uint32_t>> bins_ = {};
+    TileRasterStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_TILE_RASTER_CANVAS_HPP
@@ -0,0 +1,14 @@
+
+#ifndef SKITY_ANDROID_VK_IMAGE_HPP
+#define SKITY_ANDROID_VK_IMAGE_HPP
+
+#include <volk.h>
+
+struct ImageWrapper {
+    VkImage image = {};
+    VkImageView image_view = {};
+    VkDeviceMemory memory = {};
+    VkFormat format = {};
+};
+
+#endif //SKITY_ANDROID_VK_IMAGE_HPP
@@ -0,0 +1,161 @@
+
+#include "vk_memory_tracker.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static VKAPI_ATTR VkResult VKAPI_CALL tracked_allocate_memory(
+        VkDevice device, const VkMemoryAllocateInfo *info, const VkAllocationCallbacks *allocator,
+        VkDeviceMemory *memory) {
+    return VkMemoryTracker::Instance().allocate(device, info, VkMemoryCategory::kSkity, memory);
+}
+
+static VKAPI_ATTR void VKAPI_CALL tracked_free_memory(VkDevice device, VkDeviceMemory memory,
+                                                      const VkAllocationCallbacks *allocator) {
+    VkMemoryTracker::Instance().free(device, memory);
+}
+
+/**
+ * Hooks for the functions Skity loads, nullptr for everything else.
+ */
+static PFN_vkVoidFunction find_hook(const char *name) {
+    if (std::strcmp(name, "vkAllocateMemory") == 0) {
+        return (PFN_vkVoidFunction) tracked_allocate_memory;
+    }
+    if (std::strcmp(name, "vkFreeMemory") == 0) {
+        return (PFN_vkVoidFunction) tracked_free_memory;
+    }
+    if (std::strcmp(name, "vkGetDeviceProcAddr") == 0) {
+        return (PFN_vkVoidFunction) VkMemoryTracker::GetDeviceProcAddr;
+    }
+    if (std::strcmp(name, "vkGetInstanceProcAddr") == 0) {
+        return (PFN_vkVoidFunction) VkMemoryTracker::GetInstanceProcAddr;
+    }
+    return nullptr;
+}
+
+VkMemoryTracker &VkMemoryTracker::Instance() {
+    static VkMemoryTracker tracker;
+    return tracker;
+}
+
+void VkMemoryTracker::init(VkPhysicalDevice phy_device, bool memory_budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    phy_device_ = phy_device;
+    // vkGetPhysicalDeviceMemoryProperties2 is core in 1.1, the instance asks for it
+    memory_budget_ = memory_budget && vkGetPhysicalDeviceMemoryProperties2 != nullptr;
+    vkGetPhysicalDeviceMemoryProperties(phy_device_, &memory_properties_);
+}
+
+VkResult VkMemoryTracker::allocate(VkDevice device, VkMemoryAllocateInfo const *info,
+                                   VkMemoryCategory category, VkDeviceMemory *memory) {
+    VkResult result = vkAllocateMemory(device, info, nullptr, memory);
+    if (result == VK_SUCCESS) {
+        record(info, category, *memory);
+    }
+
+    return result;
+}
+
+void VkMemoryTracker::free(VkDevice device, VkDeviceMemory memory) {
+    if (memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = allocations_.find(memory);
+        if (it != allocations_.end()) {
+            auto &usage = usage_[static_cast<size_t>(it->second.category)];
+            usage.bytes -= it->second.size;
+            usage.allocations--;
+            heap_usage_[it->second.heap] -= it->second.size;
+
+            allocations_.erase(it);
+        }
+    }
+
+    vkFreeMemory(device, memory, nullptr);
+}
+
+void VkMemoryTracker::record(VkMemoryAllocateInfo const *info, VkMemoryCategory category,
+                             VkDeviceMemory memory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint32_t heap = 0;
+    if (info->memoryTypeIndex < memory_properties_.memoryTypeCount) {
+        heap = memory_properties_.memoryTypes[info->memoryTypeIndex].heapIndex;
+    }
+
+    allocations_[memory] = Allocation{info->allocationSize, heap, category};
+
+    auto &usage = usage_[static_cast<size_t>(category)];
+    usage.bytes += info->allocationSize;
+    usage.allocations++;
+    heap_usage_[heap] += info->allocationSize;
+}
+
+std::array<VkCategoryUsage, static_cast<size_t>(VkMemoryCategory::kCount)>
+VkMemoryTracker::Usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return usage_;
+}
+
+std::vector<VkHeapBudget> VkMemoryTracker::QueryHeapBudgets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<VkHeapBudget> heaps(memory_properties_.memoryHeapCount);
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_props{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT};
+    if (memory_budget_) {
+        VkPhysicalDeviceMemoryProperties2 props{
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2};
+        props.pNext = &budget_props;
+        vkGetPhysicalDeviceMemoryProperties2(phy_device_, &props);
+    }
+
+    for (uint32_t i = 0; i < heaps.size(); i++) {
+        heaps[i].size = memory_properties_.memoryHeaps[i].size;
+        heaps[i].flags = memory_properties_.memoryHeaps[i].flags;
+
+        if (memory_budget_) {
+            heaps[i].budget = budget_props.heapBudget[i];
+            heaps[i].usage = budget_props.heapUsage[i];
+        } else {
+            heaps[i].budget = static_cast<VkDeviceSize>(heaps[i].size * kFallbackBudgetRatio);
+            heaps[i].usage = heap_usage_[i];
+        }
+    }
+
+    return heaps;
+}
+
+float VkMemoryTracker::QueryPressure() const {
+    float pressure = 0.f;
+
+    for (auto const &heap : QueryHeapBudgets()) {
+        if (heap.budget > 0) {
+            pressure = std::max(pressure, static_cast<float>(heap.usage) / heap.budget);
+        }
+    }
+
+    return pressure;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL VkMemoryTracker::GetDeviceProcAddr(VkDevice device,
+                                                                          const char *name) {
+    auto hook = find_hook(name);
+
+    return hook ? hook : vkGetDeviceProcAddr(device, name);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL VkMemoryTracker::GetInstanceProcAddr(VkInstance instance,
+                                                                            const char *name) {
+    auto hook = find_hook(name);
+
+    return hook ? hook : vkGetInstanceProcAddr(instance, name);
+}
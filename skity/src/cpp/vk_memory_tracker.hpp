@@ -0,0 +1,113 @@
+
+#ifndef SKITY_ANDROID_VK_MEMORY_TRACKER_HPP
+#define SKITY_ANDROID_VK_MEMORY_TRACKER_HPP
+
+#include <volk.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum class VkMemoryCategory : uint32_t {
+    // MSAA, stencil and scaled render targets of VkRenderer and VkRenderTargetPool
+    kAttachment,
+    // images uploaded through VkTextureUploader
+    kTexture,
+    // staging ring and dedicated upload buffers
+    kStaging,
+    // everything Skity allocates, font atlases, vertex buffers and its own textures
+    kSkity,
+    kCount,
+};
+
+struct VkCategoryUsage {
+    uint64_t bytes = {};
+    uint64_t allocations = {};
+};
+
+struct VkHeapBudget {
+    VkDeviceSize size = {};
+    // what the process may use before the driver or the OOM killer steps in
+    VkDeviceSize budget = {};
+    VkDeviceSize usage = {};
+    VkMemoryHeapFlags flags = {};
+};
+
+/**
+ * Process wide accounting of VkDeviceMemory.
+ *
+ * Wrapper code allocates through allocate()/free() with a category. Skity is
+ * handed GetDeviceProcAddr/GetInstanceProcAddr, which resolve vkAllocateMemory
+ * and vkFreeMemory to hooks that book its allocations as kSkity.
+ *
+ * Heap budget and usage come from VK_EXT_memory_budget when the device has
+ * it, they include memory of the driver and of other APIs. Without it usage
+ * is what was booked here and the budget a fixed share of the heap.
+ */
+class VkMemoryTracker {
+public:
+    // share of a heap used as budget without VK_EXT_memory_budget
+    static constexpr float kFallbackBudgetRatio = 0.8f;
+
+    static VkMemoryTracker &Instance();
+
+    /**
+     * @param memory_budget VK_EXT_memory_budget is enabled on the device
+     */
+    void init(VkPhysicalDevice phy_device, bool memory_budget);
+
+    VkResult allocate(VkDevice device, VkMemoryAllocateInfo const *info,
+                      VkMemoryCategory category, VkDeviceMemory *memory);
+
+    /**
+     * Free memory from allocate() or a hooked vkAllocateMemory, null is
+     * ignored.
+     */
+    void free(VkDevice device, VkDeviceMemory memory);
+
+    std::array<VkCategoryUsage, static_cast<size_t>(VkMemoryCategory::kCount)> Usage() const;
+
+    /**
+     * Budget and usage of every device heap, queried on each call.
+     */
+    std::vector<VkHeapBudget> QueryHeapBudgets() const;
+
+    /**
+     * Highest usage / budget ratio over all heaps, above 1 allocations start
+     * to hurt.
+     */
+    float QueryPressure() const;
+
+    bool HasMemoryBudget() const { return memory_budget_; }
+
+    static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice device,
+                                                                      const char *name);
+
+    static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetInstanceProcAddr(VkInstance instance,
+                                                                        const char *name);
+
+private:
+    struct Allocation {
+        VkDeviceSize size = {};
+        uint32_t heap = {};
+        VkMemoryCategory category = {};
+    };
+
+    VkMemoryTracker() = default;
+
+    void record(VkMemoryAllocateInfo const *info, VkMemoryCategory category,
+                VkDeviceMemory memory);
+
+private:
+    VkPhysicalDevice phy_device_ = {};
+    bool memory_budget_ = {};
+    VkPhysicalDeviceMemoryProperties memory_properties_ = {};
+    mutable std::mutex mutex_ = {};
+    std::unordered_map<VkDeviceMemory, Allocation> allocations_ = {};
+    std::array<VkCategoryUsage, static_cast<size_t>(VkMemoryCategory::kCount)> usage_ = {};
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heap_usage_ = {};
+};
+
+#endif //SKITY_ANDROID_VK_MEMORY_TRACKER_HPP
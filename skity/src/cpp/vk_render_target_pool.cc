@@ -0,0 +1,373 @@
+
+#include "vk_render_target_pool.hpp"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+
+#include "vk_memory_tracker.hpp"
+
+constexpr uint32_t VkRenderTargetPool::kMaxIdleFrames;
+constexpr float VkRenderTargetPool::kTrimPressure;
+
+void VkRenderTargetPool::init(VkDevice device, VkPhysicalDevice phy_device,
+                              VkFormat depth_stencil_format) {
+    device_ = device;
+    depth_stencil_format_ = depth_stencil_format;
+
+    vkGetPhysicalDeviceMemoryProperties(phy_device, &memory_properties_);
+}
+
+void VkRenderTargetPool::destroy() {
+    for (auto &entry : entries_) {
+        destroy_target(entry.target.get());
+    }
+    entries_.clear();
+    idle_count_ = 0;
+
+    for (auto const &pass : passes_) {
+        vkDestroyRenderPass(device_, pass.render_pass, nullptr);
+    }
+    passes_.clear();
+
+    update_stats();
+}
+
+VkRenderPass VkRenderTargetPool::GetRenderPass(VkFormat format, VkSampleCountFlagBits samples) {
+    for (auto const &pass : passes_) {
+        if (pass.format == format && pass.samples == samples) {
+            return pass.render_pass;
+        }
+    }
+
+    bool multisampled = samples != VK_SAMPLE_COUNT_1_BIT;
+
+    // same attachments as the VkRenderer pass, only the layouts differ
+    std::array<VkAttachmentDescription, 3> attachments = {};
+    attachments[0].format = format;
+    attachments[0].samples = samples;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+                                          : VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[0].finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                                              : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    attachments[1].format = depth_stencil_format_;
+    attachments[1].samples = samples;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    attachments[2].format = format;
+    attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[2].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkAttachmentReference color_reference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    VkAttachmentReference depth_stencil_reference{
+            1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+    VkAttachmentReference resolve_reference{2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &color_reference;
+    subpass.pDepthStencilAttachment = &depth_stencil_reference;
+    subpass.pResolveAttachments = multisampled ? &resolve_reference : nullptr;
+
+    std::array<VkSubpassDependency, 2> dependencies{};
+    // an earlier use of the recycled target may still be sampling it
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    // the result is sampled or blitted from afterwards
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkRenderPassCreateInfo create_info{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    create_info.attachmentCount = multisampled ? attachments.size() : 2;
+    create_info.pAttachments = attachments.data();
+    create_info.subpassCount = 1;
+    create_info.pSubpasses = &subpass;
+    create_info.dependencyCount = dependencies.size();
+    create_info.pDependencies = dependencies.data();
+
+    Pass pass;
+    pass.format = format;
+    pass.samples = samples;
+    if (vkCreateRenderPass(device_, &create_info, nullptr, &pass.render_pass) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK",
+                            "failed to create offscreen render pass");
+        return VK_NULL_HANDLE;
+    }
+
+    passes_.emplace_back(pass);
+
+    return pass.render_pass;
+}
+
+VkRenderTarget *VkRenderTargetPool::acquire(VkRenderTargetKey const &key) {
+    for (auto &entry : entries_) {
+        if (entry.in_use || entry.serial > completed_ || !(entry.target->key == key)) {
+            continue;
+        }
+
+        entry.in_use = true;
+        entry.idle_frames = 0;
+        idle_count_--;
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.reused++;
+        }
+        update_stats();
+
+        return entry.target.get();
+    }
+
+    Entry entry;
+    entry.target = std::make_unique<VkRenderTarget>();
+    if (!create_target(key, entry.target.get())) {
+        destroy_target(entry.target.get());
+        return nullptr;
+    }
+    entry.in_use = true;
+
+    VkRenderTarget *target = entry.target.get();
+    entries_.emplace_back(std::move(entry));
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.created++;
+    }
+    update_stats();
+
+    return target;
+}
+
+void VkRenderTargetPool::release(VkRenderTarget *target, uint64_t serial) {
+    for (auto &entry : entries_) {
+        if (entry.target.get() != target) {
+            continue;
+        }
+
+        if (entry.in_use) {
+            entry.in_use = false;
+            entry.serial = serial;
+            entry.idle_frames = 0;
+            idle_count_++;
+        }
+        break;
+    }
+
+    update_stats();
+}
+
+void VkRenderTargetPool::collect(uint64_t completed_serial) {
+    completed_ = std::max(completed_, completed_serial);
+}
+
+void VkRenderTargetPool::trim(float pressure) {
+    if (idle_count_ == 0) {
+        return;
+    }
+
+    bool over_budget = pressure > kTrimPressure;
+    uint64_t trimmed = 0;
+
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->in_use || it->serial > completed_) {
+            ++it;
+            continue;
+        }
+
+        if (!over_budget && ++it->idle_frames <= kMaxIdleFrames) {
+            ++it;
+            continue;
+        }
+
+        destroy_target(it->target.get());
+        it = entries_.erase(it);
+        idle_count_--;
+        trimmed++;
+    }
+
+    if (trimmed == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.trimmed += trimmed;
+    }
+    update_stats();
+}
+
+VkRenderTargetPoolStats VkRenderTargetPool::Stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+
+    return stats_;
+}
+
+bool VkRenderTargetPool::create_target(VkRenderTargetKey const &key, VkRenderTarget *target) {
+    target->key = key;
+
+    VkRenderPass render_pass = GetRenderPass(key.format, key.samples);
+    if (render_pass == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    bool multisampled = key.samples != VK_SAMPLE_COUNT_1_BIT;
+
+    if (!create_image(key, key.format, VK_SAMPLE_COUNT_1_BIT,
+                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                      VK_IMAGE_ASPECT_COLOR_BIT, &target->color, &target->bytes)) {
+        return false;
+    }
+
+    if (multisampled &&
+        !create_image(key, key.format, key.samples,
+                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+                      VK_IMAGE_ASPECT_COLOR_BIT, &target->msaa, &target->bytes)) {
+        return false;
+    }
+
+    if (!create_image(key, depth_stencil_format_, key.samples,
+                      VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                      VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT,
+                      &target->depth_stencil, &target->bytes)) {
+        return false;
+    }
+
+    std::array<VkImageView, 3> attachments = {
+            multisampled ? target->msaa.image_view : target->color.image_view,
+            target->depth_stencil.image_view,
+            target->color.image_view,
+    };
+
+    VkFramebufferCreateInfo create_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+    create_info.renderPass = render_pass;
+    create_info.attachmentCount = multisampled ? attachments.size() : 2;
+    create_info.pAttachments = attachments.data();
+    create_info.width = key.width;
+    create_info.height = key.height;
+    create_info.layers = 1;
+
+    return vkCreateFramebuffer(device_, &create_info, nullptr, &target->framebuffer) ==
+           VK_SUCCESS;
+}
+
+bool VkRenderTargetPool::create_image(VkRenderTargetKey const &key, VkFormat format,
+                                      VkSampleCountFlagBits samples, VkImageUsageFlags usage,
+                                      VkImageAspectFlags aspect, ImageWrapper *image,
+                                      VkDeviceSize *bytes) {
+    VkImageCreateInfo image_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = format;
+    image_info.extent = {key.width, key.height, 1};
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = samples;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = usage;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(device_, &image_info, nullptr, &image->image) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements mem_reqs{};
+    vkGetImageMemoryRequirements(device_, image->image, &mem_reqs);
+
+    VkMemoryAllocateInfo mem_alloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mem_alloc.allocationSize = mem_reqs.size;
+    mem_alloc.memoryTypeIndex = get_memory_type(mem_reqs.memoryTypeBits,
+                                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (VkMemoryTracker::Instance().allocate(device_, &mem_alloc, VkMemoryCategory::kAttachment,
+                                             &image->memory) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK",
+                            "out of memory for a %u x %u render target", key.width, key.height);
+        return false;
+    }
+    vkBindImageMemory(device_, image->image, image->memory, 0);
+    *bytes += mem_reqs.size;
+
+    VkImageViewCreateInfo view_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    view_info.image = image->image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = aspect;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.layerCount = 1;
+
+    image->format = format;
+
+    return vkCreateImageView(device_, &view_info, nullptr, &image->image_view) == VK_SUCCESS;
+}
+
+void VkRenderTargetPool::destroy_target(VkRenderTarget *target) {
+    vkDestroyFramebuffer(device_, target->framebuffer, nullptr);
+
+    for (auto image : {&target->color, &target->msaa, &target->depth_stencil}) {
+        vkDestroyImageView(device_, image->image_view, nullptr);
+        vkDestroyImage(device_, image->image, nullptr);
+        VkMemoryTracker::Instance().free(device_, image->memory);
+        *image = {};
+    }
+
+    target->framebuffer = VK_NULL_HANDLE;
+    target->bytes = 0;
+}
+
+void VkRenderTargetPool::update_stats() {
+    uint64_t bytes = 0;
+    for (auto const &entry : entries_) {
+        bytes += entry.target->bytes;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.live = static_cast<uint32_t>(entries_.size());
+    stats_.idle = idle_count_;
+    stats_.bytes = bytes;
+}
+
+uint32_t VkRenderTargetPool::get_memory_type(uint32_t type_bits,
+                                             VkMemoryPropertyFlags properties) {
+    for (uint32_t i = 0; i < memory_properties_.memoryTypeCount; i++) {
+        if ((type_bits & 1) == 1) {
+            if ((memory_properties_.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+
+        type_bits >>= 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+
+#ifndef SKITY_ANDROID_VK_RENDER_TARGET_POOL_HPP
+#define SKITY_ANDROID_VK_RENDER_TARGET_POOL_HPP
+
+#include <volk.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "vk_image.hpp"
+
+struct VkRenderTargetKey {
+    uint32_t width = {};
+    uint32_t height = {};
+    VkFormat format = {};
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    bool operator==(VkRenderTargetKey const &other) const {
+        return width == other.width && height == other.height && format == other.format &&
+               samples == other.samples;
+    }
+};
+
+/**
+ * Offscreen color target with its own depth stencil attachment. When
+ * multisampled the pass renders into msaa and resolves into color.
+ */
+struct VkRenderTarget {
+    VkRenderTargetKey key = {};
+    // single sampled result, can be sampled or blitted from after the pass
+    ImageWrapper color = {};
+    ImageWrapper msaa = {};
+    ImageWrapper depth_stencil = {};
+    VkFramebuffer framebuffer = {};
+    VkDeviceSize bytes = {};
+};
+
+struct VkRenderTargetPoolStats {
+    uint64_t created = {};
+    uint64_t reused = {};
+    uint64_t trimmed = {};
+    // targets alive, in use or idle
+    uint32_t live = {};
+    uint32_t idle = {};
+    // device memory of the live targets
+    uint64_t bytes = {};
+};
+
+/**
+ * Recycles offscreen render targets instead of allocating them per use.
+ *
+ * Targets are keyed by size, color format and sample count. A released target
+ * goes back into the pool with the graphic timeline value of the last
+ * submission that used it and is handed out again once collect() saw that
+ * value complete. Idle targets are freed after kMaxIdleFrames frames, or all
+ * at once when the heaps run close to their budget.
+ *
+ * The render pass of each format and sample count has the attachment layout
+ * of the VkRenderer pass, so the framebuffers and the canvas pipelines of one
+ * work with the other.
+ *
+ * Everything but Stats() is called on the render thread.
+ */
+class VkRenderTargetPool {
+public:
+    // frames an idle target is kept for
+    static constexpr uint32_t kMaxIdleFrames = 180;
+    // heap usage / budget above which every idle target is freed
+    static constexpr float kTrimPressure = 0.9f;
+
+    VkRenderTargetPool() = default;
+
+    ~VkRenderTargetPool() = default;
+
+    void init(VkDevice device, VkPhysicalDevice phy_device, VkFormat depth_stencil_format);
+
+    /**
+     * The device has to be idle.
+     */
+    void destroy();
+
+    /**
+     * Clears all attachments and leaves color in SHADER_READ_ONLY_OPTIMAL.
+     */
+    VkRenderPass GetRenderPass(VkFormat format, VkSampleCountFlagBits samples);
+
+    /**
+     * @return a target that is not used by the GPU anymore, null if it could
+     *         not be allocated
+     */
+    VkRenderTarget *acquire(VkRenderTargetKey const &key);
+
+    /**
+     * @param serial graphic timeline value of the last submission using target
+     */
+    void release(VkRenderTarget *target, uint64_t serial);
+
+    /**
+     * Released targets up to completed_serial can be acquired again.
+     */
+    void collect(uint64_t completed_serial);
+
+    /**
+     * Call once per frame with VkMemoryTracker::QueryPressure(), skipped
+     * while nothing is idle.
+     */
+    void trim(float pressure);
+
+    bool HasIdle() const { return idle_count_ > 0; }
+
+    /**
+     * Can be called from any thread.
+     */
+    VkRenderTargetPoolStats Stats() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<VkRenderTarget> target = {};
+        bool in_use = {};
+        // graphic timeline value the last use completes at
+        uint64_t serial = {};
+        uint32_t idle_frames = {};
+    };
+
+    struct Pass {
+        VkFormat format = {};
+        VkSampleCountFlagBits samples = {};
+        VkRenderPass render_pass = {};
+    };
+
+    bool create_target(VkRenderTargetKey const &key, VkRenderTarget *target);
+
+    bool create_image(VkRenderTargetKey const &key, VkFormat format,
+                      VkSampleCountFlagBits samples, VkImageUsageFlags usage,
+                      VkImageAspectFlags aspect, ImageWrapper *image, VkDeviceSize *bytes);
+
+    void destroy_target(VkRenderTarget *target);
+
+    void update_stats();
+
+    uint32_t get_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties);
+
+private:
+    VkDevice device_ = {};
+    VkPhysicalDeviceMemoryProperties memory_properties_ = {};
+    VkFormat depth_stencil_format_ = {};
+    std::vector<Pass> passes_ = {};
+    std::vector<Entry> entries_ = {};
+    uint64_t completed_ = {};
+    uint32_t idle_count_ = {};
+    mutable std::mutex stats_mutex_ = {};
+    VkRenderTargetPoolStats stats_ = {};
+};
+
+#endif //SKITY_ANDROID_VK_RENDER_TARGET_POOL_HPP
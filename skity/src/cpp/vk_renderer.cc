@@ -6,6 +6,7 @@
 #include <cassert>
 #include <set>
 #include <limits>
+#include <algorithm>
 
 static const char *kTAG = "SkityVK";
 #define LOGI(...) \
@@ -32,10 +33,14 @@ static const char *kTAG = "SkityVK";
  */
 static const char *kValLayerName = "VK_LAYER_KHRONOS_validation";
 
+static VkSampleCountFlags get_usable_sample_counts(VkPhysicalDeviceProperties props) {
+    return props.limits.framebufferColorSampleCounts &
+           props.limits.framebufferStencilSampleCounts;
+}
+
 static VkSampleCountFlagBits get_max_usable_sample_count(
         VkPhysicalDeviceProperties props) {
-    VkSampleCountFlags counts = props.limits.framebufferColorSampleCounts &
-                                props.limits.framebufferStencilSampleCounts;
+    VkSampleCountFlags counts = get_usable_sample_counts(props);
 
     if (counts & VK_SAMPLE_COUNT_64_BIT) return VK_SAMPLE_COUNT_64_BIT;
     if (counts & VK_SAMPLE_COUNT_32_BIT) return VK_SAMPLE_COUNT_32_BIT;
@@ -99,22 +104,40 @@ static bool get_support_depth_format(VkPhysicalDevice phy_devce,
     return false;
 }
 
+// FNV-1a, cheap next to recording the canvas the hash saves
+static uint64_t hash_bytes(uint64_t hash, void const *data, size_t size) {
+    auto bytes = static_cast<uint8_t const *>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
 void VkRenderer::init(int w, int h, int d, ANativeWindow *window) {
     width_ = w;
     height_ = h;
     density_ = d;
     window_ = window;
     init_vk(window);
-    this->proc_loader = (void *) vkGetDeviceProcAddr;
+    // Skity loads vkAllocateMemory through this, the tracker books it as kSkity
+    this->proc_loader = (void *) VkMemoryTracker::GetDeviceProcAddr;
     canvas_ = skity::Canvas::MakeHardwareAccelationCanvas(width_, height_, density_, this);
 }
 
 void VkRenderer::destroy() {
+    // a pending vsync must not draw into the destroyed swapchain
+    frame_loop_.reset();
+
     vkDeviceWaitIdle(vk_device_);
 
     canvas_.reset();
 
+    texture_uploader_.destroy();
+
     destroy_swap_chain_views();
+    render_target_pool_.destroy();
 
     vkDestroyRenderPass(vk_device_, vk_render_pass_, nullptr);
     vk_render_pass_ = VK_NULL_HANDLE;
@@ -129,10 +152,9 @@ void VkRenderer::destroy() {
     }
     render_semaphore_.clear();
 
-    for (auto fence : cmd_fences_) {
-        vkDestroyFence(vk_device_, fence, nullptr);
-    }
-    cmd_fences_.clear();
+    graphic_timeline_.destroy();
+    cmd_serial_.clear();
+    command_reuse_.reset(0);
 
     vkResetCommandPool(vk_device_, cmd_pool_, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
     vkDestroyCommandPool(vk_device_, cmd_pool_, nullptr);
@@ -154,9 +176,18 @@ void VkRenderer::destroy() {
 }
 
 void VkRenderer::draw() {
+    frame_clock_.begin_frame();
+
+    // only block until the last submission of this slot, later frames keep running
+    graphic_timeline_.wait(cmd_serial_[frame_index_]);
+
+    texture_uploader_.collect(graphic_timeline_.Completed());
+    render_target_pool_.collect(graphic_timeline_.Completed());
+    if (render_target_pool_.HasIdle()) {
+        render_target_pool_.trim(VkMemoryTracker::Instance().QueryPressure());
+    }
 
-    CALL_VK(vkWaitForFences(vk_device_, 1, &cmd_fences_[frame_index_], VK_TRUE,
-                            std::numeric_limits<uint64_t>::max()));
+    update_render_targets();
 
 
     VkResult result = vkAcquireNextImageKHR(vk_device_, vk_swap_chain_,
@@ -189,57 +220,73 @@ void VkRenderer::draw() {
     assert(frame_index_ == current_frame_);
 
     VkCommandBuffer current_cmd = cmd_buffers_[current_frame_];
-    vkResetCommandBuffer(current_cmd, 0);
 
-    VkCommandBufferBeginInfo cmd_begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    cmd_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    if (vkBeginCommandBuffer(current_cmd, &cmd_begin_info) != VK_SUCCESS) {
-        __android_log_print(ANDROID_LOG_ERROR, "SkityVK",
-                            "Failed to begin cmd buffer at index : %d", current_frame_);
-        return;
+    uint64_t key = content_key();
+    reuse_frames_++;
+    if (command_reuse_.CanReuse(frame_index_, current_frame_, key)) {
+        // waited on above, the recording of this image is no longer in use.
+        // Nothing flushed other content into Skity's buffers since it was
+        // made, see CommandReuseTracker
+        reused_frames_++;
+    } else {
+        if (!record_frame(current_cmd, key != 0)) {
+            command_reuse_.dropped(current_frame_);
+            // the acquire still signals the semaphore, a wait-only batch takes
+            // it back so the next acquire into this slot can use it again. The
+            // next draw() of the slot waits for this batch first.
+            VkSubmitSync sync;
+            sync.wait(present_semaphore_[frame_index_], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+            VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+            cmd_serial_[frame_index_] = graphic_timeline_.submit(vk_graphic_queue_, submit_info,
+                                                                 &sync);
+            return;
+        }
+        command_reuse_.recorded(frame_index_, current_frame_, key);
     }
 
-    std::vector<VkClearValue> clear_values{3};
-    clear_values[0].color = {clear_color_[0], clear_color_[1], clear_color_[2],
-                             clear_color_[3]};
-    clear_values[1].depthStencil = {0.f, 0};
-    clear_values[2].color = {clear_color_[0], clear_color_[1], clear_color_[2],
-                             clear_color_[3]};
+    uint64_t frame_serial = graphic_timeline_.Submitted() + 1;
 
-    VkRenderPassBeginInfo render_pass_begin_info{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    render_pass_begin_info.renderPass = vk_render_pass_;
-    render_pass_begin_info.framebuffer = swap_chain_frame_buffers_[current_frame_];
-    render_pass_begin_info.renderArea.offset = {0, 0};
-    render_pass_begin_info.renderArea.extent = swap_chain_extend_;
-    render_pass_begin_info.clearValueCount = clear_values.size();
-    render_pass_begin_info.pClearValues = clear_values.data();
+    // mip chains of freshly uploaded textures, blitted before this frame samples them
+    std::array<VkCommandBuffer, 2> submit_cmds = {VK_NULL_HANDLE, current_cmd};
+    uint32_t first_cmd = 1;
 
-    vkCmdBeginRenderPass(current_cmd, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    // nothing is recorded on frames without new mip chains, which is nearly all of them
+    if (texture_uploader_.HasPendingMipmaps()) {
+        VkCommandBufferBeginInfo cmd_begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        cmd_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    onDraw(canvas_.get());
+        VkCommandBuffer mip_cmd = mip_cmd_buffers_[current_frame_];
+        vkResetCommandBuffer(mip_cmd, 0);
+        CALL_VK(vkBeginCommandBuffer(mip_cmd, &cmd_begin_info));
+        texture_uploader_.record_mipmaps(mip_cmd);
+        CALL_VK(vkEndCommandBuffer(mip_cmd));
 
-    canvas_->flush();
+        submit_cmds[0] = mip_cmd;
+        first_cmd = 0;
+    }
 
-    vkCmdEndRenderPass(current_cmd);
+    VkPipelineStageFlags acquire_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                          VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    if (IsScaled()) {
+        // the upscale blit writes the acquired image
+        acquire_stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
 
-    CALL_VK(vkEndCommandBuffer(current_cmd));
+    // acquire and present stay binary, the swapchain does not take timelines
+    VkSubmitSync sync;
+    sync.wait(present_semaphore_[frame_index_], acquire_stages);
+    sync.signal(render_semaphore_[frame_index_]);
 
-    VkPipelineStageFlags submit_pipeline_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                                                  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    // every image queued since the last frame goes out in one transfer submission
+    texture_uploader_.submit(frame_serial, &sync);
 
     VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    submit_info.pWaitDstStageMask = &submit_pipeline_stages;
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &present_semaphore_[frame_index_];
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = &render_semaphore_[frame_index_];
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &current_cmd;
+    submit_info.commandBufferCount = submit_cmds.size() - first_cmd;
+    submit_info.pCommandBuffers = submit_cmds.data() + first_cmd;
 
-    CALL_VK(vkResetFences(vk_device_, 1, &cmd_fences_[frame_index_]));
-
-    CALL_VK(vkQueueSubmit(vk_graphic_queue_, 1, &submit_info, cmd_fences_[frame_index_]));
+    cmd_serial_[frame_index_] = graphic_timeline_.submit(vk_graphic_queue_, submit_info, &sync);
+    input_latency_.submitted(monotonic_nanos());
 
 
     VkPresentInfoKHR present_info{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
@@ -269,8 +316,137 @@ void VkRenderer::draw() {
     frame_index_ = frame_index_ % swap_chain_image_view_.size();
 }
 
+bool VkRenderer::record_frame(VkCommandBuffer cmd, bool reusable) {
+    vkResetCommandBuffer(cmd, 0);
+
+    VkCommandBufferBeginInfo cmd_begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    // a reusable recording is submitted again by later frames of this image
+    cmd_begin_info.flags = reusable ? 0 : VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(cmd, &cmd_begin_info) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK",
+                            "Failed to begin cmd buffer at index : %d", current_frame_);
+        return false;
+    }
+
+    std::array<VkClearValue, 3> clear_values = {};
+    clear_values[0].color = {clear_color_[0], clear_color_[1], clear_color_[2],
+                             clear_color_[3]};
+    clear_values[1].depthStencil = {0.f, 0};
+    clear_values[2].color = {clear_color_[0], clear_color_[1], clear_color_[2],
+                             clear_color_[3]};
+
+    VkRenderPassBeginInfo render_pass_begin_info{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    render_pass_begin_info.renderPass = vk_render_pass_;
+    render_pass_begin_info.framebuffer = swap_chain_frame_buffers_[current_frame_];
+    render_pass_begin_info.renderArea.offset = {0, 0};
+    render_pass_begin_info.renderArea.extent = render_extent_;
+    render_pass_begin_info.clearValueCount = clear_values.size();
+    render_pass_begin_info.pClearValues = clear_values.data();
+
+    vkCmdBeginRenderPass(cmd, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+    onDraw(canvas_.get());
+
+    if (commands_ && !command_player_.play(canvas_.get(), commands_, command_size_)) {
+        __android_log_print(ANDROID_LOG_WARN, "SkityVK", "canvas commands malformed at byte %u",
+                            command_player_.LastStats().error_offset);
+    }
+
+    canvas_->flush();
+
+    vkCmdEndRenderPass(cmd);
+
+    if (IsScaled()) {
+        record_upscale(cmd);
+    }
+
+    CALL_VK(vkEndCommandBuffer(cmd));
+
+    return true;
+}
+
+uint64_t VkRenderer::content_key() {
+    uint64_t key = onContentKey();
+    if (key == 0) {
+        return 0;
+    }
+
+    uint64_t generation = content_generation_;
+    uint64_t hash = hash_bytes(0xcbf29ce484222325ull, &key, sizeof(key));
+    hash = hash_bytes(hash, &generation, sizeof(generation));
+    hash = hash_bytes(hash, clear_color_.data(), sizeof(float) * clear_color_.size());
+    if (commands_) {
+        hash = hash_bytes(hash, commands_, command_size_);
+    }
+
+    return hash != 0 ? hash : 1;
+}
+
+void VkRenderer::set_static_content(bool is_static) {
+    static_content_ = is_static;
+    invalidate_content();
+}
+
+CommandReuseStats VkRenderer::GetCommandReuseStats() const {
+    CommandReuseStats stats;
+    stats.frames = reuse_frames_;
+    stats.reused = reused_frames_;
+
+    return stats;
+}
+
+void VkRenderer::draw_commands(uint8_t const *data, size_t size) {
+    commands_ = data;
+    command_size_ = size;
+
+    draw();
+
+    commands_ = nullptr;
+    command_size_ = 0;
+}
+
+InputSample VkRenderer::latch_input() {
+    InputSample sample;
+    input_channel_.read(&sample);
+    input_latency_.latched(sample, monotonic_nanos());
+
+    return sample;
+}
+
+bool VkRenderer::start_frame_loop() {
+    if (!frame_loop_) {
+        frame_loop_ = std::make_unique<FrameLoop>(
+                std::make_unique<ChoreographerVsyncSource>(), [this](double vsync_time) {
+                    set_vsync_time(vsync_time);
+                    draw();
+                });
+    }
+
+    if (!frame_loop_->start()) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK",
+                            "frame loop needs a thread with a looper");
+        return false;
+    }
+
+    return true;
+}
+
+void VkRenderer::stop_frame_loop() {
+    if (frame_loop_) {
+        frame_loop_->stop();
+    }
+}
+
+FrameLoopStats VkRenderer::GetFrameLoopStats() const {
+    return frame_loop_ ? frame_loop_->Stats() : FrameLoopStats{};
+}
+
 void VkRenderer::set_default_typeface(std::shared_ptr<skity::Typeface> typeface) {
+    // kept for the canvas recreated by update_render_targets
+    default_typeface_ = typeface;
     canvas_->setDefaultTypeface(std::move(typeface));
+    invalidate_content();
 }
 
 void VkRenderer::init_vk(ANativeWindow *window) {
@@ -283,11 +459,16 @@ void VkRenderer::init_vk(ANativeWindow *window) {
     create_device();
     create_swap_chain();
     create_swap_chain_views();
+    render_target_pool_.init(vk_device_, vk_phy_device_, depth_stencil_format_);
     create_command_pool();
     create_command_buffers();
     create_sync_objects();
     create_render_pass();
     create_frame_buffer();
+
+    texture_uploader_.init(vk_device_, vk_phy_device_, graphic_queue_index_,
+                           transfer_queue_index_, vk_transfer_queue_, kStagingRingSize,
+                           timeline_semaphore_);
 }
 
 void VkRenderer::create_vk_instance() {
@@ -348,6 +529,7 @@ void VkRenderer::pick_phy_device() {
     int32_t graphic_queue_family = -1;
     int32_t present_queue_family = -1;
     int32_t compute_queue_family = -1;
+    int32_t transfer_queue_family = -1;
 
     for (size_t i = 0; i < available_devices.size(); i++) {
         uint32_t queue_count = 0;
@@ -376,6 +558,14 @@ void VkRenderer::pick_phy_device() {
                     return props.queueFlags & VK_QUEUE_COMPUTE_BIT;
                 });
 
+        // a transfer-only family usually maps to a dedicated DMA engine
+        auto transfer_it = std::find_if(
+                queue_family_properties.begin(), queue_family_properties.end(),
+                [](VkQueueFamilyProperties props) {
+                    return (props.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                           !(props.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+                });
+
         if (graphic_it != queue_family_properties.end() &&
             compute_it != queue_family_properties.end()) {
             vk_phy_device_ = available_devices[i];
@@ -386,7 +576,12 @@ void VkRenderer::pick_phy_device() {
                     std::distance(present_it, queue_family_properties.begin());
 
             compute_queue_family =
-                    std::distance(compute_it, queue_family_properties.begin());
+                    std::distance(queue_family_properties.begin(), compute_it);
+
+            if (transfer_it != queue_family_properties.end()) {
+                transfer_queue_family =
+                        std::distance(queue_family_properties.begin(), transfer_it);
+            }
             break;
         }
     }
@@ -426,11 +621,16 @@ void VkRenderer::pick_phy_device() {
     graphic_queue_index_ = graphic_queue_family;
     present_queue_index_ = present_queue_family;
     compute_queue_index_ = compute_queue_family;
+    transfer_queue_index_ =
+            transfer_queue_family != -1 ? transfer_queue_family : graphic_queue_family;
 
     vk_sample_count_ = get_max_usable_sample_count(phy_props);
+    supported_sample_counts_ = get_usable_sample_counts(phy_props);
+    requested_samples_ = vk_sample_count_;
 
-    __android_log_print(ANDROID_LOG_INFO, "SkityVk ", "queue family [ %d, %d, %d ]",
-                        graphic_queue_index_, present_queue_index_, compute_queue_index_);
+    __android_log_print(ANDROID_LOG_INFO, "SkityVk ", "queue family [ %d, %d, %d, %d ]",
+                        graphic_queue_index_, present_queue_index_, compute_queue_index_,
+                        transfer_queue_index_);
     __android_log_print(ANDROID_LOG_INFO, "SkityVk ", "sample count = %x", vk_sample_count_);
 }
 
@@ -441,6 +641,7 @@ void VkRenderer::create_device() {
             (uint32_t) graphic_queue_index_,
             (uint32_t) present_queue_index_,
             (uint32_t) compute_queue_index_,
+            (uint32_t) transfer_queue_index_,
     };
     float queue_priority = 1.f;
 
@@ -462,8 +663,13 @@ void VkRenderer::create_device() {
         device_features.geometryShader = VK_TRUE;
     }
 
+    // needed to sample ETC2 / ASTC assets without decoding them first
+    device_features.textureCompressionETC2 = vk_phy_features_.textureCompressionETC2;
+    device_features.textureCompressionASTC_LDR = vk_phy_features_.textureCompressionASTC_LDR;
+
     std::vector<const char *> required_device_extension{
             VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    bool memory_budget = false;
 
     {
         uint32_t count;
@@ -484,6 +690,39 @@ void VkRenderer::create_device() {
             // VUID-VkDeviceCreateInfo-pProperties-04451
             required_device_extension.emplace_back("VK_KHR_portability_subset");
         }
+
+        memory_budget = std::any_of(
+                properties.begin(), properties.end(), [](VkExtensionProperties prop) {
+                    return std::strcmp(prop.extensionName,
+                                       VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+                });
+
+        if (memory_budget) {
+            required_device_extension.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
+        timeline_semaphore_ = std::any_of(
+                properties.begin(), properties.end(), [](VkExtensionProperties prop) {
+                    return std::strcmp(prop.extensionName,
+                                       VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0;
+                });
+    }
+
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR};
+    if (timeline_semaphore_) {
+        // the extension can be exposed with the feature itself turned off
+        VkPhysicalDeviceFeatures2 features2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+        features2.pNext = &timeline_features;
+        vkGetPhysicalDeviceFeatures2(vk_phy_device_, &features2);
+
+        timeline_semaphore_ = timeline_features.timelineSemaphore == VK_TRUE;
+    }
+
+    if (timeline_semaphore_) {
+        required_device_extension.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        timeline_features.pNext = nullptr;
+        timeline_features.timelineSemaphore = VK_TRUE;
     }
 
     VkDeviceCreateInfo create_info{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
@@ -492,14 +731,23 @@ void VkRenderer::create_device() {
     create_info.pEnabledFeatures = &device_features;
     create_info.enabledExtensionCount = required_device_extension.size();
     create_info.ppEnabledExtensionNames = required_device_extension.data();
+    if (timeline_semaphore_) {
+        create_info.pNext = &timeline_features;
+    }
 
     CALL_VK(vkCreateDevice(vk_phy_device_, &create_info, nullptr, &vk_device_));
 
     volkLoadDevice(vk_device_);
 
+    VkMemoryTracker::Instance().init(vk_phy_device_, memory_budget);
+
     vkGetDeviceQueue(vk_device_, graphic_queue_index_, 0, &vk_graphic_queue_);
     vkGetDeviceQueue(vk_device_, present_queue_index_, 0, &vk_present_queue_);
     vkGetDeviceQueue(vk_device_, compute_queue_index_, 0, &vk_compute_queue_);
+    vkGetDeviceQueue(vk_device_, transfer_queue_index_, 0, &vk_transfer_queue_);
+
+    __android_log_print(ANDROID_LOG_INFO, "SkityVk ", "timeline semaphore = %d",
+                        timeline_semaphore_);
 }
 
 void VkRenderer::create_vk_surface(ANativeWindow *window) {
@@ -531,6 +779,22 @@ void VkRenderer::create_swap_chain() {
         surface_composite = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
     }
 
+    // a scaled frame is blitted into the swapchain image
+    swap_chain_usage_ = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (surface_caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) {
+        swap_chain_usage_ |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+
+    VkFormatProperties format_props{};
+    vkGetPhysicalDeviceFormatProperties(vk_phy_device_, format, &format_props);
+    VkFormatFeatureFlags blit_features =
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    can_upscale_ = (swap_chain_usage_ & VK_IMAGE_USAGE_TRANSFER_DST_BIT) &&
+                   (format_props.optimalTilingFeatures & blit_features) == blit_features;
+    upscale_filter_ = (format_props.optimalTilingFeatures &
+                       VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR
+                                                                           : VK_FILTER_NEAREST;
+
     VkSwapchainCreateInfoKHR create_info{
             VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR};
     create_info.surface = vk_surface_;
@@ -538,7 +802,7 @@ void VkRenderer::create_swap_chain() {
     create_info.imageFormat = format;
     create_info.imageExtent = surface_caps.currentExtent;
     create_info.imageArrayLayers = 1;
-    create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    create_info.imageUsage = swap_chain_usage_;
     create_info.queueFamilyIndexCount = 1;
     create_info.pQueueFamilyIndices = &present_queue_index_;
     create_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
@@ -577,17 +841,46 @@ void VkRenderer::create_swap_chain_views() {
     uint32_t image_count = 0;
     vkGetSwapchainImagesKHR(vk_device_, vk_swap_chain_, &image_count, nullptr);
 
-    std::vector<VkImage> swap_chain_image{image_count};
+    swap_chain_image_.resize(image_count);
     vkGetSwapchainImagesKHR(vk_device_, vk_swap_chain_, &image_count,
-                            swap_chain_image.data());
+                            swap_chain_image_.data());
+
+    render_extent_ = swap_chain_extend_;
+
+    // create image view for color buffer submit to screen
+    swap_chain_image_view_.resize(image_count);
+    for (uint32_t i = 0; i < image_count; i++) {
+        VkImageViewCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        create_info.image = swap_chain_image_[i];
+        create_info.format = swap_chain_format_;
+        create_info.subresourceRange.baseMipLevel = 0;
+        create_info.subresourceRange.levelCount = 1;
+        create_info.subresourceRange.baseArrayLayer = 0;
+        create_info.subresourceRange.layerCount = 1;
+        create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 
-    sampler_image_.resize(image_count);
+        CALL_VK(vkCreateImageView(vk_device_, &create_info, nullptr,
+                                  &swap_chain_image_view_[i]) != VK_SUCCESS);
+    }
+    if (!get_support_depth_format(vk_phy_device_, &depth_stencil_format_)) {
+        assert(false);
+    }
+
+    if (IsScaled()) {
+        // scaled frames render into pooled targets and only blit into the swapchain
+        acquire_scaled_targets(image_count);
+        return;
+    }
+
+    // single sampled frames draw straight into the resolve target
+    sampler_image_.resize(vk_sample_count_ != VK_SAMPLE_COUNT_1_BIT ? image_count : 0);
     for (size_t i = 0; i < sampler_image_.size(); i++) {
         VkImageCreateInfo img_create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
         img_create_info.imageType = VK_IMAGE_TYPE_2D;
         img_create_info.format = swap_chain_format_;
-        img_create_info.extent = {swap_chain_extend_.width,
-                                  swap_chain_extend_.height, 1};
+        img_create_info.extent = {render_extent_.width,
+                                  render_extent_.height, 1};
         img_create_info.mipLevels = 1;
         img_create_info.arrayLayers = 1;
         img_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -608,8 +901,9 @@ void VkRenderer::create_swap_chain_views() {
         mem_alloc.memoryTypeIndex = get_memory_type(
                 mem_reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        CALL_VK(vkAllocateMemory(vk_device_, &mem_alloc, nullptr,
-                                 &sampler_image_[i].memory) != VK_SUCCESS);
+        CALL_VK(VkMemoryTracker::Instance().allocate(vk_device_, &mem_alloc,
+                                                     VkMemoryCategory::kAttachment,
+                                                     &sampler_image_[i].memory) != VK_SUCCESS);
 
         CALL_VK(vkBindImageMemory(vk_device_, sampler_image_[i].image,
                                   sampler_image_[i].memory, 0) != VK_SUCCESS);
@@ -633,31 +927,12 @@ void VkRenderer::create_swap_chain_views() {
         sampler_image_[i].format = swap_chain_format_;
     }
 
-    // create image view for color buffer submit to screen
-    swap_chain_image_view_.resize(image_count);
-    for (uint32_t i = 0; i < image_count; i++) {
-        VkImageViewCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
-        create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        create_info.image = swap_chain_image[i];
-        create_info.format = swap_chain_format_;
-        create_info.subresourceRange.baseMipLevel = 0;
-        create_info.subresourceRange.levelCount = 1;
-        create_info.subresourceRange.baseArrayLayer = 0;
-        create_info.subresourceRange.layerCount = 1;
-        create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-
-        CALL_VK(vkCreateImageView(vk_device_, &create_info, nullptr,
-                                  &swap_chain_image_view_[i]) != VK_SUCCESS);
-    }
-    if (!get_support_depth_format(vk_phy_device_, &depth_stencil_format_)) {
-        assert(false);
-    }
     // create image and image-view for stencil buffer
     VkImageCreateInfo image_create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
     image_create_info.imageType = VK_IMAGE_TYPE_2D;
     image_create_info.format = depth_stencil_format_;
-    image_create_info.extent = {swap_chain_extend_.width,
-                                swap_chain_extend_.height, 1};
+    image_create_info.extent = {render_extent_.width,
+                                render_extent_.height, 1};
     image_create_info.mipLevels = 1;
     image_create_info.arrayLayers = 1;
     image_create_info.samples = vk_sample_count_;
@@ -678,8 +953,9 @@ void VkRenderer::create_swap_chain_views() {
         mem_alloc.allocationSize = mem_reqs.size;
         mem_alloc.memoryTypeIndex = get_memory_type(
                 mem_reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-        CALL_VK(vkAllocateMemory(vk_device_, &mem_alloc, nullptr,
-                                 &stencil_image_[i].memory) != VK_SUCCESS);
+        CALL_VK(VkMemoryTracker::Instance().allocate(vk_device_, &mem_alloc,
+                                                     VkMemoryCategory::kAttachment,
+                                                     &stencil_image_[i].memory) != VK_SUCCESS);
 
         CALL_VK(vkBindImageMemory(vk_device_, stencil_image_[i].image,
                                   stencil_image_[i].memory, 0) != VK_SUCCESS);
@@ -723,17 +999,19 @@ void VkRenderer::create_command_buffers() {
 
     CALL_VK(vkAllocateCommandBuffers(vk_device_, &allocate_info,
                                      cmd_buffers_.data()) != VK_SUCCESS);
+
+    mip_cmd_buffers_.resize(cmd_buffers_.size());
+    CALL_VK(vkAllocateCommandBuffers(vk_device_, &allocate_info,
+                                     mip_cmd_buffers_.data()) != VK_SUCCESS);
+
+    command_reuse_.reset(cmd_buffers_.size());
 }
 
 void VkRenderer::create_sync_objects() {
-    VkFenceCreateInfo create_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-    create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    cmd_fences_.resize(cmd_buffers_.size());
+    graphic_timeline_.init(vk_device_, timeline_semaphore_);
 
-    for (size_t i = 0; i < cmd_fences_.size(); i++) {
-        CALL_VK(vkCreateFence(vk_device_, &create_info, nullptr, &cmd_fences_[i]) !=
-                VK_SUCCESS);
-    }
+    // 0 is complete from the start, the first wait of every slot returns at once
+    cmd_serial_.resize(cmd_buffers_.size(), 0);
 
     present_semaphore_.resize(cmd_buffers_.size());
     render_semaphore_.resize(cmd_buffers_.size());
@@ -751,19 +1029,25 @@ void VkRenderer::create_sync_objects() {
 }
 
 void VkRenderer::create_render_pass() {
+    bool multisampled = vk_sample_count_ != VK_SAMPLE_COUNT_1_BIT;
+    VkImageLayout final_layout = IsScaled() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                            : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
     std::array<VkAttachmentDescription, 3> attachments = {};
-    // color attachment
+    // color attachment, the final target itself when single sampled
     attachments[0].format = swap_chain_format_;
     attachments[0].samples = vk_sample_count_;
     attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+                                          : VK_ATTACHMENT_STORE_OP_STORE;
     attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachments[0].finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                                              : final_layout;
 
     // depth stencil attachment
-    attachments[1].format = stencil_image_[0].format;
+    attachments[1].format = depth_stencil_format_;
     attachments[1].samples = vk_sample_count_;
     attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -780,7 +1064,7 @@ void VkRenderer::create_render_pass() {
     attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[2].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    attachments[2].finalLayout = final_layout;
 
     VkAttachmentReference color_reference{};
     color_reference.attachment = 0;
@@ -800,7 +1084,8 @@ void VkRenderer::create_render_pass() {
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &color_reference;
     subpass.pDepthStencilAttachment = &depth_stencil_reference;
-    subpass.pResolveAttachments = &resolve_reference;
+    // resolving needs a multisampled source
+    subpass.pResolveAttachments = multisampled ? &resolve_reference : nullptr;
 
     std::array<VkSubpassDependency, 2> subpass_dependencies{};
     subpass_dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
@@ -823,8 +1108,15 @@ void VkRenderer::create_render_pass() {
     subpass_dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
     subpass_dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
+    if (IsScaled()) {
+        // the resolved image is read by the upscale blit
+        subpass_dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        subpass_dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        subpass_dependencies[1].dependencyFlags = 0;
+    }
+
     VkRenderPassCreateInfo create_info{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
-    create_info.attachmentCount = attachments.size();
+    create_info.attachmentCount = multisampled ? attachments.size() : 2;
     create_info.pAttachments = attachments.data();
     create_info.subpassCount = 1;
     create_info.pSubpasses = &subpass;
@@ -837,19 +1129,30 @@ void VkRenderer::create_render_pass() {
 void VkRenderer::create_frame_buffer() {
     swap_chain_frame_buffers_.resize(swap_chain_image_view_.size());
 
+    if (!scaled_targets_.empty()) {
+        // the pool pass is compatible with vk_render_pass_
+        for (size_t i = 0; i < swap_chain_frame_buffers_.size(); i++) {
+            swap_chain_frame_buffers_[i] = scaled_targets_[i]->framebuffer;
+        }
+        return;
+    }
+
     std::array<VkImageView, 3> attachments = {};
+    bool multisampled = !sampler_image_.empty();
 
     for (size_t i = 0; i < swap_chain_frame_buffers_.size(); i++) {
-        attachments[0] = sampler_image_[i].image_view;
+        VkImageView target = swap_chain_image_view_[i];
+
+        attachments[0] = multisampled ? sampler_image_[i].image_view : target;
         attachments[1] = stencil_image_[i].image_view;
-        attachments[2] = swap_chain_image_view_[i];
+        attachments[2] = target;
         VkFramebufferCreateInfo create_info{
                 VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
         create_info.renderPass = vk_render_pass_;
-        create_info.attachmentCount = attachments.size();
+        create_info.attachmentCount = multisampled ? attachments.size() : 2;
         create_info.pAttachments = attachments.data();
-        create_info.width = swap_chain_extend_.width;
-        create_info.height = swap_chain_extend_.height;
+        create_info.width = render_extent_.width;
+        create_info.height = render_extent_.height;
         create_info.layers = 1;
 
         CALL_VK(vkCreateFramebuffer(vk_device_, &create_info, nullptr,
@@ -858,22 +1161,27 @@ void VkRenderer::create_frame_buffer() {
 }
 
 void VkRenderer::destroy_swap_chain_views() {
-    for (auto fb : swap_chain_frame_buffers_) {
-        vkDestroyFramebuffer(vk_device_, fb, nullptr);
+    // framebuffers of scaled frames belong to their pooled targets
+    if (scaled_targets_.empty()) {
+        for (auto fb : swap_chain_frame_buffers_) {
+            vkDestroyFramebuffer(vk_device_, fb, nullptr);
+        }
     }
     swap_chain_frame_buffers_.clear();
 
+    release_scaled_targets();
+
     for (auto const &st : stencil_image_) {
         vkDestroyImageView(vk_device_, st.image_view, nullptr);
         vkDestroyImage(vk_device_, st.image, nullptr);
-        vkFreeMemory(vk_device_, st.memory, nullptr);
+        VkMemoryTracker::Instance().free(vk_device_, st.memory);
     }
     stencil_image_.clear();
 
     for (auto const &si : sampler_image_) {
         vkDestroyImageView(vk_device_, si.image_view, nullptr);
         vkDestroyImage(vk_device_, si.image, nullptr);
-        vkFreeMemory(vk_device_, si.memory, nullptr);
+        VkMemoryTracker::Instance().free(vk_device_, si.memory);
     }
     sampler_image_.clear();
 
@@ -881,6 +1189,7 @@ void VkRenderer::destroy_swap_chain_views() {
         vkDestroyImageView(vk_device_, image_view, nullptr);
     }
     swap_chain_image_view_.clear();
+    swap_chain_image_.clear();
 }
 
 void VkRenderer::recreate_swap_chain() {
@@ -908,7 +1217,7 @@ void VkRenderer::recreate_swap_chain() {
     create_info.imageFormat = swap_chain_format_;
     create_info.imageExtent = capabilities.currentExtent;
     create_info.imageArrayLayers = 1;
-    create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    create_info.imageUsage = swap_chain_usage_;
     create_info.queueFamilyIndexCount = 1;
     create_info.pQueueFamilyIndices = &present_queue_index_;
     create_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
@@ -927,11 +1236,181 @@ void VkRenderer::recreate_swap_chain() {
 }
 
 void VkRenderer::recreate_frame_buffer() {
+    // recordings point at the old framebuffers
+    invalidate_content();
+
     destroy_swap_chain_views();
+    // called with the device idle, released targets can be handed out again
+    render_target_pool_.collect(graphic_timeline_.Submitted());
     create_swap_chain_views();
     create_frame_buffer();
 }
 
+void VkRenderer::update_render_targets() {
+    int32_t requested = requested_samples_;
+    float scale = requested_render_scale_;
+    if (requested == vk_sample_count_ && scale == render_scale_) {
+        return;
+    }
+
+    // highest supported count not above the request
+    auto samples = VK_SAMPLE_COUNT_1_BIT;
+    for (int32_t count = std::max(requested, 1); count > 1; count /= 2) {
+        if (supported_sample_counts_ & count) {
+            samples = static_cast<VkSampleCountFlagBits>(count);
+            break;
+        }
+    }
+    requested_samples_ = samples;
+
+    scale = can_upscale_ ? std::min(std::max(scale, kMinRenderScale), 1.f) : 1.f;
+    requested_render_scale_ = scale;
+
+    if (samples == vk_sample_count_ && scale == render_scale_) {
+        return;
+    }
+
+    // the render pass only changes with the sample count or when switching
+    // between direct and scaled rendering, a new scale alone just resizes the
+    // attachments
+    bool new_render_pass = samples != vk_sample_count_ || (scale < 1.f) != IsScaled();
+
+    invalidate_content();
+
+    if (!new_render_pass && IsScaled()) {
+        // only the pooled targets change, the ones of frames in flight return
+        // to the pool once those complete, no need to wait for the device
+        release_scaled_targets();
+        render_scale_ = scale;
+        acquire_scaled_targets(swap_chain_image_.size());
+        create_frame_buffer();
+
+        __android_log_print(ANDROID_LOG_INFO, "SkityVk ", "render extent %u x %u",
+                            render_extent_.width, render_extent_.height);
+        return;
+    }
+
+    vkDeviceWaitIdle(vk_device_);
+
+    if (new_render_pass) {
+        // pipelines inside the canvas are baked against the old render pass
+        canvas_.reset();
+    }
+
+    destroy_swap_chain_views();
+    render_target_pool_.collect(graphic_timeline_.Submitted());
+
+    vk_sample_count_ = samples;
+    render_scale_ = scale;
+
+    create_swap_chain_views();
+
+    if (new_render_pass) {
+        vkDestroyRenderPass(vk_device_, vk_render_pass_, nullptr);
+        create_render_pass();
+    }
+
+    create_frame_buffer();
+
+    if (new_render_pass) {
+        canvas_ = skity::Canvas::MakeHardwareAccelationCanvas(width_, height_, density_, this);
+        if (default_typeface_) {
+            canvas_->setDefaultTypeface(default_typeface_);
+        }
+    }
+
+    __android_log_print(ANDROID_LOG_INFO, "SkityVk ", "sample count = %x | render extent %u x %u",
+                        vk_sample_count_, render_extent_.width, render_extent_.height);
+}
+
+VkRenderTarget *VkRenderer::acquire_render_target(uint32_t width, uint32_t height) {
+    VkRenderTargetKey key;
+    key.width = width;
+    key.height = height;
+    key.format = swap_chain_format_;
+    key.samples = vk_sample_count_;
+
+    return render_target_pool_.acquire(key);
+}
+
+void VkRenderer::release_render_target(VkRenderTarget *target) {
+    // the frame being recorded is submitted with the next timeline value
+    render_target_pool_.release(target, graphic_timeline_.Submitted() + 1);
+}
+
+void VkRenderer::acquire_scaled_targets(size_t image_count) {
+    render_extent_.width = std::max(
+            uint32_t(1), static_cast<uint32_t>(swap_chain_extend_.width * render_scale_));
+    render_extent_.height = std::max(
+            uint32_t(1), static_cast<uint32_t>(swap_chain_extend_.height * render_scale_));
+
+    VkRenderTargetKey key;
+    key.width = render_extent_.width;
+    key.height = render_extent_.height;
+    key.format = swap_chain_format_;
+    key.samples = vk_sample_count_;
+
+    scaled_targets_.resize(image_count);
+    for (auto &target : scaled_targets_) {
+        target = render_target_pool_.acquire(key);
+        assert(target != nullptr);
+    }
+}
+
+void VkRenderer::release_scaled_targets() {
+    // the last submission may still render into them
+    for (auto target : scaled_targets_) {
+        render_target_pool_.release(target, graphic_timeline_.Submitted());
+    }
+    scaled_targets_.clear();
+}
+
+void VkRenderer::record_upscale(VkCommandBuffer cmd) {
+    VkImage src = scaled_targets_[current_frame_]->color.image;
+    VkImage dst = swap_chain_image_[current_frame_];
+
+    VkImageSubresourceRange range{};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.levelCount = 1;
+    range.layerCount = 1;
+
+    // src is left in TRANSFER_SRC by the render pass
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = dst;
+    barrier.subresourceRange = range;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkImageBlit blit{};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1] = {static_cast<int32_t>(render_extent_.width),
+                          static_cast<int32_t>(render_extent_.height), 1};
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.dstSubresource.layerCount = 1;
+    blit.dstOffsets[1] = {static_cast<int32_t>(swap_chain_extend_.width),
+                          static_cast<int32_t>(swap_chain_extend_.height), 1};
+
+    vkCmdBlitImage(cmd, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, upscale_filter_);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
+
 VkInstance VkRenderer::GetInstance() {
     return vk_instance_;
 }
@@ -949,7 +1428,7 @@ VkDevice VkRenderer::GetDevice() {
 }
 
 VkExtent2D VkRenderer::GetFrameExtent() {
-    return swap_chain_extend_;
+    return render_extent_;
 }
 
 VkCommandBuffer VkRenderer::GetCurrentCMD() {
@@ -961,7 +1440,7 @@ VkRenderPass VkRenderer::GetRenderPass() {
 }
 
 PFN_vkGetInstanceProcAddr VkRenderer::GetInstanceProcAddr() {
-    return vkGetInstanceProcAddr;
+    return VkMemoryTracker::GetInstanceProcAddr;
 }
 
 uint32_t VkRenderer::GetSwapchainBufferCount() {
@@ -999,3 +1478,18 @@ VkFormat VkRenderer::GetDepthStencilFormat() {
 VkSurfaceTransformFlagBitsKHR VkRenderer::GetSurfaceTransform() {
     return vk_surface_transform_;
 }
+
+std::shared_ptr<VkTexture> VkRenderer::upload_texture(skity::Pixmap const &pixmap, bool mipmaps) {
+    return texture_uploader_.upload(pixmap, mipmaps);
+}
+
+std::shared_ptr<VkTexture> VkRenderer::upload_texture(CompressedPixmap const &pixmap) {
+    return texture_uploader_.upload(pixmap);
+}
+
+TextureCompressionCaps VkRenderer::GetCompressionCaps() const {
+    TextureCompressionCaps caps{};
+    caps.etc2 = vk_phy_features_.textureCompressionETC2;
+    caps.astc_ldr = vk_phy_features_.textureCompressionASTC_LDR;
+    return caps;
+}
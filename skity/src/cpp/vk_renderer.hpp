@@ -7,18 +7,33 @@
 #include <skity/gpu/gpu_vk_context.hpp>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <android/native_window.h>
 
-struct ImageWrapper {
-    VkImage image = {};
-    VkImageView image_view = {};
-    VkDeviceMemory memory = {};
-    VkFormat format = {};
+#include "canvas_commands.hpp"
+#include "command_reuse.hpp"
+#include "frame_clock.hpp"
+#include "frame_loop.hpp"
+#include "input_channel.hpp"
+#include "vk_image.hpp"
+#include "vk_memory_tracker.hpp"
+#include "vk_render_target_pool.hpp"
+#include "vk_texture_uploader.hpp"
+#include "vk_timeline.hpp"
+
+struct CommandReuseStats {
+    uint64_t frames = {};
+    // frames that resubmitted the command buffer recorded earlier for their
+    // swapchain image instead of recording the canvas again
+    uint64_t reused = {};
 };
 
 class VkRenderer : public skity::GPUVkContext {
 public:
-    VkRenderer() : skity::GPUVkContext((void *) vkGetDeviceProcAddr) {}
+    static constexpr VkDeviceSize kStagingRingSize = 16 * 1024 * 1024;
+    static constexpr float kMinRenderScale = 0.25f;
+
+    VkRenderer() : skity::GPUVkContext((void *) VkMemoryTracker::GetDeviceProcAddr) {}
 
     virtual ~VkRenderer() = default;
 
@@ -28,8 +43,125 @@ public:
 
     void draw();
 
+    /**
+     * Draw a frame with a canvas command stream recorded after onDraw(), see
+     * CanvasCommandPlayer. data only has to live until this returns.
+     */
+    void draw_commands(uint8_t const *data, size_t size);
+
+    CanvasCommandPlayer *GetCommandPlayer() { return &command_player_; }
+
+    /**
+     * The content only changes through invalidate_content(), the clear color
+     * or the draw_commands() stream. A frame with the same content as the
+     * last one recorded for its swapchain image and frame slot resubmits that
+     * command buffer without calling onDraw(), as long as no frame flushed
+     * other content in between, see CommandReuseTracker. Can be called from
+     * any thread.
+     */
+    void set_static_content(bool is_static);
+
+    /**
+     * Record every swapchain image again, for static content that changed.
+     * Can be called from any thread.
+     */
+    void invalidate_content() { content_generation_++; }
+
+    CommandReuseStats GetCommandReuseStats() const;
+
     void set_default_typeface(std::shared_ptr<skity::Typeface> typeface);
 
+    /**
+     * Stamp the next draw() with the vsync it is drawn for, see FrameClock.
+     */
+    void set_vsync_time(double seconds) { frame_clock_.set_vsync_time(seconds); }
+
+    /**
+     * Latest touch position, written from the UI thread and latched by the
+     * frame right before it records the content that follows it.
+     */
+    InputChannel *GetInputChannel() { return &input_channel_; }
+
+    /**
+     * Input to submit latency of the frames that latched new input. Can be
+     * called from any thread.
+     */
+    InputLatencyStats GetInputLatency() const { return input_latency_.Stats(); }
+
+    /**
+     * Draw once per vsync from AChoreographer frame callbacks on the calling
+     * thread, which needs a looper. Stopped by stop_frame_loop() or destroy(),
+     * both on the same thread.
+     *
+     * @return false if the thread has no looper
+     */
+    bool start_frame_loop();
+
+    void stop_frame_loop();
+
+    /**
+     * Zero when the frame loop never ran.
+     */
+    FrameLoopStats GetFrameLoopStats() const;
+
+    /**
+     * Queue pixmap for upload into a wrapper owned texture. The copy is
+     * batched with every other upload of this frame and submitted once at the
+     * start of the next draw(), check VkTextureUploader::IsReady before
+     * sampling it outside of that frame. With mipmaps the chain is blitted on
+     * the graphic queue in front of that frame. The first call allocates the
+     * kStagingRingSize staging ring.
+     */
+    std::shared_ptr<VkTexture> upload_texture(skity::Pixmap const &pixmap, bool mipmaps = false);
+
+    std::shared_ptr<VkTexture> upload_texture(CompressedPixmap const &pixmap);
+
+    /**
+     * Compressed formats enabled on the device, valid after init().
+     */
+    TextureCompressionCaps GetCompressionCaps() const;
+
+    VkTextureUploader *GetTextureUploader() { return &texture_uploader_; }
+
+    /**
+     * Change the MSAA sample count of the swapchain targets, clamped to the
+     * counts the device supports. Can be called from any thread, the render
+     * pass, targets and canvas are recreated at the start of the next draw().
+     */
+    void set_sample_count(int32_t samples) { requested_samples_ = samples; }
+
+    /**
+     * Render the canvas into an offscreen target of scale times the surface
+     * size and upscale it into the swapchain image with a linear blit. The
+     * scale is clamped to [kMinRenderScale, 1], 1 renders straight into the
+     * swapchain again. Can be called from any thread, applied at the start of
+     * the next draw().
+     */
+    void set_render_scale(float scale) { requested_render_scale_ = scale; }
+
+    float RenderScale() const { return render_scale_; }
+
+    /**
+     * Offscreen target for layers and filter effects, in the swapchain format
+     * and sample count so the canvas pipelines render into it with the pool's
+     * render pass. Comes from a pool that scaled frames use as well.
+     */
+    VkRenderTarget *acquire_render_target(uint32_t width, uint32_t height);
+
+    /**
+     * Return target once the frame being recorded no longer needs it, it is
+     * reused after that frame completed on the GPU.
+     */
+    void release_render_target(VkRenderTarget *target);
+
+    VkRenderTargetPoolStats GetRenderTargetStats() const { return render_target_pool_.Stats(); }
+
+    /**
+     * Whether the swapchain images can be blitted into, set_render_scale
+     * keeps rendering at full size otherwise. Valid after init().
+     */
+    bool SupportsRenderScale() const { return can_upscale_; }
+
     void set_clear_color(float r, float g, float b, float a) {
         clear_color_[0] = r;
         clear_color_[1] = g;
@@ -74,8 +206,23 @@ public:
 protected:
     virtual void onDraw(skity::Canvas *canvas) {}
 
+    /**
+     * Identifies what onDraw() draws this frame, 0 when it has to be recorded
+     * every frame. Frames with the same key reuse their recording, see
+     * set_static_content.
+     */
+    virtual uint64_t onContentKey() { return static_content_ ? 1 : 0; }
+
     skity::Canvas *GetCanvas() { return canvas_.get(); }
 
+    FrameClock const &GetFrameClock() const { return frame_clock_; }
+
+    /**
+     * Read the newest input sample for the frame being recorded, call it as
+     * late as possible. Zero before the first input.
+     */
+    InputSample latch_input();
+
     int32_t Width() const { return width_; }
 
     int32_t Height() const { return height_; }
@@ -116,6 +263,23 @@ private:
 
     void recreate_frame_buffer();
 
+    void update_render_targets();
+
+    void acquire_scaled_targets(size_t image_count);
+
+    void release_scaled_targets();
+
+    void record_upscale(VkCommandBuffer cmd);
+
+    /**
+     * @return false if cmd could not be begun, nothing is recorded then
+     */
+    bool record_frame(VkCommandBuffer cmd, bool reusable);
+
+    uint64_t content_key();
+
+    bool IsScaled() const { return render_scale_ < 1.f; }
+
 private:
     int32_t width_ = {};
     int32_t height_ = {};
@@ -129,11 +293,21 @@ private:
     uint32_t graphic_queue_index_ = -1;
     uint32_t present_queue_index_ = -1;
     uint32_t compute_queue_index_ = -1;
+    uint32_t transfer_queue_index_ = -1;
     VkSampleCountFlagBits vk_sample_count_ = VK_SAMPLE_COUNT_1_BIT;
+    VkSampleCountFlags supported_sample_counts_ = {};
+    std::atomic<int32_t> requested_samples_ = {0};
+    std::atomic<float> requested_render_scale_ = {1.f};
+    float render_scale_ = 1.f;
+    // swapchain images can be blitted into, required for render scale
+    bool can_upscale_ = {};
+    VkFilter upscale_filter_ = VK_FILTER_LINEAR;
+    std::shared_ptr<skity::Typeface> default_typeface_ = {};
     VkDevice vk_device_ = {};
     VkQueue vk_graphic_queue_ = {};
     VkQueue vk_present_queue_ = {};
     VkQueue vk_compute_queue_ = {};
+    VkQueue vk_transfer_queue_ = {};
     VkSurfaceKHR vk_surface_ = {};
     VkSurfaceTransformFlagBitsKHR vk_surface_transform_ = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
     VkSwapchainKHR vk_swap_chain_ = {};
@@ -142,18 +316,47 @@ private:
     VkSurfaceTransformFlagBitsKHR pretransform_flag_ = {};
     VkCompositeAlphaFlagBitsKHR surface_composite_ = {};
     VkExtent2D swap_chain_extend_ = {};
+    VkImageUsageFlags swap_chain_usage_ = {};
+    // size of the render pass targets, swap_chain_extend_ times render_scale_
+    VkExtent2D render_extent_ = {};
+    std::vector<VkImage> swap_chain_image_ = {};
     std::vector<VkImageView> swap_chain_image_view_ = {};
     std::vector<ImageWrapper> stencil_image_ = {};
     std::vector<ImageWrapper> sampler_image_ = {};
+    VkRenderTargetPool render_target_pool_ = {};
+    // one per swapchain image when scaled, resolved into and blitted from
+    std::vector<VkRenderTarget *> scaled_targets_ = {};
     VkCommandPool cmd_pool_ = {};
     std::vector<VkCommandBuffer> cmd_buffers_ = {};
-    std::vector<VkFence> cmd_fences_ = {};
+    // submitted in front of cmd_buffers_ when there are mip chains to blit
+    std::vector<VkCommandBuffer> mip_cmd_buffers_ = {};
+    // which of cmd_buffers_ hold a recording that can be submitted again
+    CommandReuseTracker command_reuse_ = {};
+    std::atomic<bool> static_content_ = {false};
+    // part of every content key, bumped whenever recordings go stale
+    std::atomic<uint64_t> content_generation_ = {1};
+    std::atomic<uint64_t> reuse_frames_ = {0};
+    std::atomic<uint64_t> reused_frames_ = {0};
+    // VK_KHR_timeline_semaphore is enabled, VkTimeline falls back to fences otherwise
+    bool timeline_semaphore_ = {};
+    VkTimeline graphic_timeline_ = {};
+    // graphic timeline value the last submission of each slot completes at
+    std::vector<uint64_t> cmd_serial_ = {};
     std::vector<VkSemaphore> present_semaphore_ = {};
     std::vector<VkSemaphore> render_semaphore_ = {};
     VkRenderPass vk_render_pass_ = {};
     std::vector<VkFramebuffer> swap_chain_frame_buffers_ = {};
     uint32_t current_frame_ = {};
     uint32_t frame_index_ = {};
+    VkTextureUploader texture_uploader_ = {};
+    CanvasCommandPlayer command_player_{};
+    // stream of the running draw_commands() call
+    uint8_t const *commands_ = {};
+    size_t command_size_ = {};
+    FrameClock frame_clock_ = {};
+    InputChannel input_channel_ = {};
+    InputLatencyMeter input_latency_ = {};
+    std::unique_ptr<FrameLoop> frame_loop_ = {};
 };
 
 #endif //SKITY_ANDROID_VK_RENDERER_HPP
@@ -0,0 +1,117 @@
+
+#include "vk_staging_ring.hpp"
+
+#include <android/log.h>
+
+#include "vk_memory_tracker.hpp"
+
+static uint32_t find_host_memory_type(VkPhysicalDevice phy_device, uint32_t type_bits) {
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(phy_device, &memory_properties);
+
+    VkMemoryPropertyFlags properties =
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
+        if ((type_bits & (1u << i)) &&
+            (memory_properties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+bool VkStagingRing::init(VkDevice device, VkPhysicalDevice phy_device, VkDeviceSize capacity) {
+    device_ = device;
+    capacity_ = capacity;
+    head_ = tail_ = 0;
+
+    VkBufferCreateInfo buffer_info{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    buffer_info.size = capacity_;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device_, &buffer_info, nullptr, &buffer_) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK", "Failed to create staging ring buffer");
+        return false;
+    }
+
+    VkMemoryRequirements mem_reqs{};
+    vkGetBufferMemoryRequirements(device_, buffer_, &mem_reqs);
+
+    VkMemoryAllocateInfo mem_alloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mem_alloc.allocationSize = mem_reqs.size;
+    mem_alloc.memoryTypeIndex = find_host_memory_type(phy_device, mem_reqs.memoryTypeBits);
+
+    if (mem_alloc.memoryTypeIndex == UINT32_MAX ||
+        VkMemoryTracker::Instance().allocate(device_, &mem_alloc, VkMemoryCategory::kStaging,
+                                             &memory_) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK", "Failed to allocate staging ring memory");
+        destroy();
+        return false;
+    }
+
+    vkBindBufferMemory(device_, buffer_, memory_, 0);
+
+    if (vkMapMemory(device_, memory_, 0, VK_WHOLE_SIZE, 0, (void **) &mapped_) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK", "Failed to map staging ring memory");
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void VkStagingRing::destroy() {
+    if (mapped_) {
+        vkUnmapMemory(device_, memory_);
+        mapped_ = nullptr;
+    }
+
+    if (buffer_) {
+        vkDestroyBuffer(device_, buffer_, nullptr);
+        buffer_ = VK_NULL_HANDLE;
+    }
+
+    if (memory_) {
+        VkMemoryTracker::Instance().free(device_, memory_);
+        memory_ = VK_NULL_HANDLE;
+    }
+
+    capacity_ = 0;
+    head_ = tail_ = 0;
+}
+
+bool VkStagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment, Region *region) {
+    if (size > capacity_ || mapped_ == nullptr) {
+        return false;
+    }
+
+    uint64_t position = (head_ + alignment - 1) / alignment * alignment;
+    VkDeviceSize offset = position % capacity_;
+
+    // never hand out a region that wraps around the end of the buffer
+    if (offset + size > capacity_) {
+        position += capacity_ - offset;
+        offset = 0;
+    }
+
+    if (position + size - tail_ > capacity_) {
+        return false;
+    }
+
+    head_ = position + size;
+
+    region->buffer = buffer_;
+    region->offset = offset;
+    region->ptr = mapped_ + offset;
+
+    return true;
+}
+
+void VkStagingRing::release(uint64_t position) {
+    if (position > tail_) {
+        tail_ = position;
+    }
+}
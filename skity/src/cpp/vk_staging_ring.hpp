@@ -0,0 +1,61 @@
+
+#ifndef SKITY_ANDROID_VK_STAGING_RING_HPP
+#define SKITY_ANDROID_VK_STAGING_RING_HPP
+
+#include <volk.h>
+
+#include <cstdint>
+
+/**
+ * Persistently mapped, host coherent staging buffer used as a ring.
+ *
+ * Space is handed out front to back. Positions are monotonic byte counters so
+ * the owner can remember where a submission ended and give everything before
+ * it back with release() once the GPU finished reading.
+ */
+class VkStagingRing {
+public:
+    struct Region {
+        VkBuffer buffer = {};
+        VkDeviceSize offset = {};
+        uint8_t *ptr = {};
+    };
+
+    VkStagingRing() = default;
+
+    ~VkStagingRing() = default;
+
+    bool init(VkDevice device, VkPhysicalDevice phy_device, VkDeviceSize capacity);
+
+    void destroy();
+
+    /**
+     * Reserve size bytes. Returns false when the ring does not have enough
+     * free space right now, the caller needs to release older submissions
+     * first.
+     */
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, Region *region);
+
+    /**
+     * Give back everything allocated before position.
+     */
+    void release(uint64_t position);
+
+    uint64_t Head() const { return head_; }
+
+    // 0 until init()
+    VkDeviceSize Capacity() const { return capacity_; }
+
+    VkDeviceSize Used() const { return head_ - tail_; }
+
+private:
+    VkDevice device_ = {};
+    VkBuffer buffer_ = {};
+    VkDeviceMemory memory_ = {};
+    uint8_t *mapped_ = {};
+    VkDeviceSize capacity_ = {};
+    uint64_t head_ = {};
+    uint64_t tail_ = {};
+};
+
+#endif //SKITY_ANDROID_VK_STAGING_RING_HPP
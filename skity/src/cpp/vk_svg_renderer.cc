@@ -4,11 +4,98 @@
 
 #include "vk_svg_renderer.hpp"
 
+#include "span_blend.hpp"
+
+constexpr double VkSVGRender::kTileBudgetMs;
+
+void VkSVGRender::init_svg(skity::Data *data) {
+    svg_dom_ = skity::SVGDom::MakeFromData(data);
+    cull_tree_ = SVGCullTree::Record(svg_dom_.get(), Width(), Height());
+    // the clear color vk_svg_init sets
+    tile_cache_.set_content(cull_tree_.get(), premultiply_color(1.f, 1.f, 1.f, 1.f));
+    // only changes with the view, every frame after the first ones resubmits
+    set_static_content(true);
+}
+
+void VkSVGRender::set_view(float zoom, float x, float y) {
+    {
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        view_.zoom = zoom;
+        view_.x = x;
+        view_.y = y;
+    }
+
+    invalidate_content();
+}
+
+void VkSVGRender::set_culling(bool culling) {
+    culling_ = culling;
+
+    invalidate_content();
+}
+
+SVGCullStats VkSVGRender::CullStats() const {
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    return cull_stats_;
+}
+
+void VkSVGRender::set_tiled(bool tiled) {
+    tiled_ = tiled;
+
+    invalidate_content();
+}
+
+SVGTileStats VkSVGRender::TileStats() const {
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    return tile_stats_;
+}
+
 void VkSVGRender::onDraw(skity::Canvas *canvas) {
-    GetCanvas()->save();
-    GetCanvas()->translate(50, 50);
+    alloc_meter_.tick();
+    alloc_meter_.report("svg");
+
+    SVGView view;
+    {
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        view = view_;
+    }
+
+    if (tiled_ && cull_tree_) {
+        if (!tile_pool_) {
+            tile_pool_.reset(new WorkStealingPool());
+        }
+
+        bool complete = tile_cache_.draw(GetCanvas(), tile_pool_.get(), view, Width(), Height(),
+                                         kTileBudgetMs);
+
+        {
+            std::lock_guard<std::mutex> lock(view_mutex_);
+            tile_stats_ = tile_cache_.LastStats();
+        }
+
+        if (!complete) {
+            // the recording of this frame is not final, draw again next frame
+            invalidate_content();
+        }
+        return;
+    }
+
+    path_cache_.begin_frame();
+    path_canvas_.set_target(GetCanvas(), Width(), Height());
+
+    if (culling_ && cull_tree_) {
+        cull_tree_->draw(&path_canvas_, view.Matrix(),
+                         skity::Rect::MakeXYWH(0.f, 0.f, Width(), Height()));
+
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        cull_stats_ = cull_tree_->Stats();
+        return;
+    }
+
+    path_canvas_.save();
+    path_canvas_.concat(view.Matrix());
 
-    svg_dom_->Render(GetCanvas());
+    svg_dom_->Render(&path_canvas_);
 
-    GetCanvas()->restore();
-}
\ No newline at end of file
+    path_canvas_.restore();
+}
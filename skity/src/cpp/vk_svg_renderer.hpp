@@ -5,20 +5,71 @@
 #include "vk_renderer.hpp"
 #include <skity/svg/svg_dom.hpp>
 
+#include "alloc_counter.hpp"
+#include "path_geometry_cache.hpp"
+#include "svg_cull_tree.hpp"
+#include "svg_tile_cache.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <atomic>
+#include <mutex>
+
 class VkSVGRender : public VkRenderer {
 public:
+    // tile rendering time per frame in tiled mode
+    static constexpr double kTileBudgetMs = 4.0;
+
     VkSVGRender() = default;
 
     ~VkSVGRender() override = default;
 
-    void init_svg(skity::Data *data) {
-        svg_dom_ = skity::SVGDom::MakeFromData(data);
-    }
+    void init_svg(skity::Data *data);
+
+    /**
+     * Zoom and pan the document, can be called from any thread.
+     */
+    void set_view(float zoom, float x, float y);
+
+    /**
+     * Draw only what the SVGCullTree finds in the viewport, on by default.
+     * Off renders the whole DOM every frame.
+     */
+    void set_culling(bool culling);
+
+    /**
+     * Of the last frame drawn, can be called from any thread.
+     */
+    SVGCullStats CullStats() const;
+
+    /**
+     * Composite the view from an SVGTileCache instead of drawing the document,
+     * off by default. Tiles still missing are rendered over the next frames.
+     */
+    void set_tiled(bool tiled);
+
+    /**
+     * Of the last tiled frame, can be called from any thread.
+     */
+    SVGTileStats TileStats() const;
 
 protected:
     void onDraw(skity::Canvas *canvas) override;
 private:
     std::unique_ptr<skity::SVGDom> svg_dom_ = {};
+    std::unique_ptr<SVGCullTree> cull_tree_ = {};
+    std::atomic<bool> culling_ = {true};
+    mutable std::mutex view_mutex_ = {};
+    SVGView view_ = {};
+    SVGCullStats cull_stats_ = {};
+    std::atomic<bool> tiled_ = {false};
+    // created with the first tiled frame
+    std::unique_ptr<WorkStealingPool> tile_pool_ = {};
+    SVGTileCache tile_cache_ = {};
+    SVGTileStats tile_stats_ = {};
+    AllocFrameMeter alloc_meter_ = {};
+    // the svg paths only move with the canvas, they hit from the third frame on
+    PathGeometryCache path_cache_ = {};
+    PathCacheCanvas path_canvas_{&path_cache_};
 };
 
 
@@ -0,0 +1,611 @@
+
+#include "vk_texture_uploader.hpp"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "vk_memory_tracker.hpp"
+
+#define STAGING_ALIGNMENT 16
+
+static VkFormat compressed_vk_format(CompressedPixmap const &pixmap) {
+    switch (pixmap.Format()) {
+        case CompressedFormat::kETC2_RGB8:
+            return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+        case CompressedFormat::kETC2_RGBA8:
+            return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+        case CompressedFormat::kASTC:
+            // UNORM and SRGB alternate for every footprint, same order as GL
+            return static_cast<VkFormat>(VK_FORMAT_ASTC_4x4_UNORM_BLOCK +
+                                         2 * (pixmap.GLInternalFormat() - 0x93B0));
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+
+VkTexture::~VkTexture() {
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkDestroyImageView(device, image.image_view, nullptr);
+    vkDestroyImage(device, image.image, nullptr);
+    VkMemoryTracker::Instance().free(device, image.memory);
+}
+
+bool VkTextureUploader::init(VkDevice device, VkPhysicalDevice phy_device,
+                             uint32_t graphic_queue_index, uint32_t transfer_queue_index,
+                             VkQueue transfer_queue, VkDeviceSize ring_size, bool timeline) {
+    device_ = device;
+    phy_device_ = phy_device;
+    transfer_queue_ = transfer_queue;
+
+    transfer_timeline_.init(device_, timeline);
+
+    vkGetPhysicalDeviceMemoryProperties(phy_device_, &memory_properties_);
+
+    queue_families_.clear();
+    queue_families_.emplace_back(graphic_queue_index);
+    if (transfer_queue_index != graphic_queue_index) {
+        queue_families_.emplace_back(transfer_queue_index);
+    }
+
+    VkCommandPoolCreateInfo pool_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    pool_info.queueFamilyIndex = transfer_queue_index;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
+                      VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    if (vkCreateCommandPool(device_, &pool_info, nullptr, &cmd_pool_) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK", "Failed to create upload command pool");
+        return false;
+    }
+
+    // the ring is created by the first upload, renderers that never upload skip it
+    ring_size_ = ring_size;
+
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(phy_device_, VK_FORMAT_R8G8B8A8_UNORM, &properties);
+    VkFormatFeatureFlags blit_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                         VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                         VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    can_blit_ = (properties.optimalTilingFeatures & blit_features) == blit_features;
+
+    return true;
+}
+
+void VkTextureUploader::destroy() {
+    if (device_ == VK_NULL_HANDLE) {
+        return;
+    }
+
+    mip_queue_.clear();
+
+    while (!in_flight_.empty()) {
+        Batch &batch = in_flight_.front();
+        transfer_timeline_.wait(batch.value);
+        recycle(batch);
+        free_batches_.emplace_back(std::move(batch));
+        in_flight_.pop_front();
+    }
+
+    if (pending_) {
+        recycle(*pending_);
+        free_batches_.emplace_back(std::move(*pending_));
+        pending_.reset();
+    }
+
+    for (auto &batch : free_batches_) {
+        vkDestroySemaphore(device_, batch.semaphore, nullptr);
+    }
+    free_batches_.clear();
+
+    transfer_timeline_.destroy();
+
+    ring_.destroy();
+
+    vkDestroyCommandPool(device_, cmd_pool_, nullptr);
+    cmd_pool_ = VK_NULL_HANDLE;
+
+    device_ = VK_NULL_HANDLE;
+}
+
+std::shared_ptr<VkTexture> VkTextureUploader::upload(skity::Pixmap const &pixmap, bool mipmaps) {
+    uint32_t width = pixmap.Width();
+    uint32_t height = pixmap.Height();
+    VkDeviceSize row_bytes = width * 4;
+    VkDeviceSize size = row_bytes * height;
+
+    VkStagingRing::Region region{};
+    if (!allocate_staging(size, &region)) {
+        return nullptr;
+    }
+
+    uint32_t mip_levels = 1;
+    if (mipmaps && can_blit_) {
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+            mip_levels++;
+        }
+    }
+
+    auto texture = std::make_shared<VkTexture>();
+    if (!create_image(width, height, VK_FORMAT_R8G8B8A8_UNORM, mip_levels, &texture->image)) {
+        return nullptr;
+    }
+    texture->device = device_;
+    texture->width = width;
+    texture->height = height;
+    texture->mip_levels = mip_levels;
+
+    // pack rows tightly, the source may carry row padding
+    auto src = reinterpret_cast<const uint8_t *>(pixmap.Addr());
+    for (uint32_t y = 0; y < height; y++) {
+        std::memcpy(region.ptr + y * row_bytes, src + y * pixmap.RowBytes(), row_bytes);
+    }
+
+    record_copy(texture.get(), region);
+
+    if (mip_levels > 1) {
+        mip_queue_.emplace_back(texture);
+    }
+
+    return texture;
+}
+
+std::shared_ptr<VkTexture> VkTextureUploader::upload(CompressedPixmap const &pixmap) {
+    VkFormat format = compressed_vk_format(pixmap);
+
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(phy_device_, format, &properties);
+
+    if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+        // the device can not sample this format, expand it on the CPU
+        auto decoded = pixmap.Decode();
+        if (!decoded) {
+            __android_log_print(ANDROID_LOG_ERROR, "SkityVK",
+                                "compressed format %d is not supported and has no CPU decoder",
+                                (int) pixmap.Format());
+            return nullptr;
+        }
+        return upload(*decoded);
+    }
+
+    VkStagingRing::Region region{};
+    if (!allocate_staging(pixmap.BlocksSize(), &region)) {
+        return nullptr;
+    }
+
+    auto texture = std::make_shared<VkTexture>();
+    if (!create_image(pixmap.Width(), pixmap.Height(), format, 1, &texture->image)) {
+        return nullptr;
+    }
+    texture->device = device_;
+    texture->width = pixmap.Width();
+    texture->height = pixmap.Height();
+
+    // blocks are tightly packed already, a zero bufferRowLength matches them
+    std::memcpy(region.ptr, pixmap.Blocks(), pixmap.BlocksSize());
+
+    record_copy(texture.get(), region);
+
+    return texture;
+}
+
+void VkTextureUploader::record_copy(VkTexture *texture, VkStagingRing::Region const &region) {
+    Batch *batch = current_batch();
+    texture->batch = batch->id;
+
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = texture->image.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(batch->cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy copy{};
+    copy.bufferOffset = region.offset;
+    copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy.imageSubresource.layerCount = 1;
+    copy.imageExtent = {texture->width, texture->height, 1};
+
+    vkCmdCopyBufferToImage(batch->cmd, region.buffer, texture->image.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+    // the transfer queue may not know fragment stages, the semaphore wait on
+    // the graphic queue makes the data visible there. Mipmapped textures keep
+    // the base level as blit source for record_mipmaps().
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = texture->mip_levels > 1 ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                                : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+
+    vkCmdPipelineBarrier(batch->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+
+    batch->copy_count++;
+}
+
+uint32_t VkTextureUploader::record_mipmaps(VkCommandBuffer cmd) {
+    // every queued base level, early flushed ones included, is waited on by
+    // the submission of the next submit()
+    for (auto const &texture : mip_queue_) {
+        generate_mipmaps(cmd, *texture);
+    }
+
+    auto count = static_cast<uint32_t>(mip_queue_.size());
+    mip_queue_.clear();
+
+    return count;
+}
+
+void VkTextureUploader::generate_mipmaps(VkCommandBuffer cmd, VkTexture const &texture) {
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = texture.image.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+
+    int32_t width = texture.width;
+    int32_t height = texture.height;
+
+    for (uint32_t level = 1; level < texture.mip_levels; level++) {
+        int32_t next_width = std::max(width / 2, 1);
+        int32_t next_height = std::max(height / 2, 1);
+
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+
+        VkImageBlit blit{};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.layerCount = 1;
+        blit.srcOffsets[1] = {width, height, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.layerCount = 1;
+        blit.dstOffsets[1] = {next_width, next_height, 1};
+
+        vkCmdBlitImage(cmd, texture.image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       texture.image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                       VK_FILTER_LINEAR);
+
+        // this level is the source of the next blit
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+
+        width = next_width;
+        height = next_height;
+    }
+
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = texture.mip_levels;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
+
+bool VkTextureUploader::submit(uint64_t frame_serial, VkSubmitSync *graphic_sync) {
+    bool waited = false;
+
+    // batches flushed early while the ring was full
+    for (auto &batch : in_flight_) {
+        if (batch.graphic_wait) {
+            add_graphic_wait(&batch, frame_serial, graphic_sync);
+            waited = true;
+        }
+    }
+
+    return flush(frame_serial, graphic_sync) || waited;
+}
+
+void VkTextureUploader::add_graphic_wait(Batch *batch, uint64_t frame_serial,
+                                         VkSubmitSync *graphic_sync) {
+    VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    if (transfer_timeline_.IsTimeline()) {
+        graphic_sync->wait(transfer_timeline_.Semaphore(), stages, batch->value);
+    } else {
+        graphic_sync->wait(batch->semaphore, stages);
+    }
+
+    batch->frame_serial = frame_serial;
+    batch->graphic_wait = false;
+}
+
+bool VkTextureUploader::flush(uint64_t frame_serial, VkSubmitSync *graphic_sync) {
+    if (!pending_ || pending_->copy_count == 0) {
+        return false;
+    }
+
+    Batch batch = std::move(*pending_);
+    pending_.reset();
+
+    vkEndCommandBuffer(batch.cmd);
+
+    batch.ring_end = ring_.Head();
+
+    VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch.cmd;
+
+    // every batch is waited on by a graphic submission, an early one by the next
+    VkSubmitSync sync;
+    if (!transfer_timeline_.IsTimeline()) {
+        sync.signal(batch.semaphore);
+    }
+
+    batch.value = transfer_timeline_.submit(transfer_queue_, submit_info, &sync);
+    if (batch.value == 0) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK", "Failed to submit upload batch %llu",
+                            (unsigned long long) batch.id);
+    }
+
+    if (graphic_sync) {
+        add_graphic_wait(&batch, frame_serial, graphic_sync);
+    } else {
+        batch.graphic_wait = true;
+    }
+
+    in_flight_.emplace_back(std::move(batch));
+
+    return true;
+}
+
+void VkTextureUploader::collect(uint64_t completed_frame_serial) {
+    uint64_t completed = transfer_timeline_.Completed();
+
+    while (!in_flight_.empty()) {
+        Batch &batch = in_flight_.front();
+
+        if (batch.value > completed) {
+            break;
+        }
+
+        completed_batch_ = batch.id;
+        ring_.release(batch.ring_end);
+
+        // the graphic wait of an early batch is still to be added, and a
+        // binary semaphore can only be reused after the graphic submission
+        // waited on it, timeline values need no such care
+        if (batch.graphic_wait ||
+            (!transfer_timeline_.IsTimeline() && batch.frame_serial > completed_frame_serial)) {
+            break;
+        }
+
+        recycle(batch);
+        free_batches_.emplace_back(std::move(batch));
+        in_flight_.pop_front();
+    }
+}
+
+VkTextureUploader::Batch *VkTextureUploader::current_batch() {
+    if (pending_) {
+        return pending_.get();
+    }
+
+    pending_ = std::make_unique<Batch>();
+
+    if (!free_batches_.empty()) {
+        *pending_ = std::move(free_batches_.back());
+        free_batches_.pop_back();
+    } else {
+        VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        allocate_info.commandPool = cmd_pool_;
+        allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocate_info.commandBufferCount = 1;
+        vkAllocateCommandBuffers(device_, &allocate_info, &pending_->cmd);
+
+        if (!transfer_timeline_.IsTimeline()) {
+            VkSemaphoreCreateInfo semaphore_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+            vkCreateSemaphore(device_, &semaphore_info, nullptr, &pending_->semaphore);
+        }
+    }
+
+    pending_->id = next_batch_++;
+    pending_->copy_count = 0;
+    pending_->graphic_wait = false;
+
+    vkResetCommandBuffer(pending_->cmd, 0);
+
+    VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(pending_->cmd, &begin_info);
+
+    return pending_.get();
+}
+
+bool VkTextureUploader::init_ring() {
+    if (ring_.Capacity() > 0) {
+        return true;
+    }
+
+    if (!ring_.init(device_, phy_device_, ring_size_)) {
+        return false;
+    }
+
+    __android_log_print(ANDROID_LOG_INFO, "SkityVK", "texture uploader ring = %llu KB, %s queue",
+                        (unsigned long long) ring_size_ / 1024,
+                        queue_families_.size() > 1 ? "dedicated transfer" : "graphic");
+
+    return true;
+}
+
+bool VkTextureUploader::allocate_staging(VkDeviceSize size, VkStagingRing::Region *region) {
+    if (!init_ring()) {
+        return false;
+    }
+
+    if (size <= ring_.Capacity()) {
+        if (ring_.allocate(size, STAGING_ALIGNMENT, region)) {
+            return true;
+        }
+
+        // ring is full: push out what is queued and wait for the oldest batches
+        // until enough space is back, this is the only place the uploader stalls.
+        // The next submit() makes the graphic queue wait on the early batch.
+        flush(0, nullptr);
+        for (auto &batch : in_flight_) {
+            transfer_timeline_.wait(batch.value);
+            completed_batch_ = batch.id;
+            ring_.release(batch.ring_end);
+
+            if (ring_.allocate(size, STAGING_ALIGNMENT, region)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // larger than the whole ring, use a one-off buffer owned by the batch
+    VkBufferCreateInfo buffer_info{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    buffer_info.size = size;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    if (vkCreateBuffer(device_, &buffer_info, nullptr, &buffer) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements mem_reqs{};
+    vkGetBufferMemoryRequirements(device_, buffer, &mem_reqs);
+
+    VkMemoryAllocateInfo mem_alloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mem_alloc.allocationSize = mem_reqs.size;
+    mem_alloc.memoryTypeIndex = get_memory_type(
+            mem_reqs.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (VkMemoryTracker::Instance().allocate(device_, &mem_alloc, VkMemoryCategory::kStaging,
+                                             &memory) != VK_SUCCESS) {
+        vkDestroyBuffer(device_, buffer, nullptr);
+        return false;
+    }
+
+    vkBindBufferMemory(device_, buffer, memory, 0);
+
+    void *ptr = nullptr;
+    vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, &ptr);
+
+    current_batch()->dedicated.emplace_back(buffer, memory);
+
+    region->buffer = buffer;
+    region->offset = 0;
+    region->ptr = static_cast<uint8_t *>(ptr);
+
+    return true;
+}
+
+bool VkTextureUploader::create_image(uint32_t width, uint32_t height, VkFormat format,
+                                     uint32_t mip_levels, ImageWrapper *image) {
+    VkImageCreateInfo image_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = format;
+    image_info.extent = {width, height, 1};
+    image_info.mipLevels = mip_levels;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (mip_levels > 1) {
+        image_info.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // shared between transfer and graphic family, no ownership transfer needed
+    if (queue_families_.size() > 1) {
+        image_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        image_info.queueFamilyIndexCount = queue_families_.size();
+        image_info.pQueueFamilyIndices = queue_families_.data();
+    } else {
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    if (vkCreateImage(device_, &image_info, nullptr, &image->image) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements mem_reqs{};
+    vkGetImageMemoryRequirements(device_, image->image, &mem_reqs);
+
+    VkMemoryAllocateInfo mem_alloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mem_alloc.allocationSize = mem_reqs.size;
+    mem_alloc.memoryTypeIndex = get_memory_type(mem_reqs.memoryTypeBits,
+                                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (VkMemoryTracker::Instance().allocate(device_, &mem_alloc, VkMemoryCategory::kTexture,
+                                             &image->memory) != VK_SUCCESS) {
+        vkDestroyImage(device_, image->image, nullptr);
+        image->image = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkBindImageMemory(device_, image->image, image->memory, 0);
+
+    VkImageViewCreateInfo view_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    view_info.image = image->image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.levelCount = mip_levels;
+    view_info.subresourceRange.layerCount = 1;
+
+    vkCreateImageView(device_, &view_info, nullptr, &image->image_view);
+
+    image->format = format;
+
+    return true;
+}
+
+void VkTextureUploader::recycle(Batch &batch) {
+    for (auto const &dedicated : batch.dedicated) {
+        vkDestroyBuffer(device_, dedicated.first, nullptr);
+        VkMemoryTracker::Instance().free(device_, dedicated.second);
+    }
+    batch.dedicated.clear();
+    batch.copy_count = 0;
+}
+
+uint32_t VkTextureUploader::get_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties) {
+    for (uint32_t i = 0; i < memory_properties_.memoryTypeCount; i++) {
+        if ((type_bits & 1) == 1) {
+            if ((memory_properties_.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+
+        type_bits >>= 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+
+#ifndef SKITY_ANDROID_VK_TEXTURE_UPLOADER_HPP
+#define SKITY_ANDROID_VK_TEXTURE_UPLOADER_HPP
+
+#include <volk.h>
+#include <skity/skity.hpp>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "compressed_pixmap.hpp"
+#include "vk_image.hpp"
+#include "vk_staging_ring.hpp"
+#include "vk_timeline.hpp"
+
+/**
+ * Device local, sampled image owned by the wrapper.
+ */
+struct VkTexture {
+    VkDevice device = {};
+    ImageWrapper image = {};
+    uint32_t width = {};
+    uint32_t height = {};
+    uint32_t mip_levels = 1;
+    // id of the upload batch that fills this image
+    uint64_t batch = {};
+
+    ~VkTexture();
+};
+
+/**
+ * Batched texture upload through a VkStagingRing.
+ *
+ * upload() only copies pixels into the ring and records the copy. All copies
+ * queued since the last submit() go out as one submission on the transfer
+ * queue (a dedicated transfer family when the device has one), tracked on a
+ * VkTimeline so the CPU never waits on it unless the ring runs full. The ring
+ * is allocated by the first upload.
+ */
+class VkTextureUploader {
+public:
+    VkTextureUploader() = default;
+
+    ~VkTextureUploader() = default;
+
+    bool init(VkDevice device, VkPhysicalDevice phy_device, uint32_t graphic_queue_index,
+              uint32_t transfer_queue_index, VkQueue transfer_queue, VkDeviceSize ring_size,
+              bool timeline);
+
+    void destroy();
+
+    /**
+     * Create a sampled RGBA image and queue the copy of pixmap into it.
+     *
+     * @param mipmaps   allocate a full mip chain, filled on the GPU by
+     *                  record_mipmaps() once the base level has arrived
+     */
+    std::shared_ptr<VkTexture> upload(skity::Pixmap const &pixmap, bool mipmaps = false);
+
+    /**
+     * Same as above but keeps the ETC2 / ASTC blocks as they are. Formats the
+     * device can not sample are decoded on the CPU and uploaded as RGBA.
+     */
+    std::shared_ptr<VkTexture> upload(CompressedPixmap const &pixmap);
+
+    /**
+     * Record the blit chain of every mipmapped texture whose base level goes
+     * out with the next submit() (or already landed). The transfer queue can
+     * not blit, so cmd must belong to the graphic queue and be part of the
+     * submission passed to that submit().
+     *
+     * @return number of textures recorded, cmd can be skipped when 0
+     */
+    uint32_t record_mipmaps(VkCommandBuffer cmd);
+
+    /**
+     * @return true if record_mipmaps() would record anything
+     */
+    bool HasPendingMipmaps() const { return !mip_queue_.empty(); }
+
+    /**
+     * Submit every copy queued since the last call in a single batch and make
+     * graphic_sync wait for it, on the transfer timeline value or a binary
+     * semaphore of the batch in the fence fallback. Batches flushed early
+     * because the ring ran full are waited on here as well.
+     *
+     * @param frame_serial  graphic timeline value of the submission built
+     *                      with graphic_sync
+     * @return              false if nothing was queued or flushed early
+     */
+    bool submit(uint64_t frame_serial, VkSubmitSync *graphic_sync);
+
+    /**
+     * Retire batches whose transfer value completed and, in the fallback,
+     * whose consuming graphics frame is done. Never blocks.
+     */
+    void collect(uint64_t completed_frame_serial);
+
+    bool IsReady(VkTexture const &texture) const { return texture.batch <= completed_batch_; }
+
+    uint32_t InFlightBatchCount() const { return in_flight_.size(); }
+
+private:
+    struct Batch {
+        uint64_t id = {};
+        uint64_t frame_serial = {};
+        uint64_t ring_end = {};
+        // transfer timeline value the batch completes at
+        uint64_t value = {};
+        VkCommandBuffer cmd = {};
+        // waited on by the graphic queue, only without timeline semaphores
+        VkSemaphore semaphore = {};
+        // flushed early, no graphic submission waits on it yet
+        bool graphic_wait = {};
+        uint32_t copy_count = {};
+        // one-off staging buffers for uploads larger than the ring
+        std::vector<std::pair<VkBuffer, VkDeviceMemory>> dedicated = {};
+    };
+
+    Batch *current_batch();
+
+    /**
+     * @param graphic_sync  nullptr for an early flush, the next submit() adds
+     *                      the graphic wait
+     */
+    bool flush(uint64_t frame_serial, VkSubmitSync *graphic_sync);
+
+    void add_graphic_wait(Batch *batch, uint64_t frame_serial, VkSubmitSync *graphic_sync);
+
+    bool init_ring();
+
+    bool allocate_staging(VkDeviceSize size, VkStagingRing::Region *region);
+
+    void record_copy(VkTexture *texture, VkStagingRing::Region const &region);
+
+    void generate_mipmaps(VkCommandBuffer cmd, VkTexture const &texture);
+
+    bool create_image(uint32_t width, uint32_t height, VkFormat format, uint32_t mip_levels,
+                      ImageWrapper *image);
+
+    void recycle(Batch &batch);
+
+    uint32_t get_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties);
+
+private:
+    VkDevice device_ = {};
+    VkPhysicalDevice phy_device_ = {};
+    VkPhysicalDeviceMemoryProperties memory_properties_ = {};
+    std::vector<uint32_t> queue_families_ = {};
+    VkQueue transfer_queue_ = {};
+    VkCommandPool cmd_pool_ = {};
+    VkTimeline transfer_timeline_ = {};
+    VkDeviceSize ring_size_ = {};
+    VkStagingRing ring_ = {};
+    std::unique_ptr<Batch> pending_ = {};
+    std::deque<Batch> in_flight_ = {};
+    std::vector<Batch> free_batches_ = {};
+    uint64_t next_batch_ = 1;
+    uint64_t completed_batch_ = {};
+    // RGBA8 can be blitted with linear filter, needed for mip generation
+    bool can_blit_ = {};
+    std::vector<std::shared_ptr<VkTexture>> mip_queue_ = {};
+};
+
+#endif //SKITY_ANDROID_VK_TEXTURE_UPLOADER_HPP
@@ -0,0 +1,202 @@
+
+#include "vk_timeline.hpp"
+
+#include <android/log.h>
+
+#include <algorithm>
+
+constexpr uint32_t VkSubmitSync::kInlineSemaphores;
+
+void VkSubmitSync::wait(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value) {
+    if (semaphore == VK_NULL_HANDLE) {
+        return;
+    }
+
+    wait_semaphores_.push_back(semaphore);
+    wait_stages_.push_back(stage);
+    wait_values_.push_back(value);
+
+    timeline_ |= value > 0;
+}
+
+void VkSubmitSync::signal(VkSemaphore semaphore, uint64_t value) {
+    if (semaphore == VK_NULL_HANDLE) {
+        return;
+    }
+
+    signal_semaphores_.push_back(semaphore);
+    signal_values_.push_back(value);
+
+    timeline_ |= value > 0;
+}
+
+void VkSubmitSync::fill(VkSubmitInfo *info) {
+    info->waitSemaphoreCount = wait_semaphores_.Size();
+    info->pWaitSemaphores = wait_semaphores_.Data();
+    info->pWaitDstStageMask = wait_stages_.Data();
+    info->signalSemaphoreCount = signal_semaphores_.Size();
+    info->pSignalSemaphores = signal_semaphores_.Data();
+
+    if (!timeline_) {
+        return;
+    }
+
+    // values of binary semaphores in the same submit are ignored
+    timeline_info_ = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR};
+    timeline_info_.pNext = info->pNext;
+    timeline_info_.waitSemaphoreValueCount = wait_values_.Size();
+    timeline_info_.pWaitSemaphoreValues = wait_values_.Data();
+    timeline_info_.signalSemaphoreValueCount = signal_values_.Size();
+    timeline_info_.pSignalSemaphoreValues = signal_values_.Data();
+
+    info->pNext = &timeline_info_;
+}
+
+bool VkTimeline::init(VkDevice device, bool timeline) {
+    device_ = device;
+    timeline_ = timeline;
+    submitted_ = 0;
+    completed_ = 0;
+
+    if (!timeline_) {
+        return true;
+    }
+
+    VkSemaphoreTypeCreateInfoKHR type_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    create_info.pNext = &type_info;
+
+    if (vkCreateSemaphore(device_, &create_info, nullptr, &semaphore_) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_WARN, "SkityVK",
+                            "Failed to create timeline semaphore, using fences");
+        semaphore_ = VK_NULL_HANDLE;
+        timeline_ = false;
+    }
+
+    return true;
+}
+
+void VkTimeline::destroy() {
+    if (device_ == VK_NULL_HANDLE) {
+        return;
+    }
+
+    wait(submitted_);
+
+    for (auto const &pending : pending_) {
+        vkDestroyFence(device_, pending.fence, nullptr);
+    }
+    pending_.clear();
+
+    for (auto fence : free_fences_) {
+        vkDestroyFence(device_, fence, nullptr);
+    }
+    free_fences_.clear();
+
+    vkDestroySemaphore(device_, semaphore_, nullptr);
+    semaphore_ = VK_NULL_HANDLE;
+
+    device_ = VK_NULL_HANDLE;
+}
+
+uint64_t VkTimeline::submit(VkQueue queue, VkSubmitInfo const &info, VkSubmitSync *sync) {
+    uint64_t value = submitted_ + 1;
+
+    VkSubmitInfo submit_info = info;
+    VkFence fence = VK_NULL_HANDLE;
+
+    if (timeline_) {
+        sync->signal(semaphore_, value);
+    } else {
+        fence = acquire_fence();
+    }
+    sync->fill(&submit_info);
+
+    if (vkQueueSubmit(queue, 1, &submit_info, fence) != VK_SUCCESS) {
+        __android_log_print(ANDROID_LOG_ERROR, "SkityVK", "Failed to submit timeline value %llu",
+                            (unsigned long long) value);
+        if (fence != VK_NULL_HANDLE) {
+            free_fences_.emplace_back(fence);
+        }
+        return 0;
+    }
+
+    submitted_ = value;
+    if (fence != VK_NULL_HANDLE) {
+        pending_.emplace_back(PendingFence{value, fence});
+    }
+
+    return value;
+}
+
+uint64_t VkTimeline::Completed() {
+    if (timeline_) {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValueKHR(device_, semaphore_, &value) == VK_SUCCESS) {
+            completed_ = std::max(completed_, value);
+        }
+        return completed_;
+    }
+
+    while (!pending_.empty() && vkGetFenceStatus(device_, pending_.front().fence) == VK_SUCCESS) {
+        retire_front();
+    }
+
+    return completed_;
+}
+
+bool VkTimeline::wait(uint64_t value, uint64_t timeout) {
+    if (value <= completed_) {
+        return true;
+    }
+
+    if (timeline_) {
+        VkSemaphoreWaitInfoKHR wait_info{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR};
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &semaphore_;
+        wait_info.pValues = &value;
+
+        if (vkWaitSemaphoresKHR(device_, &wait_info, timeout) != VK_SUCCESS) {
+            return false;
+        }
+
+        completed_ = std::max(completed_, value);
+        return true;
+    }
+
+    // the queue completes in submission order, so the fences are waited front to back
+    while (completed_ < value && !pending_.empty()) {
+        if (vkWaitForFences(device_, 1, &pending_.front().fence, VK_TRUE, timeout) !=
+            VK_SUCCESS) {
+            return false;
+        }
+        retire_front();
+    }
+
+    return completed_ >= value;
+}
+
+VkFence VkTimeline::acquire_fence() {
+    if (!free_fences_.empty()) {
+        VkFence fence = free_fences_.back();
+        free_fences_.pop_back();
+        vkResetFences(device_, 1, &fence);
+        return fence;
+    }
+
+    VkFenceCreateInfo create_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+
+    VkFence fence = VK_NULL_HANDLE;
+    vkCreateFence(device_, &create_info, nullptr, &fence);
+
+    return fence;
+}
+
+void VkTimeline::retire_front() {
+    completed_ = std::max(completed_, pending_.front().value);
+    free_fences_.emplace_back(pending_.front().fence);
+    pending_.pop_front();
+}
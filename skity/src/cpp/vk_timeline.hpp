@@ -0,0 +1,153 @@
+
+#ifndef SKITY_ANDROID_VK_TIMELINE_HPP
+#define SKITY_ANDROID_VK_TIMELINE_HPP
+
+#include <volk.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+/**
+ * Wait and signal semaphores of one vkQueueSubmit, with the values of
+ * timeline semaphores. Up to kInlineSemaphores of each kind are kept inline,
+ * so building a usual submission never allocates; more move to the heap.
+ */
+class VkSubmitSync {
+public:
+    static constexpr uint32_t kInlineSemaphores = 4;
+
+    /**
+     * @param value   value to wait for on a timeline semaphore, 0 for binary
+     */
+    void wait(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value = 0);
+
+    void signal(VkSemaphore semaphore, uint64_t value = 0);
+
+    /**
+     * Point the semaphore arrays of info at this and chain the timeline
+     * values when any semaphore is a timeline. Must outlive the submit.
+     */
+    void fill(VkSubmitInfo *info);
+
+    uint32_t WaitCount() const { return wait_semaphores_.Size(); }
+
+private:
+    /**
+     * Contiguous list, inline until it outgrows kInlineSemaphores.
+     */
+    template<class T>
+    class List {
+    public:
+        void push_back(T const &value) {
+            if (heap_.empty() && size_ < kInlineSemaphores) {
+                inline_[size_++] = value;
+                return;
+            }
+
+            if (heap_.empty()) {
+                heap_.assign(inline_.begin(), inline_.begin() + size_);
+            }
+            heap_.emplace_back(value);
+            size_++;
+        }
+
+        T const *Data() const { return heap_.empty() ? inline_.data() : heap_.data(); }
+
+        uint32_t Size() const { return size_; }
+
+    private:
+        std::array<T, kInlineSemaphores> inline_ = {};
+        std::vector<T> heap_ = {};
+        uint32_t size_ = {};
+    };
+
+private:
+    List<VkSemaphore> wait_semaphores_ = {};
+    List<VkPipelineStageFlags> wait_stages_ = {};
+    List<uint64_t> wait_values_ = {};
+    List<VkSemaphore> signal_semaphores_ = {};
+    List<uint64_t> signal_values_ = {};
+    bool timeline_ = {};
+    VkTimelineSemaphoreSubmitInfoKHR timeline_info_ = {};
+};
+
+/**
+ * Monotonic progress counter of one queue.
+ *
+ * Every submission made through submit() gets the next value. With
+ * VK_KHR_timeline_semaphore that value is signaled on a single timeline
+ * semaphore, other queues wait on it directly and the CPU waits for exactly
+ * the value it needs. Without it each submission takes a binary fence from a
+ * pool and values complete in submission order, so callers deal in values
+ * either way. Cross queue waits need a binary semaphore of their own then.
+ */
+class VkTimeline {
+public:
+    VkTimeline() = default;
+
+    ~VkTimeline() = default;
+
+    /**
+     * @param timeline  VK_KHR_timeline_semaphore is enabled on the device
+     */
+    bool init(VkDevice device, bool timeline);
+
+    /**
+     * Wait for everything submitted and release the semaphore or fences.
+     */
+    void destroy();
+
+    /**
+     * Submit one batch signaling the next value.
+     *
+     * @return the value the batch completes, 0 if vkQueueSubmit failed
+     */
+    uint64_t submit(VkQueue queue, VkSubmitInfo const &info, VkSubmitSync *sync);
+
+    /**
+     * Poll the queue, never blocks.
+     */
+    uint64_t Completed();
+
+    /**
+     * Block until value completed or timeout nanoseconds passed.
+     *
+     * @return true if value completed
+     */
+    bool wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+
+    bool IsTimeline() const { return timeline_; }
+
+    /**
+     * Timeline semaphore to wait on from other queues, VK_NULL_HANDLE in the
+     * fence fallback.
+     */
+    VkSemaphore Semaphore() const { return semaphore_; }
+
+    uint64_t Submitted() const { return submitted_; }
+
+private:
+    struct PendingFence {
+        uint64_t value = {};
+        VkFence fence = {};
+    };
+
+    VkFence acquire_fence();
+
+    void retire_front();
+
+private:
+    VkDevice device_ = {};
+    bool timeline_ = {};
+    VkSemaphore semaphore_ = {};
+    uint64_t submitted_ = {};
+    uint64_t completed_ = {};
+    // fallback only, in submission order
+    std::deque<PendingFence> pending_ = {};
+    std::vector<VkFence> free_fences_ = {};
+};
+
+#endif //SKITY_ANDROID_VK_TIMELINE_HPP
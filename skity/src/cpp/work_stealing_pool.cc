@@ -0,0 +1,184 @@
+
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// queue of the pool thread running this code, if any
+struct WorkerSlot {
+    WorkStealingPool const *pool = nullptr;
+    uint32_t queue = 0;
+};
+
+thread_local WorkerSlot tls_worker = {};
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(uint32_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // the caller of parallel_for() runs tasks as well
+    uint32_t worker_count = threads - 1;
+    for (uint32_t i = 0; i < worker_count + 1; i++) {
+        queues_.emplace_back(new Queue);
+    }
+
+    for (uint32_t i = 0; i < worker_count; i++) {
+        workers_.emplace_back([this, i] {
+            tls_worker.pool = this;
+            tls_worker.queue = i;
+            worker_loop(i);
+        });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::parallel_for(uint32_t count, std::function<void(uint32_t)> const &fn) {
+    if (count == 0) {
+        return;
+    }
+
+    if (workers_.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        tasks_ += count;
+        return;
+    }
+
+    struct Group {
+        std::atomic<uint32_t> remaining = {0};
+        std::mutex mutex = {};
+        std::condition_variable done = {};
+    } group;
+    group.remaining = count;
+
+    uint32_t home = current_queue();
+    auto queue_count = static_cast<uint32_t>(queues_.size());
+
+    // deal contiguous index ranges to the queues, thieves take the front of a
+    // range so its owner keeps working on the neighbouring indices
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t queue = (home + static_cast<uint64_t>(i) * queue_count / count) % queue_count;
+        push(queue, [&fn, &group, i] {
+            fn(i);
+            // under the lock, so the waiter can't return while this still
+            // touches the group
+            std::lock_guard<std::mutex> lock(group.mutex);
+            if (group.remaining.fetch_sub(1) == 1) {
+                group.done.notify_all();
+            }
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_.notify_all();
+
+    while (group.remaining.load() > 0) {
+        if (run_one(home)) {
+            continue;
+        }
+
+        // the rest of the group is running on other threads
+        std::unique_lock<std::mutex> lock(group.mutex);
+        group.done.wait(lock, [&group] { return group.remaining.load() == 0; });
+    }
+
+    // wait for the last task to release the mutex
+    std::lock_guard<std::mutex> lock(group.mutex);
+}
+
+WorkStealingStats WorkStealingPool::Stats() const {
+    WorkStealingStats stats;
+    stats.tasks = tasks_.load();
+    stats.steals = steals_.load();
+
+    return stats;
+}
+
+void WorkStealingPool::reset_stats() {
+    tasks_ = 0;
+    steals_ = 0;
+}
+
+void WorkStealingPool::push(uint32_t queue, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+        queues_[queue]->tasks.emplace_back(std::move(task));
+    }
+    queued_++;
+}
+
+bool WorkStealingPool::run_one(uint32_t queue) {
+    Task task;
+
+    {
+        auto &own = *queues_[queue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    if (!task) {
+        auto queue_count = static_cast<uint32_t>(queues_.size());
+        for (uint32_t i = 1; i < queue_count && !task; i++) {
+            auto &victim = *queues_[(queue + i) % queue_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                steals_++;
+            }
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+
+    queued_--;
+    task();
+    tasks_++;
+
+    return true;
+}
+
+void WorkStealingPool::worker_loop(uint32_t queue) {
+    for (;;) {
+        if (run_one(queue)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+uint32_t WorkStealingPool::current_queue() const {
+    if (tls_worker.pool == this) {
+        return tls_worker.queue;
+    }
+
+    return static_cast<uint32_t>(queues_.size()) - 1;
+}
@@ -0,0 +1,82 @@
+
+#ifndef SKITY_ANDROID_WORK_STEALING_POOL_HPP
+#define SKITY_ANDROID_WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct WorkStealingStats {
+    uint64_t tasks = {};
+    // tasks taken from the queue of another thread
+    uint64_t steals = {};
+};
+
+/**
+ * Fixed set of worker threads, each with its own task deque. A thread pushes
+ * and pops its own deque at the back and steals from the front of the others
+ * when it runs dry, so neighbouring tasks tend to stay on one core.
+ *
+ * parallel_for() may be called from inside a task. Waiting threads keep
+ * running tasks instead of blocking, nested loops can't deadlock the pool.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @param threads   threads running tasks including the caller of
+     *                  parallel_for(), 0 for one per core
+     */
+    explicit WorkStealingPool(uint32_t threads = 0);
+
+    ~WorkStealingPool();
+
+    WorkStealingPool(WorkStealingPool const &) = delete;
+
+    WorkStealingPool &operator=(WorkStealingPool const &) = delete;
+
+    /**
+     * Run fn(i) for every i in [0, count) and return once all calls returned.
+     */
+    void parallel_for(uint32_t count, std::function<void(uint32_t)> const &fn);
+
+    uint32_t ThreadCount() const { return static_cast<uint32_t>(workers_.size()) + 1; }
+
+    WorkStealingStats Stats() const;
+
+    void reset_stats();
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex = {};
+        std::deque<Task> tasks = {};
+    };
+
+    void push(uint32_t queue, Task task);
+
+    bool run_one(uint32_t queue);
+
+    void worker_loop(uint32_t queue);
+
+    uint32_t current_queue() const;
+
+private:
+    // one per worker, the last one is shared by threads outside the pool
+    std::vector<std::unique_ptr<Queue>> queues_ = {};
+    std::vector<std::thread> workers_ = {};
+    std::mutex wake_mutex_ = {};
+    std::condition_variable wake_ = {};
+    std::atomic<uint32_t> queued_ = {0};
+    bool stop_ = {};
+    std::atomic<uint64_t> tasks_ = {0};
+    std::atomic<uint64_t> steals_ = {0};
+};
+
+#endif //SKITY_ANDROID_WORK_STEALING_POOL_HPP
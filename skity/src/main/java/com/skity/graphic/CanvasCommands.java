@@ -0,0 +1,240 @@
+package com.skity.graphic;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Canvas calls recorded into a direct buffer and executed natively in a single call, see
+ * {@link Renderer#draw(CanvasCommands)} and {@link VkRenderer#draw(CanvasCommands)}.
+ * <p>
+ * Paint state set by the set* methods applies to every following draw of the stream, each stream
+ * starts from a black, anti aliased fill. Path verbs build one path which {@link #drawPath()} draws
+ * and clears. Saves left open are restored when the stream ends.
+ * Not thread safe, record and draw on the same thread or hand the object over between frames.
+ */
+public class CanvasCommands {
+    // opcodes, keep in sync with CanvasOp in canvas_commands.hpp
+    private static final byte OP_SAVE = 1;
+    private static final byte OP_RESTORE = 2;
+    private static final byte OP_TRANSLATE = 3;
+    private static final byte OP_SCALE = 4;
+    private static final byte OP_ROTATE = 5;
+    private static final byte OP_CONCAT = 6;
+    private static final byte OP_CLIP_RECT = 7;
+    private static final byte OP_SET_COLOR = 8;
+    private static final byte OP_SET_STYLE = 9;
+    private static final byte OP_SET_STROKE_WIDTH = 10;
+    private static final byte OP_SET_TEXT_SIZE = 11;
+    private static final byte OP_SET_ANTI_ALIAS = 12;
+    private static final byte OP_MOVE_TO = 13;
+    private static final byte OP_LINE_TO = 14;
+    private static final byte OP_QUAD_TO = 15;
+    private static final byte OP_CUBIC_TO = 16;
+    private static final byte OP_CLOSE = 17;
+    private static final byte OP_DRAW_PATH = 18;
+    private static final byte OP_DRAW_RECT = 19;
+    private static final byte OP_DRAW_ROUND_RECT = 20;
+    private static final byte OP_DRAW_CIRCLE = 21;
+    private static final byte OP_DRAW_TEXT = 22;
+    private static final byte OP_DRAW_IMAGE = 23;
+
+    public static final int STYLE_FILL = 0;
+    public static final int STYLE_STROKE = 1;
+    public static final int STYLE_STROKE_AND_FILL = 2;
+
+    private ByteBuffer buffer;
+
+    public CanvasCommands() {
+        this(16 * 1024);
+    }
+
+    public CanvasCommands(int capacity) {
+        buffer = allocate(Math.max(capacity, 64));
+    }
+
+    /**
+     * Drop everything recorded, the buffer is kept.
+     */
+    public void reset() {
+        buffer.clear();
+    }
+
+    /**
+     * Bytes recorded so far.
+     */
+    public int size() {
+        return buffer.position();
+    }
+
+    ByteBuffer buffer() {
+        return buffer;
+    }
+
+    public void save() {
+        ensure(1);
+        buffer.put(OP_SAVE);
+    }
+
+    public void restore() {
+        ensure(1);
+        buffer.put(OP_RESTORE);
+    }
+
+    public void translate(float dx, float dy) {
+        putFloats(OP_TRANSLATE, dx, dy);
+    }
+
+    public void scale(float sx, float sy) {
+        putFloats(OP_SCALE, sx, sy);
+    }
+
+    public void rotate(float degrees) {
+        ensure(5);
+        buffer.put(OP_ROTATE).putFloat(degrees);
+    }
+
+    /**
+     * Affine matrix in the order of android.graphics.Matrix#getValues, without the last row.
+     */
+    public void concat(float scaleX, float skewX, float transX, float skewY, float scaleY,
+                       float transY) {
+        ensure(25);
+        buffer.put(OP_CONCAT).putFloat(scaleX).putFloat(skewX).putFloat(transX)
+                .putFloat(skewY).putFloat(scaleY).putFloat(transY);
+    }
+
+    public void clipRect(float left, float top, float right, float bottom) {
+        putFloats(OP_CLIP_RECT, left, top, right, bottom);
+    }
+
+    /**
+     * @param argb color like android.graphics.Color
+     */
+    public void setColor(int argb) {
+        ensure(5);
+        buffer.put(OP_SET_COLOR).putInt(argb);
+    }
+
+    /**
+     * @param style one of the STYLE_* constants
+     */
+    public void setStyle(int style) {
+        ensure(2);
+        buffer.put(OP_SET_STYLE).put((byte) style);
+    }
+
+    public void setStrokeWidth(float width) {
+        ensure(5);
+        buffer.put(OP_SET_STROKE_WIDTH).putFloat(width);
+    }
+
+    public void setTextSize(float size) {
+        ensure(5);
+        buffer.put(OP_SET_TEXT_SIZE).putFloat(size);
+    }
+
+    public void setAntiAlias(boolean enabled) {
+        ensure(2);
+        buffer.put(OP_SET_ANTI_ALIAS).put((byte) (enabled ? 1 : 0));
+    }
+
+    public void moveTo(float x, float y) {
+        putFloats(OP_MOVE_TO, x, y);
+    }
+
+    public void lineTo(float x, float y) {
+        putFloats(OP_LINE_TO, x, y);
+    }
+
+    public void quadTo(float x1, float y1, float x2, float y2) {
+        putFloats(OP_QUAD_TO, x1, y1, x2, y2);
+    }
+
+    public void cubicTo(float x1, float y1, float x2, float y2, float x3, float y3) {
+        ensure(25);
+        buffer.put(OP_CUBIC_TO).putFloat(x1).putFloat(y1).putFloat(x2).putFloat(y2)
+                .putFloat(x3).putFloat(y3);
+    }
+
+    public void close() {
+        ensure(1);
+        buffer.put(OP_CLOSE);
+    }
+
+    /**
+     * Draw the path built since the last drawPath() and start a new one.
+     */
+    public void drawPath() {
+        ensure(1);
+        buffer.put(OP_DRAW_PATH);
+    }
+
+    public void drawRect(float left, float top, float right, float bottom) {
+        putFloats(OP_DRAW_RECT, left, top, right, bottom);
+    }
+
+    public void drawRoundRect(float left, float top, float right, float bottom, float rx,
+                              float ry) {
+        ensure(25);
+        buffer.put(OP_DRAW_ROUND_RECT).putFloat(left).putFloat(top).putFloat(right)
+                .putFloat(bottom).putFloat(rx).putFloat(ry);
+    }
+
+    public void drawCircle(float cx, float cy, float radius) {
+        ensure(13);
+        buffer.put(OP_DRAW_CIRCLE).putFloat(cx).putFloat(cy).putFloat(radius);
+    }
+
+    /**
+     * Draw text with the renderer's default typeface, at most 65535 UTF-8 bytes. Longer text is
+     * cut at the last whole code point that fits.
+     */
+    public void drawText(String text, float x, float y) {
+        byte[] bytes = text.getBytes(StandardCharsets.UTF_8);
+        int length = Math.min(bytes.length, 0xFFFF);
+        // a continuation byte right after the cut means a code point was split
+        while (length < bytes.length && length > 0 && (bytes[length] & 0xC0) == 0x80) {
+            length--;
+        }
+
+        ensure(11 + length);
+        buffer.put(OP_DRAW_TEXT).putFloat(x).putFloat(y).putShort((short) length)
+                .put(bytes, 0, length);
+    }
+
+    /**
+     * Draw one of the images loaded by the renderer, by index.
+     */
+    public void drawImage(int index, float left, float top, float right, float bottom) {
+        ensure(21);
+        buffer.put(OP_DRAW_IMAGE).putInt(index).putFloat(left).putFloat(top).putFloat(right)
+                .putFloat(bottom);
+    }
+
+    private void putFloats(byte op, float a, float b) {
+        ensure(9);
+        buffer.put(op).putFloat(a).putFloat(b);
+    }
+
+    private void putFloats(byte op, float a, float b, float c, float d) {
+        ensure(17);
+        buffer.put(op).putFloat(a).putFloat(b).putFloat(c).putFloat(d);
+    }
+
+    private void ensure(int bytes) {
+        if (buffer.remaining() >= bytes) {
+            return;
+        }
+
+        ByteBuffer grown = allocate(Math.max(buffer.capacity() * 2, buffer.position() + bytes));
+        buffer.flip();
+        grown.put(buffer);
+        buffer = grown;
+    }
+
+    private static ByteBuffer allocate(int capacity) {
+        // the native side reads the floats in place
+        return ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder());
+    }
+}
@@ -0,0 +1,204 @@
+package com.skity.graphic;
+
+import android.opengl.GLES20;
+import android.util.Log;
+import dalvik.annotation.optimization.CriticalNative;
+import dalvik.annotation.optimization.FastNative;
+
+/**
+ * Draws the same scene through a {@link CanvasCommands} stream and through one JNI call per
+ * canvas call, and compares the CPU time per frame. Both paths run the same native code for each
+ * command and skip the renderer's own content, so the difference is the cost of the bridge.
+ * <p>
+ * Every tenth shape also draws one of the renderer's images, so the result reports how many
+ * texture switches the image draws of a frame cost once the images share atlas pages.
+ * <p>
+ * Has to run on the GL thread of the renderer, e.g. from GLSurfaceView.Renderer#onDrawFrame.
+ */
+public final class CanvasCommandsBenchmark {
+    private static final String TAG = "SkityBridge";
+    // images the demo renderers load, out of range indices draw nothing
+    private static final int IMAGES = 12;
+
+    public static final class Result {
+        public int frames;
+        public int shapes;
+        // CPU time of recording, crossing into native code and drawing
+        public double streamMs;
+        public double perCallMs;
+        public int streamBytes;
+        public int perCallJniCalls;
+        // texture switches between the image draws of the last stream frame
+        public int textureBinds;
+
+        @Override
+        public String toString() {
+            return String.format("%d shapes: stream %.3f ms/frame (%d bytes, 1 call), "
+                            + "per call %.3f ms/frame (%d calls), %d texture binds/frame", shapes,
+                    streamMs, streamBytes, perCallMs, perCallJniCalls, textureBinds);
+        }
+    }
+
+    private CanvasCommandsBenchmark() {
+    }
+
+    public static Result run(Renderer renderer, int frames, int shapes) {
+        long handle = renderer.nativeHandle;
+        CanvasCommands commands = new CanvasCommands();
+
+        Result result = new Result();
+        result.frames = frames;
+        result.shapes = shapes;
+
+        long streamNs = 0;
+        long perCallNs = 0;
+
+        for (int frame = 0; frame < frames; frame++) {
+            long start = System.nanoTime();
+            commands.reset();
+            recordScene(commands, shapes, frame);
+            nativePlayCommands(handle, commands.buffer(), commands.size());
+            streamNs += System.nanoTime() - start;
+            result.textureBinds = nativeGetTextureBinds(handle);
+
+            // keep queued GPU work out of the next measurement
+            GLES20.glFinish();
+
+            start = System.nanoTime();
+            nativeBeginFrame(handle);
+            result.perCallJniCalls = callScene(handle, shapes, frame) + 2;
+            nativeEndFrame(handle);
+            perCallNs += System.nanoTime() - start;
+
+            GLES20.glFinish();
+        }
+
+        result.streamBytes = commands.size();
+        result.streamMs = frames > 0 ? streamNs / 1e6 / frames : 0.0;
+        result.perCallMs = frames > 0 ? perCallNs / 1e6 / frames : 0.0;
+
+        Log.i(TAG, result.toString());
+
+        return result;
+    }
+
+    private static void recordScene(CanvasCommands c, int shapes, int frame) {
+        c.setStyle(CanvasCommands.STYLE_FILL);
+        c.setTextSize(14.f);
+
+        for (int i = 0; i < shapes; i++) {
+            float x = (i * 37) % 1000;
+            float y = (i * 53) % 1800;
+
+            c.save();
+            c.translate(x, y);
+            c.rotate((frame + i) % 360);
+            c.setColor(0xFF000000 | (i * 0x3F5A7) & 0xFFFFFF);
+            c.drawRect(-20.f, -20.f, 20.f, 20.f);
+
+            c.moveTo(0.f, -30.f);
+            c.lineTo(26.f, 15.f);
+            c.cubicTo(10.f, 30.f, -10.f, 30.f, -26.f, 15.f);
+            c.close();
+            c.drawPath();
+
+            if (i % 10 == 0) {
+                c.drawText("item " + i, 0.f, 40.f);
+                c.drawImage(i / 10 % IMAGES, 30.f, -20.f, 70.f, 20.f);
+            }
+            c.restore();
+        }
+    }
+
+    private static int callScene(long h, int shapes, int frame) {
+        int calls = 2;
+        nativeSetStyle(h, CanvasCommands.STYLE_FILL);
+        nativeSetTextSize(h, 14.f);
+
+        for (int i = 0; i < shapes; i++) {
+            float x = (i * 37) % 1000;
+            float y = (i * 53) % 1800;
+
+            nativeSave(h);
+            nativeTranslate(h, x, y);
+            nativeRotate(h, (frame + i) % 360);
+            nativeSetColor(h, 0xFF000000 | (i * 0x3F5A7) & 0xFFFFFF);
+            nativeDrawRect(h, -20.f, -20.f, 20.f, 20.f);
+
+            nativeMoveTo(h, 0.f, -30.f);
+            nativeLineTo(h, 26.f, 15.f);
+            nativeCubicTo(h, 10.f, 30.f, -10.f, 30.f, -26.f, 15.f);
+            nativeClose(h);
+            nativeDrawPath(h);
+            calls += 10;
+
+            if (i % 10 == 0) {
+                nativeDrawText(h, "item " + i, 0.f, 40.f);
+                nativeDrawImage(h, i / 10 % IMAGES, 30.f, -20.f, 70.f, 20.f);
+                calls += 2;
+            }
+            nativeRestore(h);
+            calls++;
+        }
+
+        return calls;
+    }
+
+    private static native void nativePlayCommands(long handler, java.nio.ByteBuffer buffer,
+                                                  int size);
+
+    private static native void nativeBeginFrame(long handler);
+
+    private static native void nativeEndFrame(long handler);
+
+    @CriticalNative
+    private static native void nativeSave(long handler);
+
+    @CriticalNative
+    private static native void nativeRestore(long handler);
+
+    @CriticalNative
+    private static native void nativeTranslate(long handler, float dx, float dy);
+
+    @CriticalNative
+    private static native void nativeRotate(long handler, float degrees);
+
+    @CriticalNative
+    private static native void nativeSetColor(long handler, int argb);
+
+    @CriticalNative
+    private static native void nativeSetStyle(long handler, int style);
+
+    @CriticalNative
+    private static native void nativeSetTextSize(long handler, float size);
+
+    @CriticalNative
+    private static native void nativeDrawRect(long handler, float left, float top, float right,
+                                              float bottom);
+
+    @CriticalNative
+    private static native void nativeMoveTo(long handler, float x, float y);
+
+    @CriticalNative
+    private static native void nativeLineTo(long handler, float x, float y);
+
+    @CriticalNative
+    private static native void nativeCubicTo(long handler, float x1, float y1, float x2, float y2,
+                                             float x3, float y3);
+
+    @CriticalNative
+    private static native void nativeClose(long handler);
+
+    @CriticalNative
+    private static native void nativeDrawPath(long handler);
+
+    @FastNative
+    private static native void nativeDrawText(long handler, String text, float x, float y);
+
+    @CriticalNative
+    private static native void nativeDrawImage(long handler, int index, float left, float top,
+                                               float right, float bottom);
+
+    @CriticalNative
+    private static native int nativeGetTextureBinds(long handler);
+}
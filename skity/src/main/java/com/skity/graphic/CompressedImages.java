@@ -0,0 +1,45 @@
+package com.skity.graphic;
+
+import android.content.res.AssetManager;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Looks up pre-compressed (ETC2 KTX) variants of the demo images, produced by
+ * the etc_compress host tool. The native side loads them straight from the
+ * assets without going through BitmapFactory and decodes them on the CPU, the
+ * canvas only samples RGBA images. ASTC has no CPU decoder, so .astc files are
+ * not picked up.
+ */
+final class CompressedImages {
+
+    private CompressedImages() {
+    }
+
+    /**
+     * @return asset paths of image1..imageN in compressed form, or null if any
+     * of them is missing
+     */
+    static String[] find(AssetManager am, int count) {
+        List<String> files;
+        try {
+            files = Arrays.asList(am.list("images"));
+        } catch (IOException e) {
+            return null;
+        }
+
+        String[] paths = new String[count];
+        for (int i = 0; i < count; i++) {
+            String ktx = String.format("image%d.ktx", i + 1);
+
+            if (!files.contains(ktx)) {
+                return null;
+            }
+            paths[i] = "images/" + ktx;
+        }
+
+        return paths;
+    }
+}
@@ -5,6 +5,7 @@ import android.content.res.AssetManager;
 import android.graphics.Bitmap;
 import android.graphics.BitmapFactory;
 import android.util.Log;
+import dalvik.annotation.optimization.CriticalNative;
 
 import java.io.IOException;
 import java.util.ArrayList;
@@ -15,7 +16,7 @@ public class GLFrameRender extends Renderer {
 
     @Override
     public void init(int width, int height, int density, Context context) {
-        nativeHandle = nativeInitFrame(width, height, density, context);
+        setNativeHandle(nativeInitFrame(width, height, density, context));
         AssetManager am = context.getAssets();
 
 
@@ -27,6 +28,12 @@ public class GLFrameRender extends Renderer {
     private void initInternal(Context context) {
         images = new ArrayList<>(12);
         AssetManager am = context.getAssets();
+
+        String[] compressed = CompressedImages.find(am, 12);
+        if (compressed != null && nativeInitCompressedImages(nativeHandle, am, compressed)) {
+            return;
+        }
+
         for (int i = 0; i < 12; i++) {
             String imageName = String.format("images/image%d.jpg", i + 1);
             try {
@@ -40,6 +47,34 @@ public class GLFrameRender extends Renderer {
         nativeInitImages(nativeHandle, images);
     }
 
+    /**
+     * Index of the current step on the adaptive quality ladder, 0 is full quality.
+     */
+    public int getQualityLevel() {
+        return nativeGetQualityLevel(nativeHandle);
+    }
+
+    /**
+     * Recent quality level changes, oldest first. Every change takes four entries: frame number,
+     * previous level, new level and the average frame time in microseconds that triggered it.
+     */
+    public long[] getQualityTransitions() {
+        return nativeGetQualityTransitions(nativeHandle);
+    }
+
+    /**
+     * Draw the demo paths through the flattened path cache, off by default. Turn it on to
+     * compare the CPU Time graph with and without it, its hit rate is graphed below the frame
+     * time while on. Can be called from any thread.
+     */
+    public void setPathCacheEnabled(boolean enabled) {
+        synchronized (handleLock) {
+            if (nativeHandle != 0) {
+                nativeSetPathCache(nativeHandle, enabled);
+            }
+        }
+    }
+
     @Override
     public void destroy() {
         super.destroy();
@@ -54,4 +89,15 @@ public class GLFrameRender extends Renderer {
     private native void nativeInitImages(long nativeHandle, List<Bitmap> images);
 
     private native void nativeInitTypefaces(long nativeHandle, AssetManager assetManager);
+
+    private native boolean nativeInitCompressedImages(long nativeHandle, AssetManager assetManager,
+                                                      String[] paths);
+
+    @CriticalNative
+    private static native int nativeGetQualityLevel(long nativeHandle);
+
+    private native long[] nativeGetQualityTransitions(long nativeHandle);
+
+    @CriticalNative
+    private static native void nativeSetPathCache(long nativeHandle, boolean enabled);
 }
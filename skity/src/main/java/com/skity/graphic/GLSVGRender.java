@@ -2,16 +2,52 @@ package com.skity.graphic;
 
 import android.content.Context;
 import android.content.res.AssetManager;
+import dalvik.annotation.optimization.CriticalNative;
 
 public class GLSVGRender extends Renderer {
 
     @Override
     public void init(int width, int height, int density, Context context) {
-        nativeHandle = nativeInitSVG(width, height, density, context);
+        setNativeHandle(nativeInitSVG(width, height, density, context));
         nativeLoadSVG(nativeHandle, context.getAssets());
     }
 
+    /**
+     * Zoom and pan the document: it is scaled by zoom, then moved by (x, y). Can be called from
+     * any thread, the next frame picks it up.
+     */
+    public void setView(float zoom, float x, float y) {
+        synchronized (handleLock) {
+            if (nativeHandle != 0) {
+                nativeSetView(nativeHandle, zoom, x, y);
+            }
+        }
+    }
+
+    /**
+     * Skip the parts of the document outside the viewport, on by default.
+     */
+    public void setCulling(boolean culling) {
+        nativeSetCulling(nativeHandle, culling);
+    }
+
+    /**
+     * Groups and draws in the document, then groups visited, groups culled, draws issued and
+     * draws culled by the last frame.
+     */
+    public long[] getCullStats() {
+        return nativeGetCullStats(nativeHandle);
+    }
+
     private native long nativeInitSVG(int width, int height, int density, Context context);
 
     private native void nativeLoadSVG(long handler, AssetManager assetManager);
+
+    @CriticalNative
+    private static native void nativeSetView(long handler, float zoom, float x, float y);
+
+    @CriticalNative
+    private static native void nativeSetCulling(long handler, boolean culling);
+
+    private native long[] nativeGetCullStats(long handler);
 }
@@ -2,9 +2,15 @@ package com.skity.graphic;
 
 import android.content.Context;
 import android.content.res.AssetManager;
+import dalvik.annotation.optimization.CriticalNative;
+
+import java.nio.ByteBuffer;
 
 public class Renderer {
     protected long nativeHandle = 0;
+    // guards nativeHandle for calls made from other threads than the render thread, e.g.
+    // setInput(), so they never reach a destroyed renderer. Held only briefly.
+    protected final Object handleLock = new Object();
 
     static {
         System.loadLibrary("skity_android");
@@ -12,7 +18,7 @@ public class Renderer {
 
 
     public void init(int width, int height, int density, Context context) {
-        nativeHandle = nativeInit(width, height, density);
+        setNativeHandle(nativeInit(width, height, density));
         nativeLoadDefaultAssets(nativeHandle, context.getAssets());
     }
 
@@ -20,16 +26,89 @@ public class Renderer {
         nativeDraw(nativeHandle);
     }
 
+    /**
+     * Draw a frame with the recorded commands on top of the renderer's own content, in a single
+     * native call. The commands can be reset and recorded again once this returns.
+     */
+    public void draw(CanvasCommands commands) {
+        nativeDrawCommands(nativeHandle, commands.buffer(), commands.size());
+    }
+
+    /**
+     * For subclasses creating the native renderer themselves.
+     */
+    protected void setNativeHandle(long handle) {
+        synchronized (handleLock) {
+            nativeHandle = handle;
+        }
+    }
+
     public void destroy() {
-        nativeDestroy(nativeHandle);
+        long handle;
+        synchronized (handleLock) {
+            handle = nativeHandle;
+            nativeHandle = 0;
+        }
+        // no setInput() can reach the renderer any more
+        if (handle != 0) {
+            nativeDestroy(handle);
+        }
+    }
+
+    /**
+     * Multisample with the given sample count. A window surface of that sample count is drawn to
+     * directly. A single sampled one gets an offscreen multisampled-render-to-texture target,
+     * resolved on-tile and blitted into the window. Pass 0 to stop using the offscreen target.
+     * The EGL config should have a stencil buffer either way, it is drawn to when the offscreen
+     * target is not available.
+     */
+    public void setMSAASamples(int samples) {
+        nativeSetMSAASamples(nativeHandle, samples);
+    }
+
+    /**
+     * Hand the latest touch position to the renderer, from the UI thread. Frames read it right
+     * before recording, so a frame shows the newest position available at that point instead
+     * of the one at the start of the frame. Positions are in surface pixels.
+     *
+     * @param eventTimeNanos when the event happened on the uptime clock, e.g.
+     *                       MotionEvent#getEventTime() * 1000000, 0 for now
+     */
+    public void setInput(float x, float y, boolean down, long eventTimeNanos) {
+        // the UI thread may race destroy() on the render thread
+        synchronized (handleLock) {
+            if (nativeHandle != 0) {
+                nativeWriteInput(nativeHandle, x, y, down, eventTimeNanos);
+            }
+        }
+    }
+
+    /**
+     * Time from the input event to the queue submission of the frame that first showed it, over
+     * the last 120 such frames: frame count, last ms, average ms, max ms and the average ms until
+     * the frame read the input.
+     */
+    public float[] getInputLatency() {
+        return nativeGetInputLatency(nativeHandle);
     }
 
     private native long nativeInit(int width, int height, int density);
 
     private native void nativeLoadDefaultAssets(long handler, AssetManager assetManager);
 
+    // renders a whole frame, too long to hold off the GC as a fast native
     private native void nativeDraw(long handler);
 
+    private native void nativeDrawCommands(long handler, ByteBuffer buffer, int size);
+
     private native void nativeDestroy(long handler);
+
+    private native void nativeSetMSAASamples(long handler, int samples);
+
+    @CriticalNative
+    private static native void nativeWriteInput(long handler, float x, float y, boolean down,
+                                                long eventTimeNanos);
+
+    private native float[] nativeGetInputLatency(long handler);
 }
 
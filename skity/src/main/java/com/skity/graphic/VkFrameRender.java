@@ -5,6 +5,7 @@ import android.content.res.AssetManager;
 import android.graphics.Bitmap;
 import android.graphics.BitmapFactory;
 import android.view.Surface;
+import dalvik.annotation.optimization.CriticalNative;
 
 import java.io.IOException;
 import java.util.ArrayList;
@@ -25,6 +26,11 @@ public class VkFrameRender extends VkRenderer {
 
         nativeInitTypeface(nativeHandle, am);
 
+        String[] compressed = CompressedImages.find(am, 12);
+        if (compressed != null && nativeInitCompressedImages(nativeHandle, am, compressed)) {
+            return;
+        }
+
         for (int i = 0; i < 12; i++) {
             String imageName = String.format("images/image%d.jpg", i + 1);
             try {
@@ -39,9 +45,47 @@ public class VkFrameRender extends VkRenderer {
     }
 
 
+    /**
+     * Index of the current step on the adaptive quality ladder, 0 is full quality.
+     */
+    public int getQualityLevel() {
+        return nativeGetQualityLevel(nativeHandle);
+    }
+
+    /**
+     * Recent quality level changes, oldest first. Every change takes four entries: frame number,
+     * previous level, new level and the average frame time in microseconds that triggered it.
+     */
+    public long[] getQualityTransitions() {
+        return nativeGetQualityTransitions(nativeHandle);
+    }
+
+    /**
+     * Draw the demo paths through the flattened path cache, off by default. Turn it on to
+     * compare the CPU Time graph with and without it, its hit rate is graphed below the frame
+     * time while on. Can be called from any thread.
+     */
+    public void setPathCacheEnabled(boolean enabled) {
+        synchronized (handleLock) {
+            if (nativeHandle != 0) {
+                nativeSetPathCache(nativeHandle, enabled);
+            }
+        }
+    }
+
     private native long nativeInit(int width, int height, int density, Surface surface);
 
     private native void nativeInitTypeface(long handle, AssetManager am);
 
     private native void nativeInitImages(long handle, List<Bitmap> images);
+
+    private native boolean nativeInitCompressedImages(long handle, AssetManager am, String[] paths);
+
+    @CriticalNative
+    private static native int nativeGetQualityLevel(long handle);
+
+    private native long[] nativeGetQualityTransitions(long handle);
+
+    @CriticalNative
+    private static native void nativeSetPathCache(long handle, boolean enabled);
 }
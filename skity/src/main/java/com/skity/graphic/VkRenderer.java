@@ -3,16 +3,31 @@ package com.skity.graphic;
 import android.content.Context;
 import android.content.res.AssetManager;
 import android.view.Surface;
+import dalvik.annotation.optimization.CriticalNative;
+
+import java.nio.ByteBuffer;
 
 public abstract class VkRenderer {
+    /**
+     * Categories of {@link #getMemoryStats()}, in order.
+     */
+    public static final int MEMORY_ATTACHMENT = 0;
+    public static final int MEMORY_TEXTURE = 1;
+    public static final int MEMORY_STAGING = 2;
+    public static final int MEMORY_SKITY = 3;
+    public static final int MEMORY_CATEGORY_COUNT = 4;
+
     protected long nativeHandle = 0;
+    // guards nativeHandle for calls made from other threads than the render thread, e.g.
+    // setInput(), so they never reach a destroyed renderer. Held only briefly.
+    protected final Object handleLock = new Object();
 
     static {
         System.loadLibrary("skity_android");
     }
 
     public void init(int width, int height, int density, Context context, Surface surface) {
-        nativeHandle = createNativeHandle(width, height, density, surface);
+        setNativeHandle(createNativeHandle(width, height, density, surface));
         nativeLoadDefaultAssets(nativeHandle, context.getAssets());
 
         onInit(context);
@@ -22,12 +37,133 @@ public abstract class VkRenderer {
         nativeDraw(nativeHandle);
     }
 
+    /**
+     * Draw a frame with the recorded commands on top of the renderer's own content, in a single
+     * native call. The commands can be reset and recorded again once this returns.
+     */
+    public void draw(CanvasCommands commands) {
+        nativeDrawCommands(nativeHandle, commands.buffer(), commands.size());
+    }
+
+    /**
+     * For subclasses creating the native renderer themselves.
+     */
+    protected void setNativeHandle(long handle) {
+        synchronized (handleLock) {
+            nativeHandle = handle;
+        }
+    }
+
     public void destroy() {
-        if (nativeHandle == 0) {
-            return;
+        long handle;
+        synchronized (handleLock) {
+            handle = nativeHandle;
+            nativeHandle = 0;
+        }
+        // no setInput() can reach the renderer any more
+        if (handle != 0) {
+            nativeDestroy(handle);
         }
-        nativeDestroy(nativeHandle);
-        nativeHandle = 0;
+    }
+
+    /**
+     * Render at a fraction of the surface size and upscale into the window with a linear blit.
+     * The scale is clamped to [0.25, 1], 1 renders at full size. Takes effect on the next frame.
+     */
+    public void setRenderScale(float scale) {
+        nativeSetRenderScale(nativeHandle, scale);
+    }
+
+    /**
+     * Device memory accounting. Starts with bytes and allocation count of every MEMORY_* category,
+     * followed by size, budget, usage and VkMemoryHeapFlags of every device heap. Heap usage
+     * covers the whole process when the device has VK_EXT_memory_budget.
+     */
+    public long[] getMemoryStats() {
+        return nativeGetMemoryStats(nativeHandle);
+    }
+
+    /**
+     * Highest usage / budget ratio over the device heaps. Above 1 caches should be dropped or
+     * quality lowered before the system starts killing processes.
+     */
+    public float getMemoryPressure() {
+        return nativeGetMemoryPressure(nativeHandle);
+    }
+
+    /**
+     * Render once per vsync from native Choreographer callbacks instead of calling {@link #draw()}
+     * from Java. Animations use the vsync timestamp, and a vsync whose callback arrives after the
+     * next one was due is skipped. Has to be called on a thread with a Looper, usually the main
+     * thread, which is also where the frames are rendered. Runs until {@link #stopFrameLoop()} or
+     * {@link #destroy()}, called on the same thread.
+     *
+     * @return false if the thread has no Looper
+     */
+    public boolean startFrameLoop() {
+        return nativeStartFrameLoop(nativeHandle);
+    }
+
+    public void stopFrameLoop() {
+        nativeStopFrameLoop(nativeHandle);
+    }
+
+    /**
+     * Counters of the frame loop: vsyncs delivered, frames rendered, vsyncs skipped because they
+     * arrived late, and the measured refresh period in microseconds.
+     */
+    public long[] getFrameLoopStats() {
+        return nativeGetFrameLoopStats(nativeHandle);
+    }
+
+    /**
+     * Hand the latest touch position to the renderer, from the UI thread. Frames read it right
+     * before recording, so a frame shows the newest position available at that point instead
+     * of the one at the start of the frame. Positions are in surface pixels.
+     *
+     * @param eventTimeNanos when the event happened on the uptime clock, e.g.
+     *                       MotionEvent#getEventTime() * 1000000, 0 for now
+     */
+    public void setInput(float x, float y, boolean down, long eventTimeNanos) {
+        // the UI thread may race destroy() on the render thread
+        synchronized (handleLock) {
+            if (nativeHandle != 0) {
+                nativeWriteInput(nativeHandle, x, y, down, eventTimeNanos);
+            }
+        }
+    }
+
+    /**
+     * Time from the input event to the queue submission of the frame that first showed it, over
+     * the last 120 such frames: frame count, last ms, average ms, max ms and the average ms until
+     * the frame read the input.
+     */
+    public float[] getInputLatency() {
+        return nativeGetInputLatency(nativeHandle);
+    }
+
+    /**
+     * Declare that the content only changes through {@link #invalidateContent()}, the clear
+     * color or the commands passed to {@link #draw(CanvasCommands)}. Unchanged frames then
+     * resubmit the command buffer recorded for their swapchain image instead of drawing the
+     * canvas again.
+     */
+    public void setStaticContent(boolean isStatic) {
+        nativeSetStaticContent(nativeHandle, isStatic);
+    }
+
+    /**
+     * Static content changed, every swapchain image is recorded again.
+     */
+    public void invalidateContent() {
+        nativeInvalidateContent(nativeHandle);
+    }
+
+    /**
+     * Frames drawn and how many of them reused an earlier command buffer recording.
+     */
+    public long[] getCommandReuse() {
+        return nativeGetCommandReuse(nativeHandle);
     }
 
     protected abstract long createNativeHandle(int width, int height, int density, Surface surface);
@@ -36,7 +172,38 @@ public abstract class VkRenderer {
 
     private native void nativeLoadDefaultAssets(long handler, AssetManager assetManager);
 
+    // renders a whole frame, too long to hold off the GC as a fast native
     private native void nativeDraw(long handler);
 
     private native void nativeDestroy(long handler);
+
+    @CriticalNative
+    private static native void nativeSetRenderScale(long handler, float scale);
+
+    private native void nativeDrawCommands(long handler, ByteBuffer buffer, int size);
+
+    private native long[] nativeGetMemoryStats(long handler);
+
+    @CriticalNative
+    private static native float nativeGetMemoryPressure(long handler);
+
+    private native boolean nativeStartFrameLoop(long handler);
+
+    private native void nativeStopFrameLoop(long handler);
+
+    private native long[] nativeGetFrameLoopStats(long handler);
+
+    @CriticalNative
+    private static native void nativeWriteInput(long handler, float x, float y, boolean down,
+                                                long eventTimeNanos);
+
+    private native float[] nativeGetInputLatency(long handler);
+
+    @CriticalNative
+    private static native void nativeSetStaticContent(long handler, boolean isStatic);
+
+    @CriticalNative
+    private static native void nativeInvalidateContent(long handler);
+
+    private native long[] nativeGetCommandReuse(long handler);
 }
@@ -3,6 +3,7 @@ package com.skity.graphic;
 import android.content.Context;
 import android.content.res.AssetManager;
 import android.view.Surface;
+import dalvik.annotation.optimization.CriticalNative;
 
 public class VkSVGRenderer extends VkRenderer {
     @Override
@@ -15,7 +16,65 @@ public class VkSVGRenderer extends VkRenderer {
         nativeInitSVGDom(nativeHandle, context.getAssets());
     }
 
+    /**
+     * Zoom and pan the document: it is scaled by zoom, then moved by (x, y). Can be called from
+     * any thread, the next frame picks it up.
+     */
+    public void setView(float zoom, float x, float y) {
+        synchronized (handleLock) {
+            if (nativeHandle != 0) {
+                nativeSetView(nativeHandle, zoom, x, y);
+            }
+        }
+    }
+
+    /**
+     * Skip the parts of the document outside the viewport, on by default.
+     */
+    public void setCulling(boolean culling) {
+        nativeSetCulling(nativeHandle, culling);
+    }
+
+    /**
+     * Groups and draws in the document, then groups visited, groups culled, draws issued and
+     * draws culled by the last frame.
+     */
+    public long[] getCullStats() {
+        return nativeGetCullStats(nativeHandle);
+    }
+
+    /**
+     * Composite the view from tiles rendered at discrete zoom levels instead of drawing the
+     * document every frame. Tiles still missing are rendered a few per frame, coarser tiles
+     * stand in for them until then. Off by default: tiles have no text, gradients or clips.
+     */
+    public void setTiled(boolean tiled) {
+        nativeSetTiled(nativeHandle, tiled);
+    }
+
+    /**
+     * Tile level, then tiles visible, up to date, covered by placeholders and missing, tiles
+     * rendered, tiles cached and the microseconds spent rendering them, all of the last tiled
+     * frame.
+     */
+    public long[] getTileStats() {
+        return nativeGetTileStats(nativeHandle);
+    }
+
     private native long nativeCreateSVGRender(int width, int height, int density, Surface surface);
 
     private native void nativeInitSVGDom(long handler, AssetManager assetManager);
+
+    @CriticalNative
+    private static native void nativeSetView(long handler, float zoom, float x, float y);
+
+    @CriticalNative
+    private static native void nativeSetCulling(long handler, boolean culling);
+
+    private native long[] nativeGetCullStats(long handler);
+
+    @CriticalNative
+    private static native void nativeSetTiled(long handler, boolean tiled);
+
+    private native long[] nativeGetTileStats(long handler);
 }
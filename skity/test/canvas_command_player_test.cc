@@ -0,0 +1,206 @@
+// CanvasCommandPlayer executes a command stream in order, restores the saves
+// it leaves open and stops at the first malformed command.
+
+#include "canvas_commands.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "test_check.hpp"
+
+/**
+ * Writes a command stream the way CanvasCommands.java does: opcode byte,
+ * arguments in native byte order, no padding.
+ */
+class StreamWriter {
+public:
+    StreamWriter &op(CanvasOp op) { return put(static_cast<uint8_t>(op)); }
+
+    template<class T>
+    StreamWriter &put(T value) {
+        size_t offset = data_.size();
+        data_.resize(offset + sizeof(T));
+        std::memcpy(data_.data() + offset, &value, sizeof(T));
+        return *this;
+    }
+
+    StreamWriter &floats(std::initializer_list<float> values) {
+        for (float value : values) {
+            put(value);
+        }
+        return *this;
+    }
+
+    uint8_t const *Data() const { return data_.data(); }
+
+    size_t Size() const { return data_.size(); }
+
+private:
+    std::vector<uint8_t> data_ = {};
+};
+
+/**
+ * Counts paths drawn and tracks the save depth.
+ */
+class CountingCanvas : public skity::Canvas {
+public:
+    CountingCanvas() { onUpdateViewport(100, 100); }
+
+    ~CountingCanvas() override = default;
+
+    uint32_t PathDraws() const { return path_draws_; }
+
+    int32_t Depth() const { return depth_; }
+
+    int32_t MaxDepth() const { return max_depth_; }
+
+protected:
+    void onClipPath(skity::Path const &path, ClipOp op) override {}
+
+    void onDrawPath(skity::Path const &path, skity::Paint const &paint) override {
+        path_draws_++;
+    }
+
+    void onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                    skity::Paint const &paint) override {}
+
+    void onSave() override {
+        depth_++;
+        if (depth_ > max_depth_) {
+            max_depth_ = depth_;
+        }
+    }
+
+    void onRestore() override { depth_--; }
+
+    void onTranslate(float dx, float dy) override {}
+
+    void onScale(float sx, float sy) override {}
+
+    void onRotate(float degree) override {}
+
+    void onRotate(float degree, float px, float py) override {}
+
+    void onConcat(skity::Matrix const &matrix) override {}
+
+    void onFlush() override {}
+
+    uint32_t onGetWidth() const override { return width_; }
+
+    uint32_t onGetHeight() const override { return height_; }
+
+    void onUpdateViewport(uint32_t width, uint32_t height) override {
+        width_ = width;
+        height_ = height;
+    }
+
+private:
+    uint32_t width_ = {};
+    uint32_t height_ = {};
+    uint32_t path_draws_ = {};
+    int32_t depth_ = {};
+    int32_t max_depth_ = {};
+};
+
+static void test_plays_stream() {
+    StreamWriter stream;
+    stream.op(CanvasOp::kSave)
+        .op(CanvasOp::kTranslate).floats({10.f, 20.f})
+        .op(CanvasOp::kSetColor).put(uint32_t{0xff336699})
+        .op(CanvasOp::kDrawRect).floats({0.f, 0.f, 10.f, 10.f})
+        .op(CanvasOp::kMoveTo).floats({0.f, 0.f})
+        .op(CanvasOp::kLineTo).floats({10.f, 0.f})
+        .op(CanvasOp::kLineTo).floats({10.f, 10.f})
+        .op(CanvasOp::kClose)
+        .op(CanvasOp::kDrawPath)
+        .op(CanvasOp::kDrawCircle).floats({50.f, 50.f, 5.f})
+        .op(CanvasOp::kRestore);
+
+    CanvasCommandPlayer player;
+    CountingCanvas canvas;
+    CHECK(player.play(&canvas, stream.Data(), stream.Size()));
+
+    auto const &stats = player.LastStats();
+    CHECK(stats.commands == 11);
+    CHECK(stats.draws == 3);
+    CHECK(stats.bytes == stream.Size());
+    CHECK(!stats.malformed);
+    CHECK(canvas.PathDraws() >= 3);
+    CHECK(canvas.Depth() == 0 && canvas.MaxDepth() == 1);
+
+    // the color does not leak into the next stream
+    CHECK(player.play(&canvas, nullptr, 0));
+    skity::Color4f color = player.GetPaint().GetFillColor();
+    CHECK(color.r == 0.f && color.g == 0.f && color.b == 0.f && color.a == 1.f);
+    CHECK(player.LastStats().commands == 0);
+}
+
+static void test_balances_saves() {
+    StreamWriter stream;
+    // one restore too many at the start, two saves left open
+    stream.op(CanvasOp::kRestore).op(CanvasOp::kSave).op(CanvasOp::kSave);
+
+    CanvasCommandPlayer player;
+    CountingCanvas canvas;
+    CHECK(player.play(&canvas, stream.Data(), stream.Size()));
+    CHECK(player.LastStats().commands == 3);
+    CHECK(canvas.MaxDepth() == 2);
+    CHECK(canvas.Depth() == 0);
+}
+
+static void test_malformed() {
+    CanvasCommandPlayer player;
+    CountingCanvas canvas;
+
+    // argument cut off
+    StreamWriter truncated;
+    truncated.op(CanvasOp::kSave).op(CanvasOp::kDrawRect).floats({0.f, 0.f, 10.f});
+    CHECK(!player.play(&canvas, truncated.Data(), truncated.Size()));
+    CHECK(player.LastStats().malformed);
+    CHECK(player.LastStats().error_offset == 1);
+    CHECK(player.LastStats().commands == 1);
+    CHECK(player.LastStats().draws == 0);
+    CHECK(canvas.Depth() == 0);
+
+    // unknown opcode, the commands before it still ran
+    StreamWriter unknown;
+    unknown.op(CanvasOp::kDrawCircle).floats({1.f, 2.f, 3.f}).put(uint8_t{0xee});
+    unknown.op(CanvasOp::kClose);
+    CHECK(!player.play(&canvas, unknown.Data(), unknown.Size()));
+    CHECK(player.LastStats().error_offset == 1 + 3 * sizeof(float));
+    CHECK(player.LastStats().draws == 1);
+
+    // text byte count past the end of the stream
+    StreamWriter text;
+    text.op(CanvasOp::kDrawText).floats({0.f, 0.f}).put(uint16_t{100}).put('a');
+    CHECK(!player.play(&canvas, text.Data(), text.Size()));
+    CHECK(player.LastStats().error_offset == 0);
+
+    // style out of range
+    StreamWriter style;
+    style.op(CanvasOp::kSetStyle).put(uint8_t{3});
+    CHECK(!player.play(&canvas, style.Data(), style.Size()));
+    CHECK(player.LastStats().error_offset == 0);
+}
+
+static void test_missing_image() {
+    StreamWriter stream;
+    stream.op(CanvasOp::kDrawImage).put(uint32_t{5}).floats({0.f, 0.f, 10.f, 10.f});
+
+    // an index without an image is skipped, the stream is still fine
+    CanvasCommandPlayer player;
+    CountingCanvas canvas;
+    CHECK(player.play(&canvas, stream.Data(), stream.Size()));
+    CHECK(player.LastStats().draws == 1);
+    CHECK(player.LastStats().image_draws == 0);
+    CHECK(player.LastStats().texture_binds == 0);
+}
+
+int main() {
+    test_plays_stream();
+    test_balances_saves();
+    test_malformed();
+    test_missing_image();
+
+    return CheckResult();
+}
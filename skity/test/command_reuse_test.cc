@@ -0,0 +1,96 @@
+// CommandReuseTracker lets a swapchain image replay its recording only from
+// the slot that made it and only while no other content was flushed since.
+
+#include "command_reuse.hpp"
+
+#include "test_check.hpp"
+
+static constexpr uint32_t kImages = 3;
+static constexpr uint64_t kStatic = 42;
+
+/**
+ * Draw one frame the way VkRenderer::draw() does, slot and image in step.
+ *
+ * @return true if the frame replayed its recording
+ */
+static bool draw(CommandReuseTracker *tracker, uint32_t frame, uint64_t key) {
+    uint32_t image = frame % kImages;
+    if (tracker->CanReuse(image, image, key)) {
+        return true;
+    }
+
+    tracker->recorded(image, image, key);
+    return false;
+}
+
+static void test_static_content() {
+    CommandReuseTracker tracker;
+    tracker.reset(kImages);
+
+    // every image records once, then all of them replay
+    uint32_t frame = 0;
+    for (; frame < kImages; frame++) {
+        CHECK(!draw(&tracker, frame, kStatic));
+    }
+    for (; frame < 4 * kImages; frame++) {
+        CHECK(draw(&tracker, frame, kStatic));
+    }
+
+    // nothing is replayed for key 0
+    CommandReuseTracker dynamic;
+    dynamic.reset(kImages);
+    for (frame = 0; frame < 4 * kImages; frame++) {
+        CHECK(!draw(&dynamic, frame, 0));
+    }
+}
+
+static void test_other_flush_ends_reuse() {
+    CommandReuseTracker tracker;
+    tracker.reset(kImages);
+
+    uint32_t frame = 0;
+    for (; frame < kImages; frame++) {
+        draw(&tracker, frame, kStatic);
+    }
+
+    // one frame of other content rewrites the shared resources, the images
+    // recorded before it have to record again even once the content is back
+    CHECK(!draw(&tracker, frame++, 7));
+    for (uint32_t i = 0; i < kImages; i++) {
+        CHECK(!draw(&tracker, frame++, kStatic));
+    }
+    CHECK(draw(&tracker, frame++, kStatic));
+
+    // the same holds for frames that are recorded every time
+    CHECK(!draw(&tracker, frame++, 0));
+    CHECK(!draw(&tracker, frame++, kStatic));
+}
+
+static void test_slot_and_image() {
+    CommandReuseTracker tracker;
+    tracker.reset(kImages);
+    tracker.recorded(0, 1, kStatic);
+
+    CHECK(tracker.CanReuse(0, 1, kStatic));
+    CHECK(!tracker.CanReuse(1, 1, kStatic));
+    CHECK(!tracker.CanReuse(0, 0, kStatic));
+    CHECK(!tracker.CanReuse(0, 1, kStatic + 1));
+    CHECK(!tracker.CanReuse(0, kImages, kStatic));
+
+    // a failed recording leaves nothing to replay
+    tracker.dropped(1);
+    CHECK(!tracker.CanReuse(0, 1, kStatic));
+
+    // a new swapchain forgets everything
+    tracker.recorded(0, 1, kStatic);
+    tracker.reset(kImages);
+    CHECK(!tracker.CanReuse(0, 1, kStatic));
+}
+
+int main() {
+    test_static_content();
+    test_other_flush_ends_reuse();
+    test_slot_and_image();
+
+    return CheckResult();
+}
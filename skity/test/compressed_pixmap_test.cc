@@ -0,0 +1,238 @@
+// KTX and .astc headers are parsed into the right format and size, and
+// truncated or oversized files are rejected instead of read past their end.
+
+#include "compressed_pixmap.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "test_check.hpp"
+
+static constexpr uint32_t kGL_ETC1_RGB8_OES = 0x8D64;
+static constexpr uint32_t kGL_COMPRESSED_RGB8_ETC2 = 0x9274;
+static constexpr uint32_t kGL_COMPRESSED_RGBA8_ETC2_EAC = 0x9278;
+static constexpr uint32_t kGL_COMPRESSED_RGBA_ASTC_4x4_KHR = 0x93B0;
+static constexpr uint32_t kGL_COMPRESSED_RGBA_ASTC_8x8_KHR = 0x93B7;
+
+static void put_u32(std::vector<uint8_t> *out, uint32_t v, bool big_endian) {
+    for (int i = 0; i < 4; i++) {
+        int shift = big_endian ? (3 - i) * 8 : i * 8;
+        out->emplace_back(static_cast<uint8_t>(v >> shift));
+    }
+}
+
+struct KTXDesc {
+    uint32_t internal_format = kGL_COMPRESSED_RGB8_ETC2;
+    uint32_t width = 8;
+    uint32_t height = 8;
+    uint32_t depth = 0;
+    uint32_t faces = 1;
+    uint32_t key_value_bytes = 0;
+    uint32_t image_size = 0;
+    // bytes after imageSize
+    size_t data_size = 0;
+    bool big_endian = false;
+};
+
+static std::vector<uint8_t> make_ktx(KTXDesc const &desc) {
+    static const uint8_t kIdentifier[12] = {
+            0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n',
+    };
+
+    std::vector<uint8_t> ktx{kIdentifier, kIdentifier + sizeof(kIdentifier)};
+    put_u32(&ktx, 0x04030201, desc.big_endian);
+    put_u32(&ktx, 0, desc.big_endian);  // glType
+    put_u32(&ktx, 1, desc.big_endian);  // glTypeSize
+    put_u32(&ktx, 0, desc.big_endian);  // glFormat
+    put_u32(&ktx, desc.internal_format, desc.big_endian);
+    put_u32(&ktx, 0x1907, desc.big_endian);  // glBaseInternalFormat, GL_RGB
+    put_u32(&ktx, desc.width, desc.big_endian);
+    put_u32(&ktx, desc.height, desc.big_endian);
+    put_u32(&ktx, desc.depth, desc.big_endian);
+    put_u32(&ktx, 0, desc.big_endian);  // numberOfArrayElements
+    put_u32(&ktx, desc.faces, desc.big_endian);
+    put_u32(&ktx, 1, desc.big_endian);  // numberOfMipmapLevels
+    put_u32(&ktx, desc.key_value_bytes, desc.big_endian);
+    ktx.resize(ktx.size() + std::min<size_t>(desc.key_value_bytes, 64), 0);
+    put_u32(&ktx, desc.image_size, desc.big_endian);
+
+    for (size_t i = 0; i < desc.data_size; i++) {
+        ktx.emplace_back(static_cast<uint8_t>(i));
+    }
+
+    return ktx;
+}
+
+static std::vector<uint8_t> make_astc(uint32_t block_width, uint32_t block_height,
+                                      uint32_t block_depth, uint32_t width, uint32_t height,
+                                      size_t data_size) {
+    std::vector<uint8_t> astc = {0x13, 0xAB, 0xA1, 0x5C};
+    astc.emplace_back(static_cast<uint8_t>(block_width));
+    astc.emplace_back(static_cast<uint8_t>(block_height));
+    astc.emplace_back(static_cast<uint8_t>(block_depth));
+    for (uint32_t v : {width, height, 1u}) {
+        astc.emplace_back(static_cast<uint8_t>(v));
+        astc.emplace_back(static_cast<uint8_t>(v >> 8));
+        astc.emplace_back(static_cast<uint8_t>(v >> 16));
+    }
+    astc.resize(astc.size() + data_size, 0x5A);
+
+    return astc;
+}
+
+static std::shared_ptr<CompressedPixmap> parse(std::vector<uint8_t> const &data) {
+    return CompressedPixmap::MakeFromData(data.data(), data.size());
+}
+
+static void test_ktx_etc2() {
+    KTXDesc desc;
+    desc.image_size = 32;
+    desc.data_size = 32;
+
+    auto pixmap = parse(make_ktx(desc));
+    CHECK(pixmap != nullptr);
+    if (pixmap) {
+        CHECK(pixmap->Format() == CompressedFormat::kETC2_RGB8);
+        CHECK(pixmap->Width() == 8);
+        CHECK(pixmap->Height() == 8);
+        CHECK(pixmap->BlocksSize() == 32);
+        CHECK(pixmap->Blocks()[31] == 31);
+        CHECK(pixmap->GLInternalFormat() == kGL_COMPRESSED_RGB8_ETC2);
+        CHECK(pixmap->Decode() != nullptr);
+    }
+
+    // ETC1 loads as ETC2 RGB8, a subset of it
+    desc.internal_format = kGL_ETC1_RGB8_OES;
+    pixmap = parse(make_ktx(desc));
+    CHECK(pixmap && pixmap->Format() == CompressedFormat::kETC2_RGB8);
+
+    // edge blocks cover the pixels past 5x5
+    desc.internal_format = kGL_COMPRESSED_RGBA8_ETC2_EAC;
+    desc.width = 5;
+    desc.height = 5;
+    desc.image_size = 64;
+    desc.data_size = 64;
+    pixmap = parse(make_ktx(desc));
+    CHECK(pixmap && pixmap->Format() == CompressedFormat::kETC2_RGBA8);
+    CHECK(pixmap && pixmap->BlocksSize() == 64);
+}
+
+static void test_ktx_big_endian() {
+    KTXDesc desc;
+    desc.width = 4;
+    desc.height = 12;
+    desc.image_size = 24;
+    desc.data_size = 24;
+    desc.big_endian = true;
+
+    auto pixmap = parse(make_ktx(desc));
+    CHECK(pixmap != nullptr);
+    CHECK(pixmap && pixmap->Width() == 4 && pixmap->Height() == 12);
+}
+
+static void test_ktx_astc() {
+    KTXDesc desc;
+    desc.internal_format = kGL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+    desc.width = 20;
+    desc.height = 9;
+    // 3 x 2 blocks of 16 bytes
+    desc.image_size = 96;
+    desc.data_size = 96;
+
+    auto pixmap = parse(make_ktx(desc));
+    CHECK(pixmap != nullptr);
+    if (pixmap) {
+        CHECK(pixmap->Format() == CompressedFormat::kASTC);
+        CHECK(pixmap->BlockWidth() == 8 && pixmap->BlockHeight() == 8);
+        CHECK(pixmap->BlocksSize() == 96);
+        CHECK(pixmap->GLInternalFormat() == kGL_COMPRESSED_RGBA_ASTC_8x8_KHR);
+        // no CPU decoder for ASTC
+        CHECK(pixmap->Decode() == nullptr);
+    }
+
+    // past the last 2D footprint
+    desc.internal_format = kGL_COMPRESSED_RGBA_ASTC_4x4_KHR + 14;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+
+    desc.internal_format = 0x8058;  // GL_RGBA8, not compressed
+    CHECK(parse(make_ktx(desc)) == nullptr);
+}
+
+static void test_ktx_rejects() {
+    KTXDesc valid;
+    valid.image_size = 32;
+    valid.data_size = 32;
+
+    auto ktx = make_ktx(valid);
+
+    // every truncation of a valid file
+    for (size_t size = 0; size < ktx.size(); size++) {
+        CHECK(CompressedPixmap::MakeFromData(ktx.data(), size) == nullptr);
+    }
+
+    KTXDesc desc = valid;
+    desc.image_size = 31;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+
+    desc = valid;
+    desc.key_value_bytes = 0xFFFFFFF0;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+
+    desc = valid;
+    desc.width = 0;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+
+    desc = valid;
+    desc.depth = 2;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+
+    desc = valid;
+    desc.faces = 6;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+
+    // 2^32 - 1 square, far more blocks than the file holds on any ABI
+    desc = valid;
+    desc.width = 0xFFFFFFFF;
+    desc.height = 0xFFFFFFFF;
+    desc.image_size = 0xFFFFFFFF;
+    CHECK(parse(make_ktx(desc)) == nullptr);
+}
+
+static void test_astc() {
+    // 12x12 at 6x6 is 2 x 2 blocks
+    auto pixmap = parse(make_astc(6, 6, 1, 12, 12, 64));
+    CHECK(pixmap != nullptr);
+    if (pixmap) {
+        CHECK(pixmap->Format() == CompressedFormat::kASTC);
+        CHECK(pixmap->Width() == 12 && pixmap->Height() == 12);
+        CHECK(pixmap->BlockWidth() == 6 && pixmap->BlockHeight() == 6);
+        CHECK(pixmap->BlocksSize() == 64);
+        CHECK(pixmap->GLInternalFormat() == kGL_COMPRESSED_RGBA_ASTC_4x4_KHR + 4);
+    }
+
+    CHECK(parse(make_astc(6, 6, 1, 12, 12, 63)) == nullptr);
+    // not a footprint
+    CHECK(parse(make_astc(7, 7, 1, 12, 12, 64)) == nullptr);
+    // 3D
+    CHECK(parse(make_astc(6, 6, 2, 12, 12, 64)) == nullptr);
+    CHECK(parse(make_astc(6, 6, 1, 0, 12, 64)) == nullptr);
+    // 2^24 - 1 square at 4x4 needs 16 TiB of blocks
+    CHECK(parse(make_astc(4, 4, 1, 0xFFFFFF, 0xFFFFFF, 64)) == nullptr);
+
+    auto astc = make_astc(4, 4, 1, 4, 4, 16);
+    for (size_t size = 0; size < astc.size(); size++) {
+        CHECK(CompressedPixmap::MakeFromData(astc.data(), size) == nullptr);
+    }
+}
+
+int main() {
+    test_ktx_etc2();
+    test_ktx_big_endian();
+    test_ktx_astc();
+    test_ktx_rejects();
+    test_astc();
+
+    return CheckResult();
+}
@@ -0,0 +1,157 @@
+// Known blocks decode to the colors the ETC2 spec gives them, and the encoder
+// round trips smooth and two colored blocks within a few steps per channel.
+
+#include "etc2_codec.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "test_check.hpp"
+
+// largest difference of one channel over the block
+static int max_error(const uint8_t *a, const uint8_t *b, int first, int channels) {
+    int error = 0;
+    for (int i = 0; i < 16; i++) {
+        for (int c = first; c < first + channels; c++) {
+            error = std::max(error, std::abs(a[i * 4 + c] - b[i * 4 + c]));
+        }
+    }
+    return error;
+}
+
+static bool is_pixel(const uint8_t *pixels, int x, int y, int r, int g, int b, int a) {
+    const uint8_t *p = pixels + (y * 4 + x) * 4;
+    return p[0] == r && p[1] == g && p[2] == b && p[3] == a;
+}
+
+static void test_individual_block() {
+    // base 0x8/0x4/0x2 in both halves, table 0, every selector 0: +2
+    const uint8_t block[8] = {0x88, 0x44, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00};
+    uint8_t pixels[16 * 4];
+    etc2::decode_rgb_block(block, pixels);
+
+    for (int i = 0; i < 16; i++) {
+        CHECK(is_pixel(pixels, i % 4, i / 4, 138, 70, 36, 255));
+    }
+}
+
+static void test_sub_blocks() {
+    // left half 0x8, right half 0x2, every selector msb set: -2
+    const uint8_t block[8] = {0x82, 0x82, 0x82, 0x00, 0xFF, 0xFF, 0x00, 0x00};
+    uint8_t pixels[16 * 4];
+    etc2::decode_rgb_block(block, pixels);
+
+    for (int y = 0; y < 4; y++) {
+        CHECK(is_pixel(pixels, 0, y, 134, 134, 134, 255));
+        CHECK(is_pixel(pixels, 1, y, 134, 134, 134, 255));
+        CHECK(is_pixel(pixels, 2, y, 32, 32, 32, 255));
+        CHECK(is_pixel(pixels, 3, y, 32, 32, 32, 255));
+    }
+
+    // same with the flip bit, top and bottom halves
+    const uint8_t flipped[8] = {0x82, 0x82, 0x82, 0x01, 0xFF, 0xFF, 0x00, 0x00};
+    etc2::decode_rgb_block(flipped, pixels);
+
+    for (int x = 0; x < 4; x++) {
+        CHECK(is_pixel(pixels, x, 0, 134, 134, 134, 255));
+        CHECK(is_pixel(pixels, x, 1, 134, 134, 134, 255));
+        CHECK(is_pixel(pixels, x, 2, 32, 32, 32, 255));
+        CHECK(is_pixel(pixels, x, 3, 32, 32, 32, 255));
+    }
+}
+
+static void test_alpha_block() {
+    // base 128, multiplier 1, table 13, every index 7: +9
+    const uint8_t block[8] = {128, 0x1D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t pixels[16 * 4] = {};
+    etc2::decode_alpha_block(block, pixels);
+
+    for (int i = 0; i < 16; i++) {
+        CHECK(pixels[i * 4 + 3] == 137);
+        // color is left alone
+        CHECK(pixels[i * 4] == 0);
+    }
+}
+
+static void test_round_trip_gradient() {
+    uint8_t pixels[16 * 4];
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            uint8_t *p = pixels + (y * 4 + x) * 4;
+            p[0] = static_cast<uint8_t>(100 + x * 6);
+            p[1] = static_cast<uint8_t>(60 + y * 6);
+            p[2] = static_cast<uint8_t>(180 - x * 3 - y * 3);
+            p[3] = 255;
+        }
+    }
+
+    uint8_t block[8];
+    etc2::encode_rgb_block(pixels, block);
+
+    uint8_t decoded[16 * 4];
+    etc2::decode_rgb_block(block, decoded);
+
+    CHECK(max_error(pixels, decoded, 0, 3) <= 12);
+}
+
+static void test_round_trip_two_colors() {
+    uint8_t pixels[16 * 4];
+    for (int i = 0; i < 16; i++) {
+        bool left = (i % 4) < 2;
+        pixels[i * 4] = left ? 220 : 30;
+        pixels[i * 4 + 1] = left ? 40 : 90;
+        pixels[i * 4 + 2] = left ? 40 : 200;
+        pixels[i * 4 + 3] = 255;
+    }
+
+    uint8_t block[8];
+    etc2::encode_rgb_block(pixels, block);
+
+    uint8_t decoded[16 * 4];
+    etc2::decode_rgb_block(block, decoded);
+
+    CHECK(max_error(pixels, decoded, 0, 3) <= 12);
+}
+
+static void test_round_trip_alpha() {
+    uint8_t pixels[16 * 4] = {};
+    for (int i = 0; i < 16; i++) {
+        pixels[i * 4 + 3] = static_cast<uint8_t>(100 + i * 4);
+    }
+
+    uint8_t block[8];
+    etc2::encode_alpha_block(pixels, block);
+
+    uint8_t decoded[16 * 4] = {};
+    etc2::decode_alpha_block(block, decoded);
+
+    CHECK(max_error(pixels, decoded, 3, 1) <= 4);
+
+    // eight levels over the whole range are about 34 apart
+    for (int i = 0; i < 16; i++) {
+        pixels[i * 4 + 3] = static_cast<uint8_t>(i * 16);
+    }
+    etc2::encode_alpha_block(pixels, block);
+    etc2::decode_alpha_block(block, decoded);
+
+    CHECK(max_error(pixels, decoded, 3, 1) <= 17);
+
+    // a constant alpha is kept exactly, opaque images rely on it
+    std::memset(pixels, 255, sizeof(pixels));
+    etc2::encode_alpha_block(pixels, block);
+    etc2::decode_alpha_block(block, decoded);
+
+    CHECK(max_error(pixels, decoded, 3, 1) == 0);
+}
+
+int main() {
+    test_individual_block();
+    test_sub_blocks();
+    test_alpha_block();
+    test_round_trip_gradient();
+    test_round_trip_two_colors();
+    test_round_trip_alpha();
+
+    return CheckResult();
+}
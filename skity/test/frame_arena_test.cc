@@ -0,0 +1,137 @@
+// FrameArena hands out aligned memory, reuses its blocks after reset() and,
+// counted with AllocCounter, takes a per frame key set off the heap.
+
+#include "frame_arena.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <new>
+#include <unordered_set>
+
+#include "alloc_counter.hpp"
+#include "test_check.hpp"
+
+static constexpr int kFrames = 10;
+// first sightings per frame, about what the frame demo's animated paths add
+static constexpr uint64_t kKeysPerFrame = 200;
+
+static bool aligned(void *ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+static void test_allocate_and_reset() {
+    FrameArena arena{1024};
+    CHECK(arena.Capacity() == 0);
+
+    void *first = arena.allocate(3, 1);
+    void *second = arena.allocate(16, 16);
+    CHECK(first != nullptr && second != nullptr);
+    CHECK(aligned(second, 16));
+    CHECK(static_cast<uint8_t *>(second) >= static_cast<uint8_t *>(first) + 3);
+    CHECK(arena.Stats().allocations == 2 && arena.Stats().bytes == 19);
+
+    // spills into a second block, larger requests get their own
+    for (int i = 0; i < 100; i++) {
+        CHECK(aligned(arena.allocate(24, 8), 8));
+    }
+    void *large = arena.allocate(4096, 64);
+    CHECK(aligned(large, 64));
+    CHECK(arena.Capacity() == 3 * 1024);
+    CHECK(arena.Stats().blocks == 4);
+
+    // the same frame again touches no new block
+    arena.reset();
+    CHECK(arena.LastFrame().allocations == 103);
+    CHECK(arena.Stats().allocations == 0);
+    CHECK(arena.allocate(3, 1) == first);
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(24, 8);
+    }
+    arena.allocate(4096, 64);
+    CHECK(arena.Stats().blocks == 1);
+    CHECK(arena.Capacity() == 3 * 1024);
+}
+
+static void test_allocator() {
+    FrameArena arena;
+    std::vector<double, ArenaAllocator<double>> values{ArenaAllocator<double>(&arena)};
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(i * 0.5);
+    }
+
+    CHECK(values.size() == 1000 && values[999] == 499.5);
+    CHECK(aligned(values.data(), alignof(double)));
+    CHECK(arena.Stats().allocations > 1);
+
+    ArenaAllocator<int> other{values.get_allocator()};
+    CHECK(other == values.get_allocator());
+}
+
+/**
+ * Insert kKeysPerFrame keys nobody saw before into a fresh set every frame,
+ * the way PathGeometryCache tracks first sightings.
+ *
+ * @return heap allocations of the frames after the first two
+ */
+template <typename MakeSet>
+static uint64_t count_key_set_allocations(MakeSet make_set) {
+    uint64_t next_key = 1;
+    uint64_t heap = 0;
+
+    for (int frame = 0; frame < kFrames; frame++) {
+        AllocCounts before = AllocCounter::CurrentThread();
+
+        make_set([&next_key](auto *keys) {
+            for (uint64_t i = 0; i < kKeysPerFrame; i++) {
+                keys->insert(next_key++);
+            }
+        });
+
+        if (frame >= 2) {
+            heap += AllocCounter::CurrentThread().allocations - before.allocations;
+        }
+    }
+
+    return heap;
+}
+
+static void test_key_set_allocations() {
+    using HeapSet = std::unordered_set<uint64_t>;
+    using ArenaSet = std::unordered_set<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                        ArenaAllocator<uint64_t>>;
+
+    uint64_t heap = count_key_set_allocations([](auto fill) {
+        HeapSet keys;
+        fill(&keys);
+    });
+
+    FrameArena arena;
+    uint64_t arena_heap = count_key_set_allocations([&arena](auto fill) {
+        {
+            ArenaSet keys{0, std::hash<uint64_t>{}, std::equal_to<uint64_t>{},
+                          ArenaAllocator<uint64_t>(&arena)};
+            fill(&keys);
+        }
+        arena.reset();
+    });
+
+    int frames = kFrames - 2;
+    std::printf("heap allocations per frame for %u new keys: std::allocator %.1f, "
+                "FrameArena %.1f\n",
+                static_cast<unsigned>(kKeysPerFrame), static_cast<double>(heap) / frames,
+                static_cast<double>(arena_heap) / frames);
+
+    if (AllocCounter::Enabled()) {
+        CHECK(heap >= kKeysPerFrame * frames);
+        CHECK(arena_heap == 0);
+    }
+    CHECK(arena.LastFrame().allocations > kKeysPerFrame);
+}
+
+int main() {
+    test_allocate_and_reset();
+    test_allocator();
+    test_key_set_allocations();
+
+    return CheckResult();
+}
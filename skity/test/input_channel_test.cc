@@ -0,0 +1,129 @@
+// InputChannel hands the newest sample to the reader whole, never fields of
+// two different writes, and InputLatencyMeter counts each sample once.
+
+#include "input_channel.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "test_check.hpp"
+
+static constexpr int kWrites = 200000;
+
+static void test_read_write() {
+    InputChannel channel;
+    InputSample sample;
+    CHECK(!channel.read(&sample));
+
+    channel.write(10.f, 20.f, true, 1234);
+    CHECK(channel.read(&sample));
+    CHECK(sample.x == 10.f && sample.y == 20.f && sample.down);
+    CHECK(sample.event_nanos == 1234);
+    CHECK(sample.sequence == 1);
+
+    // only the newest write is kept
+    channel.write(1.f, 2.f, false, 2000);
+    channel.write(3.f, 4.f, true, 3000);
+    CHECK(channel.read(&sample));
+    CHECK(sample.x == 3.f && sample.y == 4.f && sample.down);
+    CHECK(sample.sequence == 3);
+
+    // no event time, the write is stamped
+    channel.write(5.f, 6.f, false, 0);
+    CHECK(channel.read(&sample));
+    CHECK(sample.event_nanos > 0);
+}
+
+static void test_concurrent_reads() {
+    InputChannel channel;
+    std::atomic<bool> done = {false};
+
+    // every field is derived from i, a torn read breaks the relation
+    std::thread writer([&channel, &done]() {
+        for (int i = 1; i <= kWrites; i++) {
+            channel.write(static_cast<float>(i), static_cast<float>(i * 2), (i & 1) != 0, i);
+        }
+        done = true;
+    });
+
+    uint64_t last_sequence = 0;
+    uint64_t reads = 0;
+    bool consistent = true;
+    bool ordered = true;
+    while (!done) {
+        InputSample sample;
+        if (!channel.read(&sample)) {
+            continue;
+        }
+        reads++;
+
+        auto i = static_cast<int64_t>(sample.x);
+        consistent &= sample.y == static_cast<float>(i * 2) && sample.down == ((i & 1) != 0) &&
+                      sample.event_nanos == i && sample.sequence == static_cast<uint64_t>(i);
+        ordered &= sample.sequence >= last_sequence;
+        last_sequence = sample.sequence;
+    }
+    writer.join();
+
+    CHECK(reads > 0);
+    CHECK(consistent);
+    CHECK(ordered);
+
+    InputSample last;
+    CHECK(channel.read(&last));
+    CHECK(last.sequence == kWrites && last.x == static_cast<float>(kWrites));
+}
+
+static void test_latency_meter() {
+    InputLatencyMeter meter;
+    CHECK(meter.Stats().frames == 0);
+
+    InputSample sample;
+    sample.event_nanos = 1000000;
+    sample.sequence = 1;
+
+    // latched 2 ms, submitted 5 ms after the event
+    meter.latched(sample, 3000000);
+    meter.submitted(6000000);
+
+    InputLatencyStats stats = meter.Stats();
+    CHECK(stats.frames == 1);
+    CHECK(std::abs(stats.last_ms - 5.f) < 0.001f);
+    CHECK(std::abs(stats.average_latch_ms - 2.f) < 0.001f);
+
+    // the next frame latches the same sample, it is not counted again
+    meter.latched(sample, 20000000);
+    meter.submitted(21000000);
+    CHECK(meter.Stats().frames == 1);
+
+    sample.event_nanos = 30000000;
+    sample.sequence = 2;
+    meter.latched(sample, 31000000);
+    meter.submitted(40000000);
+
+    stats = meter.Stats();
+    CHECK(stats.frames == 2);
+    CHECK(std::abs(stats.last_ms - 10.f) < 0.001f);
+    CHECK(std::abs(stats.average_ms - 7.5f) < 0.001f);
+    CHECK(std::abs(stats.max_ms - 10.f) < 0.001f);
+
+    // the window keeps the last kWindow frames
+    for (uint64_t i = 0; i < InputLatencyMeter::kWindow; i++) {
+        sample.event_nanos = 100000000 + static_cast<int64_t>(i) * 1000000;
+        sample.sequence = 3 + i;
+        meter.latched(sample, sample.event_nanos);
+        meter.submitted(sample.event_nanos + 1000000);
+    }
+    stats = meter.Stats();
+    CHECK(stats.frames == 2 + InputLatencyMeter::kWindow);
+    CHECK(std::abs(stats.max_ms - 1.f) < 0.001f);
+}
+
+int main() {
+    test_read_write();
+    test_concurrent_reads();
+    test_latency_meter();
+
+    return CheckResult();
+}
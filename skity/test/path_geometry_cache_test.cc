@@ -0,0 +1,147 @@
+// PathGeometryCache flattens a curved path on its second frame, hits it by
+// content and scale bucket afterwards, keeps different paths apart and turns
+// into a pass through when disabled.
+
+#include "path_geometry_cache.hpp"
+
+#include "test_check.hpp"
+
+static skity::Path make_curve(float offset) {
+    skity::Path path;
+    path.moveTo(offset, 0.f);
+    path.quadTo(offset + 50.f, 100.f, offset + 100.f, 0.f);
+    path.cubicTo(offset + 120.f, 40.f, offset + 80.f, 80.f, offset, 60.f);
+    path.close();
+    return path;
+}
+
+static bool has_curves(skity::Path const &path) {
+    skity::Path::Iter iter{path, false};
+    skity::Point pts[4];
+
+    for (;;) {
+        auto verb = iter.next(pts);
+        if (verb == skity::Path::Verb::kDone) {
+            return false;
+        }
+        if (verb == skity::Path::Verb::kQuad || verb == skity::Path::Verb::kConic ||
+            verb == skity::Path::Verb::kCubic) {
+            return true;
+        }
+    }
+}
+
+static void test_flatten_on_second_frame() {
+    PathGeometryCache cache;
+    skity::Path path = make_curve(0.f);
+
+    // first frame only remembers the path
+    CHECK(&cache.get(path, 1.f) == &path);
+    cache.begin_frame();
+    CHECK(cache.LastFrameStats().lookups == 1 && cache.LastFrameStats().hits == 0);
+    CHECK(cache.LastFrameStats().arena_allocations > 0);
+
+    skity::Path const &flat = cache.get(path, 1.f);
+    CHECK(&flat != &path);
+    CHECK(!has_curves(flat));
+    cache.begin_frame();
+    CHECK(cache.LastFrameStats().entries == 1);
+    CHECK(cache.LastFrameStats().points > 4);
+
+    // an equal path built again hits, also a little larger in the bucket
+    skity::Path again = make_curve(0.f);
+    CHECK(&cache.get(again, 1.f) == &flat);
+    CHECK(&cache.get(again, 1.1f) == &flat);
+    cache.begin_frame();
+    CHECK(cache.LastFrameStats().hits == 2);
+    CHECK(cache.LastFrameStats().HitRate() == 1.f);
+
+    // twice the scale is another bucket, flattened finer
+    CHECK(&cache.get(path, 2.f) == &path);
+    cache.begin_frame();
+    skity::Path const &fine = cache.get(path, 2.f);
+    CHECK(&fine != &path && &fine != &flat);
+}
+
+static void test_paths_kept_apart() {
+    PathGeometryCache cache;
+    skity::Path a = make_curve(0.f);
+    skity::Path b = make_curve(1.f);
+
+    for (int frame = 0; frame < 2; frame++) {
+        cache.get(a, 1.f);
+        cache.get(b, 1.f);
+        cache.begin_frame();
+    }
+
+    skity::Path const &flat_a = cache.get(a, 1.f);
+    skity::Path const &flat_b = cache.get(b, 1.f);
+    CHECK(&flat_a != &flat_b);
+    cache.begin_frame();
+    CHECK(cache.LastFrameStats().hits == 2);
+    CHECK(cache.LastFrameStats().collisions == 0);
+}
+
+static void test_lines_pass_through() {
+    PathGeometryCache cache;
+    skity::Path lines;
+    lines.moveTo(0.f, 0.f);
+    lines.lineTo(10.f, 0.f);
+    lines.lineTo(10.f, 10.f);
+    lines.close();
+
+    for (int frame = 0; frame < 3; frame++) {
+        CHECK(&cache.get(lines, 1.f) == &lines);
+        cache.begin_frame();
+    }
+    CHECK(cache.LastFrameStats().lookups == 0);
+}
+
+static void test_disabled() {
+    PathGeometryCache cache;
+    skity::Path path = make_curve(0.f);
+
+    for (int frame = 0; frame < 2; frame++) {
+        cache.get(path, 1.f);
+        cache.begin_frame();
+    }
+    CHECK(cache.LastFrameStats().entries == 1);
+
+    cache.set_enabled(false);
+    CHECK(!cache.IsEnabled());
+    for (int frame = 0; frame < 3; frame++) {
+        CHECK(&cache.get(path, 1.f) == &path);
+        cache.begin_frame();
+    }
+    CHECK(cache.LastFrameStats().lookups == 0);
+    CHECK(cache.LastFrameStats().entries == 0);
+
+    // enabled again it starts from nothing
+    cache.set_enabled(true);
+    CHECK(&cache.get(path, 1.f) == &path);
+}
+
+static void test_point_budget() {
+    // room for about one flattened path
+    PathGeometryCache cache{64};
+    skity::Path a = make_curve(0.f);
+    skity::Path b = make_curve(1.f);
+
+    for (int frame = 0; frame < 3; frame++) {
+        cache.get(a, 1.f);
+        cache.get(b, 1.f);
+        cache.begin_frame();
+    }
+
+    CHECK(cache.LastFrameStats().points <= 64 || cache.LastFrameStats().entries <= 1);
+}
+
+int main() {
+    test_flatten_on_second_frame();
+    test_paths_kept_apart();
+    test_lines_pass_through();
+    test_disabled();
+    test_point_budget();
+
+    return CheckResult();
+}
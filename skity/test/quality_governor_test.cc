@@ -0,0 +1,157 @@
+// QualityGovernor steps down once the rolling average misses the budget, steps
+// up only after a long stretch within it, and backs off upgrades that do not
+// hold.
+
+#include "quality_governor.hpp"
+
+#include "test_check.hpp"
+
+// 60 fps budget
+static constexpr double kSlow = 0.025;
+static constexpr double kFast = 0.010;
+
+/**
+ * @return updates until the level changed, including that one, or -1 if it
+ *         did not within limit
+ */
+static int frames_until_change(QualityGovernor *governor, double frame_time, int limit) {
+    for (int i = 1; i <= limit; i++) {
+        if (governor->update(frame_time)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void test_default_levels() {
+    auto levels = QualityGovernor::DefaultLevels(4, true);
+    CHECK(levels.size() == 5);
+    if (levels.size() == 5) {
+        CHECK(levels[0].samples == 4 && levels[0].render_scale == 1.f);
+        CHECK(levels[1].samples == 2 && levels[1].render_scale == 1.f);
+        CHECK(levels[2].samples == 1 && levels[2].render_scale == 1.f);
+        CHECK(levels[3].samples == 1 && levels[3].render_scale == 0.75f);
+        CHECK(levels[4].samples == 1 && levels[4].render_scale == 0.5f);
+    }
+
+    levels = QualityGovernor::DefaultLevels(0, false);
+    CHECK(levels.size() == 1);
+    CHECK(levels.size() == 1 && levels[0].samples == 1);
+}
+
+static void test_idle_without_levels() {
+    QualityGovernor governor;
+    CHECK(frames_until_change(&governor, kSlow, 1000) == -1);
+    CHECK(governor.CurrentLevel() == 0);
+    CHECK(governor.LevelCount() == 0);
+    CHECK(governor.Transitions().empty());
+}
+
+static void test_steps_down() {
+    QualityGovernor governor;
+    governor.set_levels(QualityGovernor::DefaultLevels(4, false));
+    CHECK(governor.LevelCount() == 3);
+
+    // nothing before the window is full
+    CHECK(frames_until_change(&governor, kSlow, 100) ==
+          static_cast<int>(QualityGovernor::kWindowFrames));
+    CHECK(governor.CurrentLevel() == 1);
+    CHECK(governor.Current().samples == 2);
+
+    auto transitions = governor.Transitions();
+    CHECK(transitions.size() == 1);
+    if (transitions.size() == 1) {
+        CHECK(transitions[0].frame == QualityGovernor::kWindowFrames);
+        CHECK(transitions[0].from == 0 && transitions[0].to == 1);
+        CHECK(transitions[0].average_ms > 24.f && transitions[0].average_ms < 26.f);
+    }
+
+    // the window starts over at the new level
+    CHECK(frames_until_change(&governor, kSlow, 100) ==
+          static_cast<int>(QualityGovernor::kWindowFrames));
+    CHECK(governor.CurrentLevel() == 2);
+
+    // no level below the last one
+    CHECK(frames_until_change(&governor, kSlow, 1000) == -1);
+    CHECK(governor.CurrentLevel() == 2);
+
+    governor.set_levels(QualityGovernor::DefaultLevels(4, false));
+    CHECK(governor.CurrentLevel() == 0);
+}
+
+static void test_holds_within_budget() {
+    QualityGovernor governor;
+    governor.set_levels(QualityGovernor::DefaultLevels(4, false));
+
+    // on budget, and vsync jitter a little above it
+    CHECK(frames_until_change(&governor, 0.0166, 1000) == -1);
+    CHECK(frames_until_change(&governor, 0.0175, 1000) == -1);
+    CHECK(governor.CurrentLevel() == 0);
+
+    // pauses and stalls are not rendering cost
+    CHECK(frames_until_change(&governor, 0.5, 1000) == -1);
+    CHECK(frames_until_change(&governor, 0.0, 1000) == -1);
+    CHECK(governor.CurrentLevel() == 0);
+}
+
+static void test_steps_up_and_backs_off() {
+    QualityGovernor governor;
+    governor.set_levels(QualityGovernor::DefaultLevels(4, false));
+
+    CHECK(frames_until_change(&governor, kSlow, 100) > 0);
+    CHECK(governor.CurrentLevel() == 1);
+
+    int window = QualityGovernor::kWindowFrames;
+    int upgrade = QualityGovernor::kUpgradeFrames;
+
+    // the first in budget frame is the one filling the window
+    CHECK(frames_until_change(&governor, kFast, 10000) == window - 1 + upgrade);
+    CHECK(governor.CurrentLevel() == 0);
+
+    // the upgrade did not hold, the next one waits twice as long
+    CHECK(frames_until_change(&governor, kSlow, 100) == window);
+    CHECK(governor.CurrentLevel() == 1);
+    CHECK(frames_until_change(&governor, kFast, 10000) == window - 1 + upgrade * 2);
+    CHECK(governor.CurrentLevel() == 0);
+
+    // and again, up to kMaxUpgradeFrames
+    for (int i = 0; i < 8; i++) {
+        CHECK(frames_until_change(&governor, kSlow, 100) == window);
+        frames_until_change(&governor, kFast, 10000);
+    }
+    CHECK(frames_until_change(&governor, kSlow, 100) == window);
+    CHECK(frames_until_change(&governor, kFast, 10000) ==
+          window - 1 + static_cast<int>(QualityGovernor::kMaxUpgradeFrames));
+}
+
+static void test_transition_log() {
+    QualityGovernor governor;
+    governor.set_levels(QualityGovernor::DefaultLevels(2, false));
+
+    size_t changes = 0;
+    while (changes < QualityGovernor::kLogCapacity + 5) {
+        CHECK(frames_until_change(&governor, kSlow, 100) > 0);
+        CHECK(frames_until_change(&governor, kFast, 10000) > 0);
+        changes += 2;
+    }
+
+    auto transitions = governor.Transitions();
+    CHECK(transitions.size() == QualityGovernor::kLogCapacity);
+    for (size_t i = 1; i < transitions.size(); i++) {
+        CHECK(transitions[i - 1].frame < transitions[i].frame);
+        CHECK(transitions[i - 1].to == transitions[i].from);
+    }
+    // the last one is the most recent step up
+    CHECK(!transitions.empty() && transitions.back().to == 0);
+}
+
+int main() {
+    test_default_levels();
+    test_idle_without_levels();
+    test_steps_down();
+    test_holds_within_budget();
+    test_steps_up_and_backs_off();
+    test_transition_log();
+
+    return CheckResult();
+}
@@ -0,0 +1,259 @@
+// SVGCullTree draws everything in view, and only that: every draw that
+// touches the visible rect is issued, every issued draw touches it.
+
+#include "svg_cull_tree.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_check.hpp"
+
+// the grid is kGridSize x kGridSize cells of kCellSize, a rect inset by 1 in
+// each, one group per row
+static constexpr int kGridSize = 20;
+static constexpr float kCellSize = 10.f;
+// one more rect far to the right, inside a translated group
+static constexpr float kFarX = 1000.f;
+static constexpr float kFarSize = 50.f;
+static constexpr uint32_t kDocWidth = 2000;
+static constexpr uint32_t kDocHeight = 200;
+
+static std::string make_grid_svg() {
+    std::string svg;
+    char buf[256];
+
+    std::snprintf(buf, sizeof(buf),
+                  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%u\" height=\"%u\">\n",
+                  kDocWidth, kDocHeight);
+    svg += buf;
+
+    for (int y = 0; y < kGridSize; y++) {
+        svg += "<g>\n";
+        for (int x = 0; x < kGridSize; x++) {
+            std::snprintf(buf, sizeof(buf),
+                          "<rect x=\"%.0f\" y=\"%.0f\" width=\"8\" height=\"8\" "
+                          "fill=\"#336699\"/>\n",
+                          x * kCellSize + 1.f, y * kCellSize + 1.f);
+            svg += buf;
+        }
+        svg += "</g>\n";
+    }
+
+    std::snprintf(buf, sizeof(buf),
+                  "<g transform=\"translate(%.0f,0)\"><rect x=\"0\" y=\"0\" width=\"%.0f\" "
+                  "height=\"%.0f\" fill=\"#993366\"/></g>\n",
+                  kFarX, kFarSize, kFarSize);
+    svg += buf;
+    svg += "</svg>\n";
+
+    return svg;
+}
+
+/**
+ * Keeps the device space bounds of every path drawn into it.
+ */
+class BoundsCanvas : public skity::Canvas {
+public:
+    BoundsCanvas(uint32_t width, uint32_t height) { onUpdateViewport(width, height); }
+
+    ~BoundsCanvas() override = default;
+
+    std::vector<skity::Rect> const &Draws() const { return draws_; }
+
+    void reset() {
+        draws_.clear();
+        matrices_.assign(1, skity::Matrix(1.f));
+    }
+
+protected:
+    void onClipPath(skity::Path const &path, ClipOp op) override {}
+
+    void onDrawPath(skity::Path const &path, skity::Paint const &paint) override {
+        skity::Rect bounds = path.getBounds();
+        skity::Matrix const &m = matrices_.back();
+
+        float left = FLT_MAX;
+        float top = FLT_MAX;
+        float right = -FLT_MAX;
+        float bottom = -FLT_MAX;
+        for (float x : {bounds.left(), bounds.right()}) {
+            for (float y : {bounds.top(), bounds.bottom()}) {
+                glm::vec4 p = m * glm::vec4(x, y, 0.f, 1.f);
+                left = std::min(left, p.x);
+                top = std::min(top, p.y);
+                right = std::max(right, p.x);
+                bottom = std::max(bottom, p.y);
+            }
+        }
+
+        draws_.emplace_back(skity::Rect::MakeLTRB(left, top, right, bottom));
+    }
+
+    void onDrawBlob(const skity::TextBlob *blob, float x, float y,
+                    skity::Paint const &paint) override {}
+
+    void onSave() override { matrices_.emplace_back(matrices_.back()); }
+
+    void onRestore() override {
+        if (matrices_.size() > 1) {
+            matrices_.pop_back();
+        }
+    }
+
+    void onTranslate(float dx, float dy) override {
+        matrices_.back() = glm::translate(matrices_.back(), glm::vec3(dx, dy, 0.f));
+    }
+
+    void onScale(float sx, float sy) override {
+        matrices_.back() = glm::scale(matrices_.back(), glm::vec3(sx, sy, 1.f));
+    }
+
+    void onRotate(float degree) override {
+        matrices_.back() = glm::rotate(matrices_.back(), glm::radians(degree),
+                                       glm::vec3(0.f, 0.f, 1.f));
+    }
+
+    void onRotate(float degree, float px, float py) override {
+        onTranslate(px, py);
+        onRotate(degree);
+        onTranslate(-px, -py);
+    }
+
+    void onConcat(skity::Matrix const &matrix) override {
+        matrices_.back() = matrices_.back() * matrix;
+    }
+
+    void onFlush() override {}
+
+    uint32_t onGetWidth() const override { return width_; }
+
+    uint32_t onGetHeight() const override { return height_; }
+
+    void onUpdateViewport(uint32_t width, uint32_t height) override {
+        width_ = width;
+        height_ = height;
+    }
+
+private:
+    uint32_t width_ = {};
+    uint32_t height_ = {};
+    std::vector<skity::Matrix> matrices_ = {skity::Matrix(1.f)};
+    std::vector<skity::Rect> draws_ = {};
+};
+
+static bool touches(skity::Rect const &a, skity::Rect const &b) {
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() &&
+           b.top() <= a.bottom();
+}
+
+static bool near(skity::Rect const &a, skity::Rect const &b) {
+    return std::abs(a.left() - b.left()) < 0.01f && std::abs(a.top() - b.top()) < 0.01f &&
+           std::abs(a.right() - b.right()) < 0.01f && std::abs(a.bottom() - b.bottom()) < 0.01f;
+}
+
+/**
+ * Draw view and check the draws issued against every rect of the document.
+ *
+ * @return draws issued
+ */
+static size_t check_view(SVGCullTree *tree, BoundsCanvas *canvas, SVGView const &view,
+                         skity::Rect const &clip) {
+    canvas->reset();
+    tree->draw(canvas, view.Matrix(), clip);
+
+    auto const &draws = canvas->Draws();
+    auto const &stats = tree->Stats();
+    CHECK(stats.issued_draws == draws.size());
+
+    float pad = SVGCullTree::kCullPadding + 0.01f;
+    skity::Rect padded = skity::Rect::MakeLTRB(clip.left() - pad, clip.top() - pad,
+                                               clip.right() + pad, clip.bottom() + pad);
+    for (auto const &draw : draws) {
+        CHECK(touches(draw, padded));
+    }
+
+    auto expect = [&](float left, float top, float size) {
+        skity::Rect rect = skity::Rect::MakeXYWH(view.x + left * view.zoom,
+                                                 view.y + top * view.zoom, size * view.zoom,
+                                                 size * view.zoom);
+        if (!touches(rect, clip)) {
+            return;
+        }
+        bool drawn = std::any_of(draws.begin(), draws.end(),
+                                 [&rect](skity::Rect const &draw) { return near(draw, rect); });
+        CHECK(drawn);
+    };
+
+    for (int y = 0; y < kGridSize; y++) {
+        for (int x = 0; x < kGridSize; x++) {
+            expect(x * kCellSize + 1.f, y * kCellSize + 1.f, 8.f);
+        }
+    }
+    expect(kFarX, 0.f, kFarSize);
+
+    return draws.size();
+}
+
+int main() {
+    std::string svg = make_grid_svg();
+    auto data = skity::Data::MakeWithCopy(svg.data(), svg.size());
+    auto dom = skity::SVGDom::MakeFromData(data.get());
+    CHECK(dom != nullptr);
+    if (!dom) {
+        return CheckResult();
+    }
+
+    auto tree = SVGCullTree::Record(dom.get(), kDocWidth, kDocHeight);
+    CHECK(tree != nullptr);
+    if (!tree) {
+        return CheckResult();
+    }
+
+    size_t rects = kGridSize * kGridSize + 1;
+    CHECK(tree->Stats().draws >= rects);
+    CHECK(tree->Stats().groups > static_cast<uint32_t>(kGridSize));
+
+    // the translated group counts with its transform
+    skity::Rect content = tree->ContentBounds();
+    CHECK(content.left() <= 1.f && content.top() <= 1.f);
+    CHECK(content.right() >= kFarX + kFarSize - 0.01f);
+
+    BoundsCanvas canvas{kDocWidth, kDocHeight};
+    skity::Rect screen = skity::Rect::MakeLTRB(0.f, 0.f, 200.f, 200.f);
+
+    // whole document in view, nothing culled
+    size_t drawn = check_view(tree.get(), &canvas, SVGView{1.f, 0.f, 0.f},
+                              skity::Rect::MakeLTRB(0.f, 0.f, kDocWidth, kDocHeight));
+    CHECK(drawn == tree->Stats().draws);
+    CHECK(tree->Stats().culled_draws == 0 && tree->Stats().culled_groups == 0);
+
+    // zoomed into the top left 5 x 5 cells
+    drawn = check_view(tree.get(), &canvas, SVGView{4.f, 0.f, 0.f}, screen);
+    CHECK(drawn >= 25 && drawn < 50);
+    CHECK(tree->Stats().culled_groups > 0);
+
+    // panned into the middle of the grid, fractional zoom
+    drawn = check_view(tree.get(), &canvas, SVGView{2.5f, -137.f, -211.f}, screen);
+    CHECK(drawn > 0 && drawn < rects);
+
+    // only the far rect
+    drawn = check_view(tree.get(), &canvas, SVGView{1.f, -kFarX, 0.f}, screen);
+    CHECK(drawn == 1);
+
+    // nothing in view
+    drawn = check_view(tree.get(), &canvas, SVGView{1.f, -5000.f, 0.f}, screen);
+    CHECK(drawn == 0);
+
+    // a view without area draws nothing
+    canvas.reset();
+    tree->draw(&canvas, SVGView{0.f, 0.f, 0.f}.Matrix(), screen);
+    CHECK(canvas.Draws().empty());
+
+    return CheckResult();
+}
@@ -0,0 +1,32 @@
+
+#ifndef SKITY_ANDROID_TEST_CHECK_HPP
+#define SKITY_ANDROID_TEST_CHECK_HPP
+
+#include <cstdio>
+
+/**
+ * Checks for the host tests, no test framework is vendored. A failed check
+ * prints where it failed and keeps going, main() returns CheckResult().
+ */
+inline int &check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                       \
+    do {                                                                                  \
+        if (!(cond)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            check_failures()++;                                                           \
+        }                                                                                 \
+    } while (false)
+
+inline int CheckResult() {
+    if (check_failures() > 0) {
+        std::fprintf(stderr, "%d checks failed\n", check_failures());
+        return 1;
+    }
+    return 0;
+}
+
+#endif //SKITY_ANDROID_TEST_CHECK_HPP
@@ -0,0 +1,91 @@
+// WorkStealingPool runs every index of a parallel_for exactly once, also for
+// loops started from inside a task, and spreads them over its threads.
+
+#include "work_stealing_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "test_check.hpp"
+
+static void test_every_index_once() {
+    WorkStealingPool pool{4};
+    CHECK(pool.ThreadCount() == 4);
+
+    for (uint32_t count : {0u, 1u, 3u, 1000u}) {
+        std::vector<std::atomic<uint32_t>> calls(count);
+        for (auto &c : calls) {
+            c = 0;
+        }
+
+        pool.parallel_for(count, [&calls](uint32_t i) { calls[i]++; });
+
+        bool once = true;
+        for (auto &c : calls) {
+            once &= c == 1;
+        }
+        CHECK(once);
+    }
+}
+
+static void test_nested_loops() {
+    WorkStealingPool pool{3};
+
+    // every outer task waits for an inner loop, waiting threads have to help
+    std::atomic<uint32_t> inner = {0};
+    pool.parallel_for(16, [&pool, &inner](uint32_t) {
+        pool.parallel_for(16, [&inner](uint32_t) { inner++; });
+    });
+
+    CHECK(inner == 16 * 16);
+}
+
+static void test_spreads_over_threads() {
+    WorkStealingPool pool{4};
+    pool.reset_stats();
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    pool.parallel_for(64, [&mutex, &threads](uint32_t) {
+        // long enough for idle workers to pick up tasks
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+
+    CHECK(threads.size() > 1);
+    CHECK(pool.Stats().tasks >= 64);
+
+    pool.reset_stats();
+    CHECK(pool.Stats().tasks == 0 && pool.Stats().steals == 0);
+}
+
+static void test_single_thread() {
+    // no workers, the caller runs everything
+    WorkStealingPool pool{1};
+    CHECK(pool.ThreadCount() == 1);
+
+    std::thread::id caller = std::this_thread::get_id();
+    bool on_caller = true;
+    uint32_t sum = 0;
+    pool.parallel_for(100, [&](uint32_t i) {
+        on_caller &= std::this_thread::get_id() == caller;
+        sum += i;
+    });
+
+    CHECK(on_caller);
+    CHECK(sum == 99 * 100 / 2);
+}
+
+int main() {
+    test_every_index_once();
+    test_nested_loops();
+    test_spreads_over_threads();
+    test_single_thread();
+
+    return CheckResult();
+}
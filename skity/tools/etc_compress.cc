@@ -0,0 +1,212 @@
+// Convert image assets into ETC2 KTX files the renderers load directly:
+//
+//   convert image1.jpg image1.ppm
+//   etc_compress image1.ppm skity/src/main/assets/images/image1.ktx
+//
+// Input is binary PPM (P6, stored as ETC2 RGB8) or PAM (P7 with TUPLTYPE
+// RGB_ALPHA, stored as ETC2 RGBA8 EAC). For ASTC assets use ARM's astcenc,
+// its .astc output is read as is.
+
+#include "etc2_codec.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct Image {
+    uint32_t width = {};
+    uint32_t height = {};
+    bool has_alpha = {};
+    // RGBA
+    std::vector<uint8_t> pixels = {};
+};
+
+static bool read_token(std::istream &in, std::string &token) {
+    token.clear();
+    char c;
+    while (in.get(c)) {
+        if (c == '#') {
+            std::string comment;
+            std::getline(in, comment);
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!token.empty()) {
+                return true;
+            }
+            continue;
+        }
+        token.push_back(c);
+    }
+    return !token.empty();
+}
+
+static bool read_pnm(std::string const &path, Image *image) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "can not open %s\n", path.c_str());
+        return false;
+    }
+
+    std::string magic;
+    read_token(in, magic);
+
+    uint32_t channels;
+    uint32_t max_value = 0;
+
+    if (magic == "P6") {
+        std::string w, h, m;
+        if (!read_token(in, w) || !read_token(in, h) || !read_token(in, m)) {
+            return false;
+        }
+        image->width = std::stoul(w);
+        image->height = std::stoul(h);
+        max_value = std::stoul(m);
+        channels = 3;
+    } else if (magic == "P7") {
+        std::string key, value;
+        uint32_t depth = 0;
+        while (read_token(in, key) && key != "ENDHDR") {
+            read_token(in, value);
+            if (key == "WIDTH") {
+                image->width = std::stoul(value);
+            } else if (key == "HEIGHT") {
+                image->height = std::stoul(value);
+            } else if (key == "DEPTH") {
+                depth = std::stoul(value);
+            } else if (key == "MAXVAL") {
+                max_value = std::stoul(value);
+            }
+        }
+        if (depth != 3 && depth != 4) {
+            std::fprintf(stderr, "%s: only RGB and RGB_ALPHA PAM files are supported\n",
+                         path.c_str());
+            return false;
+        }
+        channels = depth;
+    } else {
+        std::fprintf(stderr, "%s: not a binary PPM or PAM file\n", path.c_str());
+        return false;
+    }
+
+    if (max_value != 255 || image->width == 0 || image->height == 0) {
+        std::fprintf(stderr, "%s: only 8 bit images are supported\n", path.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> raw(static_cast<size_t>(image->width) * image->height * channels);
+    in.read(reinterpret_cast<char *>(raw.data()), raw.size());
+    if (!in) {
+        std::fprintf(stderr, "%s: truncated pixel data\n", path.c_str());
+        return false;
+    }
+
+    image->has_alpha = channels == 4;
+    image->pixels.resize(static_cast<size_t>(image->width) * image->height * 4);
+    for (size_t i = 0; i < static_cast<size_t>(image->width) * image->height; i++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            image->pixels[i * 4 + c] = raw[i * channels + c];
+        }
+        image->pixels[i * 4 + 3] = image->has_alpha ? raw[i * channels + 3] : 255;
+    }
+
+    return true;
+}
+
+static void write_u32(std::ofstream &out, uint32_t value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static bool write_ktx(std::string const &path, Image const &image,
+                      std::vector<uint8_t> const &blocks) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::fprintf(stderr, "can not write %s\n", path.c_str());
+        return false;
+    }
+
+    static const uint8_t kIdentifier[12] = {
+            0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n',
+    };
+    out.write(reinterpret_cast<const char *>(kIdentifier), sizeof(kIdentifier));
+
+    write_u32(out, 0x04030201);                               // endianness
+    write_u32(out, 0);                                        // glType
+    write_u32(out, 1);                                        // glTypeSize
+    write_u32(out, 0);                                        // glFormat
+    write_u32(out, image.has_alpha ? 0x9278 : 0x9274);        // glInternalFormat
+    write_u32(out, image.has_alpha ? 0x1908 : 0x1907);        // glBaseInternalFormat
+    write_u32(out, image.width);
+    write_u32(out, image.height);
+    write_u32(out, 0);                                        // pixelDepth
+    write_u32(out, 0);                                        // numberOfArrayElements
+    write_u32(out, 1);                                        // numberOfFaces
+    write_u32(out, 1);                                        // numberOfMipmapLevels
+    write_u32(out, 0);                                        // bytesOfKeyValueData
+
+    write_u32(out, blocks.size());
+    out.write(reinterpret_cast<const char *>(blocks.data()), blocks.size());
+
+    return static_cast<bool>(out);
+}
+
+static std::vector<uint8_t> compress(Image const &image) {
+    uint32_t blocks_x = (image.width + 3) / 4;
+    uint32_t blocks_y = (image.height + 3) / 4;
+    uint32_t block_bytes = image.has_alpha ? etc2::kRGBABlockBytes : etc2::kRGBBlockBytes;
+
+    std::vector<uint8_t> blocks(static_cast<size_t>(blocks_x) * blocks_y * block_bytes);
+    uint8_t *block = blocks.data();
+
+    uint8_t pixels[16 * 4];
+    for (uint32_t by = 0; by < blocks_y; by++) {
+        for (uint32_t bx = 0; bx < blocks_x; bx++) {
+            // edge blocks repeat the last row / column
+            for (uint32_t y = 0; y < 4; y++) {
+                uint32_t sy = std::min(by * 4 + y, image.height - 1);
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = std::min(bx * 4 + x, image.width - 1);
+                    std::memcpy(pixels + (y * 4 + x) * 4,
+                                image.pixels.data() + (sy * image.width + sx) * 4, 4);
+                }
+            }
+
+            if (image.has_alpha) {
+                etc2::encode_alpha_block(pixels, block);
+                etc2::encode_rgb_block(pixels, block + 8);
+            } else {
+                etc2::encode_rgb_block(pixels, block);
+            }
+            block += block_bytes;
+        }
+    }
+
+    return blocks;
+}
+
+int main(int argc, const char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <input.ppm|input.pam> <output.ktx>\n", argv[0]);
+        return 1;
+    }
+
+    Image image;
+    if (!read_pnm(argv[1], &image)) {
+        return 1;
+    }
+
+    auto blocks = compress(image);
+    if (!write_ktx(argv[2], image, blocks)) {
+        return 1;
+    }
+
+    std::printf("%s: %ux%u %s, %zu bytes (%.1f%% of RGBA)\n", argv[2], image.width,
+                image.height, image.has_alpha ? "ETC2 RGBA8" : "ETC2 RGB8", blocks.size(),
+                100.0 * blocks.size() / image.pixels.size());
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+
+// Run the GL renderers on a Linux host without any window system, e.g. under
+// Mesa llvmpipe:
+//
+//   skity_headless frame --assets skity/src/main/assets --frames 300 --out frame.ppm
+//
+// Prints the average frame time and optionally dumps the last frame as PPM.
+// With --vsync HZ the frames are paced by a timer vsync through the same
+// FrameLoop the Vulkan renderers use on Android, including its late frame
+// skipping, instead of being drawn back to back. --path-cache compare runs the
+// frame demo once without and once with its PathGeometryCache.
+
+#include "frame_loop.hpp"
+#include "headless_egl.hpp"
+#include "static_renderer.hpp"
+#include "svg_renderer.hpp"
+#include "frame_renderer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define SKITY_DEFAULT_FONT "Roboto Mono Nerd Font Complete.ttf"
+
+static std::shared_ptr<skity::Data> load_file_data(std::string const &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "can not open %s\n", path.c_str());
+        return nullptr;
+    }
+
+    std::vector<char> buf{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    return skity::Data::MakeWithCopy(buf.data(), buf.size());
+}
+
+static std::shared_ptr<skity::Typeface> load_typeface(std::string const &path) {
+    auto data = load_file_data(path);
+    if (!data) {
+        return nullptr;
+    }
+
+    return skity::Typeface::MakeFromData(data);
+}
+
+// The host build has no image codec, so the frame demo gets generated
+// checkerboards in place of the jpg assets.
+static std::vector<std::shared_ptr<skity::Pixmap>> make_test_images(size_t count) {
+    std::vector<std::shared_ptr<skity::Pixmap>> images;
+
+    uint32_t size = 256;
+    for (size_t i = 0; i < count; i++) {
+        std::vector<uint32_t> pixels(size * size);
+        uint32_t color_a = 0xFF000000 | (0x3F * (i % 4)) << 16 | (0x2F * (i % 5)) << 8 | 0x80;
+        uint32_t color_b = 0xFFFFFFFF;
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                pixels[y * size + x] = ((x / 32 + y / 32) % 2) ? color_a : color_b;
+            }
+        }
+
+        auto data = skity::Data::MakeWithCopy(pixels.data(), pixels.size() * sizeof(uint32_t));
+        images.emplace_back(std::make_shared<skity::Pixmap>(data, size * 4, size, size));
+    }
+
+    return images;
+}
+
+static void print_usage(const char *name) {
+    std::fprintf(stderr,
+                 "usage: %s <static|svg|frame> [--width W] [--height H] [--density D]\n"
+                 "          [--frames N] [--samples N] [--vsync HZ] [--assets DIR]\n"
+                 "          [--out FILE.ppm] [--path-cache on|off|compare]\n",
+                 name);
+}
+
+int main(int argc, const char **argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    int32_t width = 1280;
+    int32_t height = 720;
+    int32_t density = 1;
+    int32_t frames = 100;
+    int32_t samples = 0;
+    double vsync_hz = 0.0;
+    std::string assets = "skity/src/main/assets";
+    std::string out;
+    // path cache setting of each timed run, frame mode only
+    std::vector<bool> path_cache_runs{true};
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--density") == 0) {
+            density = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            frames = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--samples") == 0) {
+            samples = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--vsync") == 0) {
+            vsync_hz = std::atof(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--assets") == 0) {
+            assets = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--out") == 0) {
+            out = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--path-cache") == 0 &&
+                   std::strcmp(argv[i + 1], "on") == 0) {
+            path_cache_runs = {true};
+        } else if (std::strcmp(argv[i], "--path-cache") == 0 &&
+                   std::strcmp(argv[i + 1], "off") == 0) {
+            path_cache_runs = {false};
+        } else if (std::strcmp(argv[i], "--path-cache") == 0 &&
+                   std::strcmp(argv[i + 1], "compare") == 0) {
+            path_cache_runs = {false, true};
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    HeadlessEGL egl;
+    if (!egl.init(width, height)) {
+        return 1;
+    }
+
+    std::unique_ptr<Renderer> renderer;
+    FrameRender *frame_renderer = nullptr;
+
+    if (mode == "static") {
+        renderer = std::make_unique<StaticRenderer>();
+        renderer->init(width, height, density);
+    } else if (mode == "svg") {
+        auto svg_render = std::make_unique<SVGRenderer>();
+        svg_render->init(width, height, density);
+
+        auto svg_data = load_file_data(assets + "/images/tiger.svg");
+        if (!svg_data) {
+            return 1;
+        }
+        svg_render->init_svg(svg_data.get());
+
+        renderer = std::move(svg_render);
+    } else if (mode == "frame") {
+        auto frame_render = std::make_unique<FrameRender>();
+        frame_render->init(width, height, density);
+
+        frame_render->init_render_typeface(load_typeface(assets + "/Roboto-Regular.ttf"),
+                                           load_typeface(assets + "/NotoEmoji-Regular.ttf"));
+        frame_render->init_images(make_test_images(12));
+
+        frame_renderer = frame_render.get();
+        renderer = std::move(frame_render);
+    } else {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    auto default_typeface = load_typeface(assets + "/" SKITY_DEFAULT_FONT);
+    if (default_typeface) {
+        renderer->set_default_typeface(default_typeface);
+    }
+
+    renderer->set_msaa_samples(samples);
+
+    if (frame_renderer == nullptr) {
+        path_cache_runs = {true};
+    }
+
+    for (bool path_cache : path_cache_runs) {
+        std::string label = mode;
+        if (frame_renderer) {
+            frame_renderer->set_path_cache(path_cache);
+            label += path_cache ? " path cache on" : " path cache off";
+        }
+
+        if (path_cache_runs.size() > 1) {
+            // the cache flattens a path the second frame it is seen
+            for (int32_t i = 0; i < 2; i++) {
+                renderer->draw();
+                glFinish();
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (vsync_hz > 0.0) {
+            int32_t drawn = 0;
+
+            FrameLoop loop{std::make_unique<TimerVsyncSource>(vsync_hz),
+                           [&](double vsync_time) {
+                               renderer->set_vsync_time(vsync_time);
+                               renderer->draw();
+                               glFinish();
+
+                               if (++drawn >= frames) {
+                                   loop.stop();
+                               }
+                           }};
+
+            if (frames > 0) {
+                loop.start();
+            }
+
+            auto const &stats = loop.Stats();
+            std::printf("%s: %llu vsyncs at %.2f ms, %llu frames, %llu skipped late\n",
+                        label.c_str(), static_cast<unsigned long long>(stats.vsyncs),
+                        stats.period_ms,
+                        static_cast<unsigned long long>(stats.frames),
+                        static_cast<unsigned long long>(stats.late_skips));
+        } else {
+            for (int32_t i = 0; i < frames; i++) {
+                renderer->draw();
+                glFinish();
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::printf("%s: %d frames %dx%d, %.3f ms/frame\n", label.c_str(), frames, width, height,
+                    frames > 0 ? total_ms / frames : 0.0);
+    }
+
+    if (!out.empty() && !egl.write_ppm(out.c_str())) {
+        std::fprintf(stderr, "failed to write %s\n", out.c_str());
+        return 1;
+    }
+
+    renderer.reset();
+    egl.destroy();
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Zoom and pan over a large map like SVG, with and without SVGCullTree culling:
+//
+//   svg_cull_bench --blocks 48 --frames 60
+//
+// The map is generated: --blocks x --blocks city blocks of buildings, grouped
+// into districts, with curved roads and a river across it. At every zoom level
+// the view pans once across the map. Prints ms/frame and the draws issued and
+// culled per frame for both modes. Pass --svg FILE to run on an SVG of your own.
+
+#include "headless_egl.hpp"
+#include "svg_renderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+// document units per block, roads included
+static constexpr float kBlockSize = 100.f;
+// blocks per district group side
+static constexpr int32_t kDistrictSize = 8;
+
+static std::string make_map_svg(int32_t blocks) {
+    float size = blocks * kBlockSize;
+    std::string svg;
+    char buf[256];
+
+    std::snprintf(buf, sizeof(buf),
+                  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%.0f\" height=\"%.0f\">\n",
+                  size, size);
+    svg += buf;
+    std::snprintf(buf, sizeof(buf), "<rect x=\"0\" y=\"0\" width=\"%.0f\" height=\"%.0f\" "
+                                    "fill=\"#EEEAE0\"/>\n", size, size);
+    svg += buf;
+
+    // a few pseudo random looking buildings per block, same map every run
+    uint32_t seed = 1;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>((seed >> 8) & 0xFFFF) / 65535.f;
+    };
+
+    for (int32_t dy = 0; dy < blocks; dy += kDistrictSize) {
+        for (int32_t dx = 0; dx < blocks; dx += kDistrictSize) {
+            std::snprintf(buf, sizeof(buf), "<g transform=\"translate(%.0f,%.0f)\">\n",
+                          dx * kBlockSize, dy * kBlockSize);
+            svg += buf;
+
+            for (int32_t by = 0; by < kDistrictSize && dy + by < blocks; by++) {
+                for (int32_t bx = 0; bx < kDistrictSize && dx + bx < blocks; bx++) {
+                    std::snprintf(buf, sizeof(buf), "<g transform=\"translate(%.0f,%.0f)\">\n",
+                                  bx * kBlockSize, by * kBlockSize);
+                    svg += buf;
+
+                    for (int32_t i = 0; i < 4; i++) {
+                        float x = 10.f + (i % 2) * 40.f + next() * 6.f;
+                        float y = 10.f + (i / 2) * 40.f + next() * 6.f;
+                        float w = 22.f + next() * 10.f;
+                        float h = 22.f + next() * 10.f;
+                        uint32_t shade = 0x90 + static_cast<uint32_t>(next() * 0x40);
+                        std::snprintf(buf, sizeof(buf),
+                                      "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" "
+                                      "height=\"%.1f\" rx=\"3\" fill=\"#%02X%02X%02X\" "
+                                      "stroke=\"#606060\" stroke-width=\"1\"/>\n",
+                                      x, y, w, h, shade, shade, shade - 0x10);
+                        svg += buf;
+                    }
+
+                    // park in every seventh block
+                    if ((dx + bx + (dy + by) * 3) % 7 == 0) {
+                        std::snprintf(buf, sizeof(buf),
+                                      "<circle cx=\"50\" cy=\"50\" r=\"%.1f\" "
+                                      "fill=\"#8FC98A\"/>\n", 18.f + next() * 8.f);
+                        svg += buf;
+                    }
+
+                    svg += "</g>\n";
+                }
+            }
+
+            svg += "</g>\n";
+        }
+    }
+
+    // curved roads, every one crosses the whole map
+    for (int32_t i = 0; i <= blocks; i += 4) {
+        float p = i * kBlockSize;
+        std::snprintf(buf, sizeof(buf),
+                      "<path d=\"M0 %.0f C%.0f %.0f %.0f %.0f %.0f %.0f\" fill=\"none\" "
+                      "stroke=\"#F2C94C\" stroke-width=\"6\"/>\n",
+                      p, size * 0.33f, p - 120.f, size * 0.66f, p + 120.f, size, p);
+        svg += buf;
+        std::snprintf(buf, sizeof(buf),
+                      "<path d=\"M%.0f 0 C%.0f %.0f %.0f %.0f %.0f %.0f\" fill=\"none\" "
+                      "stroke=\"#F2C94C\" stroke-width=\"6\"/>\n",
+                      p, p + 120.f, size * 0.33f, p - 120.f, size * 0.66f, p, size);
+        svg += buf;
+    }
+
+    // river, one long path of many curves
+    svg += "<path d=\"M0 ";
+    std::snprintf(buf, sizeof(buf), "%.0f", size * 0.5f);
+    svg += buf;
+    for (int32_t i = 1; i <= blocks; i++) {
+        float x = i * kBlockSize;
+        float y = size * 0.5f + std::sin(i * 0.7f) * size * 0.1f;
+        std::snprintf(buf, sizeof(buf), " Q%.0f %.0f %.0f %.0f", x - kBlockSize * 0.5f,
+                      y + 60.f, x, y);
+        svg += buf;
+    }
+    svg += "\" fill=\"none\" stroke=\"#6FA8DC\" stroke-width=\"30\"/>\n";
+
+    svg += "</svg>\n";
+
+    return svg;
+}
+
+static std::shared_ptr<skity::Data> load_file_data(std::string const &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "can not open %s\n", path.c_str());
+        return nullptr;
+    }
+
+    std::vector<char> buf{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    return skity::Data::MakeWithCopy(buf.data(), buf.size());
+}
+
+int main(int argc, const char **argv) {
+    int32_t width = 1280;
+    int32_t height = 720;
+    int32_t frames = 60;
+    int32_t blocks = 48;
+    std::string svg_path;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            frames = std::max(1, std::atoi(argv[i + 1]));
+        } else if (std::strcmp(argv[i], "--blocks") == 0) {
+            blocks = std::max(1, std::atoi(argv[i + 1]));
+        } else if (std::strcmp(argv[i], "--svg") == 0) {
+            svg_path = argv[i + 1];
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--width W] [--height H] [--frames N] [--blocks N] "
+                         "[--svg FILE]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    std::shared_ptr<skity::Data> data;
+    if (svg_path.empty()) {
+        std::string svg = make_map_svg(blocks);
+        data = skity::Data::MakeWithCopy(svg.data(), svg.size());
+    } else {
+        data = load_file_data(svg_path);
+    }
+    if (!data) {
+        return 1;
+    }
+
+    HeadlessEGL egl;
+    if (!egl.init(width, height)) {
+        return 1;
+    }
+
+    auto renderer = std::make_unique<SVGRenderer>();
+    renderer->init(width, height, 1);
+
+    auto record_start = std::chrono::steady_clock::now();
+    renderer->init_svg(data.get());
+    auto record_end = std::chrono::steady_clock::now();
+
+    // the view fitting the whole document is zoom 1 below
+    renderer->set_view(1.f, 0.f, 0.f);
+    renderer->draw();
+    SVGCullStats tree = renderer->CullStats();
+    std::printf("parsed and recorded in %.1f ms, %u groups, %u draws\n",
+                std::chrono::duration<double, std::milli>(record_end - record_start).count(),
+                tree.groups, tree.draws);
+
+    float doc_size = svg_path.empty() ? blocks * kBlockSize : std::max(width, height);
+    float fit = std::min(width, height) / doc_size;
+
+    std::printf("%-8s %-8s %12s %14s %14s\n", "zoom", "culling", "ms/frame", "draws/frame",
+                "culled/frame");
+
+    const float zooms[] = {1.f, 4.f, 16.f, 64.f};
+    for (float zoom : zooms) {
+        float scale = fit * zoom;
+        // the view pans diagonally from the top left to the bottom right corner
+        float travel_x = std::max(doc_size * scale - width, 0.f);
+        float travel_y = std::max(doc_size * scale - height, 0.f);
+
+        for (bool culling : {false, true}) {
+            renderer->set_culling(culling);
+
+            // first frame of every run flattens and uploads, keep it out
+            renderer->set_view(scale, 0.f, 0.f);
+            renderer->draw();
+            glFinish();
+
+            uint64_t draws = 0;
+            uint64_t culled = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (int32_t i = 0; i < frames; i++) {
+                float t = frames > 1 ? static_cast<float>(i) / (frames - 1) : 0.f;
+                renderer->set_view(scale, -travel_x * t, -travel_y * t);
+                renderer->draw();
+                glFinish();
+
+                SVGCullStats stats = renderer->CullStats();
+                draws += culling ? stats.issued_draws : tree.draws;
+                culled += culling ? stats.culled_draws : 0;
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+            std::printf("%-8.0f %-8s %12.3f %14.0f %14.0f\n", zoom, culling ? "on" : "off",
+                        ms / frames, static_cast<double>(draws) / frames,
+                        static_cast<double>(culled) / frames);
+        }
+    }
+
+    renderer.reset();
+    egl.destroy();
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Rasterize a directory of SVGs into thumbnails on the CPU, no GPU or EGL:
+//
+//   svg_raster --dir svgs --size 256 --threads 1,2,4,8 --repeat 3 --out thumbs
+//
+// Every SVG is parsed with the same SVGDom the app uses, recorded into a
+// TileRasterCanvas, fitted into size x size and rasterized tile by tile on a
+// WorkStealingPool. The SVGs themselves are spread over the same pool, so
+// small thumbnails with few tiles still keep every thread busy. Prints SVGs
+// per second for every thread count and optionally writes the thumbnails of
+// the first run as PPM.
+
+#include "span_blend.hpp"
+#include "tile_raster_canvas.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <skity/svg/svg_dom.hpp>
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SvgFile {
+    std::string name = {};
+    std::shared_ptr<skity::Data> data = {};
+};
+
+static std::shared_ptr<skity::Data> load_file_data(std::string const &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "can not open %s\n", path.c_str());
+        return nullptr;
+    }
+
+    std::vector<char> buf{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    return skity::Data::MakeWithCopy(buf.data(), buf.size());
+}
+
+static std::vector<SvgFile> load_svg_dir(std::string const &dir) {
+    std::vector<std::string> names;
+
+    DIR *handle = opendir(dir.c_str());
+    if (!handle) {
+        std::fprintf(stderr, "can not open directory %s\n", dir.c_str());
+        return {};
+    }
+
+    while (auto entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".svg") == 0) {
+            names.emplace_back(std::move(name));
+        }
+    }
+    closedir(handle);
+
+    std::sort(names.begin(), names.end());
+
+    std::vector<SvgFile> files;
+    for (auto const &name : names) {
+        auto data = load_file_data(dir + "/" + name);
+        if (data) {
+            files.emplace_back(SvgFile{name, std::move(data)});
+        }
+    }
+
+    return files;
+}
+
+static std::vector<uint32_t> parse_thread_counts(const char *list) {
+    std::vector<uint32_t> counts;
+
+    for (const char *p = list; *p;) {
+        char *end = nullptr;
+        long value = std::strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        if (value > 0) {
+            counts.emplace_back(static_cast<uint32_t>(value));
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    return counts;
+}
+
+static bool write_ppm(std::string const &path, std::vector<uint32_t> const &pixels,
+                      uint32_t size) {
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "can not write %s\n", path.c_str());
+        return false;
+    }
+
+    // cleared to opaque white, so the premultiplied pixels are the final colors
+    std::fprintf(file, "P6\n%u %u\n255\n", size, size);
+    for (uint32_t pixel : pixels) {
+        std::fwrite(&pixel, 1, 3, file);
+    }
+    std::fclose(file);
+
+    return true;
+}
+
+int main(int argc, const char **argv) {
+    std::string dir;
+    std::string out;
+    uint32_t size = 256;
+    uint32_t repeat = 3;
+    std::vector<uint32_t> thread_counts;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--dir") == 0) {
+            dir = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--size") == 0) {
+            size = static_cast<uint32_t>(std::max(1, std::atoi(argv[i + 1])));
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            thread_counts = parse_thread_counts(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--repeat") == 0) {
+            repeat = static_cast<uint32_t>(std::max(1, std::atoi(argv[i + 1])));
+        } else if (std::strcmp(argv[i], "--out") == 0) {
+            out = argv[i + 1];
+        } else {
+            dir.clear();
+            break;
+        }
+    }
+
+    if (dir.empty()) {
+        std::fprintf(stderr,
+                     "usage: %s --dir DIR [--size N] [--threads N,N,...] [--repeat N] "
+                     "[--out DIR]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    if (thread_counts.empty()) {
+        // powers of two up to the core count
+        uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t n = 1; n < cores; n *= 2) {
+            thread_counts.emplace_back(n);
+        }
+        thread_counts.emplace_back(cores);
+    }
+
+    auto files = load_svg_dir(dir);
+    if (files.empty()) {
+        std::fprintf(stderr, "no svg files in %s\n", dir.c_str());
+        return 1;
+    }
+
+    uint32_t clear_color = premultiply_color(1.f, 1.f, 1.f, 1.f);
+    skity::Rect target = skity::Rect::MakeLTRB(0.f, 0.f, size, size);
+
+    std::printf("%zu svgs, %ux%u thumbnails\n", files.size(), size, size);
+    std::printf("%-8s %12s %12s %10s %10s\n", "threads", "svgs/s", "ms/svg", "speedup", "steals");
+
+    bool write_out = !out.empty();
+    double base_rate = 0.0;
+
+    for (uint32_t threads : thread_counts) {
+        WorkStealingPool pool(threads);
+
+        std::atomic<uint32_t> failed = {0};
+        std::atomic<uint64_t> draws = {0};
+        std::atomic<uint64_t> unsupported = {0};
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t r = 0; r < repeat; r++) {
+            pool.parallel_for(static_cast<uint32_t>(files.size()), [&](uint32_t index) {
+                auto dom = skity::SVGDom::MakeFromData(files[index].data.get());
+                if (!dom) {
+                    failed++;
+                    return;
+                }
+
+                TileRasterCanvas canvas(size, size);
+                dom->Render(&canvas);
+                canvas.fit_content(target);
+
+                std::vector<uint32_t> pixels(size * size);
+                canvas.rasterize(&pool, pixels.data(), size * sizeof(uint32_t), clear_color);
+
+                draws += canvas.Stats().draws;
+                unsupported += canvas.Stats().unsupported;
+
+                if (write_out && r == 0) {
+                    write_ppm(out + "/" + files[index].name + ".ppm", pixels, size);
+                }
+            });
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        write_out = false;
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double rendered = static_cast<double>(files.size()) * repeat;
+        double rate = seconds > 0.0 ? rendered / seconds : 0.0;
+        if (base_rate == 0.0) {
+            base_rate = rate;
+        }
+
+        std::printf("%-8u %12.1f %12.3f %9.2fx %10llu\n", threads, rate,
+                    rendered > 0.0 ? seconds * 1000.0 / rendered : 0.0,
+                    base_rate > 0.0 ? rate / base_rate : 0.0,
+                    static_cast<unsigned long long>(pool.Stats().steals));
+
+        if (failed > 0 || unsupported > 0) {
+            std::printf("         %u failed to parse, %llu of %llu draws unsupported\n",
+                        failed.load() / repeat,
+                        static_cast<unsigned long long>(unsupported.load()),
+                        static_cast<unsigned long long>(draws.load()));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Texture bandwidth at several draw scales, with and without mipmaps:
+//
+//   texture_bench --frames 100 --count 32
+//
+// Every frame draws --count copies of a 1024x1024 detailed image through a
+// canvas scale. Without mips every draw samples the full base level; with
+// mips MipImage picks the levels matching the scale. Prints ms/frame and the
+// bytes of texture levels sampled per frame.
+
+#include "headless_egl.hpp"
+#include "mip_image.hpp"
+#include "renderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+static std::shared_ptr<skity::Pixmap> make_detailed_image(uint32_t size) {
+    std::vector<uint32_t> pixels(size * size);
+
+    // fine stripes and checkers alias badly when minified without mips
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t r = ((x / 2 + y / 2) % 2) ? 0xFF : 0x20;
+            uint32_t g = (x % 3 == 0) ? 0xE0 : 0x30;
+            uint32_t b = ((x ^ y) & 0x10) ? 0xC0 : 0x40;
+            pixels[y * size + x] = 0xFF000000 | (b << 16) | (g << 8) | r;
+        }
+    }
+
+    auto data = skity::Data::MakeWithCopy(pixels.data(), pixels.size() * sizeof(uint32_t));
+    return std::make_shared<skity::Pixmap>(data, size * 4, size, size);
+}
+
+class TextureBenchRenderer : public Renderer {
+public:
+    void set_image(std::shared_ptr<MipImage> image) { image_ = std::move(image); }
+
+    void set_scale(float scale) { scale_ = scale; }
+
+    void set_count(int32_t count) { count_ = count; }
+
+protected:
+    void onDraw(skity::Canvas *canvas) override {
+        float size = image_->Level(0)->Width();
+        float cell = size * scale_;
+        int32_t columns = std::max(1, static_cast<int32_t>(Width() / std::max(cell, 1.f)));
+
+        skity::Rect dst = skity::Rect::MakeXYWH(0.f, 0.f, size, size);
+
+        for (int32_t i = 0; i < count_; i++) {
+            // wrap around the screen, overlapping draws are fine here
+            float x = std::fmod((i % columns) * cell, std::max(Width() - cell, 1.f));
+            float y = std::fmod((i / columns) * cell, std::max(Height() - cell, 1.f));
+
+            canvas->save();
+            canvas->translate(x, y);
+            canvas->scale(scale_, scale_);
+            image_->draw(canvas, dst);
+            canvas->restore();
+        }
+    }
+
+private:
+    std::shared_ptr<MipImage> image_ = {};
+    float scale_ = 1.f;
+    int32_t count_ = 32;
+};
+
+int main(int argc, const char **argv) {
+    int32_t width = 1280;
+    int32_t height = 720;
+    int32_t frames = 100;
+    int32_t count = 32;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            frames = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--count") == 0) {
+            count = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--width W] [--height H] [--frames N] [--count N]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    HeadlessEGL egl;
+    if (!egl.init(width, height)) {
+        return 1;
+    }
+
+    auto base = make_detailed_image(1024);
+
+    auto renderer = std::make_unique<TextureBenchRenderer>();
+    renderer->init(width, height, 1);
+    renderer->set_count(count);
+
+    std::printf("%-8s %-8s %12s %16s\n", "scale", "mipmaps", "ms/frame", "sampled MB/frame");
+
+    const float scales[] = {1.f, 0.5f, 0.25f, 0.125f, 0.0625f};
+    for (float scale : scales) {
+        for (bool mipmaps : {false, true}) {
+            auto image = MipImage::Make(base, mipmaps);
+            renderer->set_image(image);
+            renderer->set_scale(scale);
+
+            // first frame uploads the levels, keep it out of the numbers
+            renderer->draw();
+            glFinish();
+            image->reset_stats();
+
+            auto start = std::chrono::steady_clock::now();
+            for (int32_t i = 0; i < frames; i++) {
+                renderer->draw();
+                glFinish();
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            double mb = image->Stats().sampled_bytes / (1024.0 * 1024.0);
+
+            std::printf("%-8.4f %-8s %12.3f %16.2f\n", scale, mipmaps ? "on" : "off",
+                        frames > 0 ? ms / frames : 0.0, frames > 0 ? mb / frames : 0.0);
+        }
+    }
+
+    renderer.reset();
+    egl.destroy();
+
+    return 0;
+}